@@ -997,6 +997,10 @@ protected:
   void pickNodeFromQueue(SchedCandidate &Cand);
 };
 
+/// Create the standard converging machine scheduler, with its DAG
+/// mutations, so that a target can add mutations of its own.
+ScheduleDAGMILive *createGenericSchedLive(MachineSchedContext *C);
+
 } // namespace llvm
 
 #endif
@@ -19,6 +19,7 @@
 #include "llvm/Support/ErrorHandling.h"
 
 namespace llvm {
+class MCAlignFragment;
 class MCAsmLayout;
 class MCAssembler;
 class MCELFObjectTargetWriter;
@@ -119,6 +120,25 @@ public:
   /// \return - True on success.
   virtual bool writeNopData(uint64_t Count, MCObjectWriter *OW) const = 0;
 
+  /// Hook to pad a code alignment with more nops than it needs.  Targets
+  /// whose linker may delete code ahead of the alignment use this to leave
+  /// it room to realign.  If the hook returns true, \p Size is the padding
+  /// to emit instead of the usual amount.
+  virtual bool shouldInsertExtraNopBytesForCodeAlign(const MCAssembler &Asm,
+                                                     const MCAlignFragment &AF,
+                                                     unsigned &Size) {
+    return false;
+  }
+
+  /// Hook to record a relocation against the padding of a code alignment,
+  /// once layout is final, so that the linker can find it.  Return true if
+  /// a relocation was recorded.
+  virtual bool shouldInsertFixupForCodeAlign(MCAssembler &Asm,
+                                             const MCAsmLayout &Layout,
+                                             MCAlignFragment &AF) {
+    return false;
+  }
+
   /// Give backend an opportunity to finish layout after relaxation
   virtual void finishLayout(MCAssembler const &Asm,
                             MCAsmLayout &Layout) const {}
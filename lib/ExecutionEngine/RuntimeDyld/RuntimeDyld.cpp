@@ -19,6 +19,7 @@
 #include "RuntimeDyldMachO.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/COFF.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MutexGuard.h"
@@ -850,6 +851,17 @@ uint8_t *RuntimeDyldImpl::createStubFunction(uint8_t *Addr,
       writeInt32BE(Addr+40, 0x4E800420); // bctr
     }
     return Addr;
+  } else if (Arch == Triple::riscv || Arch == Triple::riscv64) {
+    // 0: auipc t1, %pcrel_hi(<got entry>)
+    // 4: ld    t1, %pcrel_lo(0b)(t1)   (lw on RV32)
+    // 8: jr    t1
+    // Instructions are little-endian whatever the byte order of the data,
+    // and the load has the register and immediate layout of the backend.
+    support::endian::write32le(Addr, 0x00000317);
+    support::endian::write32le(Addr + 4, Arch == Triple::riscv64 ? 0x31800183
+                                                                 : 0x31800103);
+    support::endian::write32le(Addr + 8, 0x00030067);
+    return Addr;
   } else if (Arch == Triple::systemz) {
     writeInt16BE(Addr,    0xC418);     // lgrl %r1,.+8
     writeInt16BE(Addr+2,  0x0000);
@@ -582,8 +582,9 @@ void RuntimeDyldELF::resolveMIPSRelocation(const SectionEntry &Section,
 }
 
 void RuntimeDyldELF::setMipsABI(const ObjectFile &Obj) {
-  if (Arch == Triple::UnknownArch ||
-      !StringRef(Triple::getArchTypePrefix(Arch)).equals("mips")) {
+  // Not every architecture has a prefix.
+  const char *ArchPrefix = Triple::getArchTypePrefix(Arch);
+  if (!ArchPrefix || !StringRef(ArchPrefix).equals("mips")) {
     IsMipsO32ABI = false;
     IsMipsN64ABI = false;
     return;
@@ -1074,6 +1075,142 @@ void RuntimeDyldELF::resolveSystemZRelocation(const SectionEntry &Section,
   }
 }
 
+// RISCV instructions are little-endian whatever the byte order of the data,
+// so they are patched here rather than with writeBytesUnaligned.  Replace the
+// bits of the instruction at LocalAddress selected by Mask with those of
+// Bits.
+static void applyRISCVInstFixup(uint8_t *LocalAddress, uint32_t Mask,
+                                uint32_t Bits) {
+  uint32_t Inst = support::endian::read32le(LocalAddress);
+  support::endian::write32le(LocalAddress, (Inst & ~Mask) | (Bits & Mask));
+}
+
+// Return the immediate fields of the RISCV instruction formats for Imm.
+static uint32_t getRISCVUImm(uint64_t Imm) {
+  // The low 12 bits are added back sign-extended, so round to nearest.
+  return (Imm + 0x800) & 0xfffff000;
+}
+
+// Loads, stores and branches still use the layouts of the old ISA, which
+// keep imm[6:0] in bits 16-10 and imm[11:7] in bits 21-17 (loads) or 31-27
+// (stores and branches, whose immediate is in halfwords).
+static const uint32_t RISCVLoadMask = 0x003ffc00, RISCVStoreMask = 0xf801fc00;
+
+static uint32_t getRISCVSplitImm(uint64_t Imm, unsigned HiShift) {
+  return ((Imm >> 7) & 0x1f) << HiShift | (Imm & 0x7f) << 10;
+}
+
+// Install the 12-bit immediate Imm of the I-type instruction at
+// LocalAddress.  Loads, including the hardcoded return, have a layout of
+// their own; the other I-type instructions use the standard one.
+static void applyRISCVIImm(uint8_t *LocalAddress, uint64_t Imm) {
+  switch (support::endian::read32le(LocalAddress) & 0x7f) {
+  case 0x03: // LOAD
+  case 0x07: // LOAD-FP
+  case 0x6b: // ret
+    applyRISCVInstFixup(LocalAddress, RISCVLoadMask, getRISCVSplitImm(Imm, 17));
+    break;
+  default:
+    applyRISCVInstFixup(LocalAddress, 0xfff00000, (Imm & 0xfff) << 20);
+    break;
+  }
+}
+
+static void applyRISCVSImm(uint8_t *LocalAddress, uint64_t Imm) {
+  applyRISCVInstFixup(LocalAddress, RISCVStoreMask, getRISCVSplitImm(Imm, 27));
+}
+
+static uint32_t getRISCVJImm(uint64_t Imm) {
+  return ((Imm & 0x100000) << 11) | ((Imm & 0x7fe) << 20) |
+         ((Imm & 0x800) << 9) | (Imm & 0xff000);
+}
+
+void RuntimeDyldELF::resolveRISCVRelocation(const SectionEntry &Section,
+                                            uint64_t Offset, uint64_t Value,
+                                            uint32_t Type, int64_t Addend,
+                                            uint64_t SymOffset) {
+  uint8_t *LocalAddress = Section.getAddressWithOffset(Offset);
+  uint64_t FinalAddress = Section.getLoadAddressWithOffset(Offset);
+
+  DEBUG(dbgs() << "resolveRISCVRelocation, LocalAddress: "
+               << format("%p", LocalAddress)
+               << " FinalAddress: 0x" << format("%llx", FinalAddress)
+               << " Value: 0x" << format("%llx", Value) << " Type: 0x"
+               << format("%x", Type) << " Addend: 0x" << format("%llx", Addend)
+               << "\n");
+
+  const uint32_t UMask = 0xfffff000;
+  switch (Type) {
+  default:
+    llvm_unreachable("Relocation type not implemented yet!");
+    break;
+  case ELF::R_RISCV_32:
+    writeBytesUnaligned(Value + Addend, LocalAddress, 4);
+    break;
+  case ELF::R_RISCV_64:
+    writeBytesUnaligned(Value + Addend, LocalAddress, 8);
+    break;
+  case ELF::R_RISCV_32_PCREL: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<32>(Delta) && "R_RISCV_32_PCREL overflow");
+    writeBytesUnaligned(Delta, LocalAddress, 4);
+    break;
+  }
+  case ELF::R_RISCV_HI20:
+    applyRISCVInstFixup(LocalAddress, UMask, getRISCVUImm(Value + Addend));
+    break;
+  case ELF::R_RISCV_LO12_I:
+    applyRISCVIImm(LocalAddress, Value + Addend);
+    break;
+  case ELF::R_RISCV_LO12_S:
+    applyRISCVSImm(LocalAddress, Value + Addend);
+    break;
+  case ELF::R_RISCV_PCREL_HI20: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<32>(Delta + 0x800) && "R_RISCV_PCREL_HI20 overflow");
+    applyRISCVInstFixup(LocalAddress, UMask, getRISCVUImm(Delta));
+    break;
+  }
+  // The low part is that of the offset computed by the auipc at SymOffset,
+  // not of one relative to this instruction.
+  case ELF::R_RISCV_PCREL_LO12_I: {
+    int64_t Delta =
+        (Value + Addend) - Section.getLoadAddressWithOffset(SymOffset);
+    applyRISCVIImm(LocalAddress, Delta);
+    break;
+  }
+  case ELF::R_RISCV_PCREL_LO12_S: {
+    int64_t Delta =
+        (Value + Addend) - Section.getLoadAddressWithOffset(SymOffset);
+    applyRISCVSImm(LocalAddress, Delta);
+    break;
+  }
+  case ELF::R_RISCV_BRANCH: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<13>(Delta) && "R_RISCV_BRANCH overflow");
+    // Branches use the immediate fields of stores, in halfwords.
+    applyRISCVInstFixup(LocalAddress, RISCVStoreMask,
+                        getRISCVSplitImm(Delta >> 1, 27));
+    break;
+  }
+  case ELF::R_RISCV_JAL: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<21>(Delta) && "R_RISCV_JAL overflow");
+    applyRISCVInstFixup(LocalAddress, UMask, getRISCVJImm(Delta));
+    break;
+  }
+  // An auipc and jalr pair.
+  case ELF::R_RISCV_CALL:
+  case ELF::R_RISCV_CALL_PLT: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<32>(Delta + 0x800) && "R_RISCV_CALL overflow");
+    applyRISCVInstFixup(LocalAddress, UMask, getRISCVUImm(Delta));
+    applyRISCVIImm(LocalAddress + 4, Delta);
+    break;
+  }
+  }
+}
+
 // The target location for the relocation is described by RE.SectionID and
 // RE.Offset.  RE.SectionID can be used to find the SectionEntry.  Each
 // SectionEntry has three members describing its location.
@@ -1147,6 +1284,10 @@ void RuntimeDyldELF::resolveRelocation(const SectionEntry &Section,
   case Triple::systemz:
     resolveSystemZRelocation(Section, Offset, Value, Type, Addend);
     break;
+  case Triple::riscv:
+  case Triple::riscv64:
+    resolveRISCVRelocation(Section, Offset, Value, Type, Addend, SymOffset);
+    break;
   default:
     llvm_unreachable("Unsupported CPU type!");
   }
@@ -1686,6 +1827,96 @@ RuntimeDyldELF::processRelocationRef(
                         Addend);
     else
       resolveRelocation(Section, Offset, StubAddress, RelType, Addend);
+  } else if (Arch == Triple::riscv || Arch == Triple::riscv64) {
+    uint32_t GOTEntryType =
+        Arch == Triple::riscv64 ? ELF::R_RISCV_64 : ELF::R_RISCV_32;
+    if (RelType == ELF::R_RISCV_PCREL_HI20) {
+      PCRelHiTargets[std::make_pair(SectionID, Offset)] = Value;
+      processSimpleRelocation(SectionID, Offset, RelType, Value);
+    } else if (RelType == ELF::R_RISCV_GOT_HI20) {
+      // Point the auipc at a GOT entry holding the address of the symbol.
+      uint64_t GOTOffset = allocateGOTEntries(SectionID, 1);
+      RelocationEntry RE =
+          computeGOTOffsetRE(SectionID, GOTOffset, Value.Offset, GOTEntryType);
+      if (Value.SymbolName)
+        addRelocationForSymbol(RE, Value.SymbolName);
+      else
+        addRelocationForSection(RE, Value.SectionID);
+
+      RelocationValueRef GOTEntry;
+      GOTEntry.SectionID = GOTSectionID;
+      GOTEntry.Addend = GOTOffset;
+      PCRelHiTargets[std::make_pair(SectionID, Offset)] = GOTEntry;
+      processSimpleRelocation(SectionID, Offset, ELF::R_RISCV_PCREL_HI20,
+                              GOTEntry);
+    } else if (RelType == ELF::R_RISCV_PCREL_LO12_I ||
+               RelType == ELF::R_RISCV_PCREL_LO12_S) {
+      // The symbol is the label of the auipc that computed the high part, so
+      // the relocation is against the target of that auipc, with the offset
+      // of the auipc in SymOffset.
+      auto I = PCRelHiTargets.find(
+          std::make_pair(Value.SectionID, uint64_t(Value.Addend)));
+      if (Value.SymbolName || Value.SectionID != SectionID ||
+          I == PCRelHiTargets.end())
+        return make_error<RuntimeDyldError>(
+            "Can't find matching R_RISCV_PCREL_HI20 reloc");
+      const RelocationValueRef &HiTarget = I->second;
+      RelocationEntry RE(SectionID, Offset, RelType, HiTarget.Addend,
+                         Value.Addend);
+      if (HiTarget.SymbolName)
+        addRelocationForSymbol(RE, HiTarget.SymbolName);
+      else
+        addRelocationForSection(RE, HiTarget.SectionID);
+    } else if ((RelType == ELF::R_RISCV_CALL ||
+                RelType == ELF::R_RISCV_CALL_PLT ||
+                RelType == ELF::R_RISCV_JAL) && Value.SymbolName) {
+      // An external function may be anywhere in the address space, so call
+      // it through a stub that loads its address from the GOT, as a PLT
+      // entry would.
+      DEBUG(dbgs() << "\t\tThis is a RISCV call to an external function.");
+      SectionEntry &Section = Sections[SectionID];
+
+      // Look for an existing stub.
+      StubMap::const_iterator i = Stubs.find(Value);
+      uint64_t StubOffset;
+      if (i != Stubs.end()) {
+        StubOffset = i->second;
+        DEBUG(dbgs() << " Stub function found\n");
+      } else {
+        // Create a new stub function.
+        DEBUG(dbgs() << " Create a new stub function\n");
+
+        uintptr_t BaseAddress = uintptr_t(Section.getAddress());
+        uintptr_t StubAlignment = getStubAlignment();
+        uintptr_t StubAddress =
+            (BaseAddress + Section.getStubOffset() + StubAlignment - 1) &
+            -StubAlignment;
+        StubOffset = StubAddress - BaseAddress;
+        Stubs[Value] = StubOffset;
+        createStubFunction((uint8_t *)StubAddress);
+        Section.advanceStubOffset(StubOffset - Section.getStubOffset() +
+                                  getMaxStubSize());
+
+        uint64_t GOTOffset = allocateGOTEntries(SectionID, 1);
+        RelocationEntry HiRE(SectionID, StubOffset, ELF::R_RISCV_PCREL_HI20,
+                             GOTOffset);
+        RelocationEntry LoRE(SectionID, StubOffset + 4,
+                             ELF::R_RISCV_PCREL_LO12_I, GOTOffset, StubOffset);
+        addRelocationForSection(HiRE, GOTSectionID);
+        addRelocationForSection(LoRE, GOTSectionID);
+
+        // Fill in the value of the symbol we're targeting into the GOT
+        addRelocationForSymbol(
+            computeGOTOffsetRE(SectionID, GOTOffset, 0, GOTEntryType),
+            Value.SymbolName);
+      }
+
+      // Make the target call a call into the stub.
+      RelocationEntry RE(SectionID, Offset, RelType, StubOffset);
+      addRelocationForSection(RE, SectionID);
+    } else {
+      processSimpleRelocation(SectionID, Offset, RelType, Value);
+    }
   } else if (Arch == Triple::x86_64) {
     if (RelType == ELF::R_X86_64_PLT32) {
       // The way the PLT relocations normally work is that the linker allocates
@@ -1790,9 +2021,11 @@ size_t RuntimeDyldELF::getGOTEntrySize() {
   case Triple::ppc64:
   case Triple::ppc64le:
   case Triple::systemz:
+  case Triple::riscv64:
     Result = sizeof(uint64_t);
     break;
   case Triple::x86:
+  case Triple::riscv:
   case Triple::arm:
   case Triple::thumb:
     Result = sizeof(uint32_t);
@@ -1847,6 +2080,7 @@ Error RuntimeDyldELF::finalizeLoad(const ObjectFile &Obj,
   if (IsMipsO32ABI)
     if (!PendingRelocs.empty())
       return make_error<RuntimeDyldError>("Can't find matching LO16 reloc");
+  PCRelHiTargets.clear();
 
   // If necessary, allocate the global offset table
   if (GOTSectionID != 0) {
@@ -1905,6 +2139,17 @@ bool RuntimeDyldELF::isCompatibleFile(const object::ObjectFile &Obj) const {
 }
 
 bool RuntimeDyldELF::relocationNeedsStub(const RelocationRef &R) const {
+  if (Arch == Triple::riscv || Arch == Triple::riscv64) {
+    switch (R.getType()) {
+    case ELF::R_RISCV_CALL:
+    case ELF::R_RISCV_CALL_PLT:
+    case ELF::R_RISCV_JAL:
+      return true;
+    default:
+      return false;
+    }
+  }
+
   if (Arch != Triple::x86_64)
     return true;  // Conservative answer
 
@@ -59,6 +59,10 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
                                uint64_t Value, uint32_t Type, int64_t Addend,
                                uint64_t SymOffset, SID SectionID);
 
+  void resolveRISCVRelocation(const SectionEntry &Section, uint64_t Offset,
+                              uint64_t Value, uint32_t Type, int64_t Addend,
+                              uint64_t SymOffset);
+
   int64_t evaluateMIPS64Relocation(const SectionEntry &Section,
                                    uint64_t Offset, uint64_t Value,
                                    uint32_t Type,  int64_t Addend,
@@ -80,6 +84,8 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
       return 6; // 2-byte jmp instruction + 32-bit relative address
     else if (Arch == Triple::systemz)
       return 16;
+    else if (Arch == Triple::riscv || Arch == Triple::riscv64)
+      return 12; // auipc; l[wd]; jr
     else
       return 0;
   }
@@ -87,6 +93,8 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
   unsigned getStubAlignment() override {
     if (Arch == Triple::systemz)
       return 8;
+    else if (Arch == Triple::riscv || Arch == Triple::riscv64)
+      return 4;
     else
       return 1;
   }
@@ -149,6 +157,12 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
   // *LO16 part. (Mips specific)
   SmallVector<std::pair<RelocationValueRef, RelocationEntry>, 8> PendingRelocs;
 
+  // The targets of the R_RISCV_PCREL_HI20 and R_RISCV_GOT_HI20 relocations
+  // seen so far, keyed by the section and offset of their auipc.  The
+  // matching R_RISCV_PCREL_LO12_* relocations refer to the auipc rather than
+  // to the target. (RISCV specific)
+  DenseMap<std::pair<SID, uint64_t>, RelocationValueRef> PCRelHiTargets;
+
   // When a module is loaded we save the SectionID of the EH frame section
   // in a table until we receive a request to register all unregistered
   // EH frame sections with the memory manager.
@@ -264,6 +264,10 @@ uint64_t MCAssembler::computeFragmentSize(const MCAsmLayout &Layout,
     const MCAlignFragment &AF = cast<MCAlignFragment>(F);
     unsigned Offset = Layout.getFragmentOffset(&AF);
     unsigned Size = OffsetToAlignment(Offset, AF.getAlignment());
+    // The target may want extra nops in code for the linker to trim.
+    if (AF.hasEmitNops() && AF.getParent()->UseCodeAlign() &&
+        getBackend().shouldInsertExtraNopBytesForCodeAlign(*this, AF, Size))
+      return Size;
     // If we are padding with nops, force the padding to be larger than the
     // minimum nop size.
     if (Size > 0 && AF.hasEmitNops()) {
@@ -680,6 +684,13 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   // Evaluate and apply the fixups, generating relocation entries as necessary.
   for (MCSection &Sec : *this) {
     for (MCFragment &Frag : Sec) {
+      // Code alignments have no fixups of their own, but the target may
+      // want a relocation against their padding.
+      if (auto *AF = dyn_cast<MCAlignFragment>(&Frag)) {
+        if (AF->hasEmitNops() && Sec.UseCodeAlign())
+          getBackend().shouldInsertFixupForCodeAlign(*this, Layout, *AF);
+        continue;
+      }
       // Data and relaxable fragments both have fixups.  So only process
       // those here.
       // FIXME: Is there a better way to do this?  MCEncodedFragmentWithFixups
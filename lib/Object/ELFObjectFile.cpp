@@ -117,6 +117,12 @@ SubtargetFeatures ELFObjectFileBase::getFeatures() const {
 
     return Features;
   }
+  case ELF::EM_RISCV: {
+    // The base ISA follows from the ELF class; extensions aren't recorded.
+    SubtargetFeatures Features;
+    Features.AddFeature(getBytesInAddress() == 8 ? "rv64" : "rv32");
+    return Features;
+  }
   default:
     return SubtargetFeatures();
   }
@@ -7,10 +7,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "MCTargetDesc/RISCVCompressInst.h"
 #include "MCTargetDesc/RISCVMCTargetDesc.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCParser/MCParsedAsmOperand.h"
 #include "llvm/MC/MCParser/MCTargetAsmParser.h"
 #include "llvm/MC/MCStreamer.h"
@@ -182,6 +184,9 @@ public:
   bool isMemDisp20(RegisterKind RegKind, bool HasIndex) const {
     return isMem(RegKind, HasIndex) && inRange(Mem.Disp, -524288, 524287);
   }
+  bool isMemReg(RegisterKind RegKind) const {
+    return isMem(RegKind, false) && !Mem.Disp;
+  }
 
   // Override MCParsedAsmOperand.
   SMLoc getStartLoc() const override { return StartLoc; }
@@ -198,6 +203,10 @@ public:
     assert(N == 1 && "Invalid number of operands");
     addExpr(Inst, getImm());
   }
+  void addMemRegOperands(MCInst &Inst, unsigned N) const {
+    assert(N == 1 && "Invalid number of operands");
+    Inst.addOperand(MCOperand::createReg(Mem.Base));
+  }
 
   // Used by the TableGen code to check for particular operand types.
   bool isPCReg() const { return isReg(PCReg); }
@@ -213,7 +222,10 @@ public:
   bool isPairFP64() const { return isReg(PairFP64Reg); }
   bool isPairFP128() const { return isReg(PairFP128Reg); }
   bool isFP128() const { return isReg(FP128Reg); }
+  bool isMemReg32() const { return isMemReg(GR32Reg); }
+  bool isMemReg64() const { return isMemReg(GR64Reg); }
   bool isU4Imm() const { return isImm(0, 15); }
+  bool isFenceArg() const { return isImm(0, 15); }
   bool isU12Imm() const { return isImm(0, 4096); }
   bool isS12Imm() const { return isImm(-2048, 2047); }
   bool isU20Imm() const { return isImm(0, 1048576); }
@@ -303,6 +315,7 @@ class RISCVAsmParser : public MCTargetAsmParser {
 
 private:
   const MCSubtargetInfo &STI;
+  const MCInstrInfo &MII;
   MCAsmParser &Parser;
   struct Register {
     char Prefix;
@@ -327,12 +340,16 @@ private:
                                     RISCVOperand::RegisterKind RegKind,
                                     bool HasIndex);
 
+  OperandMatchResultTy parseMemReg(OperandVector &Operands,
+                                   const unsigned *Regs,
+                                   RISCVOperand::RegisterKind RegKind);
+
   bool parseOperand(OperandVector &Operands, StringRef Mnemonic);
 
 public:
   RISCVAsmParser(const MCSubtargetInfo &sti, MCAsmParser &parser,
                  const MCInstrInfo &MII, const MCTargetOptions &Options)
-      : MCTargetAsmParser(Options, sti), STI(sti), Parser(parser) {
+      : MCTargetAsmParser(Options, sti), STI(sti), MII(MII), Parser(parser) {
     MCAsmParserExtension::Initialize(Parser);
 
     // Initialize the set of available features.
@@ -358,6 +375,16 @@ public:
     return parseRegister(Operands, 'x', GR64Regs, RISCVOperand::GR64Reg);
   }
 
+  OperandMatchResultTy parseMemReg32(OperandVector &Operands) {
+    return parseMemReg(Operands, GR32Regs, RISCVOperand::GR32Reg);
+  }
+
+  OperandMatchResultTy parseMemReg64(OperandVector &Operands) {
+    return parseMemReg(Operands, GR64Regs, RISCVOperand::GR64Reg);
+  }
+
+  OperandMatchResultTy parseFenceArg(OperandVector &Operands);
+
   OperandMatchResultTy parsePairGR64(OperandVector &Operands) {
     return parseRegister(Operands, 'x', PairGR64Regs,
                          RISCVOperand::PairGR64Reg);
@@ -684,6 +711,77 @@ RISCVAsmParser::parseAddress(OperandVector &Operands, const unsigned *Regs,
   return MatchOperand_Success;
 }
 
+// Parse the address of an instruction that has no displacement, such as an
+// AMO, and add it to Operands.  The base register is written in
+// parentheses, optionally after the zero displacement that the printer
+// writes.  Regs and RegKind are as for parseAddress.
+RISCVAsmParser::OperandMatchResultTy
+RISCVAsmParser::parseMemReg(OperandVector &Operands, const unsigned *Regs,
+                            RISCVOperand::RegisterKind RegKind) {
+  SMLoc StartLoc = Parser.getTok().getLoc();
+  if (getLexer().is(AsmToken::Integer)) {
+    if (Parser.getTok().getIntVal() != 0) {
+      Error(StartLoc, "expected a zero offset");
+      return MatchOperand_ParseFail;
+    }
+    Parser.Lex();
+    if (getLexer().isNot(AsmToken::LParen)) {
+      Error(Parser.getTok().getLoc(), "expected '('");
+      return MatchOperand_ParseFail;
+    }
+  }
+  if (getLexer().isNot(AsmToken::LParen))
+    return MatchOperand_NoMatch;
+  Parser.Lex();
+
+  Register Reg;
+  OperandMatchResultTy Result = parseRegister(Reg, 'x', Regs);
+  if (Result == MatchOperand_NoMatch)
+    Error(Parser.getTok().getLoc(), "register expected");
+  if (Result != MatchOperand_Success)
+    return MatchOperand_ParseFail;
+
+  if (getLexer().isNot(AsmToken::RParen)) {
+    Error(Parser.getTok().getLoc(), "expected ')'");
+    return MatchOperand_ParseFail;
+  }
+  SMLoc EndLoc = Parser.getTok().getLoc();
+  Parser.Lex();
+
+  Operands.push_back(RISCVOperand::createMem(RegKind, Reg.Number, nullptr, 0,
+                                             StartLoc, EndLoc));
+  return MatchOperand_Success;
+}
+
+// Parse the predecessor or successor set of a fence, which is either a
+// subset of "iorw", in that order, or its 4-bit value.
+RISCVAsmParser::OperandMatchResultTy
+RISCVAsmParser::parseFenceArg(OperandVector &Operands) {
+  if (getLexer().isNot(AsmToken::Identifier))
+    return MatchOperand_NoMatch;
+
+  SMLoc StartLoc = Parser.getTok().getLoc();
+  StringRef Set = Parser.getTok().getIdentifier();
+  StringRef Order = "iorw";
+  int64_t Value = 0;
+  size_t Pos = 0;
+  for (char C : Set) {
+    size_t Bit = Order.find(C, Pos);
+    if (Bit == StringRef::npos) {
+      Error(StartLoc, "invalid fence set");
+      return MatchOperand_ParseFail;
+    }
+    Value |= 8 >> Bit;
+    Pos = Bit + 1;
+  }
+  SMLoc EndLoc = Parser.getTok().getEndLoc();
+  Parser.Lex();
+
+  Operands.push_back(RISCVOperand::createImm(
+      MCConstantExpr::create(Value, getContext()), StartLoc, EndLoc));
+  return MatchOperand_Success;
+}
+
 bool RISCVAsmParser::ParseDirective(AsmToken DirectiveID) {
   return true;
 }
@@ -806,6 +904,10 @@ bool RISCVAsmParser::MatchAndEmitInstruction(SMLoc IDLoc, unsigned &Opcode,
     return false;
   }
 #endif
+    // The RVC operand classes are wider than the encodings.
+    if (MII.get(Inst.getOpcode()).getSize() == 2 &&
+        !RISCV::isValidCompressedInst(Inst))
+      return Error(IDLoc, "invalid operands for compressed instruction");
     Inst.setLoc(IDLoc);
     Out.EmitInstruction(Inst, STI);
     return false;
@@ -0,0 +1,275 @@
+//===-- RISCVDisassembler.cpp - Disassembler for RISCV ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the RISCVDisassembler class.  The decoder tables are
+// generated from the instruction encodings, so the disassembler accepts what
+// RISCVMCCodeEmitter produces, including the load, store and branch layouts
+// that are still those of the old ISA.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCFixedLenDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/TargetRegistry.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-disassembler"
+
+typedef MCDisassembler::DecodeStatus DecodeStatus;
+
+namespace {
+class RISCVDisassembler : public MCDisassembler {
+public:
+  RISCVDisassembler(const MCSubtargetInfo &STI, MCContext &Ctx)
+    : MCDisassembler(STI, Ctx) {}
+  ~RISCVDisassembler() {}
+
+  // Override MCDisassembler.
+  DecodeStatus getInstruction(MCInst &Instr, uint64_t &Size,
+                              ArrayRef<uint8_t> Bytes, uint64_t Address,
+                              raw_ostream &VStream,
+                              raw_ostream &CStream) const override;
+
+  bool isRV64() const {
+    return STI.getFeatureBits()[RISCV::FeatureRV64];
+  }
+};
+} // end anonymous namespace
+
+static MCDisassembler *createRISCVDisassembler(const Target &T,
+                                               const MCSubtargetInfo &STI,
+                                               MCContext &Ctx) {
+  return new RISCVDisassembler(STI, Ctx);
+}
+
+extern "C" void LLVMInitializeRISCVDisassembler() {
+  // Register the disassembler.
+  TargetRegistry::RegisterMCDisassembler(TheRISCVTarget,
+                                         createRISCVDisassembler);
+  TargetRegistry::RegisterMCDisassembler(TheRISCV64Target,
+                                         createRISCVDisassembler);
+}
+
+// The register classes list their registers in encoding order, so a
+// register number is an index into its class.
+static DecodeStatus decodeRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                        unsigned RCID, const void *Decoder) {
+  const MCDisassembler *Dis = static_cast<const MCDisassembler *>(Decoder);
+  const MCRegisterClass &RC =
+    Dis->getContext().getRegisterInfo()->getRegClass(RCID);
+  if (RegNo >= RC.getNumRegs())
+    return MCDisassembler::Fail;
+  Inst.addOperand(MCOperand::createReg(RC.getRegister(RegNo)));
+  return MCDisassembler::Success;
+}
+
+static DecodeStatus DecodeGR32BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, RISCV::GR32BitRegClassID, Decoder);
+}
+
+static DecodeStatus DecodeGR32CBitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                                uint64_t Address,
+                                                const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, RISCV::GR32CBitRegClassID, Decoder);
+}
+
+static DecodeStatus DecodeGR64BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, RISCV::GR64BitRegClassID, Decoder);
+}
+
+static DecodeStatus DecodeFP32BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, RISCV::FP32BitRegClassID, Decoder);
+}
+
+static DecodeStatus DecodeFP64BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, RISCV::FP64BitRegClassID, Decoder);
+}
+
+template<unsigned N>
+static DecodeStatus decodeSImmOperand(MCInst &Inst, uint64_t Imm,
+                                      uint64_t Address, const void *Decoder) {
+  assert(isUInt<N>(Imm) && "Invalid immediate");
+  Inst.addOperand(MCOperand::createImm(SignExtend64<N>(Imm)));
+  return MCDisassembler::Success;
+}
+
+// c.lui holds bits 17-12 of the result, but the operand is the whole
+// 20-bit upper immediate, as for lui.
+static DecodeStatus decodeCLUIImmOperand(MCInst &Inst, uint64_t Imm,
+                                         uint64_t Address,
+                                         const void *Decoder) {
+  assert(isUInt<6>(Imm) && "Invalid immediate");
+  Inst.addOperand(MCOperand::createImm(SignExtend64<6>(Imm) & 0xfffff));
+  return MCDisassembler::Success;
+}
+
+// Undo getCMemEncoding for an offset from one of x8-x15.
+static DecodeStatus decodeCMemOperand(MCInst &Inst, uint64_t Imm,
+                                      uint64_t Address, const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(Imm >> 5));
+  return DecodeGR32CBitRegisterClass(Inst, Imm & 7, Address, Decoder);
+}
+
+// Likewise for an offset from sp, which isn't encoded.
+static DecodeStatus decodeCSPMemOperand(MCInst &Inst, uint64_t Imm,
+                                        uint64_t Address,
+                                        const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(Imm >> 5));
+  Inst.addOperand(MCOperand::createReg(RISCV::sp));
+  return MCDisassembler::Success;
+}
+
+static DecodeStatus decodeBranchInstruction(MCInst &Inst, unsigned Insn,
+                                            uint64_t Address,
+                                            const void *Decoder);
+static DecodeStatus decodeCallInstruction(MCInst &Inst, unsigned Insn,
+                                          uint64_t Address,
+                                          const void *Decoder);
+static DecodeStatus decodeJumpInstruction(MCInst &Inst, unsigned Insn,
+                                          uint64_t Address,
+                                          const void *Decoder);
+template<unsigned RCID>
+static DecodeStatus decodeStoreInstruction(MCInst &Inst, unsigned Insn,
+                                           uint64_t Address,
+                                           const void *Decoder);
+
+#include "RISCVGenDisassemblerTables.inc"
+
+static DecodeStatus decodeGPR(MCInst &Inst, uint64_t RegNo, uint64_t Address,
+                              const void *Decoder) {
+  if (static_cast<const RISCVDisassembler *>(Decoder)->isRV64())
+    return DecodeGR64BitRegisterClass(Inst, RegNo, Address, Decoder);
+  return DecodeGR32BitRegisterClass(Inst, RegNo, Address, Decoder);
+}
+
+// Conditional branches: the byte offset of the target, which is kept in
+// halfwords, and the two registers.
+static DecodeStatus decodeBranchInstruction(MCInst &Inst, unsigned Insn,
+                                            uint64_t Address,
+                                            const void *Decoder) {
+  uint64_t Imm = (fieldFromInstruction(Insn, 27, 5) << 7) |
+                 fieldFromInstruction(Insn, 10, 7);
+  Inst.addOperand(MCOperand::createImm(SignExtend64<12>(Imm) * 2));
+  if (decodeGPR(Inst, fieldFromInstruction(Insn, 22, 5), Address, Decoder) ==
+      MCDisassembler::Fail)
+    return MCDisassembler::Fail;
+  return decodeGPR(Inst, fieldFromInstruction(Insn, 17, 5), Address, Decoder);
+}
+
+// Stores: the source, of register class RCID, then the offset, whose
+// imm[11:7] and imm[6:0] are bits 31-27 and 16-10, and the base.
+template<unsigned RCID>
+static DecodeStatus decodeStoreInstruction(MCInst &Inst, unsigned Insn,
+                                           uint64_t Address,
+                                           const void *Decoder) {
+  if (decodeRegisterClass(Inst, fieldFromInstruction(Insn, 17, 5), RCID,
+                          Decoder) == MCDisassembler::Fail)
+    return MCDisassembler::Fail;
+  uint64_t Imm = (fieldFromInstruction(Insn, 27, 5) << 7) |
+                 fieldFromInstruction(Insn, 10, 7);
+  Inst.addOperand(MCOperand::createImm(SignExtend64<12>(Imm)));
+  return decodeGPR(Inst, fieldFromInstruction(Insn, 22, 5), Address, Decoder);
+}
+
+// Gather the offset of a jal back from imm[20|10:1|11|19:12].
+static int64_t getJalOffset(unsigned Insn) {
+  uint64_t Imm = (fieldFromInstruction(Insn, 31, 1) << 20) |
+                 (fieldFromInstruction(Insn, 12, 8) << 12) |
+                 (fieldFromInstruction(Insn, 20, 1) << 11) |
+                 (fieldFromInstruction(Insn, 21, 10) << 1);
+  return SignExtend64<21>(Imm);
+}
+
+// jal: the return register and the offset.
+static DecodeStatus decodeCallInstruction(MCInst &Inst, unsigned Insn,
+                                          uint64_t Address,
+                                          const void *Decoder) {
+  if (decodeGPR(Inst, fieldFromInstruction(Insn, 7, 5), Address, Decoder) ==
+      MCDisassembler::Fail)
+    return MCDisassembler::Fail;
+  Inst.addOperand(MCOperand::createImm(getJalOffset(Insn)));
+  return MCDisassembler::Success;
+}
+
+// j is jal x0, which leaves just the offset.
+static DecodeStatus decodeJumpInstruction(MCInst &Inst, unsigned Insn,
+                                          uint64_t Address,
+                                          const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(getJalOffset(Insn)));
+  return MCDisassembler::Success;
+}
+
+DecodeStatus RISCVDisassembler::getInstruction(MCInst &MI, uint64_t &Size,
+                                               ArrayRef<uint8_t> Bytes,
+                                               uint64_t Address,
+                                               raw_ostream &OS,
+                                               raw_ostream &CS) const {
+  // Instructions are little-endian and, unless the low two bits are both
+  // set, 16 bits long.
+  if (Bytes.size() < 2) {
+    Size = 0;
+    return MCDisassembler::Fail;
+  }
+
+  if ((Bytes[0] & 3) != 3) {
+    if (!STI.getFeatureBits()[RISCV::FeatureC]) {
+      Size = 2;
+      return MCDisassembler::Fail;
+    }
+    uint32_t Insn = Bytes[0] | (Bytes[1] << 8);
+    Size = 2;
+    DecodeStatus Result =
+      decodeInstruction(DecoderTable16, MI, Insn, Address, this, STI);
+    if (Result == MCDisassembler::Fail)
+      return Result;
+
+    // The stack-pointer forms of addi have no register field for sp.
+    if (MI.getOpcode() == RISCV::CADDI4SPN)
+      MI.insert(MI.begin() + 1, MCOperand::createReg(RISCV::sp));
+    else if (MI.getOpcode() == RISCV::CADDI16SP) {
+      MI.insert(MI.begin(), MCOperand::createReg(RISCV::sp));
+      MI.insert(MI.begin(), MCOperand::createReg(RISCV::sp));
+    }
+    return Result;
+  }
+
+  if (Bytes.size() < 4) {
+    Size = 0;
+    return MCDisassembler::Fail;
+  }
+
+  uint32_t Insn = Bytes[0] | (Bytes[1] << 8) | (Bytes[2] << 16) |
+                  (uint32_t(Bytes[3]) << 24);
+  Size = 4;
+
+  // The RV64 forms of the RV32 instructions share their encodings and are
+  // kept in a table of their own.
+  if (isRV64()) {
+    DecodeStatus Result =
+      decodeInstruction(DecoderTableRISCV6432, MI, Insn, Address, this, STI);
+    if (Result != MCDisassembler::Fail)
+      return Result;
+  }
+  return decodeInstruction(DecoderTable32, MI, Insn, Address, this, STI);
+}
@@ -57,8 +57,15 @@ void RISCVInstPrinter::printJALRMemOperand(const MCInst *MI, int opNum,
 
 void RISCVInstPrinter::printBranchTarget(const MCInst *MI, int opNum, 
                                          raw_ostream &OS) {
-    if(MI->getOperand(opNum).isImm()){
-      OS << ".+";//constant branch
+    const MCOperand &MO = MI->getOperand(opNum);
+    if(MO.isImm()){
+      //constant branch, as a byte offset from the branch
+      int64_t Offset = MO.getImm();
+      if (Offset < 0)
+        OS << ".-" << -Offset;
+      else
+        OS << ".+" << Offset;
+      return;
     }
     printOperand(MI, opNum, OS);
 }
@@ -71,6 +78,20 @@ void RISCVInstPrinter::printMemRegOperand(const MCInst *MI, int opNum,
      OS << ")";
 }
 
+// A fence set is printed as the letters of its members, from i down to w.
+void RISCVInstPrinter::printFenceArgOperand(const MCInst *MI, int OpNum,
+                                            raw_ostream &O) {
+  int64_t Value = MI->getOperand(OpNum).getImm();
+  assert(isUInt<4>(Value) && "Invalid fence argument");
+  if (Value == 0) {
+    O << "0";
+    return;
+  }
+  for (unsigned Bit = 0; Bit < 4; ++Bit)
+    if (Value & (8 >> Bit))
+      O << "iorw"[Bit];
+}
+
 void RISCVInstPrinter::printS12ImmOperand(const MCInst *MI, int OpNum,
                                            raw_ostream &O) {
   if(MI->getOperand(OpNum).isImm()){
@@ -52,6 +52,7 @@ private:
   void printMemOperand(const MCInst *MI, int OpNUm, raw_ostream &O);
   void printJALRMemOperand(const MCInst *MI, int OpNUm, raw_ostream &O);
   void printMemRegOperand(const MCInst *MI, int OpNUm, raw_ostream &O);
+  void printFenceArgOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printS32ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printU32ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printS64ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
@@ -0,0 +1,237 @@
+//===-- RISCVCompressInst.cpp - RVC compression ---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file maps RV32 instructions onto their 16-bit RVC forms.  Every
+// candidate is built with the operands of the original instruction and is
+// only accepted if isValidCompressedInst agrees, so the operand constraints
+// of the RVC encodings live in one place.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/RISCVCompressInst.h"
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+// Return true if Reg is one of x8-x15, which the 3-bit register fields of
+// the RVC formats address.
+static bool isCReg(unsigned Reg) {
+  switch (Reg) {
+  case RISCV::fp:
+  case RISCV::s0:
+  case RISCV::s1:
+  case RISCV::a0:
+  case RISCV::a1:
+  case RISCV::a2:
+  case RISCV::a3:
+  case RISCV::a4:
+  case RISCV::a5:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool isShamt(int64_t Imm) { return Imm > 0 && Imm < 32; }
+
+static bool isScaledUInt(int64_t Imm, unsigned Bits, unsigned Scale) {
+  return Imm >= 0 && Imm % Scale == 0 && isUIntN(Bits, Imm);
+}
+
+static bool isScaledInt(int64_t Imm, unsigned Bits, unsigned Scale) {
+  return Imm % Scale == 0 && isIntN(Bits, Imm);
+}
+
+bool RISCV::isValidCompressedInst(const MCInst &Inst) {
+  for (unsigned I = 0, E = Inst.getNumOperands(); I != E; ++I)
+    if (!Inst.getOperand(I).isReg() && !Inst.getOperand(I).isImm())
+      return false;
+
+  auto Reg = [&](unsigned I) { return Inst.getOperand(I).getReg(); };
+  auto Imm = [&](unsigned I) { return Inst.getOperand(I).getImm(); };
+
+  switch (Inst.getOpcode()) {
+  case RISCV::CNOP:
+  case RISCV::CEBREAK:
+    return true;
+  case RISCV::CADDI4SPN:
+    return isCReg(Reg(0)) && Reg(1) == RISCV::sp && Imm(2) != 0 &&
+           isScaledUInt(Imm(2), 10, 4);
+  case RISCV::CLW:
+  case RISCV::CSW:
+    return isCReg(Reg(0)) && isCReg(Reg(2)) && isScaledUInt(Imm(1), 7, 4);
+  case RISCV::CLWSP:
+    return Reg(0) != RISCV::zero && Reg(2) == RISCV::sp &&
+           isScaledUInt(Imm(1), 8, 4);
+  case RISCV::CSWSP:
+    return Reg(2) == RISCV::sp && isScaledUInt(Imm(1), 8, 4);
+  case RISCV::CADDI:
+    return Reg(1) != RISCV::zero && Imm(2) != 0 && isInt<6>(Imm(2));
+  case RISCV::CADDI16SP:
+    return Reg(1) == RISCV::sp && Imm(2) != 0 && isScaledInt(Imm(2), 10, 16);
+  case RISCV::CLI:
+    return Reg(0) != RISCV::zero && isInt<6>(Imm(1));
+  case RISCV::CLUI:
+    // The immediate is the upper 20 bits of the result and is sign-extended
+    // from bit 5 of the 6-bit field.
+    return Reg(0) != RISCV::zero && Reg(0) != RISCV::sp && Imm(1) != 0 &&
+           isInt<6>(SignExtend64<20>(Imm(1)));
+  case RISCV::CSRLI:
+  case RISCV::CSRAI:
+    return isCReg(Reg(1)) && isShamt(Imm(2));
+  case RISCV::CANDI:
+    return isCReg(Reg(1)) && isInt<6>(Imm(2));
+  case RISCV::CSUB:
+  case RISCV::CXOR:
+  case RISCV::COR:
+  case RISCV::CAND:
+    return isCReg(Reg(1)) && isCReg(Reg(2));
+  case RISCV::CSLLI:
+    return Reg(1) != RISCV::zero && isShamt(Imm(2));
+  case RISCV::CJ:
+  case RISCV::CJAL:
+    return isScaledInt(Imm(0), 12, 2);
+  case RISCV::CBEQZ:
+  case RISCV::CBNEZ:
+    return isCReg(Reg(0)) && isScaledInt(Imm(1), 9, 2);
+  case RISCV::CJR:
+  case RISCV::CJALR:
+    return Reg(0) != RISCV::zero;
+  case RISCV::CMV:
+    return Reg(0) != RISCV::zero && Reg(1) != RISCV::zero;
+  case RISCV::CADD:
+    return Reg(1) != RISCV::zero && Reg(2) != RISCV::zero;
+  }
+  return false;
+}
+
+// Store Candidate in Out if it is a valid RVC instruction.
+static bool tryCompress(MCInst &Out, const MCInst &Candidate) {
+  if (!RISCV::isValidCompressedInst(Candidate))
+    return false;
+  Out = Candidate;
+  return true;
+}
+
+// Compress a three-address operation into the two-address form Opcode,
+// swapping the sources if that makes the destination match.
+static bool tryCompressRR(MCInst &Out, unsigned Opcode, unsigned Rd,
+                          unsigned Rs1, unsigned Rs2, bool IsCommutable) {
+  if (IsCommutable && Rd != Rs1)
+    std::swap(Rs1, Rs2);
+  return Rd == Rs1 &&
+         tryCompress(Out,
+                     MCInstBuilder(Opcode).addReg(Rd).addReg(Rd).addReg(Rs2));
+}
+
+static bool tryCompressRI(MCInst &Out, unsigned Opcode, unsigned Rd,
+                          unsigned Rs1, int64_t Imm) {
+  return Rd == Rs1 &&
+         tryCompress(Out,
+                     MCInstBuilder(Opcode).addReg(Rd).addReg(Rd).addImm(Imm));
+}
+
+static bool tryCompressMV(MCInst &Out, unsigned Rd, unsigned Rs) {
+  return tryCompress(Out, MCInstBuilder(RISCV::CMV).addReg(Rd).addReg(Rs));
+}
+
+bool RISCV::compressInst(MCInst &Out, const MCInst &Inst) {
+  for (unsigned I = 0, E = Inst.getNumOperands(); I != E; ++I)
+    if (!Inst.getOperand(I).isReg() && !Inst.getOperand(I).isImm())
+      return false;
+
+  switch (Inst.getOpcode()) {
+  case RISCV::ADDI:
+  case RISCV::LLI: {
+    unsigned Rd = Inst.getOperand(0).getReg();
+    unsigned Rs1 = Inst.getOperand(1).getReg();
+    int64_t Imm = Inst.getOperand(2).getImm();
+    if (Rd == RISCV::zero && Rs1 == RISCV::zero && Imm == 0)
+      return tryCompress(Out, MCInstBuilder(RISCV::CNOP));
+    if (Rs1 == RISCV::zero)
+      return tryCompress(Out,
+                         MCInstBuilder(RISCV::CLI).addReg(Rd).addImm(Imm));
+    if (Imm == 0)
+      return tryCompressMV(Out, Rd, Rs1);
+    return tryCompressRI(Out, RISCV::CADDI, Rd, Rs1, Imm) ||
+           tryCompressRI(Out, RISCV::CADDI16SP, Rd, Rs1, Imm) ||
+           tryCompress(Out, MCInstBuilder(RISCV::CADDI4SPN)
+                                .addReg(Rd).addReg(Rs1).addImm(Imm));
+  }
+  case RISCV::ADD: {
+    unsigned Rd = Inst.getOperand(0).getReg();
+    unsigned Rs1 = Inst.getOperand(1).getReg();
+    unsigned Rs2 = Inst.getOperand(2).getReg();
+    if (Rs1 == RISCV::zero)
+      return tryCompressMV(Out, Rd, Rs2);
+    if (Rs2 == RISCV::zero)
+      return tryCompressMV(Out, Rd, Rs1);
+    return tryCompressRR(Out, RISCV::CADD, Rd, Rs1, Rs2, true);
+  }
+  case RISCV::SUB:
+  case RISCV::XOR:
+  case RISCV::OR:
+  case RISCV::AND: {
+    unsigned Opcode = Inst.getOpcode() == RISCV::SUB ? RISCV::CSUB :
+                      Inst.getOpcode() == RISCV::XOR ? RISCV::CXOR :
+                      Inst.getOpcode() == RISCV::OR ? RISCV::COR : RISCV::CAND;
+    return tryCompressRR(Out, Opcode, Inst.getOperand(0).getReg(),
+                         Inst.getOperand(1).getReg(),
+                         Inst.getOperand(2).getReg(),
+                         Inst.getOpcode() != RISCV::SUB);
+  }
+  case RISCV::ANDI:
+  case RISCV::SLLI:
+  case RISCV::SRLI:
+  case RISCV::SRAI: {
+    unsigned Opcode = Inst.getOpcode() == RISCV::ANDI ? RISCV::CANDI :
+                      Inst.getOpcode() == RISCV::SLLI ? RISCV::CSLLI :
+                      Inst.getOpcode() == RISCV::SRLI ? RISCV::CSRLI :
+                      RISCV::CSRAI;
+    return tryCompressRI(Out, Opcode, Inst.getOperand(0).getReg(),
+                         Inst.getOperand(1).getReg(),
+                         Inst.getOperand(2).getImm());
+  }
+  case RISCV::LUI:
+    return tryCompress(Out, MCInstBuilder(RISCV::CLUI)
+                                .addOperand(Inst.getOperand(0))
+                                .addOperand(Inst.getOperand(1)));
+  case RISCV::LW:
+  case RISCV::SW: {
+    bool IsLoad = Inst.getOpcode() == RISCV::LW;
+    for (unsigned Opcode : {IsLoad ? RISCV::CLWSP : RISCV::CSWSP,
+                            IsLoad ? RISCV::CLW : RISCV::CSW})
+      if (tryCompress(Out, MCInstBuilder(Opcode)
+                               .addOperand(Inst.getOperand(0))
+                               .addOperand(Inst.getOperand(1))
+                               .addOperand(Inst.getOperand(2))))
+        return true;
+    return false;
+  }
+  case RISCV::JALR: {
+    // jalr ret, 0(base) is c.jr or c.jalr when ret is zero or ra.
+    if (!Inst.getOperand(0).isReg() || Inst.getOperand(1).getImm() != 0)
+      return false;
+    unsigned Ret = Inst.getOperand(0).getReg();
+    if (Ret != RISCV::zero && Ret != RISCV::ra)
+      return false;
+    return tryCompress(Out, MCInstBuilder(Ret == RISCV::zero ? RISCV::CJR
+                                                             : RISCV::CJALR)
+                                .addOperand(Inst.getOperand(2)));
+  }
+  case RISCV::RET:
+    return tryCompress(Out, MCInstBuilder(RISCV::CJR).addReg(RISCV::ra));
+  case RISCV::SBREAK:
+    return tryCompress(Out, MCInstBuilder(RISCV::CEBREAK));
+  }
+  return false;
+}
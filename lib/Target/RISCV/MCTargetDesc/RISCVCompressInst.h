@@ -0,0 +1,34 @@
+//===-- RISCVCompressInst.h - RVC compression -------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the helpers that map RV32 instructions onto their 16-bit
+// RVC forms.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVCOMPRESSINST_H
+#define LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVCOMPRESSINST_H
+
+namespace llvm {
+class MCInst;
+
+namespace RISCV {
+// If Inst has a 16-bit equivalent, store it in Out and return true.
+// Instructions with symbolic operands are never compressed, as there are no
+// fixups for the scattered RVC immediates.
+bool compressInst(MCInst &Out, const MCInst &Inst);
+
+// Return true if the operands of the RVC instruction Inst fit its encoding.
+// The operand classes of the RVC instructions accept any register and a
+// 12- or 20-bit immediate, so this does the rest of the checking.
+bool isValidCompressedInst(const MCInst &Inst);
+} // end namespace RISCV
+} // end namespace llvm
+
+#endif
@@ -7,13 +7,19 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "MCTargetDesc/RISCVMCAsmBackend.h"
 #include "MCTargetDesc/RISCVMCFixups.h"
-#include "llvm/MC/MCAsmBackend.h"
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "llvm/MC/MCAsmLayout.h"
+#include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCELFObjectWriter.h"
+#include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCFixupKindInfo.h"
 #include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCValue.h"
+#include "llvm/Support/Endian.h"
 
 using namespace llvm;
 
@@ -44,39 +50,63 @@ static unsigned getRelaxedOpcode(unsigned Opcode) {
   return 0;
 }
 
-namespace {
-class RISCVMCAsmBackend : public MCAsmBackend {
-  uint8_t OSABI;
-public:
-  RISCVMCAsmBackend(uint8_t osABI)
-    : OSABI(osABI) {}
+// Install the bits of Bits selected by Mask in the little-endian
+// instruction word at Data.
+static void applyInstFixup(char *Data, uint32_t Mask, uint32_t Bits) {
+  uint32_t Insn = support::endian::read32le(Data);
+  support::endian::write32le(Data, (Insn & ~Mask) | (Bits & Mask));
+}
 
-  // Override MCAsmBackend
-  unsigned getNumFixupKinds() const override {
-    return RISCV::NumTargetFixupKinds;
-  }
-  const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const override;
-  void applyFixup(const MCFixup &Fixup, char *Data, unsigned DataSize,
-                  uint64_t Value, bool IsPCRel) const override;
-  bool mayNeedRelaxation(const MCInst &Inst) const override;
-  bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
-                            const MCRelaxableFragment *Fragment,
-                            const MCAsmLayout &Layout) const override;
-  void relaxInstruction(const MCInst &Inst, MCInst &Res) const override;
-  bool writeNopData(uint64_t Count, MCObjectWriter *OW) const override;
-  MCObjectWriter *createObjectWriter(raw_pwrite_stream &OS) const override {
-    return createRISCVObjectWriter(OS, OSABI);
-  }
-};
-} // end anonymous namespace
+// lui and auipc add a 20-bit upper immediate to the sign-extended 12-bit
+// immediate of the instruction after them, so round the upper part up when
+// bit 11 is set.
+static uint32_t getHi20Bits(uint64_t Value) {
+  return (Value + 0x800) & 0xfffff000;
+}
+
+static uint32_t getLo12IBits(uint64_t Value) {
+  return Value << 20;
+}
+
+// jal scatters its offset as imm[20|10:1|11|19:12] over bits 31-12.
+static uint32_t getJalBits(uint64_t Value) {
+  return (((Value >> 20) & 0x1) << 31) | (((Value >> 1) & 0x3ff) << 21) |
+         (((Value >> 11) & 0x1) << 20) | (((Value >> 12) & 0xff) << 12);
+}
+
+void RISCVMCAsmBackend::noteSubtarget(const MCSubtargetInfo &STI) {
+  if (STI.getFeatureBits()[RISCV::FeatureRelax])
+    ForceRelocs = true;
+  if (STI.getFeatureBits()[RISCV::FeatureC])
+    HasC = true;
+}
+
+unsigned RISCVMCAsmBackend::getNumFixupKinds() const {
+  return RISCV::NumTargetFixupKinds;
+}
 
 const MCFixupKindInfo &
 RISCVMCAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
   const static MCFixupKindInfo Infos[RISCV::NumTargetFixupKinds] = {
     { "fixup_riscv_brlo",  10, 7, MCFixupKindInfo::FKF_IsPCRel },
     { "fixup_riscv_brhi",  27, 5, MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_riscv_jal", 0, 20, MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_jal",  12, 20, MCFixupKindInfo::FKF_IsPCRel },
     // target offset(0) doesn't make sense here: bits are non continuous
+    // The call fixups cover an auipc/jalr pair.
+    { "fixup_riscv_call", 0, 64, MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_call_plt", 0, 64, MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_lo12", 20, 12, 0 },
+    { "fixup_riscv_hi20", 12, 20, 0 },
+    { "fixup_riscv_pcrel_lo12", 20, 12, MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_pcrel_hi20", 12, 20, MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_tprel_lo12", 20, 12, 0 },
+    { "fixup_riscv_tprel_hi20", 12, 20, 0 },
+    // The gp-relative fixups always become relocations, which are installed
+    // like those of %lo: in the split fields of loads and stores.
+    { "fixup_riscv_gprel_i", 20, 12, 0 },
+    { "fixup_riscv_gprel_s", 0, 32, 0 },
+    { "fixup_riscv_relax", 0, 0, 0 },
+    { "fixup_riscv_align", 0, 0, 0 },
   };
 
   if (Kind < FirstTargetFixupKind)
@@ -87,22 +117,90 @@ RISCVMCAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
   return Infos[Kind - FirstTargetFixupKind];
 }
 
+void RISCVMCAsmBackend::processFixupValue(const MCAssembler &Asm,
+                                          const MCAsmLayout &Layout,
+                                          const MCFixup &Fixup,
+                                          const MCFragment *DF,
+                                          const MCValue &Target,
+                                          uint64_t &Value, bool &IsResolved) {
+  switch (unsigned(Fixup.getKind())) {
+  case RISCV::fixup_riscv_relax:
+  case RISCV::fixup_riscv_align:
+    // These only mark places for the linker and always become relocations.
+    IsResolved = false;
+    return;
+  case RISCV::fixup_riscv_gprel_i:
+  case RISCV::fixup_riscv_gprel_s:
+    // Only the linker knows where gp points.
+    IsResolved = false;
+    return;
+  case RISCV::fixup_riscv_brlo:
+    // The offset of a branch is split over brlo and brhi, and the
+    // R_RISCV_BRANCH of brhi covers both.
+    return;
+  }
+
+  // Once the linker may delete code, the distance between two places in a
+  // section is only known at link time.
+  if (ForceRelocs && Fixup.getKind() >= FirstTargetFixupKind)
+    IsResolved = false;
+}
+
 void RISCVMCAsmBackend::applyFixup(const MCFixup &Fixup, char *Data,
                                    unsigned DataSize, uint64_t Value,
                                    bool IsPCRel) const {
   MCFixupKind Kind = Fixup.getKind();
   unsigned Offset = Fixup.getOffset();
+  // Fixups that became relocations leave nothing to install.
+  if (!Value)
+    return;
+
+  switch (unsigned(Kind)) {
+  case RISCV::fixup_riscv_hi20:
+  case RISCV::fixup_riscv_pcrel_hi20:
+  case RISCV::fixup_riscv_tprel_hi20:
+    assert(Offset + 4 <= DataSize && "Invalid fixup offset!");
+    applyInstFixup(Data + Offset, 0xfffff000, getHi20Bits(Value));
+    return;
+  case RISCV::fixup_riscv_lo12:
+  case RISCV::fixup_riscv_pcrel_lo12:
+  case RISCV::fixup_riscv_tprel_lo12:
+    assert(Offset + 4 <= DataSize && "Invalid fixup offset!");
+    applyInstFixup(Data + Offset, 0xfff00000, getLo12IBits(Value));
+    return;
+  case RISCV::fixup_riscv_call:
+  case RISCV::fixup_riscv_call_plt:
+    assert(Offset + 8 <= DataSize && "Invalid fixup offset!");
+    applyInstFixup(Data + Offset, 0xfffff000, getHi20Bits(Value));
+    applyInstFixup(Data + Offset + 4, 0xfff00000, getLo12IBits(Value));
+    return;
+  case RISCV::fixup_riscv_jal:
+    assert(Offset + 4 <= DataSize && "Invalid fixup offset!");
+    applyInstFixup(Data + Offset, 0xfffff000, getJalBits(Value));
+    return;
+  case RISCV::fixup_riscv_brlo:
+  case RISCV::fixup_riscv_brhi: {
+    // Both branch fixups see the whole offset; brhi installs the 5 bits
+    // above the 7 that brlo does.
+    const MCFixupKindInfo &Info = getFixupKindInfo(Kind);
+    uint64_t Bits = extractBitsForFixup(Kind, Value);
+    if (Kind == (MCFixupKind)RISCV::fixup_riscv_brhi)
+      Bits >>= 7;
+    uint32_t Mask = ((1u << Info.TargetSize) - 1) << Info.TargetOffset;
+    assert(Offset + 4 <= DataSize && "Invalid fixup offset!");
+    applyInstFixup(Data + Offset, Mask, Bits << Info.TargetOffset);
+    return;
+  }
+  }
+
   unsigned Size = (getFixupKindInfo(Kind).TargetSize + 7) / 8;
 
   assert(Offset + Size <= DataSize && "Invalid fixup offset!");
 
-  // Big-endian insertion of Size bytes.
+  // Little-endian insertion of Size bytes.
   Value = extractBitsForFixup(Kind, Value);
-  unsigned ShiftValue = (Size * 8) - 8;
-  for (unsigned I = 0; I != Size; ++I) {
-    Data[Offset + I] |= uint8_t(Value >> ShiftValue);
-    ShiftValue -= 8;
-  }
+  for (unsigned I = 0; I != Size; ++I)
+    Data[Offset + I] |= uint8_t(Value >> (I * 8));
 }
 
 bool RISCVMCAsmBackend::mayNeedRelaxation(const MCInst &Inst) const {
@@ -129,14 +227,62 @@ void RISCVMCAsmBackend::relaxInstruction(const MCInst &Inst,
 
 bool RISCVMCAsmBackend::writeNopData(uint64_t Count,
                                        MCObjectWriter *OW) const {
-  for (uint64_t I = 0; I != Count; ++I)
-    OW->write8(7);
+  // Pad to a halfword with zeros, then use c.nop if a halfword is left over
+  // and addi x0, x0, 0 for the rest.  Instructions are little-endian,
+  // whatever the byte order of the object file.
+  for (; Count % 2; --Count)
+    OW->write8(0);
+  if (Count % 4) {
+    OW->write8(0x01);
+    OW->write8(0x00);
+    Count -= 2;
+  }
+  for (; Count; Count -= 4) {
+    OW->write8(0x13);
+    OW->write8(0x00);
+    OW->write8(0x00);
+    OW->write8(0x00);
+  }
   return true;
 }
 
+bool RISCVMCAsmBackend::shouldInsertExtraNopBytesForCodeAlign(
+    const MCAssembler &Asm, const MCAlignFragment &AF, unsigned &Size) {
+  // Pad for the worst case, in which the code before the alignment ends
+  // just past a boundary.  The linker deletes what isn't needed once it
+  // knows the final addresses.
+  if (!ForceRelocs || AF.getAlignment() <= getMinimumNopLength())
+    return false;
+  Size = AF.getAlignment() - getMinimumNopLength();
+  return true;
+}
+
+bool RISCVMCAsmBackend::shouldInsertFixupForCodeAlign(
+    MCAssembler &Asm, const MCAsmLayout &Layout, MCAlignFragment &AF) {
+  unsigned Count;
+  if (!shouldInsertExtraNopBytesForCodeAlign(Asm, AF, Count) || Count == 0)
+    return false;
+
+  // R_RISCV_ALIGN has no symbol.  Its addend is the size of the padding.
+  MCContext &Ctx = Asm.getContext();
+  MCFixup Fixup =
+      MCFixup::create(0, MCConstantExpr::create(0, Ctx),
+                      MCFixupKind(RISCV::fixup_riscv_align), SMLoc());
+  bool IsPCRel = false;
+  uint64_t FixedValue = 0;
+  Asm.getWriter().recordRelocation(Asm, Layout, &AF, Fixup,
+                                   MCValue::get(Count), IsPCRel, FixedValue);
+  return true;
+}
+
+MCObjectWriter *
+RISCVMCAsmBackend::createObjectWriter(raw_pwrite_stream &OS) const {
+  return createRISCVObjectWriter(OS, OSABI, Is64Bit);
+}
+
 MCAsmBackend *llvm::createRISCVMCAsmBackend(const Target &T,
                                             const MCRegisterInfo &MRI,
                                             const Triple &TT, StringRef CPU) {
   uint8_t OSABI = MCELFObjectTargetWriter::getOSABI(TT.getOS());
-  return new RISCVMCAsmBackend(OSABI);
+  return new RISCVMCAsmBackend(OSABI, TT.isArch64Bit());
 }
@@ -0,0 +1,69 @@
+//===-- RISCVMCAsmBackend.h - RISCV assembler backend -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVMCASMBACKEND_H
+#define LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVMCASMBACKEND_H
+
+#include "llvm/MC/MCAsmBackend.h"
+
+namespace llvm {
+class MCSubtargetInfo;
+
+class RISCVMCAsmBackend : public MCAsmBackend {
+  uint8_t OSABI;
+  bool Is64Bit;
+
+  // Set once an instruction has been emitted for a subtarget with linker
+  // relaxation.  From then on the linker may delete code, so offsets
+  // within a section are left to it and code alignments get extra nops.
+  bool ForceRelocs;
+
+  // Set once an instruction has been emitted for a subtarget with RVC,
+  // which lets the linker delete and the alignments pad in 2-byte steps.
+  bool HasC;
+
+  unsigned getMinimumNopLength() const { return HasC ? 2 : 4; }
+
+public:
+  RISCVMCAsmBackend(uint8_t osABI, bool is64Bit)
+    : OSABI(osABI), Is64Bit(is64Bit), ForceRelocs(false), HasC(false) {}
+
+  // Note the features of a subtarget the streamer emitted code for.
+  void noteSubtarget(const MCSubtargetInfo &STI);
+
+  // Override MCAsmBackend
+  void reset() override {
+    ForceRelocs = false;
+    HasC = false;
+  }
+  unsigned getNumFixupKinds() const override;
+  const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const override;
+  void processFixupValue(const MCAssembler &Asm, const MCAsmLayout &Layout,
+                         const MCFixup &Fixup, const MCFragment *DF,
+                         const MCValue &Target, uint64_t &Value,
+                         bool &IsResolved) override;
+  void applyFixup(const MCFixup &Fixup, char *Data, unsigned DataSize,
+                  uint64_t Value, bool IsPCRel) const override;
+  bool mayNeedRelaxation(const MCInst &Inst) const override;
+  bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
+                            const MCRelaxableFragment *Fragment,
+                            const MCAsmLayout &Layout) const override;
+  void relaxInstruction(const MCInst &Inst, MCInst &Res) const override;
+  bool writeNopData(uint64_t Count, MCObjectWriter *OW) const override;
+  bool shouldInsertExtraNopBytesForCodeAlign(const MCAssembler &Asm,
+                                             const MCAlignFragment &AF,
+                                             unsigned &Size) override;
+  bool shouldInsertFixupForCodeAlign(MCAssembler &Asm,
+                                     const MCAsmLayout &Layout,
+                                     MCAlignFragment &AF) override;
+  MCObjectWriter *createObjectWriter(raw_pwrite_stream &OS) const override;
+};
+} // end namespace llvm
+
+#endif
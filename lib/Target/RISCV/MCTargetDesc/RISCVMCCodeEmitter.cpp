@@ -12,14 +12,17 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "mccodeemitter"
-#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "MCTargetDesc/RISCVMCExpr.h"
 #include "MCTargetDesc/RISCVMCFixups.h"
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
 #include "llvm/MC/MCCodeEmitter.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/EndianStream.h"
 
 using namespace llvm;
 
@@ -52,24 +55,40 @@ private:
                              SmallVectorImpl<MCFixup> &Fixups,
                              const MCSubtargetInfo &STI) const;
 
+  // Add the fixups for symbolic operand Expr of MI and return the
+  // in-place value, which is always 0.
+  unsigned getExprOpValue(const MCInst &MI, const MCExpr *Expr,
+                          SmallVectorImpl<MCFixup> &Fixups,
+                          const MCSubtargetInfo &STI) const;
+
+  // Emit CALL or CALL64 as an auipc/jalr pair through ra, or a direct tail
+  // call or one of the save/restore libcall pseudos as a pair through t0
+  // or t1.
+  void expandCall(const MCInst &MI, raw_ostream &OS,
+                  SmallVectorImpl<MCFixup> &Fixups,
+                  const MCSubtargetInfo &STI) const;
+
+  // Mark the fixup just added at Offset as one the linker may relax.
+  void addRelaxFixup(SmallVectorImpl<MCFixup> &Fixups, uint32_t Offset) const {
+    Fixups.push_back(MCFixup::create(Offset, MCConstantExpr::create(0, Ctx),
+                                     MCFixupKind(RISCV::fixup_riscv_relax)));
+  }
+
   //RISCV
+  // j is jal x0, so its target is encoded and fixed up like a call's.
   unsigned getJumpTargetEncoding(const MCInst &MI, unsigned int OpNum,
                                  SmallVectorImpl<MCFixup> &Fixups,
                                  const MCSubtargetInfo &STI) const {
-    const MCOperand &MO = MI.getOperand(OpNum);
-    //TODO: do we need to sign extend explicitly?
-    if (MO.isImm())
-      return MO.getImm() << 1;
-    llvm_unreachable("Jump with no immediate field");
+    return getPCRelEncoding(MI, OpNum, Fixups, RISCV::fixup_riscv_jal, 0);
   }
 
   unsigned getBranchTargetEncoding(const MCInst &MI, unsigned int OpNum,
                                    SmallVectorImpl<MCFixup> &Fixups,
                                    const MCSubtargetInfo &STI) const {
     const MCOperand &MO = MI.getOperand(OpNum);
-    //TODO: do we need to sign extend explicitly?
+    // A constant target is a byte offset, and is encoded in halfwords.
     if (MO.isImm())
-      return MO.getImm() << 1;
+      return MO.getImm() >> 1;
     // Branch target is expr add fixup
     Fixups.push_back(MCFixup::create(0, MO.getExpr(),
           (MCFixupKind)RISCV::fixup_riscv_brlo));
@@ -98,6 +117,18 @@ private:
     llvm_unreachable("Branch with no immediate field");
   }
 
+  // Return the offset and base register of a compressed load or store
+  // as (offset << 5) | base, for the formats to pick apart.
+  unsigned getCMemEncoding(const MCInst &MI, unsigned int OpNum,
+                           SmallVectorImpl<MCFixup> &Fixups,
+                           const MCSubtargetInfo &STI) const {
+    const MCOperand &Off = MI.getOperand(OpNum);
+    const MCOperand &Base = MI.getOperand(OpNum + 1);
+    assert(Off.isImm() && "Compressed memory operand with symbolic offset");
+    return (static_cast<unsigned>(Off.getImm()) << 5) |
+           getMachineOpValue(MI, Base, Fixups, STI);
+  }
+
   // Operand OpNum of MI needs a PC-relative fixup of kind Kind at
   // Offset bytes from the start of MI.  Add the fixup to Fixups
   // and return the in-place addend, which since we're a RELA target
@@ -107,8 +138,9 @@ private:
                             unsigned Kind, int64_t Offset) const;
 
   unsigned getCallEncoding(const MCInst &MI, unsigned int OpNum,
-                               SmallVectorImpl<MCFixup> &Fixups) const {
-    return getPCRelEncoding(MI, OpNum, Fixups, RISCV::fixup_riscv_call, 0);
+                           SmallVectorImpl<MCFixup> &Fixups,
+                           const MCSubtargetInfo &STI) const {
+    return getPCRelEncoding(MI, OpNum, Fixups, RISCV::fixup_riscv_jal, 0);
   }
 };
 }
@@ -122,6 +154,23 @@ MCCodeEmitter *llvm::createRISCVMCCodeEmitter(const MCInstrInfo &MCII,
 void RISCVMCCodeEmitter::encodeInstruction(const MCInst &MI, raw_ostream &OS,
                                            SmallVectorImpl<MCFixup> &Fixups,
                                            const MCSubtargetInfo &STI) const {
+  unsigned Opcode = MI.getOpcode();
+  if (Opcode == RISCV::CALL || Opcode == RISCV::CALL64 ||
+      Opcode == RISCV::SAVE_LIBCALL || Opcode == RISCV::SAVE_LIBCALL64 ||
+      Opcode == RISCV::RESTORE_LIBCALL || Opcode == RISCV::RESTORE_LIBCALL64 ||
+      Opcode == RISCV::TCRETURN || Opcode == RISCV::TCRETURN64) {
+    expandCall(MI, OS, Fixups, STI);
+    return;
+  }
+
+  // An indirect tail call is jalr zero, 0(target).
+  if (Opcode == RISCV::TCRETURNREG || Opcode == RISCV::TCRETURNREG64) {
+    unsigned Target = getMachineOpValue(MI, MI.getOperand(0), Fixups, STI);
+    support::endian::Writer<support::little>(OS).write<uint32_t>(
+        0x00000067 | (Target << 15));
+    return;
+  }
+
   uint64_t Bits = getBinaryCodeForInstr(MI, Fixups, STI);
   unsigned Size = MCII.get(MI.getOpcode()).getSize();
   // Little-endian insertion of Size bytes.
@@ -140,9 +189,75 @@ RISCVMCCodeEmitter::getMachineOpValue(const MCInst &MI, const MCOperand &MO,
     return Ctx.getRegisterInfo()->getEncodingValue(MO.getReg());
   if (MO.isImm())
     return static_cast<unsigned>(MO.getImm());
+  if (MO.isExpr())
+    return getExprOpValue(MI, MO.getExpr(), Fixups, STI);
   llvm_unreachable("Unexpected operand type!");
 }
 
+unsigned
+RISCVMCCodeEmitter::getExprOpValue(const MCInst &MI, const MCExpr *Expr,
+                                   SmallVectorImpl<MCFixup> &Fixups,
+                                   const MCSubtargetInfo &STI) const {
+  const RISCVMCExpr *RVExpr = dyn_cast<RISCVMCExpr>(Expr);
+  if (!RVExpr || RVExpr->getKind() == RISCVMCExpr::VK_RISCV_None)
+    llvm_unreachable("Unexpected symbolic operand!");
+
+  RISCVMCExpr::VariantKind Kind = RVExpr->getKind();
+  unsigned FixupKind = RVExpr->getFixupKind();
+  // A store splits its offset, so it needs the S-type relocation.
+  if (Kind == RISCVMCExpr::VK_RISCV_GPREL &&
+      MCII.get(MI.getOpcode()).mayStore())
+    FixupKind = RISCV::fixup_riscv_gprel_s;
+  Fixups.push_back(MCFixup::create(0, Expr, MCFixupKind(FixupKind)));
+
+  // The linker may turn a %hi/%lo pair into a gp-relative access or drop
+  // the lui.  TLS accesses have their own relaxations, which need
+  // R_RISCV_TPREL_ADD, so leave them alone, and gp-relative accesses are
+  // already as short as they get.
+  if (STI.getFeatureBits()[RISCV::FeatureRelax] &&
+      Kind != RISCVMCExpr::VK_RISCV_TPREL_HI20 &&
+      Kind != RISCVMCExpr::VK_RISCV_TPREL_LO12 &&
+      Kind != RISCVMCExpr::VK_RISCV_GPREL)
+    addRelaxFixup(Fixups, 0);
+  return 0;
+}
+
+void RISCVMCCodeEmitter::expandCall(const MCInst &MI, raw_ostream &OS,
+                                    SmallVectorImpl<MCFixup> &Fixups,
+                                    const MCSubtargetInfo &STI) const {
+  const MCOperand &MO = MI.getOperand(0);
+  assert(MO.isExpr() && "Call to an immediate address");
+
+  // R_RISCV_CALL fills in both immediates, so both are encoded as 0.
+  support::endian::Writer<support::little> LE(OS);
+  switch (MI.getOpcode()) {
+  case RISCV::SAVE_LIBCALL:
+  case RISCV::SAVE_LIBCALL64:
+    LE.write<uint32_t>(0x00000297); // auipc t0, 0
+    LE.write<uint32_t>(0x000282e7); // jalr t0, 0(t0)
+    break;
+  case RISCV::RESTORE_LIBCALL:
+  case RISCV::RESTORE_LIBCALL64:
+  case RISCV::TCRETURN:
+  case RISCV::TCRETURN64:
+    LE.write<uint32_t>(0x00000317); // auipc t1, 0
+    LE.write<uint32_t>(0x00030067); // jalr zero, 0(t1)
+    break;
+  default:
+    LE.write<uint32_t>(0x00000097); // auipc ra, 0
+    LE.write<uint32_t>(0x000080e7); // jalr ra, 0(ra)
+    break;
+  }
+
+  const MCExpr *Expr = MO.getExpr();
+  if (const RISCVMCExpr *RVExpr = dyn_cast<RISCVMCExpr>(Expr))
+    Expr = RVExpr->getSubExpr();
+  Fixups.push_back(MCFixup::create(0, Expr,
+                                   MCFixupKind(RISCV::fixup_riscv_call)));
+  if (STI.getFeatureBits()[RISCV::FeatureRelax])
+    addRelaxFixup(Fixups, 0);
+}
+
 unsigned
 RISCVMCCodeEmitter::getPCRelEncoding(const MCInst &MI, unsigned int OpNum,
                                        SmallVectorImpl<MCFixup> &Fixups,
@@ -50,6 +50,7 @@ bool RISCVMCExpr::printVariantKind(raw_ostream &OS, VariantKind Kind)
   case VK_RISCV_PCREL_HI20: OS << "%pcrel_hi(";  break;
   case VK_RISCV_TPREL_LO12: OS << "%tprel_lo(";  break;
   case VK_RISCV_TPREL_HI20: OS << "%tprel_hi(";  break;
+  case VK_RISCV_GPREL:      OS << "%gprel(";  break;
   }
   return closeParen;
 }
@@ -63,6 +64,7 @@ RISCVMCExpr::VariantKind RISCVMCExpr::parseVariantKind(StringRef name)
     .Case("pcrel_hi",  VK_RISCV_PCREL_HI20)
     .Case("tprel_lo",  VK_RISCV_TPREL_LO12)
     .Case("tprel_hi",  VK_RISCV_TPREL_HI20)
+    .Case("gprel",  VK_RISCV_GPREL)
     .Default(VK_RISCV_None);
 }
 
@@ -75,6 +77,7 @@ RISCV::FixupKind RISCVMCExpr::getFixupKind(RISCVMCExpr::VariantKind Kind) {
   case VK_RISCV_PCREL_HI20: return RISCV::fixup_riscv_pcrel_hi20;
   case VK_RISCV_TPREL_LO12: return RISCV::fixup_riscv_tprel_lo12;
   case VK_RISCV_TPREL_HI20: return RISCV::fixup_riscv_tprel_hi20;
+  case VK_RISCV_GPREL:      return RISCV::fixup_riscv_gprel_i;
   }
 }
 
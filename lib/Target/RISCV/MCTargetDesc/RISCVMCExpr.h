@@ -30,7 +30,8 @@ public:
     VK_RISCV_PCREL_LO12,
     VK_RISCV_PCREL_HI20,
     VK_RISCV_TPREL_LO12,
-    VK_RISCV_TPREL_HI20
+    VK_RISCV_TPREL_HI20,
+    VK_RISCV_GPREL
   };
 
 private:
@@ -30,6 +30,17 @@ namespace RISCV {
     fixup_riscv_tprel_lo12,
     fixup_riscv_tprel_hi20,
 
+    // %gprel(sym) in the offset of a load (I-type) or a store (S-type).
+    fixup_riscv_gprel_i,
+    fixup_riscv_gprel_s,
+
+    // Linker relaxation markers.  fixup_riscv_relax shares its offset with
+    // the fixup of an instruction the linker may rewrite; fixup_riscv_align
+    // covers the nops of a code alignment, whose size the linker may
+    // reduce.  Both become relocations without a symbol.
+    fixup_riscv_relax,
+    fixup_riscv_align,
+
     // Marker
     LastTargetFixupKind,
     NumTargetFixupKinds = LastTargetFixupKind - FirstTargetFixupKind
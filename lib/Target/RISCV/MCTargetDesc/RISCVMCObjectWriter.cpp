@@ -18,7 +18,7 @@ using namespace llvm;
 namespace {
 class RISCVObjectWriter : public MCELFObjectTargetWriter {
 public:
-  RISCVObjectWriter(uint8_t OSABI);
+  RISCVObjectWriter(uint8_t OSABI, bool Is64Bit);
 
   virtual ~RISCVObjectWriter();
 
@@ -29,8 +29,8 @@ protected:
 };
 } // end anonymouse namespace
 
-RISCVObjectWriter::RISCVObjectWriter(uint8_t OSABI)
-  : MCELFObjectTargetWriter(/*Is64Bit=*/true, OSABI, ELF::EM_RISCV,
+RISCVObjectWriter::RISCVObjectWriter(uint8_t OSABI, bool Is64Bit)
+  : MCELFObjectTargetWriter(Is64Bit, OSABI, ELF::EM_RISCV,
                             /*HasRelocationAddend=*/ true) {}
 
 RISCVObjectWriter::~RISCVObjectWriter() {
@@ -45,11 +45,10 @@ static unsigned getAbsoluteReloc(unsigned Kind) {
   llvm_unreachable("Unsupported absolute address");
 }
 
-//TODO: fix relocation types
 // Return the relocation type for a PC-relative value of MCFixupKind Kind.
 static unsigned getPCRelReloc(unsigned Kind) {
   switch (Kind) {
-  case FK_Data_4:                return ELF::R_RISCV_CALL;
+  case FK_Data_4:                return ELF::R_RISCV_32_PCREL;
   case RISCV::fixup_riscv_brlo:  return ELF::R_RISCV_BRANCH;
   case RISCV::fixup_riscv_brhi:  return ELF::R_RISCV_BRANCH;
   case RISCV::fixup_riscv_jal:   return ELF::R_RISCV_JAL;
@@ -82,6 +81,22 @@ unsigned RISCVObjectWriter::getRelocType(MCContext &Ctx, const MCValue &Target,
                                            MCSymbolRefExpr::VK_None :
                                            Target.getSymA()->getKind());
   unsigned Kind = Fixup.getKind();
+
+  // The %hi/%lo/%gprel operators and the relaxation markers pick the
+  // relocation through the fixup kind alone.
+  switch (Kind) {
+  case RISCV::fixup_riscv_hi20:        return ELF::R_RISCV_HI20;
+  case RISCV::fixup_riscv_lo12:        return ELF::R_RISCV_LO12_I;
+  case RISCV::fixup_riscv_pcrel_hi20:  return ELF::R_RISCV_PCREL_HI20;
+  case RISCV::fixup_riscv_pcrel_lo12:  return ELF::R_RISCV_PCREL_LO12_I;
+  case RISCV::fixup_riscv_tprel_hi20:  return ELF::R_RISCV_TPREL_HI20;
+  case RISCV::fixup_riscv_tprel_lo12:  return ELF::R_RISCV_TPREL_LO12_I;
+  case RISCV::fixup_riscv_gprel_i:     return ELF::R_RISCV_GPREL_I;
+  case RISCV::fixup_riscv_gprel_s:     return ELF::R_RISCV_GPREL_S;
+  case RISCV::fixup_riscv_relax:       return ELF::R_RISCV_RELAX;
+  case RISCV::fixup_riscv_align:       return ELF::R_RISCV_ALIGN;
+  }
+
   switch (Modifier) {
   case MCSymbolRefExpr::VK_None:
     if (IsPCRel)
@@ -105,7 +120,7 @@ unsigned RISCVObjectWriter::getRelocType(MCContext &Ctx, const MCValue &Target,
 }
 
 MCObjectWriter *llvm::createRISCVObjectWriter(raw_pwrite_stream &OS,
-                                                uint8_t OSABI) {
-  MCELFObjectTargetWriter *MOTW = new RISCVObjectWriter(OSABI);
-  return createELFObjectWriter(MOTW, OS, /*IsLittleEndian=*/false);
+                                              uint8_t OSABI, bool Is64Bit) {
+  MCELFObjectTargetWriter *MOTW = new RISCVObjectWriter(OSABI, Is64Bit);
+  return createELFObjectWriter(MOTW, OS, /*IsLittleEndian=*/true);
 }
@@ -9,7 +9,10 @@
 
 #include "RISCVMCTargetDesc.h"
 #include "InstPrinter/RISCVInstPrinter.h"
+#include "RISCVMCAsmBackend.h"
 #include "RISCVMCAsmInfo.h"
+#include "llvm/MC/MCAssembler.h"
+#include "llvm/MC/MCELFStreamer.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCStreamer.h"
@@ -63,11 +66,32 @@ static MCInstPrinter *createRISCVMCInstPrinter(const Triple &TT,
   return new RISCVInstPrinter(MAI, MII, MRI);
 }
 
+namespace {
+// An ELF streamer that tells the asm backend which subtarget the code it
+// lays out was generated for.
+class RISCVELFStreamer : public MCELFStreamer {
+public:
+  RISCVELFStreamer(MCContext &Context, MCAsmBackend &TAB,
+                   raw_pwrite_stream &OS, MCCodeEmitter *Emitter)
+    : MCELFStreamer(Context, TAB, OS, Emitter) {}
+
+  void EmitInstruction(const MCInst &Inst,
+                       const MCSubtargetInfo &STI) override {
+    static_cast<RISCVMCAsmBackend &>(getAssembler().getBackend())
+      .noteSubtarget(STI);
+    MCELFStreamer::EmitInstruction(Inst, STI);
+  }
+};
+} // end anonymous namespace
+
 static MCStreamer *
 createRISCVMCObjectStreamer(const Triple &TT, MCContext &Ctx,
                             MCAsmBackend &MAB, raw_pwrite_stream &OS,
                             MCCodeEmitter *Emitter, bool RelaxAll) {
-  return createELFStreamer(Ctx, MAB, OS, Emitter, RelaxAll);
+  RISCVELFStreamer *S = new RISCVELFStreamer(Ctx, MAB, OS, Emitter);
+  if (RelaxAll)
+    S->getAssembler().setRelaxAll(true);
+  return S;
 }
 
 extern "C" void LLVMInitializeRISCVTargetMC() {
@@ -37,7 +37,8 @@ MCAsmBackend *createRISCVMCAsmBackend(const Target &T,
                                       const MCRegisterInfo &MRI, const Triple &TT,
                                       StringRef CPU);
 
-MCObjectWriter *createRISCVObjectWriter(raw_pwrite_stream &OS, uint8_t OSABI);
+MCObjectWriter *createRISCVObjectWriter(raw_pwrite_stream &OS, uint8_t OSABI,
+                                        bool Is64Bit);
 
 namespace RISCVMC {
   // How many bytes are in the ABI-defined, caller-allocated part of
@@ -0,0 +1,97 @@
+//===-- RISCVMatInt.cpp - Immediate materialization -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file works out how to load an integer constant with lui, addi, slli
+// and srli.  Both the asm printer, which expands the LI pseudos, and the
+// cost and size queries use it, so they agree on what a constant costs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/RISCVMatInt.h"
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+static void generateInstSeqImpl(int64_t Val, bool IsRV64,
+                                RISCVMatInt::InstSeq &Res) {
+  unsigned LUIOpc = IsRV64 ? RISCV::LUI64 : RISCV::LUI;
+  unsigned ADDIOpc = IsRV64 ? RISCV::ADDI64 : RISCV::ADDI;
+
+  if (isInt<32>(Val)) {
+    // lui fills bits 31-12 and addi adds a sign-extended 12-bit value, so
+    // round the upper part up when bit 11 is set.
+    int64_t Hi20 = ((Val + 0x800) >> 12) & 0xfffff;
+    int64_t Lo12 = SignExtend64<12>(Val);
+
+    // addiw only has a GR32 form, so on RV64 this only works if the
+    // rounding doesn't carry into bit 31, which lui sign-extends.
+    if (!IsRV64 || SignExtend64<32>(Hi20 << 12) + Lo12 == Val) {
+      if (Hi20)
+        Res.push_back(RISCVMatInt::Inst(LUIOpc, Hi20));
+      if (Lo12 || Hi20 == 0)
+        Res.push_back(RISCVMatInt::Inst(ADDIOpc, Lo12));
+      return;
+    }
+  }
+
+  assert(IsRV64 && "Can't materialize this constant on RV32");
+
+  // Peel off the low 12 bits, load what is left with its trailing zeros
+  // removed and shift it back into place.  Shifting out the zeros keeps
+  // the recursion short for shifted masks and for values with few
+  // significant bits.
+  int64_t Lo12 = SignExtend64<12>(Val);
+  int64_t Hi52 = ((uint64_t)Val + 0x800ull) >> 12;
+  int ShiftAmount = 12 + countTrailingZeros((uint64_t)Hi52);
+  Hi52 = SignExtend64((uint64_t)Hi52 >> (ShiftAmount - 12),
+                      64 - ShiftAmount);
+
+  generateInstSeqImpl(Hi52, IsRV64, Res);
+
+  Res.push_back(RISCVMatInt::Inst(RISCV::SLLI64, ShiftAmount));
+  if (Lo12)
+    Res.push_back(RISCVMatInt::Inst(RISCV::ADDI64, Lo12));
+}
+
+void RISCVMatInt::generateInstSeq(int64_t Val, bool IsRV64, InstSeq &Res) {
+  generateInstSeqImpl(Val, IsRV64, Res);
+
+  // A positive value with leading zeros may be cheaper to build shifted
+  // all the way left, with the vacated bits filled with zeros or with
+  // ones, and then shifted back with srli.
+  if (!IsRV64 || Val <= 0 || Res.size() <= 2)
+    return;
+
+  unsigned ShiftAmount = countLeadingZeros((uint64_t)Val);
+  uint64_t ShiftedVal = (uint64_t)Val << ShiftAmount;
+  for (uint64_t Fill : {0ull, (1ull << ShiftAmount) - 1}) {
+    InstSeq TmpSeq;
+    generateInstSeqImpl(ShiftedVal | Fill, IsRV64, TmpSeq);
+    TmpSeq.push_back(Inst(RISCV::SRLI64, ShiftAmount));
+    if (TmpSeq.size() < Res.size())
+      Res = TmpSeq;
+  }
+}
+
+void RISCVMatInt::buildInstSeq(const InstSeq &Seq, unsigned DestReg,
+                               unsigned ZeroReg,
+                               SmallVectorImpl<MCInst> &Insts) {
+  unsigned SrcReg = ZeroReg;
+  for (const Inst &I : Seq) {
+    if (I.Opc == RISCV::LUI || I.Opc == RISCV::LUI64)
+      Insts.push_back(MCInstBuilder(I.Opc).addReg(DestReg).addImm(I.Imm));
+    else
+      Insts.push_back(MCInstBuilder(I.Opc)
+                          .addReg(DestReg).addReg(SrcReg).addImm(I.Imm));
+    SrcReg = DestReg;
+  }
+}
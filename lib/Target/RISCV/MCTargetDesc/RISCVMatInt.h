@@ -0,0 +1,46 @@
+//===-- RISCVMatInt.h - Immediate materialization ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the helpers that work out the shortest lui/addi/slli/srli
+// sequence for loading an integer constant into a register.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVMATINT_H
+#define LLVM_LIB_TARGET_RISCV_MCTARGETDESC_RISCVMATINT_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace llvm {
+class MCInst;
+
+namespace RISCVMatInt {
+// One step of a sequence.  The first step reads the zero register, every
+// later one the result of the step before it.
+struct Inst {
+  unsigned Opc;
+  int64_t Imm;
+
+  Inst(unsigned Opc, int64_t Imm) : Opc(Opc), Imm(Imm) {}
+};
+typedef SmallVector<Inst, 8> InstSeq;
+
+// Store in Res the shortest sequence we know of that loads Val.  On RV32
+// Val must be a sign-extended 32-bit value.
+void generateInstSeq(int64_t Val, bool IsRV64, InstSeq &Res);
+
+// Turn Seq into MCInsts that leave the value in DestReg.  ZeroReg is the
+// zero register of the same width as DestReg.
+void buildInstSeq(const InstSeq &Seq, unsigned DestReg, unsigned ZeroReg,
+                  SmallVectorImpl<MCInst> &Insts);
+} // end namespace RISCVMatInt
+} // end namespace llvm
+
+#endif
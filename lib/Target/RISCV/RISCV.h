@@ -17,10 +17,14 @@
 
 #include "MCTargetDesc/RISCVMCTargetDesc.h"
 #include "llvm/Support/CodeGen.h"
+#include <memory>
 
 namespace llvm {
+  class RISCVSubtarget;
   class RISCVTargetMachine;
   class FunctionPass;
+  class PassRegistry;
+  class ScheduleDAGMutation;
 
   namespace RISCV {
     // Condition-code mask values.
@@ -74,5 +78,16 @@ namespace llvm {
   FunctionPass *createRISCVISelDag(RISCVTargetMachine &TM,
                                      CodeGenOpt::Level OptLevel);
   FunctionPass *createRISCVBranchSelectionPass();
+  FunctionPass *createRISCVEarlyIfConversionPass();
+  FunctionPass *createRISCVSExtEliminationPass();
+  FunctionPass *createRISCVXvecVectorizePass();
+  FunctionPass *createRISCVXvecPaddingPass();
+  std::unique_ptr<ScheduleDAGMutation>
+  createRISCVXvecReductionMutation(const RISCVSubtarget &STI);
+  std::unique_ptr<ScheduleDAGMutation>
+  createRISCVXvecElementMutation(const RISCVSubtarget &STI);
+
+  void initializeRISCVXvecVectorizePass(PassRegistry&);
+  void initializeRISCVXvecPaddingPass(PassRegistry&);
 } // end namespace llvm;
 #endif
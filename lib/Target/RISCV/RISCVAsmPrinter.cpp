@@ -14,68 +14,186 @@
 
 #include "RISCVAsmPrinter.h"
 #include "InstPrinter/RISCVInstPrinter.h"
+#include "MCTargetDesc/RISCVCompressInst.h"
+#include "MCTargetDesc/RISCVMatInt.h"
 #include "RISCVConstantPoolValue.h"
 #include "RISCVMCInstLower.h"
 #include "llvm/CodeGen/MachineModuleInfoImpls.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/MC/MCExpr.h"
+#include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Support/TargetRegistry.h"
-#include "RISCVVectorInstrBuilder.h"
-// TODO: Remove
-#include <iostream>
 
 using namespace llvm;
 
-void RISCVAsmPrinter::EmitFunctionBody() {
-  RISCVVectorInstrBuilder builder;
-
-  /* For each basic block, perform pattern matching and substitution */
-  for(unsigned int i = 0; i < MF->getNumBlockIDs(); i++) {
-    MachineBasicBlock *MBB = MF->getBlockNumbered(i);
-
-    /* Search for RR, RI and IR patterns */
-    bool rrFound = builder.checkForVectorPatternRR(*MBB);
-    bool riFound = builder.checkForVectorPatternRI(*MBB);
-    bool irFound = builder.checkForVectorPatternIR(*MBB);
-    /* If any were found, substitute */
-    if(rrFound || riFound || irFound) {
-      // TODO: Remove
-      std::cout << "Found patterns!" << std::endl;
-      for(unsigned int j = 0; j < builder.getListSize(); j++) {
-        std::cout << "Block " << j << std::endl;
-        std::cout << " class " << builder.getClassAt(j) << std::endl;
-        std::cout << " startPoint " << builder.getStartPointAt(j) << std::endl;
-        std::cout << " blockSize " << builder.getBlockSizeAt(j) << std::endl;
-        std::cout << " opcode " << builder.getOpcodeAt(j) << std::endl;
-        std::cout << " xImm " << builder.getXImmAt(j) << std::endl;
-        std::cout << " xAIdx " << builder.getXAIdxAt(j) << std::endl;
-        std::cout << " xBIdx " << builder.getXBIdxAt(j) << std::endl;
-        std::cout << " xCIdx " << builder.getXCIdxAt(j) << std::endl;
-      }
-
-      builder.substituteAllMatches(MBB, Subtarget);
-
-      // TODO: Remove
-      unsigned int j = 0;
-      for(MachineBasicBlock::iterator MI = MBB->begin(); MI != MBB->end(); MI++) {
-        if(!(MI->isPseudo()))
-          j++;
-      }
-      std::cout << "Number of real ops after substitution: " << j << std::endl;
+void RISCVAsmPrinter::EmitInstruction(const MachineInstr *MI) {
+  // The LI pseudos stay whole until now so that they can be hoisted and
+  // rematerialized like any other constant.
+  switch (MI->getOpcode()) {
+  case RISCV::LI:
+  case RISCV::LI64:
+  case RISCV::LI64_32:
+    if (MI->getOperand(1).isImm()) {
+      emitLoadImmediate(MI);
+      return;
     }
+    break;
+  case RISCV::ATOMIC_CMP_SWAP_W:
+  case RISCV::ATOMIC_CMP_SWAP_W64:
+  case RISCV::ATOMIC_CMP_SWAP_D:
+  case RISCV::ATOMIC_LOAD_NAND_W:
+  case RISCV::ATOMIC_LOAD_NAND_W64:
+  case RISCV::ATOMIC_LOAD_NAND_D:
+    emitAtomicLoop(MI);
+    return;
   }
 
-  /* Proceed to standard behaviour */
-  AsmPrinter::EmitFunctionBody();
-}
-
-void RISCVAsmPrinter::EmitInstruction(const MachineInstr *MI) {
   RISCVMCInstLower Lower(MF->getContext(), *this);
   MCInst LoweredMI;
   Lower.lower(MI, LoweredMI);
-  EmitToStreamer(*OutStreamer, LoweredMI);
+  emitCompressed(LoweredMI);
+}
+
+void RISCVAsmPrinter::emitCompressed(const MCInst &Inst) {
+  // Instructions are selected in their 32-bit forms and only shrunk here,
+  // once every register and offset is final.
+  MCInst CompressedMI;
+  if (Subtarget->hasC() && Subtarget->isRV32() &&
+      RISCV::compressInst(CompressedMI, Inst))
+    EmitToStreamer(*OutStreamer, CompressedMI);
+  else
+    EmitToStreamer(*OutStreamer, Inst);
+}
+
+void RISCVAsmPrinter::emitLoadImmediate(const MachineInstr *MI) {
+  // The 32-bit forms hold a sign-extended 32-bit value, whatever the width
+  // of the register.
+  int64_t Value = MI->getOperand(1).getImm();
+  if (MI->getOpcode() != RISCV::LI64)
+    Value = SignExtend64<32>(Value);
+
+  RISCVMatInt::InstSeq Seq;
+  RISCVMatInt::generateInstSeq(Value, Subtarget->isRV64(), Seq);
+
+  SmallVector<MCInst, 8> Insts;
+  RISCVMatInt::buildInstSeq(Seq, MI->getOperand(0).getReg(),
+                            MI->getOpcode() == RISCV::LI ? RISCV::zero
+                                                         : RISCV::zero_64,
+                            Insts);
+  for (const MCInst &Inst : Insts)
+    emitCompressed(Inst);
+}
+
+// The plain, .aq, .rl and .aqrl forms of the LRs and SCs, by the width of
+// the loop: a word on RV32, a word on RV64 and a doubleword.
+static const unsigned LROpcodes[3][4] = {
+  { RISCV::LR_W, RISCV::LR_W_AQ, RISCV::LR_W_RL, RISCV::LR_W_AQ_RL },
+  { RISCV::LR_W64, RISCV::LR_W64_AQ, RISCV::LR_W64_RL, RISCV::LR_W64_AQ_RL },
+  { RISCV::LR_D, RISCV::LR_D_AQ, RISCV::LR_D_RL, RISCV::LR_D_AQ_RL }
+};
+static const unsigned SCOpcodes[3][4] = {
+  { RISCV::SC_W, RISCV::SC_W_AQ, RISCV::SC_W_RL, RISCV::SC_W_AQ_RL },
+  { RISCV::SC_W64, RISCV::SC_W64_AQ, RISCV::SC_W64_RL, RISCV::SC_W64_AQ_RL },
+  { RISCV::SC_D, RISCV::SC_D_AQ, RISCV::SC_D_RL, RISCV::SC_D_AQ_RL }
+};
+
+// Return the LR or SC opcode, from row Width of the tables above, whose aq
+// and rl bits give an LR/SC loop the ordering Ord.  As in the ISA manual's
+// mappings, the LR acquires and the SC releases, and a seq_cst loop also
+// sets rl on the LR.
+static unsigned getLRSCOpcode(bool IsSC, unsigned Width, AtomicOrdering Ord) {
+  const unsigned *Forms = IsSC ? SCOpcodes[Width] : LROpcodes[Width];
+  switch (Ord) {
+  case AtomicOrdering::Monotonic:
+    return Forms[0];
+  case AtomicOrdering::Acquire:
+    return IsSC ? Forms[0] : Forms[1];
+  case AtomicOrdering::Release:
+    return IsSC ? Forms[2] : Forms[0];
+  case AtomicOrdering::AcquireRelease:
+    return IsSC ? Forms[2] : Forms[1];
+  case AtomicOrdering::SequentiallyConsistent:
+    return IsSC ? Forms[2] : Forms[3];
+  default:
+    llvm_unreachable("Unexpected atomic ordering");
+  }
+}
+
+void RISCVAsmPrinter::emitAtomicLoop(const MachineInstr *MI) {
+  // The loop is emitted uncompressed, so that its size is the one
+  // RISCVInstrInfo::GetInstSizeInBytes reports.  The RV64 word loops work
+  // on GR32 values, so only their LR and SC differ from the RV32 ones.
+  unsigned Opcode = MI->getOpcode();
+  bool Is64 = Opcode == RISCV::ATOMIC_CMP_SWAP_D ||
+              Opcode == RISCV::ATOMIC_LOAD_NAND_D;
+  unsigned Width = Is64 ? 2
+                   : (Opcode == RISCV::ATOMIC_CMP_SWAP_W64 ||
+                      Opcode == RISCV::ATOMIC_LOAD_NAND_W64) ? 1 : 0;
+  unsigned Res = MI->getOperand(0).getReg();
+  unsigned Scratch = MI->getOperand(1).getReg();
+  unsigned Addr = MI->getOperand(2).getReg();
+  AtomicOrdering Ord = static_cast<AtomicOrdering>(
+      MI->getOperand(MI->getNumExplicitOperands() - 1).getImm());
+  unsigned BNE = Is64 ? RISCV::BNE64 : RISCV::BNE;
+  unsigned Zero = Is64 ? RISCV::zero_64 : RISCV::zero;
+
+  MCSymbol *Loop = OutContext.createTempSymbol();
+  const MCExpr *LoopExpr = MCSymbolRefExpr::create(Loop, OutContext);
+  OutStreamer->EmitLabel(Loop);
+  EmitToStreamer(*OutStreamer, MCInstBuilder(getLRSCOpcode(false, Width, Ord))
+                                   .addReg(Res)
+                                   .addReg(Addr));
+
+  if (Opcode == RISCV::ATOMIC_CMP_SWAP_W ||
+      Opcode == RISCV::ATOMIC_CMP_SWAP_W64 ||
+      Opcode == RISCV::ATOMIC_CMP_SWAP_D) {
+    //   loop: lr   res, (addr)
+    //         bne  res, cmp, done
+    //         sc   scratch, new, (addr)
+    //         bne  scratch, zero, loop
+    //   done:
+    MCSymbol *Done = OutContext.createTempSymbol();
+    EmitToStreamer(*OutStreamer,
+                   MCInstBuilder(BNE)
+                       .addExpr(MCSymbolRefExpr::create(Done, OutContext))
+                       .addReg(Res)
+                       .addReg(MI->getOperand(3).getReg()));
+    EmitToStreamer(*OutStreamer, MCInstBuilder(getLRSCOpcode(true, Width, Ord))
+                                     .addReg(Scratch)
+                                     .addReg(MI->getOperand(4).getReg())
+                                     .addReg(Addr));
+    EmitToStreamer(*OutStreamer, MCInstBuilder(BNE)
+                                     .addExpr(LoopExpr)
+                                     .addReg(Scratch)
+                                     .addReg(Zero));
+    OutStreamer->EmitLabel(Done);
+    return;
+  }
+
+  //   loop: lr   res, (addr)
+  //         and  scratch, res, incr
+  //         xori scratch, scratch, -1
+  //         sc   scratch, scratch, (addr)
+  //         bne  scratch, zero, loop
+  EmitToStreamer(*OutStreamer, MCInstBuilder(Is64 ? RISCV::AND64 : RISCV::AND)
+                                   .addReg(Scratch)
+                                   .addReg(Res)
+                                   .addReg(MI->getOperand(3).getReg()));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(Is64 ? RISCV::XORI64 : RISCV::XORI)
+                     .addReg(Scratch)
+                     .addReg(Scratch)
+                     .addImm(-1));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(getLRSCOpcode(true, Width, Ord))
+                                   .addReg(Scratch)
+                                   .addReg(Scratch)
+                                   .addReg(Addr));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(BNE)
+                                   .addExpr(LoopExpr)
+                                   .addReg(Scratch)
+                                   .addReg(Zero));
 }
 
 // Convert a RISCV-specific constant pool modifier into the associated
@@ -110,6 +228,7 @@ void RISCVAsmPrinter::printOperand(const MachineInstr *MI, int OpNo, raw_ostream
     case RISCVII::MO_ABS_LO: O << "%lo("; break;
     case RISCVII::MO_TPREL_HI: O << "%tprel_hi("; break;
     case RISCVII::MO_TPREL_LO: O << "%tprel_lo("; break;
+    case RISCVII::MO_GPREL: O << "%gprel("; break;
   }
  switch (MO.getType()) {
     case MachineOperand::MO_Register:
@@ -190,16 +309,8 @@ void RISCVAsmPrinter::EmitEndOfAsmFile(Module &M) {
 }
 
 bool RISCVAsmPrinter::runOnMachineFunction(MachineFunction &MF) {
-  /**
-   * Note: RISC-V did use the AsmPrinter::runOnMachineFunction() method here. Since we wanted
-   * our pattern modifications to be local, we inlined the AsmPrinter::runOnMachineFunction()
-   * body here and changed the call AsmPrinter::EmitFunctionBody() to
-   * RISCVAsmPrinter::EmitFunctionBody().
-   */
   Subtarget = &MF.getSubtarget<RISCVSubtarget>();
-  AsmPrinter::SetupMachineFunction(MF);
-  EmitFunctionBody();
-  return false;
+  return AsmPrinter::runOnMachineFunction(MF);
 }
 
 // Force static initialization.
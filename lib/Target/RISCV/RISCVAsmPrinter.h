@@ -15,6 +15,7 @@
 #include "llvm/Support/Compiler.h"
 
 namespace llvm {
+class MCInst;
 class MCStreamer;
 class MachineBasicBlock;
 class MachineInstr;
@@ -25,6 +26,15 @@ class LLVM_LIBRARY_VISIBILITY RISCVAsmPrinter : public AsmPrinter {
 private:
   const RISCVSubtarget *Subtarget;
 
+  // Emit Inst, in its RVC form if it has one that can be used.
+  void emitCompressed(const MCInst &Inst);
+
+  // Expand the LI pseudo MI into the sequence picked by RISCVMatInt.
+  void emitLoadImmediate(const MachineInstr *MI);
+
+  // Expand the compare-and-swap or nand pseudo MI into its LR/SC loop.
+  void emitAtomicLoop(const MachineInstr *MI);
+
 public:
   RISCVAsmPrinter(TargetMachine &TM, std::unique_ptr<MCStreamer> Streamer)
     : AsmPrinter(TM, std::move(Streamer)) {}
@@ -33,7 +43,6 @@ public:
   const char *getPassName() const override {
     return "RISCV Assembly Printer";
   }
-  void EmitFunctionBody();
   void EmitInstruction(const MachineInstr *MI) override;
   void EmitMachineConstantPoolValue(MachineConstantPoolValue *MCPV) override;
   void printOperand(const MachineInstr *MI, int opNum, raw_ostream &O);
@@ -159,7 +159,7 @@ bool RISCVBSel::runOnMachineFunction(MachineFunction &Fn) {
 
         // If this branch is in range, ignore it.
         if (isInt<12>(BranchSize)) {
-          MBBStartOffset += 4;
+          MBBStartOffset += TII->GetInstSizeInBytes(I);
           continue;
         }
 
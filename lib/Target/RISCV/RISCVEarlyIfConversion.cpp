@@ -0,0 +1,322 @@
+//===-- RISCVEarlyIfConversion.cpp - Flatten small branch diamonds --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains a pass that if-converts small triangles and diamonds
+// while the function is still in SSA form.  The instructions of the
+// conditional blocks are speculated into the head block and the PHIs of the
+// tail block become the mask selects of RISCVInstrInfo::insertSelect.
+//
+// The generic EarlyIfConversion pass weighs the conversion against the
+// unused issue slots of an out-of-order core, which a single-issue in-order
+// core never has.  Our cores pay for every taken branch instead, so the cost
+// model here compares instruction counts against the branch and the expected
+// mispredict penalty of the scheduling model.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "riscv-early-ifcvt"
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+using namespace llvm;
+
+STATISTIC(NumTriangles, "Number of triangles if-converted");
+STATISTIC(NumDiamonds,  "Number of diamonds if-converted");
+STATISTIC(NumRejected,  "Number of candidates left alone by the cost model");
+
+static cl::opt<bool>
+EnableEarlyIfCvt("riscv-early-ifcvt", cl::init(true), cl::Hidden,
+                 cl::desc("If-convert small triangles and diamonds into "
+                          "mask selects"));
+
+static cl::opt<unsigned>
+EarlyIfCvtLimit("riscv-early-ifcvt-limit", cl::init(8), cl::Hidden,
+                cl::desc("Maximum number of instructions speculated from "
+                         "each side of a branch"));
+
+namespace llvm {
+  void initializeRISCVEarlyIfConversionPass(PassRegistry&);
+}
+
+namespace {
+  struct RISCVEarlyIfConversion : public MachineFunctionPass {
+    static char ID;
+    RISCVEarlyIfConversion() : MachineFunctionPass(ID) {
+      initializeRISCVEarlyIfConversionPass(*PassRegistry::getPassRegistry());
+    }
+
+    const RISCVInstrInfo *TII;
+    MachineRegisterInfo *MRI;
+    unsigned MispredictPenalty;
+
+    bool runOnMachineFunction(MachineFunction &Fn) override;
+
+    bool canSpeculate(MachineBasicBlock *MBB, unsigned &Count);
+    bool tryConvert(MachineBasicBlock *Head);
+
+    const char *getPassName() const override {
+      return "RISCV Early If-Conversion";
+    }
+  };
+  char RISCVEarlyIfConversion::ID = 0;
+}
+
+INITIALIZE_PASS(RISCVEarlyIfConversion, "riscv-early-if-conversion",
+                "RISCV Early If-Conversion", false, false)
+
+/// createRISCVEarlyIfConversionPass - returns an instance of the early
+/// if-conversion pass.
+///
+FunctionPass *llvm::createRISCVEarlyIfConversionPass() {
+  return new RISCVEarlyIfConversion();
+}
+
+/// isExpensive - Return true if MI is a load, which may trap and is only
+/// speculated by the DAG when its value is needed anyway, or a multiplication
+/// or division, which the iterative unit makes too slow to run on both sides.
+static bool isExpensive(const MachineInstr &MI) {
+  if (MI.mayLoad())
+    return true;
+  switch (MI.getOpcode()) {
+  case RISCV::MUL:   case RISCV::MULH:   case RISCV::MULHU:
+  case RISCV::MUL64: case RISCV::MULH64: case RISCV::MULHU64: case RISCV::MULW:
+  case RISCV::DIV:   case RISCV::DIVU:   case RISCV::REM:   case RISCV::REMU:
+  case RISCV::DIV64: case RISCV::DIVU64: case RISCV::REM64: case RISCV::REMU64:
+  case RISCV::DIVW:  case RISCV::DIVUW:  case RISCV::REMW:  case RISCV::REMUW:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// canSpeculate - Return true if every instruction of MBB, the terminators
+/// aside, can be executed whichever way the branch goes.  Count is set to
+/// the number of instructions that would be speculated.
+bool RISCVEarlyIfConversion::canSpeculate(MachineBasicBlock *MBB,
+                                          unsigned &Count) {
+  if (!MBB->livein_empty() || MBB->hasAddressTaken() || MBB->isEHPad())
+    return false;
+
+  Count = 0;
+  for (MachineBasicBlock::iterator I = MBB->begin(), E = MBB->end();
+       I != E; ++I) {
+    if (I->isDebugValue())
+      continue;
+
+    // The only terminator allowed is the jump to the tail.
+    if (I->isTerminator()) {
+      SmallVector<MachineOperand, 1> Cond;
+      Cond.push_back(MachineOperand::CreateImm(0));
+      const MachineOperand *Target;
+      if (!TII->isBranch(&*I, Cond, Target) ||
+          Cond[0].getImm() != RISCV::CCMASK_ANY || !Target->isMBB())
+        return false;
+      continue;
+    }
+
+    if (++Count > EarlyIfCvtLimit || I->isPHI() || isExpensive(*I))
+      return false;
+    bool DontMoveAcrossStore = true;
+    if (!I->isSafeToMove(nullptr, DontMoveAcrossStore))
+      return false;
+
+    // Physical registers may be live across the branch, leave them alone.
+    for (const MachineOperand &MO : I->operands()) {
+      if (MO.isRegMask())
+        return false;
+      if (MO.isReg() && MO.isDef() &&
+          !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        return false;
+    }
+  }
+  return true;
+}
+
+/// tryConvert - If Head ends in a branch that forms a triangle or a diamond
+/// and flattening it is cheaper, speculate the conditional blocks into Head
+/// and replace the PHIs of the tail with selects.
+bool RISCVEarlyIfConversion::tryConvert(MachineBasicBlock *Head) {
+  if (Head->succ_size() != 2)
+    return false;
+  MachineBasicBlock *Succ0 = Head->succ_begin()[0];
+  MachineBasicBlock *Succ1 = Head->succ_begin()[1];
+
+  // Canonicalize so that Succ0 is always a conditional block.
+  if (Succ0->pred_size() != 1 || Succ0->succ_size() != 1)
+    std::swap(Succ0, Succ1);
+  if (Succ0->pred_size() != 1 || Succ0->succ_size() != 1)
+    return false;
+
+  MachineBasicBlock *Tail = Succ0->succ_begin()[0];
+  if (Tail != Succ1) {
+    // A diamond.  Both sides must join at Tail and nothing else may.
+    if (Succ1->pred_size() != 1 || Succ1->succ_size() != 1 ||
+        Succ1->succ_begin()[0] != Tail)
+      return false;
+  }
+  if (Tail == Head || Tail->pred_size() != 2 || !Tail->livein_empty() ||
+      Tail->hasAddressTaken() || Tail->isEHPad())
+    return false;
+
+  // If Tail has no PHIs the conditional blocks have side effects.
+  if (Tail->empty() || !Tail->front().isPHI())
+    return false;
+
+  MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+  SmallVector<MachineOperand, 4> Cond;
+  if (TII->AnalyzeBranch(*Head, TBB, FBB, Cond, false) || !TBB ||
+      Cond.empty())
+    return false;
+  // AnalyzeBranch doesn't set FBB on a fall-through branch.
+  FBB = TBB == Succ0 ? Succ1 : Succ0;
+
+  unsigned TCount = 0, FCount = 0;
+  if ((TBB != Tail && !canSpeculate(TBB, TCount)) ||
+      (FBB != Tail && !canSpeculate(FBB, FCount)))
+    return false;
+
+  // Every PHI needs a select, unless it gets the same value both ways.
+  MachineBasicBlock *TPred = TBB == Tail ? Head : TBB;
+  MachineBasicBlock *FPred = FBB == Tail ? Head : FBB;
+  unsigned SelectCount = 0;
+  int CondCycles = 0, TrueCycles = 0, FalseCycles = 0;
+  for (MachineBasicBlock::iterator I = Tail->begin(), E = Tail->end();
+       I != E && I->isPHI(); ++I) {
+    unsigned TReg = 0, FReg = 0;
+    for (unsigned i = 1, e = I->getNumOperands(); i != e; i += 2) {
+      if (I->getOperand(i + 1).getMBB() == TPred)
+        TReg = I->getOperand(i).getReg();
+      if (I->getOperand(i + 1).getMBB() == FPred)
+        FReg = I->getOperand(i).getReg();
+    }
+    if (TReg == FReg)
+      continue;
+    // A triangle's select pseudo leaves values that are only needed on one
+    // side in Head for MachineSinking to move; keep the branch for those.
+    for (unsigned Reg : {TReg, FReg}) {
+      MachineInstr *DefMI = MRI->getVRegDef(Reg);
+      if (DefMI && DefMI->getParent() == Head && isExpensive(*DefMI) &&
+          MRI->hasOneNonDBGUse(Reg))
+        return false;
+    }
+    if (!TII->canInsertSelect(*Head, Cond, TReg, FReg,
+                              CondCycles, TrueCycles, FalseCycles))
+      return false;
+    ++SelectCount;
+  }
+
+  // Without a predictor worth the name, the conditional branch is taken
+  // half the time and then costs the mispredict penalty; a diamond also
+  // always jumps over one side.  The flattened code runs both sides, the
+  // condition once, since MachineCSE merges the copies, and the selects.
+  // Both costs are doubled to keep them integral.
+  bool IsDiamond = TBB != Tail && FBB != Tail;
+  unsigned BranchCost = 2 + TCount + FCount + MispredictPenalty;
+  if (IsDiamond)
+    BranchCost += 1 + MispredictPenalty;
+  unsigned FlatCost = 2 * (TCount + FCount);
+  if (SelectCount)
+    FlatCost += 2 * (CondCycles + SelectCount * std::max(TrueCycles,
+                                                         FalseCycles));
+  DEBUG(dbgs() << "BB#" << Head->getNumber() << ": branch cost "
+               << BranchCost << ", flat cost " << FlatCost << '\n');
+  if (FlatCost > BranchCost) {
+    ++NumRejected;
+    return false;
+  }
+
+  // Speculate the conditional blocks into Head, ahead of its branch.  The
+  // values they killed may now be read by the selects.
+  MachineBasicBlock::iterator InsertPt = Head->getFirstTerminator();
+  DebugLoc DL = InsertPt->getDebugLoc();
+  for (MachineBasicBlock *MBB : {TBB, FBB}) {
+    if (MBB == Tail)
+      continue;
+    for (MachineInstr &MI : make_range(MBB->begin(),
+                                       MBB->getFirstTerminator()))
+      for (MachineOperand &MO : MI.operands())
+        if (MO.isReg() && MO.isUse())
+          MO.setIsKill(false);
+    Head->splice(InsertPt, MBB, MBB->begin(), MBB->getFirstTerminator());
+  }
+  for (unsigned i = 2; i != Cond.size(); ++i)
+    if (Cond[i].isReg())
+      MRI->clearKillFlags(Cond[i].getReg());
+
+  while (!Tail->empty() && Tail->front().isPHI()) {
+    MachineInstr &PHI = Tail->front();
+    unsigned TReg = 0, FReg = 0;
+    for (unsigned i = 1, e = PHI.getNumOperands(); i != e; i += 2) {
+      if (PHI.getOperand(i + 1).getMBB() == TPred)
+        TReg = PHI.getOperand(i).getReg();
+      if (PHI.getOperand(i + 1).getMBB() == FPred)
+        FReg = PHI.getOperand(i).getReg();
+    }
+    unsigned DstReg = PHI.getOperand(0).getReg();
+    MRI->clearKillFlags(TReg);
+    MRI->clearKillFlags(FReg);
+    if (TReg == FReg)
+      BuildMI(*Head, InsertPt, DL, TII->get(TargetOpcode::COPY), DstReg)
+        .addReg(TReg);
+    else
+      TII->insertSelect(*Head, InsertPt, DL, DstReg, Cond, TReg, FReg);
+    PHI.eraseFromParent();
+  }
+
+  // Head now flows straight into Tail.
+  Head->removeSuccessor(TBB);
+  Head->removeSuccessor(FBB);
+  TII->RemoveBranch(*Head);
+  if (TBB != Tail)
+    TBB->eraseFromParent();
+  if (FBB != Tail)
+    FBB->eraseFromParent();
+
+  if (Head->isLayoutSuccessor(Tail)) {
+    Head->splice(Head->end(), Tail, Tail->begin(), Tail->end());
+    Head->transferSuccessorsAndUpdatePHIs(Tail);
+    Tail->eraseFromParent();
+  } else {
+    SmallVector<MachineOperand, 0> EmptyCond;
+    TII->InsertBranch(*Head, Tail, nullptr, EmptyCond, DL);
+    Head->addSuccessor(Tail);
+  }
+
+  if (IsDiamond)
+    ++NumDiamonds;
+  else
+    ++NumTriangles;
+  return true;
+}
+
+bool RISCVEarlyIfConversion::runOnMachineFunction(MachineFunction &Fn) {
+  if (!EnableEarlyIfCvt || skipFunction(*Fn.getFunction()))
+    return false;
+
+  const TargetSubtargetInfo &STI = Fn.getSubtarget();
+  TII = static_cast<const RISCVInstrInfo *>(STI.getInstrInfo());
+  MRI = &Fn.getRegInfo();
+  MispredictPenalty = STI.getSchedModel().MispredictPenalty;
+  if (!MRI->isSSA())
+    return false;
+
+  bool Changed = false;
+  for (MachineFunction::iterator MFI = Fn.begin(); MFI != Fn.end(); ++MFI)
+    while (tryConvert(&*MFI))
+      Changed = true;
+  return Changed;
+}
@@ -0,0 +1,838 @@
+//===-- RISCVFastISel.cpp - RISCV FastISel implementation -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RISCV-specific support for the FastISel class, which
+// selects -O0 code without building a SelectionDAG.  It covers the integer
+// subset of RV32: ALU operations, loads and stores, branches, direct calls
+// and returns.  Anything else makes FastISel fall back to SelectionDAG for
+// the rest of the block.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVISelLowering.h"
+#include "RISCVMachineFunctionInfo.h"
+#include "RISCVSubtarget.h"
+#include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+#include "llvm/CodeGen/FastISel.h"
+#include "llvm/CodeGen/FunctionLoweringInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-fastisel"
+
+namespace {
+
+class RISCVFastISel final : public FastISel {
+  // An address is either a register or a frame index, plus an offset that
+  // is folded into the immediate of the load or store if it fits.
+  class Address {
+  public:
+    enum BaseKind { RegBase, FrameIndexBase };
+
+  private:
+    BaseKind Kind;
+    union {
+      unsigned Reg;
+      int FI;
+    } Base;
+    int64_t Offset;
+
+  public:
+    Address() : Kind(RegBase), Offset(0) { Base.Reg = 0; }
+    bool isRegBase() const { return Kind == RegBase; }
+    bool isFIBase() const { return Kind == FrameIndexBase; }
+    void setReg(unsigned Reg) { Kind = RegBase; Base.Reg = Reg; }
+    unsigned getReg() const { return Base.Reg; }
+    void setFI(int FI) { Kind = FrameIndexBase; Base.FI = FI; }
+    int getFI() const { return Base.FI; }
+    void setOffset(int64_t O) { Offset = O; }
+    int64_t getOffset() const { return Offset; }
+  };
+
+  const RISCVSubtarget &Subtarget;
+  LLVMContext *Context;
+
+public:
+  explicit RISCVFastISel(FunctionLoweringInfo &FuncInfo,
+                         const TargetLibraryInfo *LibInfo)
+    : FastISel(FuncInfo, LibInfo),
+      Subtarget(FuncInfo.MF->getSubtarget<RISCVSubtarget>()),
+      Context(&FuncInfo.Fn->getContext()) {}
+
+  // Override FastISel.
+  bool fastSelectInstruction(const Instruction *I) override;
+  bool fastLowerArguments() override;
+  bool fastLowerCall(CallLoweringInfo &CLI) override;
+  unsigned fastMaterializeConstant(const Constant *C) override;
+  unsigned fastMaterializeAlloca(const AllocaInst *AI) override;
+  unsigned fastEmit_rr(MVT VT, MVT RetVT, unsigned Opcode, unsigned Op0,
+                       bool Op0IsKill, unsigned Op1, bool Op1IsKill) override;
+  unsigned fastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode, unsigned Op0,
+                       bool Op0IsKill, uint64_t Imm) override;
+
+private:
+  bool selectLoad(const Instruction *I);
+  bool selectStore(const Instruction *I);
+  bool selectBranch(const Instruction *I);
+  bool selectCmp(const Instruction *I);
+  bool selectIntExt(const Instruction *I);
+  bool selectTrunc(const Instruction *I);
+  bool selectRet(const Instruction *I);
+
+  void addSuccessor(const BasicBlock *BB, MachineBasicBlock *Succ);
+  bool isTypeSupported(Type *Ty, MVT &VT);
+  bool computeAddress(const Value *Obj, Address &Addr);
+  void addLoadStoreOperands(MachineInstrBuilder &MIB, Address &Addr,
+                            MachineMemOperand *MMO);
+  unsigned emitIntExt(MVT SrcVT, unsigned SrcReg, bool IsZExt);
+  unsigned emitCmp(CmpInst::Predicate Pred, unsigned LHSReg, unsigned RHSReg);
+  unsigned materializeGV(const GlobalValue *GV);
+  unsigned materializeInt(int64_t Imm);
+};
+
+} // end anonymous namespace
+
+#include "RISCVGenCallingConv.inc"
+
+// Return true if values of type Ty live in a single GR32, setting VT to
+// the type's MVT.  Types narrower than i32 are held in a promoted register
+// whose high bits are unspecified.  That includes i1: the generic code
+// selects "xor i1 %c, true" as an xori with -1.
+bool RISCVFastISel::isTypeSupported(Type *Ty, MVT &VT) {
+  EVT Evt = TLI.getValueType(DL, Ty, true);
+  if (Evt == MVT::Other || !Evt.isSimple())
+    return false;
+  VT = Evt.getSimpleVT();
+  return VT == MVT::i1 || VT == MVT::i8 || VT == MVT::i16 || VT == MVT::i32;
+}
+
+bool RISCVFastISel::computeAddress(const Value *Obj, Address &Addr) {
+  const User *U = nullptr;
+  unsigned Opcode = Instruction::UserOp1;
+  if (const Instruction *I = dyn_cast<Instruction>(Obj)) {
+    // Only fold instructions from the block being selected, or static
+    // allocas, whose frame index is valid everywhere.
+    if (FuncInfo.StaticAllocaMap.count(static_cast<const AllocaInst *>(Obj)) ||
+        FuncInfo.MBBMap[I->getParent()] == FuncInfo.MBB) {
+      Opcode = I->getOpcode();
+      U = I;
+    }
+  } else if (const ConstantExpr *C = dyn_cast<ConstantExpr>(Obj)) {
+    Opcode = C->getOpcode();
+    U = C;
+  }
+
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::BitCast:
+    return computeAddress(U->getOperand(0), Addr);
+  case Instruction::IntToPtr:
+  case Instruction::PtrToInt:
+    if (TLI.getValueType(DL, U->getOperand(0)->getType()) ==
+        TLI.getPointerTy(DL))
+      return computeAddress(U->getOperand(0), Addr);
+    break;
+  case Instruction::GetElementPtr: {
+    // Fold GEPs with constant indices into the offset.
+    Address SavedAddr = Addr;
+    int64_t TmpOffset = Addr.getOffset();
+    bool AllConstant = true;
+    gep_type_iterator GTI = gep_type_begin(U);
+    for (User::const_op_iterator OI = U->op_begin() + 1, OE = U->op_end();
+         OI != OE; ++OI, ++GTI) {
+      const ConstantInt *CI = dyn_cast<ConstantInt>(*OI);
+      if (!CI) {
+        AllConstant = false;
+        break;
+      }
+      if (StructType *STy = dyn_cast<StructType>(*GTI)) {
+        const StructLayout *SL = DL.getStructLayout(STy);
+        TmpOffset += SL->getElementOffset(CI->getZExtValue());
+      } else {
+        uint64_t S = DL.getTypeAllocSize(GTI.getIndexedType());
+        TmpOffset += CI->getSExtValue() * S;
+      }
+    }
+    if (AllConstant) {
+      Addr.setOffset(TmpOffset);
+      if (computeAddress(U->getOperand(0), Addr))
+        return true;
+    }
+    Addr = SavedAddr;
+    break;
+  }
+  case Instruction::Alloca: {
+    const AllocaInst *AI = cast<AllocaInst>(Obj);
+    DenseMap<const AllocaInst *, int>::iterator SI =
+        FuncInfo.StaticAllocaMap.find(AI);
+    if (SI != FuncInfo.StaticAllocaMap.end()) {
+      Addr.setFI(SI->second);
+      return true;
+    }
+    break;
+  }
+  }
+
+  unsigned Reg = getRegForValue(Obj);
+  if (!Reg)
+    return false;
+  Addr.setReg(Reg);
+  return true;
+}
+
+// Add the mem operand of a load or store, which is the offset followed by
+// the base.
+void RISCVFastISel::addLoadStoreOperands(MachineInstrBuilder &MIB,
+                                         Address &Addr,
+                                         MachineMemOperand *MMO) {
+  MIB.addImm(Addr.getOffset());
+  if (Addr.isFIBase())
+    MIB.addFrameIndex(Addr.getFI());
+  else
+    MIB.addReg(Addr.getReg());
+  MIB.addMemOperand(MMO);
+}
+
+bool RISCVFastISel::selectLoad(const Instruction *I) {
+  const LoadInst *LI = cast<LoadInst>(I);
+  if (LI->isAtomic())
+    return false;
+
+  MVT VT;
+  if (!isTypeSupported(LI->getType(), VT))
+    return false;
+
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  case MVT::i1:
+  case MVT::i8:  Opc = RISCV::LBU; break;
+  case MVT::i16: Opc = RISCV::LHU; break;
+  case MVT::i32: Opc = RISCV::LW; break;
+  default: return false;
+  }
+
+  Address Addr;
+  if (!computeAddress(LI->getPointerOperand(), Addr))
+    return false;
+  if (!isInt<12>(Addr.getOffset())) {
+    if (Addr.isFIBase())
+      return false;
+    unsigned Reg = fastEmit_ri_(MVT::i32, ISD::ADD, Addr.getReg(), false,
+                                Addr.getOffset(), MVT::i32);
+    if (!Reg)
+      return false;
+    Addr.setReg(Reg);
+    Addr.setOffset(0);
+  }
+
+  unsigned ResultReg = createResultReg(&RISCV::GR32BitRegClass);
+  MachineInstrBuilder MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+                                    TII.get(Opc), ResultReg);
+  addLoadStoreOperands(MIB, Addr, createMachineMemOperandFor(I));
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool RISCVFastISel::selectStore(const Instruction *I) {
+  const StoreInst *SI = cast<StoreInst>(I);
+  if (SI->isAtomic())
+    return false;
+
+  const Value *Op0 = SI->getValueOperand();
+  MVT VT;
+  if (!isTypeSupported(Op0->getType(), VT))
+    return false;
+
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  case MVT::i1:
+  case MVT::i8:  Opc = RISCV::SB; break;
+  case MVT::i16: Opc = RISCV::SH; break;
+  case MVT::i32: Opc = RISCV::SW; break;
+  default: return false;
+  }
+
+  unsigned SrcReg = getRegForValue(Op0);
+  if (!SrcReg)
+    return false;
+  // An i1 is stored as a byte that is 0 or 1.
+  if (VT == MVT::i1)
+    SrcReg = emitIntExt(VT, SrcReg, /*IsZExt=*/true);
+
+  Address Addr;
+  if (!computeAddress(SI->getPointerOperand(), Addr))
+    return false;
+  if (!isInt<12>(Addr.getOffset())) {
+    if (Addr.isFIBase())
+      return false;
+    unsigned Reg = fastEmit_ri_(MVT::i32, ISD::ADD, Addr.getReg(), false,
+                                Addr.getOffset(), MVT::i32);
+    if (!Reg)
+      return false;
+    Addr.setReg(Reg);
+    Addr.setOffset(0);
+  }
+
+  MachineInstrBuilder MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+                                    TII.get(Opc)).addReg(SrcReg);
+  addLoadStoreOperands(MIB, Addr, createMachineMemOperandFor(I));
+  return true;
+}
+
+// Conditional branches test the low bit of the i1 condition against zero.
+// Unconditional branches are handled by the target-independent code.
+bool RISCVFastISel::selectBranch(const Instruction *I) {
+  const BranchInst *BI = cast<BranchInst>(I);
+  MachineBasicBlock *TBB = FuncInfo.MBBMap[BI->getSuccessor(0)];
+  MachineBasicBlock *FBB = FuncInfo.MBBMap[BI->getSuccessor(1)];
+
+  unsigned CondReg = getRegForValue(BI->getCondition());
+  if (!CondReg)
+    return false;
+  // Comparisons produce 0 or 1; anything else may have its high bits set.
+  if (!isa<ICmpInst>(BI->getCondition()))
+    CondReg = emitIntExt(MVT::i1, CondReg, /*IsZExt=*/true);
+
+  // Conditional branches are barriers here, so the false edge always gets
+  // its own jump, even to the layout successor.
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::BNE))
+      .addMBB(TBB)
+      .addReg(CondReg)
+      .addReg(RISCV::zero);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::J))
+      .addMBB(FBB);
+
+  if (TBB != FBB)
+    addSuccessor(BI->getParent(), TBB);
+  addSuccessor(BI->getParent(), FBB);
+  return true;
+}
+
+void RISCVFastISel::addSuccessor(const BasicBlock *BB,
+                                 MachineBasicBlock *Succ) {
+  if (FuncInfo.BPI)
+    FuncInfo.MBB->addSuccessor(
+        Succ, FuncInfo.BPI->getEdgeProbability(BB, Succ->getBasicBlock()));
+  else
+    FuncInfo.MBB->addSuccessorWithoutProb(Succ);
+}
+
+unsigned RISCVFastISel::emitCmp(CmpInst::Predicate Pred, unsigned LHSReg,
+                                unsigned RHSReg) {
+  const TargetRegisterClass *RC = &RISCV::GR32BitRegClass;
+  unsigned Opc, Tmp;
+  bool Swap = false, Invert = false;
+  switch (Pred) {
+  case CmpInst::ICMP_EQ:
+    Tmp = fastEmitInst_rr(RISCV::XOR, RC, LHSReg, false, RHSReg, false);
+    return fastEmitInst_ri(RISCV::SLTIU, RC, Tmp, true, 1);
+  case CmpInst::ICMP_NE:
+    Tmp = fastEmitInst_rr(RISCV::XOR, RC, LHSReg, false, RHSReg, false);
+    return fastEmitInst_rr(RISCV::SLTU, RC, RISCV::zero, false, Tmp, true);
+  case CmpInst::ICMP_SLT: Opc = RISCV::SLT; break;
+  case CmpInst::ICMP_SGT: Opc = RISCV::SLT; Swap = true; break;
+  case CmpInst::ICMP_SGE: Opc = RISCV::SLT; Invert = true; break;
+  case CmpInst::ICMP_SLE: Opc = RISCV::SLT; Swap = Invert = true; break;
+  case CmpInst::ICMP_ULT: Opc = RISCV::SLTU; break;
+  case CmpInst::ICMP_UGT: Opc = RISCV::SLTU; Swap = true; break;
+  case CmpInst::ICMP_UGE: Opc = RISCV::SLTU; Invert = true; break;
+  case CmpInst::ICMP_ULE: Opc = RISCV::SLTU; Swap = Invert = true; break;
+  default:
+    return 0;
+  }
+  if (Swap)
+    std::swap(LHSReg, RHSReg);
+  unsigned ResultReg = fastEmitInst_rr(Opc, RC, LHSReg, false, RHSReg, false);
+  if (Invert)
+    ResultReg = fastEmitInst_ri(RISCV::XORI, RC, ResultReg, true, 1);
+  return ResultReg;
+}
+
+bool RISCVFastISel::selectCmp(const Instruction *I) {
+  const ICmpInst *CI = dyn_cast<ICmpInst>(I);
+  if (!CI)
+    return false;
+
+  MVT VT;
+  if (!isTypeSupported(CI->getOperand(0)->getType(), VT))
+    return false;
+
+  unsigned LHSReg = getRegForValue(CI->getOperand(0));
+  unsigned RHSReg = getRegForValue(CI->getOperand(1));
+  if (!LHSReg || !RHSReg)
+    return false;
+
+  // Narrow operands must be extended the way the predicate reads them.
+  bool IsZExt = !CI->isSigned();
+  LHSReg = emitIntExt(VT, LHSReg, IsZExt);
+  RHSReg = emitIntExt(VT, RHSReg, IsZExt);
+  if (!LHSReg || !RHSReg)
+    return false;
+
+  unsigned ResultReg = emitCmp(CI->getPredicate(), LHSReg, RHSReg);
+  if (!ResultReg)
+    return false;
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+// Extend the SrcVT value in SrcReg to i32.
+unsigned RISCVFastISel::emitIntExt(MVT SrcVT, unsigned SrcReg, bool IsZExt) {
+  const TargetRegisterClass *RC = &RISCV::GR32BitRegClass;
+  unsigned Bits;
+  switch (SrcVT.SimpleTy) {
+  case MVT::i1:  Bits = 1; break;
+  case MVT::i8:  Bits = 8; break;
+  case MVT::i16: Bits = 16; break;
+  case MVT::i32: return SrcReg;
+  default: return 0;
+  }
+
+  if (IsZExt && Bits < 12)
+    return fastEmitInst_ri(RISCV::ANDI, RC, SrcReg, false, (1 << Bits) - 1);
+  unsigned Tmp = fastEmitInst_ri(RISCV::SLLI, RC, SrcReg, false, 32 - Bits);
+  return fastEmitInst_ri(IsZExt ? RISCV::SRLI : RISCV::SRAI, RC, Tmp, true,
+                         32 - Bits);
+}
+
+bool RISCVFastISel::selectIntExt(const Instruction *I) {
+  MVT SrcVT, DestVT;
+  if (!isTypeSupported(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeSupported(I->getType(), DestVT))
+    return false;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (!SrcReg)
+    return false;
+
+  unsigned ResultReg = emitIntExt(SrcVT, SrcReg, isa<ZExtInst>(I));
+  if (!ResultReg)
+    return false;
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+// Truncation keeps the register, since the high bits of narrow values are
+// unspecified, except that an i1 must be cleared down to its low bit.
+bool RISCVFastISel::selectTrunc(const Instruction *I) {
+  MVT SrcVT, DestVT;
+  if (!isTypeSupported(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeSupported(I->getType(), DestVT))
+    return false;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (!SrcReg)
+    return false;
+
+  unsigned ResultReg = SrcReg;
+  if (DestVT == MVT::i1)
+    ResultReg = fastEmitInst_ri(RISCV::ANDI, &RISCV::GR32BitRegClass, SrcReg,
+                                false, 1);
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool RISCVFastISel::selectRet(const Instruction *I) {
+  const Function &F = *I->getParent()->getParent();
+  const ReturnInst *Ret = cast<ReturnInst>(I);
+
+  if (!FuncInfo.CanLowerReturn || F.isVarArg())
+    return false;
+
+  SmallVector<unsigned, 4> RetRegs;
+  if (Ret->getNumOperands() > 0) {
+    CallingConv::ID CC = F.getCallingConv();
+    if (CC != CallingConv::C)
+      return false;
+
+    SmallVector<ISD::OutputArg, 4> Outs;
+    GetReturnInfo(F.getReturnType(), F.getAttributes(), Outs, TLI, DL);
+
+    const Value *RV = Ret->getOperand(0);
+    MVT RVVT;
+    if (!isTypeSupported(RV->getType(), RVVT) || Outs.size() != 1)
+      return false;
+    // Narrow values are only returned with an extension attribute, which
+    // promotes them to i32 above.
+    if (Outs[0].VT != MVT::i32)
+      return false;
+
+    SmallVector<CCValAssign, 16> ValLocs;
+    CCState CCInfo(CC, F.isVarArg(), *FuncInfo.MF, ValLocs, *Context);
+    CCInfo.AnalyzeReturn(Outs, RetCC_RISCV32);
+    CCValAssign &VA = ValLocs[0];
+    if (!VA.isRegLoc())
+      return false;
+
+    unsigned Reg = getRegForValue(RV);
+    if (!Reg)
+      return false;
+    if (RVVT != MVT::i32) {
+      Reg = emitIntExt(RVVT, Reg, Outs[0].Flags.isZExt());
+      if (!Reg)
+        return false;
+    }
+
+    unsigned DestReg = VA.getLocReg();
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), DestReg).addReg(Reg);
+    RetRegs.push_back(DestReg);
+  }
+
+  MachineInstrBuilder MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+                                    TII.get(RISCV::RET));
+  for (unsigned Reg : RetRegs)
+    MIB.addReg(Reg, RegState::Implicit);
+  return true;
+}
+
+bool RISCVFastISel::fastSelectInstruction(const Instruction *I) {
+  switch (I->getOpcode()) {
+  default:
+    break;
+  case Instruction::Load:
+    return selectLoad(I);
+  case Instruction::Store:
+    return selectStore(I);
+  case Instruction::Br:
+    return selectBranch(I);
+  case Instruction::ICmp:
+    return selectCmp(I);
+  case Instruction::ZExt:
+  case Instruction::SExt:
+    return selectIntExt(I);
+  case Instruction::Trunc:
+    return selectTrunc(I);
+  case Instruction::Ret:
+    return selectRet(I);
+  }
+  return false;
+}
+
+// Only functions whose arguments all arrive whole in a0-a7 are handled.
+bool RISCVFastISel::fastLowerArguments() {
+  if (!FuncInfo.CanLowerReturn)
+    return false;
+
+  const Function *F = FuncInfo.Fn;
+  if (F->isVarArg() || F->getCallingConv() != CallingConv::C)
+    return false;
+
+  static const MCPhysReg ArgRegs[] = {
+    RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3,
+    RISCV::a4, RISCV::a5, RISCV::a6, RISCV::a7
+  };
+  if (F->arg_size() > array_lengthof(ArgRegs))
+    return false;
+
+  for (const Argument &Arg : F->args()) {
+    unsigned Idx = Arg.getArgNo() + 1;
+    if (F->getAttributes().hasAttribute(Idx, Attribute::ByVal) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::InReg) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::StructRet) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::SwiftSelf) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::SwiftError) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::Nest))
+      return false;
+
+    EVT ArgVT = TLI.getValueType(DL, Arg.getType());
+    if (ArgVT != MVT::i32)
+      return false;
+  }
+
+  const TargetRegisterClass *RC = &RISCV::GR32BitRegClass;
+  for (const Argument &Arg : F->args()) {
+    unsigned SrcReg = ArgRegs[Arg.getArgNo()];
+    unsigned DstReg = FuncInfo.MF->addLiveIn(SrcReg, RC);
+    // The live-in copy may be coalesced away, so copy it into a fresh vreg
+    // that the rest of the function can use.
+    unsigned ResultReg = createResultReg(RC);
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ResultReg)
+        .addReg(DstReg, getKillRegState(true));
+    updateValueMap(&Arg, ResultReg);
+  }
+  return true;
+}
+
+// Direct, non-variadic calls to functions.  Stack arguments are stored
+// relative to sp, inside the call frame set up by ADJCALLSTACKDOWN.
+bool RISCVFastISel::fastLowerCall(CallLoweringInfo &CLI) {
+  CallingConv::ID CC = CLI.CallConv;
+  bool IsVarArg = CLI.IsVarArg;
+
+  // Allow SelectionDAG isel to handle tail calls.
+  if (CLI.IsTailCall)
+    return false;
+  if (IsVarArg || CC != CallingConv::C)
+    return false;
+  if (TM.getRelocationModel() == Reloc::PIC_)
+    return false;
+
+  const GlobalValue *GV = dyn_cast_or_null<GlobalValue>(CLI.Callee);
+  if (!GV || GV->isThreadLocal())
+    return false;
+
+  // The result must fit in a0.
+  MVT RetVT = MVT::isVoid;
+  if (!CLI.RetTy->isVoidTy()) {
+    if (!isTypeSupported(CLI.RetTy, RetVT) || RetVT != MVT::i32)
+      return false;
+  }
+
+  SmallVector<MVT, 16> OutVTs;
+  for (unsigned I = 0, E = CLI.OutVals.size(); I != E; ++I) {
+    ISD::ArgFlagsTy Flags = CLI.OutFlags[I];
+    if (Flags.isByVal() || Flags.isInReg() || Flags.isSRet() ||
+        Flags.isNest() || Flags.isSwiftSelf() || Flags.isSwiftError())
+      return false;
+    MVT VT;
+    if (!isTypeSupported(CLI.OutVals[I]->getType(), VT) || VT == MVT::i1)
+      return false;
+    OutVTs.push_back(VT);
+  }
+
+  unsigned CalleeReg = 0;
+  if (!Subtarget.enableLinkerRelax()) {
+    CalleeReg = getRegForValue(GV);
+    if (!CalleeReg)
+      return false;
+  }
+
+  SmallVector<CCValAssign, 16> ArgLocs;
+  CCState CCInfo(CC, IsVarArg, *FuncInfo.MF, ArgLocs, *Context);
+  CCInfo.AnalyzeCallOperands(OutVTs, CLI.OutFlags, CC_RISCV32);
+  unsigned NumBytes = CCInfo.getNextStackOffset();
+
+  // Issue CALLSEQ_START.
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(TII.getCallFrameSetupOpcode())).addImm(NumBytes);
+
+  // Copy the arguments to their locations.
+  for (unsigned I = 0, E = ArgLocs.size(); I != E; ++I) {
+    CCValAssign &VA = ArgLocs[I];
+    unsigned ArgReg = getRegForValue(CLI.OutVals[I]);
+    if (!ArgReg)
+      return false;
+
+    switch (VA.getLocInfo()) {
+    case CCValAssign::Full:
+    case CCValAssign::AExt:
+      break;
+    case CCValAssign::SExt:
+    case CCValAssign::ZExt:
+      ArgReg = emitIntExt(VA.getValVT(), ArgReg,
+                          VA.getLocInfo() == CCValAssign::ZExt);
+      if (!ArgReg)
+        return false;
+      break;
+    default:
+      return false;
+    }
+
+    if (VA.isRegLoc()) {
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+              TII.get(TargetOpcode::COPY), VA.getLocReg()).addReg(ArgReg);
+      CLI.OutRegs.push_back(VA.getLocReg());
+    } else {
+      unsigned Offset = VA.getLocMemOffset();
+      if (!isInt<12>(Offset))
+        return false;
+      MachineMemOperand *MMO = FuncInfo.MF->getMachineMemOperand(
+          MachinePointerInfo::getStack(*FuncInfo.MF, Offset),
+          MachineMemOperand::MOStore, 4, 4);
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::SW))
+          .addReg(ArgReg)
+          .addImm(Offset)
+          .addReg(RISCV::sp)
+          .addMemOperand(MMO);
+    }
+  }
+
+  // As in LowerCall, a direct call is an auipc/jalr pair with linker
+  // relaxation and otherwise goes through a register holding the address.
+  // The custom inserter turns both pseudos into the real instructions.
+  MachineInstrBuilder MIB;
+  if (Subtarget.enableLinkerRelax())
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+                  TII.get(RISCV::CALL)).addGlobalAddress(GV);
+  else
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+                  TII.get(RISCV::CALLREG)).addImm(0).addReg(CalleeReg);
+  for (unsigned Reg : CLI.OutRegs)
+    MIB.addReg(Reg, RegState::Implicit);
+  MIB.addRegMask(TRI.getCallPreservedMask(*FuncInfo.MF, CC));
+  CLI.Call = MIB;
+
+  // Issue CALLSEQ_END.
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+          TII.get(TII.getCallFrameDestroyOpcode())).addImm(NumBytes).addImm(0);
+
+  // Copy the result out of a0.
+  if (RetVT != MVT::isVoid) {
+    SmallVector<CCValAssign, 16> RetLocs;
+    CCState RetCCInfo(CC, IsVarArg, *FuncInfo.MF, RetLocs, *Context);
+    RetCCInfo.AnalyzeCallResult(RetVT, RetCC_RISCV32);
+    unsigned ResultReg = createResultReg(&RISCV::GR32BitRegClass);
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ResultReg)
+        .addReg(RetLocs[0].getLocReg());
+    CLI.InRegs.push_back(RetLocs[0].getLocReg());
+    CLI.ResultReg = ResultReg;
+    CLI.NumResultRegs = 1;
+  }
+  return true;
+}
+
+unsigned RISCVFastISel::materializeInt(int64_t Imm) {
+  unsigned ResultReg = createResultReg(&RISCV::GR32BitRegClass);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::LI),
+          ResultReg).addImm(Imm);
+  return ResultReg;
+}
+
+// Globals are addressed as in RISCVTargetLowering::lowerGlobalAddress:
+// relative to gp in the small data sections, otherwise with %hi/%lo.
+unsigned RISCVFastISel::materializeGV(const GlobalValue *GV) {
+  if (GV->isThreadLocal() || TM.getRelocationModel() == Reloc::PIC_)
+    return 0;
+
+  const TargetRegisterClass *RC = &RISCV::GR32BitRegClass;
+  unsigned ResultReg = createResultReg(RC);
+  const RISCVTargetObjectFile *TLOF =
+      static_cast<const RISCVTargetObjectFile *>(TM.getObjFileLowering());
+  if (TLOF->isGlobalInSmallSection(GV, TM)) {
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::ADDI),
+            ResultReg)
+        .addReg(RISCV::gp)
+        .addGlobalAddress(GV, 0, RISCVII::MO_GPREL);
+    return ResultReg;
+  }
+
+  unsigned HiReg = createResultReg(RC);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::LUI), HiReg)
+      .addGlobalAddress(GV, 0, RISCVII::MO_ABS_HI);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::ADDI),
+          ResultReg)
+      .addReg(HiReg, RegState::Kill)
+      .addGlobalAddress(GV, 0, RISCVII::MO_ABS_LO);
+  return ResultReg;
+}
+
+unsigned RISCVFastISel::fastMaterializeConstant(const Constant *C) {
+  if (const ConstantInt *CI = dyn_cast<ConstantInt>(C)) {
+    MVT VT;
+    if (!isTypeSupported(CI->getType(), VT))
+      return 0;
+    // Keep i1 constants as 0 or 1.
+    return materializeInt(VT == MVT::i1 ? CI->getZExtValue()
+                                        : CI->getSExtValue());
+  }
+  if (isa<ConstantPointerNull>(C))
+    return materializeInt(0);
+  if (const GlobalValue *GV = dyn_cast<GlobalValue>(C))
+    return materializeGV(GV);
+  return 0;
+}
+
+unsigned RISCVFastISel::fastMaterializeAlloca(const AllocaInst *AI) {
+  DenseMap<const AllocaInst *, int>::iterator SI =
+      FuncInfo.StaticAllocaMap.find(AI);
+  if (SI == FuncInfo.StaticAllocaMap.end())
+    return 0;
+
+  // The same ADDI that RISCVDAGToDAGISel selects for a FrameIndex.
+  unsigned ResultReg = createResultReg(&RISCV::GR32BitRegClass);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(RISCV::ADDI),
+          ResultReg)
+      .addFrameIndex(SI->second)
+      .addImm(0);
+  return ResultReg;
+}
+
+// The target-independent code selects binary operators of legal types
+// through these two hooks.
+unsigned RISCVFastISel::fastEmit_rr(MVT VT, MVT RetVT, unsigned Opcode,
+                                    unsigned Op0, bool Op0IsKill,
+                                    unsigned Op1, bool Op1IsKill) {
+  if (VT != MVT::i32 || RetVT != MVT::i32)
+    return 0;
+
+  unsigned Opc;
+  switch (Opcode) {
+  case ISD::ADD: Opc = RISCV::ADD; break;
+  case ISD::SUB: Opc = RISCV::SUB; break;
+  case ISD::AND: Opc = RISCV::AND; break;
+  case ISD::OR:  Opc = RISCV::OR;  break;
+  case ISD::XOR: Opc = RISCV::XOR; break;
+  case ISD::SHL: Opc = RISCV::SLL; break;
+  case ISD::SRL: Opc = RISCV::SRL; break;
+  case ISD::SRA: Opc = RISCV::SRA; break;
+  case ISD::MUL:
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+    if (!Subtarget.hasM())
+      return 0;
+    Opc = Opcode == ISD::MUL  ? RISCV::MUL  :
+          Opcode == ISD::SDIV ? RISCV::DIV  :
+          Opcode == ISD::UDIV ? RISCV::DIVU :
+          Opcode == ISD::SREM ? RISCV::REM  : RISCV::REMU;
+    break;
+  default:
+    return 0;
+  }
+  return fastEmitInst_rr(Opc, &RISCV::GR32BitRegClass, Op0, Op0IsKill,
+                         Op1, Op1IsKill);
+}
+
+unsigned RISCVFastISel::fastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode,
+                                    unsigned Op0, bool Op0IsKill,
+                                    uint64_t Imm) {
+  if (VT != MVT::i32 || RetVT != MVT::i32)
+    return 0;
+
+  unsigned Opc;
+  switch (Opcode) {
+  case ISD::ADD: Opc = RISCV::ADDI; break;
+  case ISD::AND: Opc = RISCV::ANDI; break;
+  case ISD::OR:  Opc = RISCV::ORI;  break;
+  case ISD::XOR: Opc = RISCV::XORI; break;
+  case ISD::SHL: Opc = RISCV::SLLI; break;
+  case ISD::SRL: Opc = RISCV::SRLI; break;
+  case ISD::SRA: Opc = RISCV::SRAI; break;
+  default:
+    return 0;
+  }
+  if (Opc == RISCV::SLLI || Opc == RISCV::SRLI || Opc == RISCV::SRAI) {
+    if (Imm >= 32)
+      return 0;
+  } else if (!isInt<12>((int64_t)Imm))
+    return 0;
+  return fastEmitInst_ri(Opc, &RISCV::GR32BitRegClass, Op0, Op0IsKill, Imm);
+}
+
+namespace llvm {
+FastISel *RISCV::createFastISel(FunctionLoweringInfo &FuncInfo,
+                                const TargetLibraryInfo *LibInfo) {
+  return new RISCVFastISel(FuncInfo, LibInfo);
+}
+} // end namespace llvm
@@ -77,8 +77,98 @@ unsigned RISCVFrameLowering::ehDataReg(unsigned I) const {
   return EhDataReg[I];
 }
 
+// Return true if the callee-saved GPRs of MF are saved and restored by
+// the __riscv_save_N and __riscv_restore_N routines.
+static bool useSaveRestoreLibCalls(const MachineFunction &MF) {
+  return MF.getSubtarget<RISCVSubtarget>().enableSaveRestore() &&
+    !MF.getInfo<RISCVFunctionInfo>()->getCallsEhReturn() &&
+    !MF.getFunction()->isVarArg();
+}
+
+// The save and restore routines handle ra and s0-s11.  Return the slot of
+// Reg in the area they use, counting down from the incoming stack pointer,
+// or -1 if they don't handle Reg.
+static int getLibCallSlot(unsigned Reg) {
+  switch (Reg) {
+  case RISCV::ra:  case RISCV::ra_64:  return 0;
+  case RISCV::fp:  case RISCV::fp_64:
+  case RISCV::s0:  case RISCV::s0_64:  return 1;
+  case RISCV::s1:  case RISCV::s1_64:  return 2;
+  case RISCV::s2:  case RISCV::s2_64:  return 3;
+  case RISCV::s3:  case RISCV::s3_64:  return 4;
+  case RISCV::s4:  case RISCV::s4_64:  return 5;
+  case RISCV::s5:  case RISCV::s5_64:  return 6;
+  case RISCV::s6:  case RISCV::s6_64:  return 7;
+  case RISCV::s7:  case RISCV::s7_64:  return 8;
+  case RISCV::s8:  case RISCV::s8_64:  return 9;
+  case RISCV::s9:  case RISCV::s9_64:  return 10;
+  case RISCV::s10: case RISCV::s10_64: return 11;
+  case RISCV::s11: case RISCV::s11_64: return 12;
+  }
+  return -1;
+}
+
+// Return the N of the __riscv_save_N/__riscv_restore_N pair that covers
+// CSI, i.e. the number of s registers saved, or -1 if no libcall is used.
+static int getLibCallID(const MachineFunction &MF,
+                        const std::vector<CalleeSavedInfo> &CSI) {
+  if (!useSaveRestoreLibCalls(MF))
+    return -1;
+
+  int MaxSlot = -1;
+  for (const CalleeSavedInfo &I : CSI)
+    MaxSlot = std::max(MaxSlot, getLibCallSlot(I.getReg()));
+  return MaxSlot;
+}
+
+static const char *getSaveLibCallName(int LibCallID) {
+  static const char *const Names[] = {
+    "__riscv_save_0",  "__riscv_save_1",  "__riscv_save_2",
+    "__riscv_save_3",  "__riscv_save_4",  "__riscv_save_5",
+    "__riscv_save_6",  "__riscv_save_7",  "__riscv_save_8",
+    "__riscv_save_9",  "__riscv_save_10", "__riscv_save_11",
+    "__riscv_save_12"
+  };
+  return Names[LibCallID];
+}
+
+static const char *getRestoreLibCallName(int LibCallID) {
+  static const char *const Names[] = {
+    "__riscv_restore_0",  "__riscv_restore_1",  "__riscv_restore_2",
+    "__riscv_restore_3",  "__riscv_restore_4",  "__riscv_restore_5",
+    "__riscv_restore_6",  "__riscv_restore_7",  "__riscv_restore_8",
+    "__riscv_restore_9",  "__riscv_restore_10", "__riscv_restore_11",
+    "__riscv_restore_12"
+  };
+  return Names[LibCallID];
+}
+
+// Return the number of bytes the save routine for LibCallID allocates:
+// one slot for ra and one per s register, rounded up to keep the stack
+// aligned.
+static unsigned getLibCallFrameSize(const MachineFunction &MF, int LibCallID) {
+  if (LibCallID < 0)
+    return 0;
+  unsigned SlotSize = MF.getSubtarget<RISCVSubtarget>().isRV64() ? 8 : 4;
+  return alignTo((LibCallID + 1) * SlotSize,
+                 MF.getSubtarget().getFrameLowering()->getStackAlignment());
+}
+
+// Return the number of entries of CSI that are saved by ordinary stores
+// rather than by the save routine.
+static unsigned getNumNonLibCallCSRs(const MachineFunction &MF,
+                                     const std::vector<CalleeSavedInfo> &CSI) {
+  if (getLibCallID(MF, CSI) < 0)
+    return CSI.size();
+
+  unsigned N = 0;
+  for (const CalleeSavedInfo &I : CSI)
+    if (getLibCallSlot(I.getReg()) < 0)
+      ++N;
+  return N;
+}
+
 void RISCVFrameLowering::emitPrologue(MachineFunction &MF, MachineBasicBlock &MBB) const {
-  assert(&MBB == &MF.front() && "Shrink-wrapping not yet implemented");
   MachineFrameInfo *MFI    = MF.getFrameInfo();
   RISCVFunctionInfo *RISCVFI = MF.getInfo<RISCVFunctionInfo>();
   const RISCVRegisterInfo *RegInfo =
@@ -102,22 +192,36 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF, MachineBasicBlock &MB
   MachineModuleInfo &MMI = MF.getMMI();
   const MCRegisterInfo *MRI = MMI.getContext().getRegisterInfo();
   MachineLocation DstML, SrcML;
+  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
 
-  // Adjust stack.
-  TII.adjustStackPtr(SP, -StackSize, MBB, MBBI);
+  // The save routine, called first, allocates the top of the frame.
+  unsigned LibCallFrameSize =
+    getLibCallFrameSize(MF, getLibCallID(MF, CSI));
+  if (LibCallFrameSize) {
+    ++MBBI;
 
-  // emit ".cfi_def_cfa_offset StackSize"
-  unsigned CFIIndex = MMI.addFrameInst(
-      MCCFIInstruction::createDefCfaOffset(nullptr, -StackSize));
-  BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
-      .addCFIIndex(CFIIndex);
+    // emit ".cfi_def_cfa_offset LibCallFrameSize"
+    unsigned CFIIndex = MMI.addFrameInst(
+        MCCFIInstruction::createDefCfaOffset(nullptr, -LibCallFrameSize));
+    BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+  }
 
-  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
+  if (StackSize > LibCallFrameSize) {
+    // Adjust stack.
+    TII.adjustStackPtr(SP, -(StackSize - LibCallFrameSize), MBB, MBBI);
+
+    // emit ".cfi_def_cfa_offset StackSize"
+    unsigned CFIIndex = MMI.addFrameInst(
+        MCCFIInstruction::createDefCfaOffset(nullptr, -StackSize));
+    BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+  }
 
   if (CSI.size()) {
     // Find the instruction past the last instruction that saves a callee-saved
     // register to the stack.
-    for (unsigned i = 0; i < CSI.size(); ++i)
+    for (unsigned i = 0, e = getNumNonLibCallCSRs(MF, CSI); i < e; ++i)
       ++MBBI;
 
     // Iterate over list of callee-saved registers and emit .cfi_offset
@@ -174,15 +278,19 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF, MachineBasicBlock &MB
 
 void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
                                        MachineBasicBlock &MBB) const {
-  MachineBasicBlock::iterator MBBI = MBB.getLastNonDebugInstr();
+  // With shrink-wrapping the epilogue may go in a block that doesn't
+  // return, so insert it before the terminators rather than the return.
+  MachineBasicBlock::iterator MBBI = MBB.getFirstTerminator();
   MachineFrameInfo *MFI            = MF.getFrameInfo();
   RISCVFunctionInfo *RISCVFI = MF.getInfo<RISCVFunctionInfo>();
   const RISCVRegisterInfo *RegInfo =
     static_cast<const RISCVRegisterInfo*>(MF.getSubtarget().getRegisterInfo());
   const RISCVInstrInfo &TII =
     *static_cast<const RISCVInstrInfo*>(MF.getSubtarget().getInstrInfo());
-  DebugLoc dl = MBBI->getDebugLoc();
+  DebugLoc dl = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
   const RISCVSubtarget &STI = MF.getSubtarget<RISCVSubtarget>();
+  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
+  unsigned NumRestores = getNumNonLibCallCSRs(MF, CSI);
   unsigned SP   = STI.isRV64() ? RISCV::sp_64 : RISCV::sp;
   unsigned FP   = STI.isRV64() ? RISCV::fp_64 : RISCV::fp;
   unsigned ZERO = STI.isRV64() ? RISCV::zero_64 : RISCV::zero;
@@ -193,7 +301,7 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
     // Find the first instruction that restores a callee-saved register.
     MachineBasicBlock::iterator I = MBBI;
 
-    for (unsigned i = 0; i < MFI->getCalleeSavedInfo().size(); ++i)
+    for (unsigned i = 0; i < NumRestores; ++i)
       --I;
 
     // Insert instruction "move $sp, $fp" at this location.
@@ -205,7 +313,7 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
 
     // Find first instruction that restores a callee-saved register.
     MachineBasicBlock::iterator I = MBBI;
-    for (unsigned i = 0; i < MFI->getCalleeSavedInfo().size(); ++i)
+    for (unsigned i = 0; i < NumRestores; ++i)
       --I;
 
     // Insert instructions that restore eh data registers.
@@ -215,8 +323,10 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
     }
   }
 
-  // Get the number of bytes from FrameInfo
-  uint64_t StackSize = MFI->getStackSize();
+  // Get the number of bytes from FrameInfo.  The restore routine frees
+  // what the save routine allocated.
+  uint64_t StackSize = MFI->getStackSize() -
+    getLibCallFrameSize(MF, getLibCallID(MF, CSI));
 
   if (!StackSize)
     return;
@@ -231,8 +341,19 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
                           const std::vector<CalleeSavedInfo> &CSI,
                           const TargetRegisterInfo *TRI) const {
   MachineFunction *MF = MBB.getParent();
-  MachineBasicBlock &EntryBlock = *(MF->begin());
   const TargetInstrInfo &TII = *MF->getSubtarget().getInstrInfo();
+  const RISCVSubtarget &STI = MF->getSubtarget<RISCVSubtarget>();
+  DebugLoc DL = MI != MBB.end() ? MI->getDebugLoc() : DebugLoc();
+
+  // Call the save routine first; the prologue relies on finding it there.
+  int LibCallID = getLibCallID(*MF, CSI);
+  MachineInstrBuilder LibCall;
+  if (LibCallID >= 0)
+    LibCall = BuildMI(MBB, MI, DL, TII.get(STI.isRV64() ?
+                                           RISCV::SAVE_LIBCALL64 :
+                                           RISCV::SAVE_LIBCALL))
+      .addExternalSymbol(getSaveLibCallName(LibCallID))
+      .setMIFlag(MachineInstr::FrameSetup);
 
   for (unsigned i = 0, e = CSI.size(); i != e; ++i) {
     // Add the callee-saved register as live-in. Do not add if the register is
@@ -244,18 +365,113 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
     bool IsRAAndRetAddrIsTaken = (Reg == RISCV::ra || Reg == RISCV::ra_64)
         && MF->getFrameInfo()->isReturnAddressTaken();
     if (!IsRAAndRetAddrIsTaken)
-      EntryBlock.addLiveIn(Reg);
+      MBB.addLiveIn(Reg);
 
     // Insert the spill to the stack frame.
     bool IsKill = !IsRAAndRetAddrIsTaken;
+    if (LibCallID >= 0 && getLibCallSlot(Reg) >= 0) {
+      LibCall.addReg(Reg, getImplRegState(true) | getKillRegState(IsKill));
+      continue;
+    }
     const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
-    TII.storeRegToStackSlot(EntryBlock, MI, Reg, IsKill,
+    TII.storeRegToStackSlot(MBB, MI, Reg, IsKill,
                             CSI[i].getFrameIdx(), RC, TRI);
   }
 
   return true;
 }
 
+bool RISCVFrameLowering::
+restoreCalleeSavedRegisters(MachineBasicBlock &MBB,
+                            MachineBasicBlock::iterator MI,
+                            const std::vector<CalleeSavedInfo> &CSI,
+                            const TargetRegisterInfo *TRI) const {
+  MachineFunction *MF = MBB.getParent();
+  int LibCallID = getLibCallID(*MF, CSI);
+  if (LibCallID < 0)
+    return false;
+
+  const TargetInstrInfo &TII = *MF->getSubtarget().getInstrInfo();
+  const RISCVSubtarget &STI = MF->getSubtarget<RISCVSubtarget>();
+  DebugLoc DL = MI != MBB.end() ? MI->getDebugLoc() : DebugLoc();
+
+  for (const CalleeSavedInfo &I : CSI) {
+    if (getLibCallSlot(I.getReg()) >= 0)
+      continue;
+    const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(I.getReg());
+    TII.loadRegFromStackSlot(MBB, MI, I.getReg(), I.getFrameIdx(), RC, TRI);
+  }
+
+  // The restore routine returns for the function, so it replaces the
+  // return.  canUseAsEpilogue only lets us get here in a return block.
+  assert(MI != MBB.end() && MI->isReturn() && "Restore outside a return block");
+  MachineInstrBuilder LibCall =
+    BuildMI(MBB, MI, DL, TII.get(STI.isRV64() ? RISCV::RESTORE_LIBCALL64 :
+                                                RISCV::RESTORE_LIBCALL))
+      .addExternalSymbol(getRestoreLibCallName(LibCallID))
+      .setMIFlag(MachineInstr::FrameDestroy);
+  for (const CalleeSavedInfo &I : CSI)
+    if (getLibCallSlot(I.getReg()) >= 0)
+      LibCall.addReg(I.getReg(), RegState::ImplicitDefine);
+
+  // Keep the return value live into the restore routine.
+  for (const MachineOperand &MO : MI->implicit_operands())
+    if (MO.isReg() && MO.isUse())
+      LibCall.addReg(MO.getReg(), RegState::Implicit);
+  MBB.erase(MI);
+
+  return true;
+}
+
+bool RISCVFrameLowering::
+assignCalleeSavedSpillSlots(MachineFunction &MF, const TargetRegisterInfo *TRI,
+                            std::vector<CalleeSavedInfo> &CSI) const {
+  if (getLibCallID(MF, CSI) < 0)
+    return false;
+
+  // The save routine stores ra and the s registers at fixed offsets from
+  // the incoming stack pointer.  Everything else gets an ordinary slot.
+  MachineFrameInfo *MFI = MF.getFrameInfo();
+  int SlotSize = MF.getSubtarget<RISCVSubtarget>().isRV64() ? 8 : 4;
+  for (CalleeSavedInfo &I : CSI) {
+    const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(I.getReg());
+    int Slot = getLibCallSlot(I.getReg());
+    int FrameIdx;
+    if (Slot >= 0)
+      FrameIdx = MFI->CreateFixedSpillStackObject(SlotSize,
+                                                  -(Slot + 1) * SlotSize);
+    else
+      FrameIdx = MFI->CreateStackObject(RC->getSize(),
+                                        std::min(RC->getAlignment(),
+                                                 getStackAlignment()),
+                                        true);
+    I.setFrameIdx(FrameIdx);
+  }
+
+  // Keep the frame a multiple of the stack alignment, so that it covers
+  // all of the area the save routine allocates.
+  MFI->ensureMaxAlignment(getStackAlignment());
+  return true;
+}
+
+bool RISCVFrameLowering::canUseAsPrologue(const MachineBasicBlock &MBB) const {
+  const MachineFunction &MF = *MBB.getParent();
+  if (!useSaveRestoreLibCalls(MF))
+    return true;
+
+  // The save routine returns through t0.
+  unsigned T0 = MF.getSubtarget<RISCVSubtarget>().isRV64() ? RISCV::t0_64 :
+                                                              RISCV::t0;
+  return !MBB.isLiveIn(T0);
+}
+
+bool RISCVFrameLowering::canUseAsEpilogue(const MachineBasicBlock &MBB) const {
+  // The restore routine returns for the function.
+  if (!useSaveRestoreLibCalls(*MBB.getParent()))
+    return true;
+  return MBB.isReturnBlock();
+}
+
 bool
 RISCVFrameLowering::hasReservedCallFrame(const MachineFunction &MF) const {
   const MachineFrameInfo *MFI = MF.getFrameInfo();
@@ -0,0 +1,138 @@
+//===-- RISCVHazardRecognizer.cpp - RISCV Hazard Recognizer ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVHazardRecognizer.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVVectorInstrBuilder.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/ScheduleDAG.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-hazard"
+
+static cl::opt<unsigned>
+XvecHazardDistance("riscv-xvec-hazard-distance", cl::init(3), cl::Hidden,
+                   cl::desc("Issue slots between an Xvec operation and "
+                            "scalar accesses to the vector bank"));
+
+RISCVXvecHazardRecognizer::RISCVXvecHazardRecognizer(
+    const TargetRegisterInfo *TRI)
+    : TRI(TRI), Distance(getHazardDistance()) {
+  MaxLookAhead = Distance;
+  Reset();
+}
+
+bool RISCVXvecHazardRecognizer::isVectorOp(const MachineInstr *MI) {
+  switch (MI->getOpcode()) {
+  case RISCV::ADDV:
+  case RISCV::SUBV:
+  case RISCV::SLLV:
+  case RISCV::SLTV:
+  case RISCV::SLTUV:
+  case RISCV::XORV:
+  case RISCV::SRLV:
+  case RISCV::SRAV:
+  case RISCV::ORV:
+  case RISCV::ANDV:
+  case RISCV::ADDIV:
+  case RISCV::XORIV:
+  case RISCV::ORIV:
+  case RISCV::ANDIV:
+  case RISCV::SLLIV:
+  case RISCV::SRLIV:
+  case RISCV::SRAIV:
+  case RISCV::SLTIV:
+  case RISCV::SLTIUV:
+    return true;
+  default:
+    return false;
+  }
+}
+
+unsigned RISCVXvecHazardRecognizer::getHazardDistance() {
+  return XvecHazardDistance;
+}
+
+// Only explicit operands count: the vector operations that read or write bank
+// 1 carry it as implicit operands to keep scalar code from being scheduled
+// across them.
+bool RISCVXvecHazardRecognizer::accessesBank(const MachineInstr *MI) const {
+  for (const MachineOperand &MO : MI->explicit_operands()) {
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    unsigned Reg = MO.getReg();
+    if (!RISCV::GR32BitRegClass.contains(Reg) &&
+        !RISCV::GR64BitRegClass.contains(Reg))
+      continue;
+    unsigned Encoding = TRI->getEncodingValue(Reg);
+    if (Encoding >= 1 && Encoding <= XVEC_AVAIL_REGS)
+      return true;
+  }
+  return false;
+}
+
+unsigned RISCVXvecHazardRecognizer::PreEmitNoops(MachineInstr *MI) {
+  if (isVectorOp(MI))
+    return Distance - std::min(SinceVector, SinceBankAccess);
+  if (accessesBank(MI))
+    return Distance - SinceVector;
+  return 0;
+}
+
+unsigned RISCVXvecHazardRecognizer::PreEmitNoops(SUnit *SU) {
+  return PreEmitNoops(SU->getInstr());
+}
+
+ScheduleHazardRecognizer::HazardType
+RISCVXvecHazardRecognizer::getHazardType(SUnit *SU, int Stalls) {
+  return PreEmitNoops(SU) ? NoopHazard : NoHazard;
+}
+
+void RISCVXvecHazardRecognizer::Reset() {
+  // Nothing is known about the code above, so assume it just touched the
+  // bank. Vector operations are never left in flight across a block boundary;
+  // see getTrailingNoops(). The post-RA scheduler also resets at the start of
+  // each of its regions, where this may not hold, but RISCVXvecPadding pads
+  // the final order again.
+  SinceVector = Distance;
+  SinceBankAccess = 0;
+  IssuedThisCycle = false;
+}
+
+void RISCVXvecHazardRecognizer::EmitInstruction(MachineInstr *MI) {
+  if (isVectorOp(MI))
+    SinceVector = 0;
+  else if (accessesBank(MI))
+    SinceBankAccess = 0;
+  IssuedThisCycle = true;
+}
+
+void RISCVXvecHazardRecognizer::EmitInstruction(SUnit *SU) {
+  EmitInstruction(SU->getInstr());
+}
+
+void RISCVXvecHazardRecognizer::AdvanceCycle() {
+  if (IssuedThisCycle) {
+    SinceVector = std::min(SinceVector + 1, Distance);
+    SinceBankAccess = std::min(SinceBankAccess + 1, Distance);
+  }
+  IssuedThisCycle = false;
+}
+
+void RISCVXvecHazardRecognizer::EmitNoop() {
+  IssuedThisCycle = true;
+  AdvanceCycle();
+}
+
+unsigned RISCVXvecHazardRecognizer::getTrailingNoops() const {
+  return Distance - SinceVector;
+}
@@ -0,0 +1,70 @@
+//===-- RISCVHazardRecognizer.h - RISCV Hazard Recognizer -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the hazard recognizer for the Xvec vector unit.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_RISCVHAZARDRECOGNIZER_H
+#define LLVM_LIB_TARGET_RISCV_RISCVHAZARDRECOGNIZER_H
+
+#include "llvm/CodeGen/ScheduleHazardRecognizer.h"
+
+namespace llvm {
+
+class MachineInstr;
+class TargetRegisterInfo;
+
+// The Xvec unit reads and writes the x1-x28 bank without interlocks. A vector
+// operation must not issue until the pipeline has drained every scalar access
+// to the bank, and no scalar access to the bank may issue until the vector
+// operation has written back. Both distances are counted in issue slots; any
+// instruction that leaves the bank alone can fill them, which the post-RA
+// scheduler does. Cycles in which nothing issues do not count, since the
+// pipeline stalls as a whole.
+class RISCVXvecHazardRecognizer : public ScheduleHazardRecognizer {
+  const TargetRegisterInfo *TRI;
+  unsigned Distance;
+
+  // Issue slots since the last vector operation and since the last scalar
+  // instruction that accessed the bank. Both saturate at Distance.
+  unsigned SinceVector;
+  unsigned SinceBankAccess;
+  bool IssuedThisCycle;
+
+  bool accessesBank(const MachineInstr *MI) const;
+
+public:
+  RISCVXvecHazardRecognizer(const TargetRegisterInfo *TRI);
+
+  // Return true if MI is one of the Xvec vector operations.
+  static bool isVectorOp(const MachineInstr *MI);
+
+  // Return the number of issue slots required between the vector unit and
+  // scalar accesses to its bank.
+  static unsigned getHazardDistance();
+
+  HazardType getHazardType(SUnit *SU, int Stalls) override;
+  void Reset() override;
+  void EmitInstruction(SUnit *SU) override;
+  void EmitInstruction(MachineInstr *MI) override;
+  unsigned PreEmitNoops(SUnit *SU) override;
+  unsigned PreEmitNoops(MachineInstr *MI) override;
+  bool atIssueLimit() const override { return IssuedThisCycle; }
+  void AdvanceCycle() override;
+  void EmitNoop() override;
+
+  // Return the number of no-ops needed after the last instruction so that
+  // whatever follows may access the bank.
+  unsigned getTrailingNoops() const;
+};
+
+} // end namespace llvm
+
+#endif
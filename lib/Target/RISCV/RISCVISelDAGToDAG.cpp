@@ -99,6 +99,26 @@ class RISCVDAGToDAGISel : public SelectionDAGISel {
       return true;
     }
 
+    // Small data is a %gprel offset from gp, which fits in the offset
+    // field of the access itself.
+    if (Addr.getOpcode() == RISCVISD::GPRel ||
+        (CurDAG->isBaseWithConstantOffset(Addr) &&
+         Addr.getOperand(0).getOpcode() == RISCVISD::GPRel)) {
+      int64_t Disp = 0;
+      if (Addr.getOpcode() != RISCVISD::GPRel) {
+        Disp = cast<ConstantSDNode>(Addr.getOperand(1))->getSExtValue();
+        Addr = Addr.getOperand(0);
+      }
+      GlobalAddressSDNode *GA =
+        cast<GlobalAddressSDNode>(Addr.getOperand(0));
+      Base = CurDAG->getRegister(ValTy == MVT::i64 ? RISCV::gp_64 : RISCV::gp,
+                                 ValTy);
+      Offset = CurDAG->getTargetGlobalAddress(GA->getGlobal(), SDLoc(Addr),
+                                              ValTy, GA->getOffset() + Disp,
+                                              GA->getTargetFlags());
+      return true;
+    }
+
     if (TM.getRelocationModel() != Reloc::PIC_) {
       if ((Addr.getOpcode() == ISD::TargetExternalSymbol ||
           Addr.getOpcode() == ISD::TargetGlobalAddress))
@@ -191,16 +211,6 @@ class RISCVDAGToDAGISel : public SelectionDAGISel {
     return false;
   }
 
-  // If Op0 is null, then Node is a constant that can be loaded using:
-  //
-  //   (Opcode UpperVal LowerVal)
-  //
-  // If Op0 is nonnull, then Node can be implemented using:
-  //
-  //   (Opcode (Opcode Op0 UpperVal) LowerVal)
-  void splitLargeImmediate(unsigned Opcode, SDNode *Node, SDValue Op0,
-                              uint64_t UpperVal, uint64_t LowerVal);
-
 public:
   RISCVDAGToDAGISel(RISCVTargetMachine &TM, CodeGenOpt::Level OptLevel)
     : SelectionDAGISel(TM, OptLevel),
@@ -362,43 +372,6 @@ void RISCVDAGToDAGISel::getAddressOperands(const RISCVAddressingMode &AM,
   Offset = CurDAG->getTargetConstant(AM.Offset, SDLoc(Base), VT);
 }
 
-
-void RISCVDAGToDAGISel::splitLargeImmediate(unsigned Opcode, SDNode *Node,
-                                                 SDValue Op0, uint64_t UpperVal,
-                                                 uint64_t LowerVal) {
-  EVT VT = Node->getValueType(0);
-  SDLoc DL(Node);
-  SDValue Upper = CurDAG->getConstant(UpperVal, DL, VT);
-  if (Op0.getNode())
-    Upper = CurDAG->getNode(Opcode, DL, VT, Op0, Upper);
-
-  {
-    // When we haven't passed in Op0, Upper will be a constant. In order to
-    // prevent folding back to the large immediate in `Or = getNode(...)` we run
-    // SelectCode first and end up with an opaque machine node. This means that
-    // we need to use a handle to keep track of Upper in case it gets CSE'd by
-    // SelectCode.
-    //
-    // Note that in the case where Op0 is passed in we could just call
-    // SelectCode(Upper) later, along with the SelectCode(Or), and avoid needing
-    // the handle at all, but it's fine to do it here.
-    //
-    // TODO: This is a pretty hacky way to do this. Can we do something that
-    // doesn't require a two paragraph explanation?
-    HandleSDNode Handle(Upper);
-    SelectCode(Upper.getNode());
-    Upper = Handle.getValue();
-  }
-
-  SDValue Lower = CurDAG->getConstant(LowerVal, DL, VT);
-  SDValue Or = CurDAG->getNode(Opcode, DL, VT, Upper, Lower);
-
-  ReplaceUses(Node, Or.getNode());
-  CurDAG->RemoveDeadNode(Node);
-
-  SelectCode(Or.getNode());
-}
-
 void RISCVDAGToDAGISel::Select(SDNode *Node) {
   SDLoc DL(Node);
   // Dump information about the Node being selected
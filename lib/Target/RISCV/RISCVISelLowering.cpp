@@ -19,16 +19,31 @@
 #include "RISCVMachineFunctionInfo.h"
 #include "RISCVSubtarget.h"
 #include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+STATISTIC(NumTailCalls, "Number of tail calls");
+STATISTIC(NumBranchlessSelects, "Number of selects lowered to masks");
+
+static cl::opt<bool>
+EnableTailCalls("riscv-tail-calls", cl::init(true), cl::Hidden,
+                cl::desc("Turn calls in tail position into tail calls"));
+
+static cl::opt<bool>
+EnableBranchlessSelect("riscv-branchless-select", cl::init(true), cl::Hidden,
+                       cl::desc("Lower integer selects with cheap operands "
+                                "to mask arithmetic instead of branches"));
+
 static const MCPhysReg RV32IntRegs[8] = {
   RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3,
   RISCV::a4, RISCV::a5, RISCV::a6, RISCV::a7
@@ -49,11 +64,6 @@ static const MCPhysReg FPDRegs[8] = {
   RISCV::fa4_64, RISCV::fa5_64, RISCV::fa6_64, RISCV::fa7_64
 };
 
-void RISCVTargetObjectFile::Initialize(MCContext &Ctx, const TargetMachine &TM) {
-  TargetLoweringObjectFileELF::Initialize(Ctx, TM);
-  InitializeELF(TM.Options.UseInitArray);
-}
-
 RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm, 
                                          const RISCVSubtarget &STI)
     : TargetLowering(tm), Subtarget(STI), IsRV32(Subtarget.isRV32()) {
@@ -123,6 +133,12 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
   //make BRCOND legal, its actually only legal for a subset of conds
   setOperationAction(ISD::BRCOND, MVT::Other, Legal);
 
+  // Integer selects whose operands are cheap become mask arithmetic; the
+  // rest keep the SELECT_CC pseudo and its branch diamond.
+  setOperationAction(ISD::SELECT, MVT::i32, Custom);
+  if (Subtarget.isRV64())
+    setOperationAction(ISD::SELECT, MVT::i64, Custom);
+
   //Custom Lower Overflow operators
 
   // Handle integer types.
@@ -168,10 +184,10 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
       setOperationAction(ISD::ROTL, VT, Expand);
       setOperationAction(ISD::ROTR, VT, Expand);
 
-      // Expand ATOMIC_LOAD and ATOMIC_STORE using ATOMIC_CMP_SWAP.
-      // FIXME: probably much too conservative.
-      setOperationAction(ISD::ATOMIC_LOAD,  VT, Expand);
-      setOperationAction(ISD::ATOMIC_STORE, VT, Expand);
+      // Naturally aligned loads and stores are single-copy atomic.  Any
+      // ordering they need comes from the fences around them.
+      setOperationAction(ISD::ATOMIC_LOAD,  VT, Legal);
+      setOperationAction(ISD::ATOMIC_STORE, VT, Legal);
 
       // No special instructions for these.
       setOperationAction(ISD::CTPOP,           VT, Expand);
@@ -208,13 +224,14 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
       setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i64, Legal);
       setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i64, Legal);
       setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i64, Legal);
-      //These are not native instructions
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i64, Expand);
+      //sub is an amoadd of the negated value, cmpxchg and nand are LR/SC
+      //loops
+      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Legal);
+      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i64, Legal);
+      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Legal);
+      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i64, Legal);
+      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Legal);
+      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i64, Legal);
     } else {
       //Legal in RV32A
       setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Legal);
@@ -236,14 +253,20 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
       setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i64, Expand);
       setOperationAction(ISD::ATOMIC_LOAD_UMIN, MVT::i64, Expand);
       setOperationAction(ISD::ATOMIC_LOAD_UMAX, MVT::i64, Expand);
-      //These are not native instructions
-      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Expand);
+      //sub is an amoadd of the negated value, cmpxchg and nand are LR/SC
+      //loops
+      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Legal);
+      setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Legal);
+      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Legal);
       setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i64, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Expand);
-      setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Expand);
       setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i64, Expand);
       setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i64, Expand);
     }
+    // AtomicExpandPass turns wider atomics into __atomic_* calls, and
+    // widens narrower read-modify-writes into cmpxchg loops on the
+    // containing word.
+    setMaxAtomicSizeInBitsSupported(Subtarget.isRV64() ? 64 : 32);
+    setMinCmpXchgSizeInBits(32);
   } else {
     //No atomic ops so expand all
     setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Expand);
@@ -286,7 +309,9 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i1, Expand);
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i8, Expand);
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i16, Expand);
-  setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i32, Expand);
+  // sext.w does this on RV64.
+  setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i32,
+                     Subtarget.isRV64() ? Legal : Expand);
 
   // Handle the various types of symbolic address.
   setOperationAction(ISD::ConstantPool,     PtrVT, Custom);
@@ -688,6 +713,15 @@ addLiveIn(MachineFunction &MF, unsigned PReg, const TargetRegisterClass *RC)
 // Value is a value that has been passed to us in the location described by VA
 // (and so has type VA.getLocVT()).  Convert Value to VA.getValVT(), chaining
 // any loads onto Chain.
+// Return true if VA is an integer of 32 bits or less that is any-extended
+// into a 64-bit register.  The RV64 calling convention sign-extends 32-bit
+// values whatever their signedness, and so do we, since GR32 values are
+// always held sign-extended.
+static bool isSExtInLoc(const CCValAssign &VA) {
+  return VA.getLocInfo() == CCValAssign::AExt && VA.getLocVT() == MVT::i64 &&
+         VA.getValVT().isInteger() && VA.getValVT().getSizeInBits() <= 32;
+}
+
 static SDValue convertLocVTToValVT(SelectionDAG &DAG, SDLoc DL, CCValAssign &VA,
                                    SDValue Chain, SDValue Value) {
   // If the argument has been promoted from a smaller type, insert an
@@ -698,6 +732,9 @@ static SDValue convertLocVTToValVT(SelectionDAG &DAG, SDLoc DL, CCValAssign &VA,
   else if (VA.getLocInfo() == CCValAssign::ZExt)
     Value = DAG.getNode(ISD::AssertZext, DL, VA.getLocVT(), Value,
                         DAG.getValueType(VA.getValVT()));
+  else if (isSExtInLoc(VA))
+    Value = DAG.getNode(ISD::AssertSext, DL, VA.getLocVT(), Value,
+                        DAG.getValueType(MVT::i32));
 
   if (VA.isExtInLoc())
     Value = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), Value);
@@ -720,6 +757,11 @@ static SDValue convertValVTToLocVT(SelectionDAG &DAG, SDLoc DL, CCValAssign &VA,
   case CCValAssign::ZExt:
     return DAG.getNode(ISD::ZERO_EXTEND, DL, VA.getLocVT(), Value);
   case CCValAssign::AExt:
+    if (isSExtInLoc(VA)) {
+      if (Value.getValueType() != MVT::i32)
+        Value = DAG.getNode(ISD::ANY_EXTEND, DL, MVT::i32, Value);
+      return DAG.getNode(ISD::SIGN_EXTEND, DL, VA.getLocVT(), Value);
+    }
     return DAG.getNode(ISD::ANY_EXTEND, DL, VA.getLocVT(), Value);
   case CCValAssign::BCvt:
     return DAG.getNode(ISD::BITCAST, DL, VA.getLocVT(), Value);
@@ -800,13 +842,18 @@ LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv, bool IsVarArg,
       // truncate to the right size.
       if (VA.getLocInfo() != CCValAssign::Full) {
         unsigned Opcode = 0;
+        EVT AssertVT = VA.getValVT();
         if (VA.getLocInfo() == CCValAssign::SExt)
           Opcode = ISD::AssertSext;
         else if (VA.getLocInfo() == CCValAssign::ZExt)
           Opcode = ISD::AssertZext;
+        else if (isSExtInLoc(VA)) {
+          Opcode = ISD::AssertSext;
+          AssertVT = MVT::i32;
+        }
         if (Opcode)
           ArgValue = DAG.getNode(Opcode, DL, RegVT, ArgValue,
-                                 DAG.getValueType(VA.getValVT()));
+                                 DAG.getValueType(AssertVT));
         ArgValue = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), ArgValue);
       }
 
@@ -832,6 +879,13 @@ LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv, bool IsVarArg,
 
   //TODO: handle ByVal
 
+  // Record the size of the incoming argument area, which bounds the stack
+  // arguments of our tail calls.
+  bool HasByval = false;
+  for (const ISD::InputArg &In : Ins)
+    HasByval |= In.Flags.isByVal();
+  RISCVFI->setFormalArgInfo(CCInfo.getNextStackOffset(), HasByval);
+
   if (IsVarArg){
     auto ArgRegs = IsRV32 ? RV32IntRegs : RV64IntRegs;
     unsigned NumRegs = llvm::RISCV::NumArgGPRs;
@@ -909,12 +963,81 @@ SDValue RISCVTargetLowering::getAddrNonPIC(SDValue Op, SelectionDAG &DAG) const
   return DAG.getNode(ISD::ADD, DL, Ty, ResHi, ResLo);
 }
 
+SDValue RISCVTargetLowering::getAddrGPRel(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT Ty = getPointerTy(DAG.getDataLayout());
+  SDValue GPRel = getTargetNode(Op, DAG, RISCVII::MO_GPREL);
+  return DAG.getNode(RISCVISD::GPRel, DL, Ty, GPRel);
+}
+
 SDValue RISCVTargetLowering::getAddrPIC(SDValue Op, SelectionDAG &DAG) const {
   SDLoc DL(Op);
   EVT Ty = Op.getValueType();
   return DAG.getNode(RISCVISD::PCREL_WRAPPER, DL, Ty, Op);
 }
 
+bool RISCVTargetLowering::isEligibleForTailCallOptimization(
+    const CCState &CCInfo, const CallLoweringInfo &CLI,
+    const SmallVectorImpl<CCValAssign> &ArgLocs) const {
+  MachineFunction &MF = CLI.DAG.getMachineFunction();
+  const RISCVFunctionInfo *RISCVFI = MF.getInfo<RISCVFunctionInfo>();
+  const Function *Caller = MF.getFunction();
+
+  if (!EnableTailCalls)
+    return false;
+
+  // __riscv_restore_N returns for the function, so it can't be followed by
+  // a jump to the callee.
+  if (Subtarget.enableSaveRestore())
+    return false;
+
+  // Byval arguments would have to be copied into our own argument area,
+  // which may be where they come from.
+  if (RISCVFI->hasByvalArg() || CCInfo.getInRegsParamsCount() > 0)
+    return false;
+  for (const ISD::OutputArg &Out : CLI.Outs)
+    if (Out.Flags.isByVal())
+      return false;
+
+  // The callee would write the result through a pointer of its own rather
+  // than ours.
+  if (Caller->hasStructRetAttr() ||
+      (!CLI.Outs.empty() && CLI.Outs[0].Flags.isSRet()))
+    return false;
+
+  // The callee must preserve every register that our caller expects us to.
+  CallingConv::ID CallerCC = Caller->getCallingConv();
+  if (CLI.CallConv != CallerCC) {
+    const TargetRegisterInfo *TRI = Subtarget.getRegisterInfo();
+    if (!TRI->regmaskSubsetEqual(TRI->getCallPreservedMask(MF, CallerCC),
+                                 TRI->getCallPreservedMask(MF, CLI.CallConv)))
+      return false;
+  }
+
+  // Stack arguments are written over our own incoming arguments, since the
+  // caller pops the area it allocated.  They must fit in it.
+  for (const CCValAssign &VA : ArgLocs)
+    if (VA.getLocInfo() == CCValAssign::Indirect)
+      return false;
+  return CCInfo.getNextStackOffset() <= RISCVFI->getIncomingArgSize();
+}
+
+// Return Chain, ordered after every load of an incoming stack argument in
+// the current block.  The stack arguments of a tail call overwrite them.
+static SDValue getChainAfterIncomingArgLoads(SelectionDAG &DAG,
+                                             SDValue Chain) {
+  SmallVector<SDValue, 8> ArgChains;
+  ArgChains.push_back(Chain);
+  SDNode *Entry = DAG.getEntryNode().getNode();
+  for (SDNode::use_iterator U = Entry->use_begin(), UE = Entry->use_end();
+       U != UE; ++U)
+    if (LoadSDNode *L = dyn_cast<LoadSDNode>(*U))
+      if (FrameIndexSDNode *FI = dyn_cast<FrameIndexSDNode>(L->getBasePtr()))
+        if (FI->getIndex() < 0)
+          ArgChains.push_back(SDValue(L, 1));
+  return DAG.getNode(ISD::TokenFactor, SDLoc(Chain), MVT::Other, ArgChains);
+}
+
 SDValue
 RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
                                  SmallVectorImpl<SDValue> &InVals) const {
@@ -931,9 +1054,6 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   MachineFunction &MF = DAG.getMachineFunction();
   EVT PtrVT = getPointerTy(DAG.getDataLayout());
 
-  // RISCV target does not yet support tail call optimization.
-  isTailCall = false;
-
   // Analyze the operands of the call, assigning locations to each operand.
   SmallVector<CCValAssign, 16> ArgLocs;
   CCState CCInfo(CallConv, IsVarArg, MF, ArgLocs, *DAG.getContext());
@@ -945,9 +1065,24 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   // Get a count of how many bytes are to be pushed on the stack.
   unsigned NumBytes = CCInfo.getNextStackOffset();
 
-  // Mark the start of the call.
-  Chain = DAG.getCALLSEQ_START(Chain, DAG.getConstant(NumBytes, DL, PtrVT, true),
-                               DL);
+  // The generic code only asks for tail calls in tail position.
+  if (isTailCall) {
+    isTailCall = isEligibleForTailCallOptimization(CCInfo, CLI, ArgLocs);
+    if (!isTailCall && CLI.CS && CLI.CS->isMustTailCall())
+      report_fatal_error("failed to perform tail call elimination on a call "
+                         "site marked musttail");
+    if (isTailCall)
+      ++NumTailCalls;
+  }
+
+  // Mark the start of the call.  A tail call reuses our own argument area
+  // rather than allocating one.
+  if (!isTailCall)
+    Chain = DAG.getCALLSEQ_START(Chain,
+                                 DAG.getConstant(NumBytes, DL, PtrVT, true),
+                                 DL);
+  else if (NumBytes)
+    Chain = getChainAfterIncomingArgLoads(DAG, Chain);
 
   // Copy argument values to their designated locations.
   std::deque< std::pair<unsigned, SDValue> > RegsToPass;
@@ -997,6 +1132,19 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
       // TODO: Handle byvals partially or entirely not in registers
 
     }
+    else if (isTailCall) {
+      assert(VA.isMemLoc() && "Argument not register or memory");
+
+      // Store into the slot of our own incoming arguments that the callee
+      // will find at the same offset.
+      MachineFrameInfo *MFI = MF.getFrameInfo();
+      int FI = MFI->CreateFixedObject(ArgValue.getValueSizeInBits() / 8,
+                                      VA.getLocMemOffset(), false);
+      SDValue FIN = DAG.getFrameIndex(FI, PtrVT);
+      MemOpChains.push_back(DAG.getStore(
+          Chain, DL, ArgValue, FIN,
+          MachinePointerInfo::getFixedStack(MF, FI), false, false, 0));
+    }
     else {
       assert(VA.isMemLoc() && "Argument not register or memory");
 
@@ -1034,6 +1182,14 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
       Callee = getAddrPIC(DAG.getTargetExternalSymbol(E->getSymbol(), PtrVT), DAG);
     } else
       Callee = DAG.getTargetExternalSymbol(E->getSymbol(), PtrVT);
+  } else if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee)) {
+    // A call pair relaxed by the linker is cheaper than building the
+    // address with lui/addi and calling through a register.  A direct
+    // tail call is always such a pair.
+    if ((Subtarget.enableLinkerRelax() || isTailCall) &&
+        DAG.getTarget().getRelocationModel() != Reloc::PIC_)
+      Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL, PtrVT,
+                                          G->getOffset());
   }
 
   // The first call operand is the chain and the second is the target address.
@@ -1047,10 +1203,22 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
     Ops.push_back(DAG.getRegister(RegsToPass[I].first,
                                   RegsToPass[I].second.getValueType()));
 
+  // The callee may clobber every register that its calling convention
+  // doesn't preserve, temporaries included.
+  const TargetRegisterInfo *TRI = Subtarget.getRegisterInfo();
+  const uint32_t *Mask = TRI->getCallPreservedMask(MF, CallConv);
+  assert(Mask && "Missing call preserved mask for calling convention");
+  Ops.push_back(DAG.getRegisterMask(Mask));
+
   // Glue the call to the argument copies, if any.
   if (Glue.getNode())
     Ops.push_back(Glue);
 
+  // The callee returns straight to our caller, so there is nothing to
+  // copy out.
+  if (isTailCall)
+    return DAG.getNode(RISCVISD::TAIL, DL, MVT::Other, Ops);
+
   SDVTList NodeTys = DAG.getVTList(MVT::Other, MVT::Glue);
   Chain = DAG.getNode(RISCVISD::CALL, DL, NodeTys, Ops);
   Glue = Chain.getValue(1);
@@ -1090,6 +1258,57 @@ RISCVTargetLowering::LowerCall(CallLoweringInfo &CLI,
   return Chain;
 }
 
+FastISel *
+RISCVTargetLowering::createFastISel(FunctionLoweringInfo &FuncInfo,
+                                    const TargetLibraryInfo *LibInfo) const {
+  // The fast selector only knows the RV32 integer instructions.
+  if (Subtarget.isRV64())
+    return nullptr;
+  return RISCV::createFastISel(FuncInfo, LibInfo);
+}
+
+// The mapping is the one in the memory model appendix of the ISA manual: a
+// seq_cst load is preceded by fence rw,rw, an acquire load is followed by
+// fence r,rw and a release store is preceded by fence rw,w.
+Instruction *RISCVTargetLowering::emitLeadingFence(IRBuilder<> &Builder,
+                                                   AtomicOrdering Ord,
+                                                   bool IsStore,
+                                                   bool IsLoad) const {
+  if (IsLoad && Ord == AtomicOrdering::SequentiallyConsistent)
+    return Builder.CreateFence(Ord);
+  if (IsStore && isReleaseOrStronger(Ord))
+    return Builder.CreateFence(AtomicOrdering::Release);
+  return nullptr;
+}
+
+Instruction *RISCVTargetLowering::emitTrailingFence(IRBuilder<> &Builder,
+                                                    AtomicOrdering Ord,
+                                                    bool IsStore,
+                                                    bool IsLoad) const {
+  if (IsLoad && isAcquireOrStronger(Ord))
+    return Builder.CreateFence(AtomicOrdering::Acquire);
+  return nullptr;
+}
+
+TargetLowering::AtomicExpansionKind
+RISCVTargetLowering::shouldExpandAtomicRMWInIR(AtomicRMWInst *AI) const {
+  // There are only word and doubleword AMOs and LR/SCs, so narrower
+  // operations become a cmpxchg loop on the containing word.
+  unsigned Size = AI->getType()->getPrimitiveSizeInBits();
+  if (Subtarget.hasA() && Size < 32)
+    return AtomicExpansionKind::CmpXChg;
+  return AtomicExpansionKind::None;
+}
+
+bool RISCVTargetLowering::shouldExpandAtomicCmpXchgInIR(
+    AtomicCmpXchgInst *AI) const {
+  // The LR/SC loop is kept as a single pseudo until the asm printer, rather
+  // than being built in IR, because the A extension only guarantees forward
+  // progress when nothing else -- in particular no spill -- sits between the
+  // LR and the SC.
+  return false;
+}
+
 /// This hook should be implemented to check whether the return values
 /// described by the Outs array can fit into the return registers.  If false
 /// is returned, an sret-demotion is performed.
@@ -1167,6 +1386,89 @@ lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const
                      Op.getOperand(3));
 }
 
+// Return the number of instructions that are only there to compute V for a
+// select, or a number above Budget if that is more than Budget or V is not
+// worth computing on both sides at all.  Values that are needed elsewhere
+// anyway cost nothing extra, whereas a single-use load, multiplication or
+// division would otherwise be sunk into the branch arm and only executed when
+// it is selected.
+static unsigned getSelectOperandCost(SDValue V, unsigned Budget) {
+  if (!V.hasOneUse())
+    return 0;
+  if (isa<ConstantSDNode>(V))
+    return 0;
+  if (isa<MemSDNode>(V))
+    return Budget + 1;
+  switch (V.getOpcode()) {
+  case ISD::CopyFromReg:
+  case ISD::UNDEF:
+    return 0;
+  case ISD::MUL:
+  case ISD::MULHS:
+  case ISD::MULHU:
+  case ISD::SMUL_LOHI:
+  case ISD::UMUL_LOHI:
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+  case ISD::SDIVREM:
+  case ISD::UDIVREM:
+    return Budget + 1;
+  default:
+    break;
+  }
+
+  unsigned Cost = 1;
+  for (const SDValue &Op : V->op_values()) {
+    if (Cost > Budget)
+      break;
+    Cost += getSelectOperandCost(Op, Budget - Cost);
+  }
+  return Cost;
+}
+
+SDValue RISCVTargetLowering::lowerSELECT(SDValue Op, SelectionDAG &DAG) const {
+  SDValue Cond = Op.getOperand(0);
+  SDValue TrueV = Op.getOperand(1);
+  SDValue FalseV = Op.getOperand(2);
+  if (!EnableBranchlessSelect)
+    return Op;
+
+  // The mask computes both operands where a branch computes one of them, so
+  // the extra work must stay below what the branch costs: itself and, taken
+  // half of the time without a predictor worth the name, the mispredict
+  // penalty.  Selects with more expensive operands are left to the SELECT_CC
+  // pseudo, for MachineSinking to move the operands into the arms.
+  unsigned Budget = 2 + Subtarget.getSchedModel().MispredictPenalty / 2;
+  unsigned TrueCost = getSelectOperandCost(TrueV, Budget);
+  if (TrueCost > Budget ||
+      getSelectOperandCost(FalseV, Budget - TrueCost) > Budget - TrueCost)
+    return Op;
+
+  // Our cores barely predict branches, so a select whose operands are
+  // already available is cheaper as
+  //   mask = 0 - cond
+  //   res  = F ^ ((T ^ F) & mask)
+  // than as a branch around a move.  Booleans are zero or one, but make
+  // sure of it when the condition comes from somewhere other than a setcc.
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  EVT CondVT = Cond.getValueType();
+  unsigned CondBits = CondVT.getSizeInBits();
+  if (!DAG.MaskedValueIsZero(Cond, APInt::getHighBitsSet(CondBits,
+                                                         CondBits - 1)))
+    Cond = DAG.getNode(ISD::AND, DL, CondVT, Cond,
+                       DAG.getConstant(1, DL, CondVT));
+  Cond = DAG.getZExtOrTrunc(Cond, DL, VT);
+  SDValue Mask = DAG.getNode(ISD::SUB, DL, VT, DAG.getConstant(0, DL, VT),
+                             Cond);
+  SDValue Diff = DAG.getNode(ISD::XOR, DL, VT, TrueV, FalseV);
+  Diff = DAG.getNode(ISD::AND, DL, VT, Diff, Mask);
+  ++NumBranchlessSelects;
+  return DAG.getNode(ISD::XOR, DL, VT, FalseV, Diff);
+}
+
 SDValue RISCVTargetLowering::lowerRETURNADDR(SDValue Op, SelectionDAG &DAG) const {
   // check the depth
   //TODO: riscv-gcc can handle this, by navigating through the stack, we should be able to do this too
@@ -1189,6 +1491,14 @@ SDValue RISCVTargetLowering::lowerGlobalAddress(SDValue Op,
   Reloc::Model RM = DAG.getTarget().getRelocationModel();
 
   if(RM != Reloc::PIC_) {
+      //%gprel relocation for small data
+      const GlobalValue *GV = cast<GlobalAddressSDNode>(Op)->getGlobal();
+      const RISCVTargetObjectFile *TLOF =
+        static_cast<const RISCVTargetObjectFile *>(
+          getTargetMachine().getObjFileLowering());
+      if (TLOF->isGlobalInSmallSection(GV, getTargetMachine()))
+        return getAddrGPRel(Op, DAG);
+
       //%hi/%lo relocation
       return getAddrNonPIC(Op,DAG);
   }
@@ -1319,35 +1629,29 @@ SDValue RISCVTargetLowering::lowerVAARG(SDValue Op, SelectionDAG &DAG) const{
 
 SDValue RISCVTargetLowering::lowerATOMIC_FENCE(SDValue Op, SelectionDAG &DAG) const {
   SDLoc DL(Op);
-  
-  unsigned PI,PO,PR,PW,SI,SO,SR,SW;
+
+  // The predecessor and successor sets of the fence: I=8, O=4, R=2, W=1.
+  // C++ orderings only constrain ordinary memory, so the I/O bits stay
+  // clear.
+  const unsigned R = 1 << 1, W = 1 << 0;
+  unsigned pred, succ;
   AtomicOrdering Ord = static_cast<AtomicOrdering>(
       cast<ConstantSDNode>(Op.getOperand(1))->getZExtValue());
   switch(Ord) {
-    case AtomicOrdering::NotAtomic:
-    case AtomicOrdering::Unordered:
-    case AtomicOrdering::Monotonic:
     case AtomicOrdering::Acquire:
+      pred = R;
+      succ = R | W;
+      break;
     case AtomicOrdering::Release:
-    case AtomicOrdering::AcquireRelease:
-    case AtomicOrdering::SequentiallyConsistent:
-      PI = 1 << 3;
-      PO = 1 << 2;
-      PR = 1 << 1;
-      PW = 1 << 0;
-  }
-
-  switch(Op.getConstantOperandVal(2)) {
-    case SingleThread:
-    case CrossThread:
-      SI = 1 << 3;
-      SO = 1 << 2;
-      SR = 1 << 1;
-      SW = 1 << 0;
+      pred = R | W;
+      succ = W;
+      break;
+    default:
+      pred = R | W;
+      succ = R | W;
+      break;
   }
 
-  unsigned pred = PI | PO | PR | PW;
-  unsigned succ = SI | SO | SR | SW;
   return DAG.getNode(RISCVISD::FENCE, DL, MVT::Other,Op.getOperand(0),
                        DAG.getConstant(pred, DL, Subtarget.isRV64() ? MVT::i64 : MVT::i32),
                        DAG.getConstant(succ, DL, Subtarget.isRV64() ? MVT::i64 : MVT::i32));
@@ -1391,6 +1695,8 @@ SDValue RISCVTargetLowering::LowerOperation(SDValue Op,
     return lowerRETURNADDR(Op, DAG);
   case ISD::SELECT_CC:
     return lowerSELECT_CC(Op, DAG);
+  case ISD::SELECT:
+    return lowerSELECT(Op, DAG);
   case ISD::GlobalAddress:
     return lowerGlobalAddress(Op, DAG);
   case ISD::GlobalTLSAddress:
@@ -1423,11 +1729,14 @@ const char *RISCVTargetLowering::getTargetNodeName(unsigned Opcode) const {
   switch (Opcode) {
     OPCODE(RET_FLAG);
     OPCODE(CALL);
+    OPCODE(TAIL);
     OPCODE(PCREL_WRAPPER);
     OPCODE(Hi);
     OPCODE(Lo);
+    OPCODE(GPRel);
     OPCODE(FENCE);
     OPCODE(SELECT_CC);
+    OPCODE(XVEC_MEMCPY);
   }
   return NULL;
 #undef OPCODE
@@ -1444,6 +1753,12 @@ emitCALL(MachineInstr &MI, MachineBasicBlock *BB) const {
   const TargetInstrInfo *TII = BB->getParent()->getSubtarget().getInstrInfo();
   DebugLoc DL = MI.getDebugLoc();
 
+  // With linker relaxation, direct calls stay as auipc/jalr pairs, which
+  // reach any address and which the linker shrinks to jal when it can.
+  if ((MI.getOpcode() == RISCV::CALL || MI.getOpcode() == RISCV::CALL64) &&
+      Subtarget.enableLinkerRelax())
+    return BB;
+
   unsigned jump;
   unsigned RA;
   switch(MI.getOpcode()) {
@@ -37,6 +37,10 @@ namespace RISCVISD {
     // There is an optional glue operand at the end.
     CALL,
 
+    // Tail-calls a function, with the same operands as CALL.  The caller's
+    // frame has been torn down by the time the callee is entered.
+    TAIL,
+
     // Jump and link to Operand 0 is the chain operand and operand 1
     // is the register to store the return address. Operand 2 is the target address
     JAL,
@@ -57,6 +61,10 @@ namespace RISCVISD {
     TprelHi,
     TprelLo,
 
+    // Wraps a TargetGlobalAddress in .sdata or .sbss, which is addressed
+    // relative to gp.  Operand 0 is the address.
+    GPRel,
+
     // Branches if a condition is true.  Operand 0 is the chain operand;
     // operand 1 is the 4-bit condition-code mask, with bit N in
     // big-endian order meaning "branch if CC=N"; operand 2 is the
@@ -71,6 +79,13 @@ namespace RISCVISD {
 
     FENCE,
 
+    // Copies a block of memory through the Xvec vector bank.  Operand 0 is
+    // the chain, operands 1 and 2 are the destination and source addresses
+    // and operands 3 and 4 are the size and alignment of the block, as
+    // target constants.  The node has no memory operand, so it must come
+    // before FIRST_TARGET_MEMORY_OPCODE.
+    XVEC_MEMCPY,
+
     // Wrappers around the inner loop of an 8- or 16-bit ATOMIC_SWAP or
     // ATOMIC_LOAD_<op>.
     //
@@ -97,6 +112,11 @@ namespace RISCVISD {
 
 class RISCVSubtarget;
 
+namespace RISCV {
+  FastISel *createFastISel(FunctionLoweringInfo &FuncInfo,
+                           const TargetLibraryInfo *LibInfo);
+} // end namespace RISCV
+
 class RISCVTargetLowering : public TargetLowering {
 public:
   explicit RISCVTargetLowering(const TargetMachine &TM, const RISCVSubtarget &STI);
@@ -149,6 +169,23 @@ public:
   SDValue LowerCall(CallLoweringInfo &CLI,
                     SmallVectorImpl<SDValue> &InVals) const override;
 
+  FastISel *createFastISel(FunctionLoweringInfo &FuncInfo,
+                           const TargetLibraryInfo *LibInfo) const override;
+
+  /// Atomic loads and stores are plain loads and stores bracketed by the
+  /// fences their ordering needs.  AMOs and LR/SC loops order themselves
+  /// through their aq and rl bits.
+  bool shouldInsertFencesForAtomic(const Instruction *I) const override {
+    return isa<LoadInst>(I) || isa<StoreInst>(I);
+  }
+  Instruction *emitLeadingFence(IRBuilder<> &Builder, AtomicOrdering Ord,
+                                bool IsStore, bool IsLoad) const override;
+  Instruction *emitTrailingFence(IRBuilder<> &Builder, AtomicOrdering Ord,
+                                 bool IsStore, bool IsLoad) const override;
+  AtomicExpansionKind
+  shouldExpandAtomicRMWInIR(AtomicRMWInst *AI) const override;
+  bool shouldExpandAtomicCmpXchgInIR(AtomicCmpXchgInst *AI) const override;
+
   virtual bool
     CanLowerReturn(CallingConv::ID CallConv, MachineFunction &MF,
                    bool isVarArg,
@@ -183,6 +220,7 @@ private:
 
   // Implement LowerOperation for individual opcodes.
   SDValue lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerSELECT(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerRETURNADDR(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerGlobalAddress(SDValue Op,
                              SelectionDAG &DAG) const;
@@ -207,8 +245,15 @@ private:
   // Helper functions for above
   SDValue getTargetNode(SDValue Op, SelectionDAG &DAG, unsigned Flag) const;
   SDValue getAddrNonPIC(SDValue Op, SelectionDAG &DAG) const;
+  SDValue getAddrGPRel(SDValue Op, SelectionDAG &DAG) const;
   SDValue getAddrPIC(SDValue Op, SelectionDAG &DAG) const;
 
+  // Return true if the call described by CLI, whose arguments CCInfo has
+  // assigned to ArgLocs, can be made as a tail call.
+  bool isEligibleForTailCallOptimization(
+      const CCState &CCInfo, const CallLoweringInfo &CLI,
+      const SmallVectorImpl<CCValAssign> &ArgLocs) const;
+
   // Implement EmitInstrWithCustomInserter for individual operation types.
   MachineBasicBlock *emitCALL(MachineInstr &MI,
                                 MachineBasicBlock *BB) const;
@@ -217,10 +262,6 @@ private:
 
 };
 
-class RISCVTargetObjectFile : public TargetLoweringObjectFileELF {
-  void Initialize(MCContext &Ctx, const TargetMachine &TM);
-};
-
 } // end namespace llvm
 
 #endif
@@ -12,8 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "RISCVInstrInfo.h"
+#include "MCTargetDesc/RISCVCompressInst.h"
+#include "MCTargetDesc/RISCVMatInt.h"
+#include "RISCVHazardRecognizer.h"
 #include "RISCVInstrBuilder.h"
 #include "RISCVTargetMachine.h"
+#include "RISCVVectorInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 
 #define GET_INSTRINFO_CTOR_DTOR
@@ -71,10 +75,105 @@ void RISCVInstrInfo::adjustStackPtr(unsigned SP, int64_t Amount,
   }
 }
 
+/// Insert an "addi zero, zero, 0" before MI.
+void RISCVInstrInfo::insertNoop(MachineBasicBlock &MBB,
+                                MachineBasicBlock::iterator MI) const {
+  DebugLoc DL;
+  if (STI.isRV64())
+    BuildMI(MBB, MI, DL, get(RISCV::ADDI64), RISCV::zero_64)
+      .addReg(RISCV::zero_64).addImm(0);
+  else
+    BuildMI(MBB, MI, DL, get(RISCV::ADDI), RISCV::zero)
+      .addReg(RISCV::zero).addImm(0);
+}
+
+// The stack pointer is also a lane of the Xvec bank, which the element loads
+// and the vector operations of an Xvec sequence write.  Only instructions
+// that adjust it are boundaries, so that the post-RA scheduler may fill the
+// hazard slots of the sequence with the scalar work around it.
+bool RISCVInstrInfo::isSchedulingBoundary(const MachineInstr &MI,
+                                          const MachineBasicBlock *MBB,
+                                          const MachineFunction &MF) const {
+  if (MI.isTerminator() || MI.isPosition())
+    return true;
+  if (RISCVXvecHazardRecognizer::isVectorOp(&MI))
+    return false;
+  unsigned SP = STI.isRV64() ? RISCV::sp_64 : RISCV::sp;
+  return MI.modifiesRegister(SP, &RI) && MI.readsRegister(SP, &RI);
+}
+
+ScheduleHazardRecognizer *RISCVInstrInfo::CreateTargetPostRAHazardRecognizer(
+    const InstrItineraryData *II, const ScheduleDAG *DAG) const {
+  return new RISCVXvecHazardRecognizer(&RI);
+}
+
 unsigned RISCVInstrInfo::GetInstSizeInBytes(MachineInstr *I) const {
-  //Since we don't have variable length instructions this just looks at the subtarget
-  //TODO:check for C
-  return (STI.isRV64() || STI.isRV32()) ? 4 : 4;
+  // The LI pseudos are as long as the sequence the asm printer expands
+  // them into.
+  unsigned Opcode = I->getOpcode();
+  if ((Opcode == RISCV::LI || Opcode == RISCV::LI64 ||
+       Opcode == RISCV::LI64_32) && I->getOperand(1).isImm()) {
+    int64_t Value = I->getOperand(1).getImm();
+    if (Opcode != RISCV::LI64)
+      Value = SignExtend64<32>(Value);
+    RISCVMatInt::InstSeq Seq;
+    RISCVMatInt::generateInstSeq(Value, STI.isRV64(), Seq);
+    if (!STI.hasC() || !STI.isRV32())
+      return 4 * Seq.size();
+
+    SmallVector<MCInst, 8> Insts;
+    RISCVMatInt::buildInstSeq(Seq, I->getOperand(0).getReg(), RISCV::zero,
+                              Insts);
+    unsigned Size = 0;
+    for (const MCInst &Inst : Insts) {
+      MCInst Compressed;
+      Size += RISCV::compressInst(Compressed, Inst) ? 2 : 4;
+    }
+    return Size;
+  }
+
+  // CALL and CALL64 only survive to here as auipc/jalr pairs, and direct
+  // tail calls and the save/restore libcalls are always emitted as such
+  // pairs.
+  switch (Opcode) {
+  case RISCV::CALL:
+  case RISCV::CALL64:
+  case RISCV::SAVE_LIBCALL:
+  case RISCV::SAVE_LIBCALL64:
+  case RISCV::RESTORE_LIBCALL:
+  case RISCV::RESTORE_LIBCALL64:
+  case RISCV::TCRETURN:
+  case RISCV::TCRETURN64:
+    return 8;
+  // The LR/SC loops are expanded by the asm printer and never compressed.
+  case RISCV::ATOMIC_CMP_SWAP_W:
+  case RISCV::ATOMIC_CMP_SWAP_W64:
+  case RISCV::ATOMIC_CMP_SWAP_D:
+    return 16;
+  case RISCV::ATOMIC_LOAD_NAND_W:
+  case RISCV::ATOMIC_LOAD_NAND_W64:
+  case RISCV::ATOMIC_LOAD_NAND_D:
+    return 20;
+  }
+
+  if (!STI.hasC() || !STI.isRV32())
+    return 4;
+
+  // Lower the register and immediate operands the way RISCVMCInstLower does
+  // and ask the compressor, which the asm printer will do for real.  Symbolic
+  // operands are never compressed.
+  MCInst Inst;
+  Inst.setOpcode(I->getOpcode());
+  for (const MachineOperand &MO : I->operands()) {
+    if (MO.isReg() && !MO.isImplicit())
+      Inst.addOperand(MCOperand::createReg(MO.getReg()));
+    else if (MO.isImm())
+      Inst.addOperand(MCOperand::createImm(MO.getImm()));
+    else if (!MO.isReg())
+      return 4;
+  }
+  MCInst Compressed;
+  return RISCV::compressInst(Compressed, Inst) ? 2 : 4;
 }
 
 bool RISCVInstrInfo::AnalyzeBranch(MachineBasicBlock &MBB,
@@ -458,6 +557,9 @@ RISCVInstrInfo::loadRegFromStackSlot(MachineBasicBlock &MBB,
 bool
 RISCVInstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   switch (MI.getOpcode()) {
+  case RISCV::XVEC_MEMCPY:
+    RISCVVectorInstrBuilder().expandBlockCopy(MI, &STI);
+    return true;
 
   default:
     return false;
@@ -505,6 +607,165 @@ ReverseBranchCondition(SmallVectorImpl<MachineOperand> &Cond) const {
   }
 }
 
+// Return true if Reg, virtual or physical, holds a 64-bit integer.
+static bool isGR64(const MachineRegisterInfo &MRI, unsigned Reg) {
+  if (TargetRegisterInfo::isVirtualRegister(Reg))
+    return RISCV::GR64BitRegClass.hasSubClassEq(MRI.getRegClass(Reg));
+  return RISCV::GR64BitRegClass.contains(Reg);
+}
+
+// Return true if Reg is known to hold 0 or 1.
+static bool isBooleanReg(const MachineRegisterInfo &MRI, unsigned Reg) {
+  if (!TargetRegisterInfo::isVirtualRegister(Reg))
+    return false;
+  const MachineInstr *MI = MRI.getVRegDef(Reg);
+  if (!MI)
+    return false;
+  switch (MI->getOpcode()) {
+  case RISCV::SLT:   case RISCV::SLTU:   case RISCV::SLTI:   case RISCV::SLTIU:
+  case RISCV::SLT64: case RISCV::SLTU64: case RISCV::SLTI64: case RISCV::SLTIU64:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// If Cond tests a boolean against zero, as the SELECT_CC pseudo does,
+// return the boolean, otherwise return 0.
+static unsigned getBooleanCond(const MachineRegisterInfo &MRI,
+                               ArrayRef<MachineOperand> Cond) {
+  unsigned CC = Cond[0].getImm() & ~RISCV::CCMASK_CMP_UO;
+  if (CC != RISCV::CCMASK_CMP_EQ && CC != RISCV::CCMASK_CMP_NE)
+    return 0;
+  unsigned LHS = Cond[2].getReg(), RHS = Cond[3].getReg();
+  if ((LHS == RISCV::zero || LHS == RISCV::zero_64) && isBooleanReg(MRI, RHS))
+    return RHS;
+  if ((RHS == RISCV::zero || RHS == RISCV::zero_64) && isBooleanReg(MRI, LHS))
+    return LHS;
+  return 0;
+}
+
+bool RISCVInstrInfo::canInsertSelect(const MachineBasicBlock &MBB,
+                                     ArrayRef<MachineOperand> Cond,
+                                     unsigned TrueReg, unsigned FalseReg,
+                                     int &CondCycles, int &TrueCycles,
+                                     int &FalseCycles) const {
+  // Only conditional branches on two registers, as AnalyzeBranch gives them.
+  if (Cond.size() != 4 || Cond[0].getImm() == RISCV::CCMASK_ANY ||
+      !Cond[2].isReg() || !Cond[3].isReg())
+    return false;
+
+  // The select is done with integer masks, so both values must be in
+  // integer registers of the same width.
+  const MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  const TargetRegisterClass *RC =
+    RI.getCommonSubClass(MRI.getRegClass(TrueReg), MRI.getRegClass(FalseReg));
+  if (!RC)
+    return false;
+  if (!RISCV::GR32BitRegClass.hasSubClassEq(RC) &&
+      !(STI.isRV64() && RISCV::GR64BitRegClass.hasSubClassEq(RC)))
+    return false;
+
+  // An slt/sltu, or an xor and an sltiu for equality, then the negation
+  // that turns the 0/1 result into a mask.  The values each go through an
+  // xor, an and and another xor.
+  unsigned CC = Cond[0].getImm() & ~RISCV::CCMASK_CMP_UO;
+  if (getBooleanCond(MRI, Cond))
+    CondCycles = 1;
+  else if (CC == RISCV::CCMASK_CMP_EQ || CC == RISCV::CCMASK_CMP_NE)
+    CondCycles = 3;
+  else
+    CondCycles = 2;
+  TrueCycles = FalseCycles = 3;
+  return true;
+}
+
+void RISCVInstrInfo::insertSelect(MachineBasicBlock &MBB,
+                                  MachineBasicBlock::iterator I,
+                                  const DebugLoc &DL, unsigned DstReg,
+                                  ArrayRef<MachineOperand> Cond,
+                                  unsigned TrueReg, unsigned FalseReg) const {
+  MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  unsigned LHS = Cond[2].getReg();
+  unsigned RHS = Cond[3].getReg();
+  bool CmpIs64 = isGR64(MRI, LHS) || isGR64(MRI, RHS);
+  unsigned Zero = CmpIs64 ? RISCV::zero_64 : RISCV::zero;
+  unsigned SLT = CmpIs64 ? RISCV::SLT64 : RISCV::SLT;
+  unsigned SLTU = CmpIs64 ? RISCV::SLTU64 : RISCV::SLTU;
+
+  // Compute a GR32 that is 1 when the branch would have been taken, unless
+  // the branch already tests such a value.  The conditions that need an
+  // extra xori are computed inverted instead and the two values swapped.
+  unsigned CC = Cond[0].getImm();
+  bool Unsigned = CC & RISCV::CCMASK_CMP_UO;
+  bool Swap = false;
+  unsigned CondReg = getBooleanCond(MRI, Cond);
+  if (CondReg)
+    Swap = (CC & ~RISCV::CCMASK_CMP_UO) == RISCV::CCMASK_CMP_EQ;
+  else {
+    CondReg = MRI.createVirtualRegister(&RISCV::GR32BitRegClass);
+    switch (CC & ~RISCV::CCMASK_CMP_UO) {
+    case RISCV::CCMASK_CMP_EQ:
+    case RISCV::CCMASK_CMP_NE: {
+      unsigned Diff = LHS;
+      if (RHS != Zero && LHS != Zero) {
+        Diff = MRI.createVirtualRegister(CmpIs64 ? &RISCV::GR64BitRegClass
+                                                 : &RISCV::GR32BitRegClass);
+        BuildMI(MBB, I, DL, get(CmpIs64 ? RISCV::XOR64 : RISCV::XOR), Diff)
+          .addReg(LHS).addReg(RHS);
+      } else if (LHS == Zero)
+        Diff = RHS;
+      if ((CC & ~RISCV::CCMASK_CMP_UO) == RISCV::CCMASK_CMP_EQ)
+        BuildMI(MBB, I, DL, get(CmpIs64 ? RISCV::SLTIU64 : RISCV::SLTIU),
+                CondReg).addReg(Diff).addImm(1);
+      else
+        BuildMI(MBB, I, DL, get(SLTU), CondReg).addReg(Zero).addReg(Diff);
+      break;
+    }
+    case RISCV::CCMASK_CMP_GE:
+      Swap = true;
+      // Fall through.
+    case RISCV::CCMASK_CMP_LT:
+      BuildMI(MBB, I, DL, get(Unsigned ? SLTU : SLT), CondReg)
+        .addReg(LHS).addReg(RHS);
+      break;
+    case RISCV::CCMASK_CMP_LE:
+      Swap = true;
+      // Fall through.
+    case RISCV::CCMASK_CMP_GT:
+      BuildMI(MBB, I, DL, get(Unsigned ? SLTU : SLT), CondReg)
+        .addReg(RHS).addReg(LHS);
+      break;
+    default:
+      llvm_unreachable("Invalid branch condition!");
+    }
+  }
+  if (Swap)
+    std::swap(TrueReg, FalseReg);
+
+  // DstReg = FalseReg ^ ((TrueReg ^ FalseReg) & -CondReg)
+  bool Is64 = isGR64(MRI, DstReg);
+  const TargetRegisterClass *RC = Is64 ? &RISCV::GR64BitRegClass
+                                       : &RISCV::GR32BitRegClass;
+  unsigned XOR = Is64 ? RISCV::XOR64 : RISCV::XOR;
+  unsigned Mask = MRI.createVirtualRegister(RC);
+  if (Is64) {
+    unsigned Wide = MRI.createVirtualRegister(RC);
+    BuildMI(MBB, I, DL, get(TargetOpcode::SUBREG_TO_REG), Wide)
+      .addImm(0).addReg(CondReg).addImm(RISCV::sub_32);
+    BuildMI(MBB, I, DL, get(RISCV::SUB64), Mask)
+      .addReg(RISCV::zero_64).addReg(Wide);
+  } else
+    BuildMI(MBB, I, DL, get(STI.isRV64() ? RISCV::SUBW : RISCV::SUB), Mask)
+      .addReg(RISCV::zero).addReg(CondReg);
+  unsigned Diff = MRI.createVirtualRegister(RC);
+  BuildMI(MBB, I, DL, get(XOR), Diff).addReg(TrueReg).addReg(FalseReg);
+  unsigned Masked = MRI.createVirtualRegister(RC);
+  BuildMI(MBB, I, DL, get(Is64 ? RISCV::AND64 : RISCV::AND), Masked)
+    .addReg(Diff).addReg(Mask);
+  BuildMI(MBB, I, DL, get(XOR), DstReg).addReg(FalseReg).addReg(Masked);
+}
+
 bool RISCVInstrInfo::isBranch(const MachineInstr *MI, SmallVectorImpl<MachineOperand> &Cond,
                                 const MachineOperand *&Target) const {
   switch (MI->getOpcode()) {
@@ -579,10 +840,11 @@ bool RISCVInstrInfo::isBranch(const MachineInstr *MI, SmallVectorImpl<MachineOpe
 void RISCVInstrInfo::getLoadStoreOpcodes(const TargetRegisterClass *RC,
                                            unsigned &LoadOpcode,
                                            unsigned &StoreOpcode) const {
-  if (RC == &RISCV::GR32BitRegClass ){
+  // Subclasses such as GR32C hold the same values as their parent class.
+  if (RISCV::GR32BitRegClass.hasSubClassEq(RC)) {
     LoadOpcode = STI.isRV64() ? RISCV::LW64_32 : RISCV::LW;
     StoreOpcode = STI.isRV64() ? RISCV::SW64_32 : RISCV::SW;
-  } else if (RC == &RISCV::GR64BitRegClass) {
+  } else if (RISCV::GR64BitRegClass.hasSubClassEq(RC)) {
     LoadOpcode = RISCV::LD;
     StoreOpcode = RISCV::SD;
   } else if (RC == &RISCV::FP32BitRegClass) {
@@ -623,7 +885,8 @@ void RISCVInstrInfo::loadImmediate(MachineBasicBlock &MBB,
     Opcode = STI.isRV64() ? RISCV::ADDI64 : RISCV::ADDI;
     BuildMI(MBB, MBBI, DL, get(Opcode), *Reg).addReg(ZERO).addImm(Value);
   } else {
-  //use LI to let assembler load immediate best
-  BuildMI(MBB, MBBI, DL, get(RISCV::LI), *Reg).addImm(Value);
+  //the asm printer expands LI into the shortest sequence RISCVMatInt finds
+  Opcode = STI.isRV64() ? RISCV::LI64 : RISCV::LI;
+  BuildMI(MBB, MBBI, DL, get(Opcode), *Reg).addImm(Value);
   }
 }
@@ -37,7 +37,8 @@ namespace RISCVII {
     MO_ABS_HI,
     MO_ABS_LO,
     MO_TPREL_HI,
-    MO_TPREL_LO
+    MO_TPREL_LO,
+    MO_GPREL
   };
 }
 
@@ -60,6 +61,14 @@ public:
   void adjustStackPtr(unsigned SP, int64_t Amount,
                                      MachineBasicBlock &MBB,
                                      MachineBasicBlock::iterator I) const;
+  void insertNoop(MachineBasicBlock &MBB,
+                  MachineBasicBlock::iterator MI) const override;
+  bool isSchedulingBoundary(const MachineInstr &MI,
+                            const MachineBasicBlock *MBB,
+                            const MachineFunction &MF) const override;
+  ScheduleHazardRecognizer *
+  CreateTargetPostRAHazardRecognizer(const InstrItineraryData *II,
+                                     const ScheduleDAG *DAG) const override;
   unsigned GetInstSizeInBytes(MachineInstr *I) const;
   bool AnalyzeBranch(MachineBasicBlock &MBB, MachineBasicBlock *&TBB,
                      MachineBasicBlock *&FBB,
@@ -93,6 +102,15 @@ public:
   bool expandPostRAPseudo(MachineInstr &MI) const override;
   bool
   ReverseBranchCondition(SmallVectorImpl<MachineOperand> &Cond) const override;
+  bool canInsertSelect(const MachineBasicBlock &MBB,
+                       ArrayRef<MachineOperand> Cond,
+                       unsigned TrueReg, unsigned FalseReg,
+                       int &CondCycles,
+                       int &TrueCycles, int &FalseCycles) const override;
+  void insertSelect(MachineBasicBlock &MBB,
+                    MachineBasicBlock::iterator I, const DebugLoc &DL,
+                    unsigned DstReg, ArrayRef<MachineOperand> Cond,
+                    unsigned TrueReg, unsigned FalseReg) const override;
 
   // Return the RISCVRegisterInfo, which this class owns.
   const RISCVRegisterInfo &getRegisterInfo() const { return RI; }
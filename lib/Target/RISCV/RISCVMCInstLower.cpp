@@ -32,6 +32,7 @@ static MCSymbolRefExpr::VariantKind getVariantKind(unsigned Flags) {
     case RISCVII::MO_NONE:
     case RISCVII::MO_ABS_HI:
     case RISCVII::MO_ABS_LO:
+    case RISCVII::MO_GPREL:
       return MCSymbolRefExpr::VK_None;
     case RISCVII::MO_TPREL_HI:
     case RISCVII::MO_TPREL_LO:
@@ -53,6 +54,7 @@ MCOperand RISCVMCInstLower::lowerSymbolOperand(const MachineOperand &MO,
     case RISCVII::MO_ABS_LO:    TargetKind = RISCVMCExpr::VK_RISCV_LO12; break;
     case RISCVII::MO_TPREL_HI:    TargetKind = RISCVMCExpr::VK_RISCV_TPREL_HI20; break;
     case RISCVII::MO_TPREL_LO:    TargetKind = RISCVMCExpr::VK_RISCV_TPREL_LO12; break;
+    case RISCVII::MO_GPREL:    TargetKind = RISCVMCExpr::VK_RISCV_GPREL; break;
   }
   const MCExpr *Expr = MCSymbolRefExpr::create(Symbol, Kind, Ctx);
   if (Offset) {
@@ -76,6 +78,10 @@ MCOperand RISCVMCInstLower::lowerOperand(const MachineOperand &MO) const {
       return MCOperand();
     return MCOperand::createReg(MO.getReg());
 
+  case MachineOperand::MO_RegisterMask:
+    // Calls from the fast selector carry the clobbers as a mask.
+    return MCOperand();
+
   case MachineOperand::MO_Immediate:
     return MCOperand::createImm(MO.getImm());
 
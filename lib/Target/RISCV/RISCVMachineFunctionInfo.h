@@ -40,7 +40,8 @@ public:
   explicit RISCVFunctionInfo(MachineFunction &MF)
     : MF(MF), SavedGPRFrameSize(0), LowSavedGPR(0), HighSavedGPR(0), VarArgsFirstGPR(0),
       VarArgsFirstFPR(0), VarArgsFrameIndex(0), RegSaveFrameIndex(0),
-      ManipulatesSP(false), CallsEhReturn(false) {}
+      ManipulatesSP(false), HasByvalArg(false), IncomingArgSize(0),
+      CallsEhReturn(false) {}
 
   // Get and set the number of bytes allocated by generic code to store
   // call-saved GPRs.
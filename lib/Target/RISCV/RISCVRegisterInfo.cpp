@@ -11,6 +11,7 @@
 #include "RISCVSubtarget.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -22,6 +23,11 @@
 
 using namespace llvm;
 
+static cl::opt<unsigned>
+XvecIndexHintThreshold("riscv-xvec-index-hint", cl::init(4), cl::Hidden,
+                       cl::desc("Hint base registers of at least this many "
+                                "word accesses to x29-x31 (0 disables)"));
+
 RISCVRegisterInfo::RISCVRegisterInfo(const RISCVSubtarget &STI)
     : RISCVGenRegisterInfo(RISCV::ra), Subtarget(STI) {}
 
@@ -92,6 +98,36 @@ RISCVRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   return Reserved;
 }
 
+// Xvec operations use x1-x28 as their register bank, so RISCVXvecVectorize
+// has to move every array pointer it finds there into x29-x31 and back.
+// Steer pointers that are the base of many word accesses to x29-x31 in the
+// first place.
+void
+RISCVRegisterInfo::getRegAllocationHints(unsigned VirtReg,
+                                         ArrayRef<MCPhysReg> Order,
+                                         SmallVectorImpl<MCPhysReg> &Hints,
+                                         const MachineFunction &MF,
+                                         const VirtRegMap *VRM,
+                                         const LiveRegMatrix *Matrix) const {
+  TargetRegisterInfo::getRegAllocationHints(VirtReg, Order, Hints, MF, VRM,
+                                            Matrix);
+  if (!Hints.empty() || !XvecIndexHintThreshold || !Subtarget.isRV32())
+    return;
+
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  unsigned NumAccesses = 0;
+  for (const MachineInstr &MI : MRI.use_nodbg_instructions(VirtReg))
+    if ((MI.getOpcode() == RISCV::LW || MI.getOpcode() == RISCV::SW) &&
+        MI.getOperand(2).isReg() && MI.getOperand(2).getReg() == VirtReg)
+      ++NumAccesses;
+  if (NumAccesses < XvecIndexHintThreshold)
+    return;
+
+  for (MCPhysReg Reg : {RISCV::t4, RISCV::t5, RISCV::t6})
+    if (std::find(Order.begin(), Order.end(), Reg) != Order.end())
+      Hints.push_back(Reg);
+}
+
 void RISCVRegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
                                      unsigned OpNo, int FrameIndex,
                                      uint64_t StackSize,
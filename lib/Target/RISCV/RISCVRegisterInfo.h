@@ -40,6 +40,11 @@ public:
   const uint32_t *
   getCallPreservedMask(const MachineFunction &MF, CallingConv::ID) const override;
   BitVector getReservedRegs(const MachineFunction &MF) const override;
+  void getRegAllocationHints(unsigned VirtReg, ArrayRef<MCPhysReg> Order,
+                             SmallVectorImpl<MCPhysReg> &Hints,
+                             const MachineFunction &MF,
+                             const VirtRegMap *VRM,
+                             const LiveRegMatrix *Matrix) const override;
   void eliminateFrameIndex(MachineBasicBlock::iterator MI, int SPAdj,
                            unsigned FIOperandNum,
                            RegScavenger *RS) const override;
@@ -0,0 +1,203 @@
+//===-- RISCVSExtElimination.cpp - Remove redundant RV64 sext.w -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains a pass that removes the sext.w (addiw rd, rs, 0) that
+// instruction selection puts on every truncation to i32 in RV64 code when
+// the 64-bit value is already sign-extended from 32 bits.
+//
+// GR32 values are always held sign-extended, so anything that comes from a
+// GR32 register through SUBREG_TO_REG qualifies, as do sign-extending
+// loads, shifts that leave at most 32 significant bits, small constants and
+// the bitwise operations and PHIs of such values.  The DAG only sees one
+// block at a time, so this mostly catches values that are extended in one
+// block and truncated in another, or that go around a loop.  The pass runs
+// on SSA form just before register allocation.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "riscv-sext-elim"
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+STATISTIC(NumEliminated, "Number of redundant sign extensions removed");
+
+static cl::opt<bool>
+EnableSExtElim("riscv-sext-elim", cl::init(true), cl::Hidden,
+               cl::desc("Remove sext.w of values that are already "
+                        "sign-extended"));
+
+namespace llvm {
+  void initializeRISCVSExtEliminationPass(PassRegistry&);
+}
+
+namespace {
+  struct RISCVSExtElimination : public MachineFunctionPass {
+    static char ID;
+    RISCVSExtElimination() : MachineFunctionPass(ID) {
+      initializeRISCVSExtEliminationPass(*PassRegistry::getPassRegistry());
+    }
+
+    MachineRegisterInfo *MRI;
+
+    bool runOnMachineFunction(MachineFunction &Fn) override;
+
+    bool isSignExtended(unsigned Reg);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesCFG();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    const char *getPassName() const override {
+      return "RISCV Sign Extension Elimination";
+    }
+  };
+  char RISCVSExtElimination::ID = 0;
+}
+
+INITIALIZE_PASS(RISCVSExtElimination, "riscv-sext-elimination",
+                "RISCV Sign Extension Elimination", false, false)
+
+/// createRISCVSExtEliminationPass - returns an instance of the sign
+/// extension elimination pass.
+///
+FunctionPass *llvm::createRISCVSExtEliminationPass() {
+  return new RISCVSExtElimination();
+}
+
+/// isSignExtended - Return true if bits 63-31 of Reg are all the same.
+/// PHIs are assumed to be sign-extended until one of their inputs proves
+/// otherwise, so that loop-carried values qualify.
+bool RISCVSExtElimination::isSignExtended(unsigned Reg) {
+  SmallPtrSet<MachineInstr *, 16> Visited;
+  SmallVector<unsigned, 16> Worklist;
+  Worklist.push_back(Reg);
+  while (!Worklist.empty()) {
+    Reg = Worklist.pop_back_val();
+    if (!TargetRegisterInfo::isVirtualRegister(Reg))
+      return false;
+    MachineInstr *MI = MRI->getVRegDef(Reg);
+    if (!MI)
+      return false;
+    if (!Visited.insert(MI).second)
+      continue;
+
+    switch (MI->getOpcode()) {
+    case TargetOpcode::COPY: {
+      // A GR32 taken from the low half of a GR64 is only sign-extended if
+      // the GR64 is.
+      unsigned SrcReg = MI->getOperand(1).getReg();
+      if (SrcReg == RISCV::zero || SrcReg == RISCV::zero_64)
+        break;
+      Worklist.push_back(SrcReg);
+      break;
+    }
+
+    case TargetOpcode::PHI:
+      for (unsigned i = 1, e = MI->getNumOperands(); i != e; i += 2)
+        Worklist.push_back(MI->getOperand(i).getReg());
+      break;
+
+    case TargetOpcode::SUBREG_TO_REG:
+      Worklist.push_back(MI->getOperand(2).getReg());
+      break;
+
+    case RISCV::AND64:
+    case RISCV::OR64:
+    case RISCV::XOR64:
+      Worklist.push_back(MI->getOperand(1).getReg());
+      Worklist.push_back(MI->getOperand(2).getReg());
+      break;
+
+    case RISCV::ANDI64:
+      // Masking with a positive immediate clears the upper bits.
+      if (MI->getOperand(2).isImm() && MI->getOperand(2).getImm() >= 0)
+        break;
+      // Fall through.
+    case RISCV::ORI64:
+    case RISCV::XORI64:
+      Worklist.push_back(MI->getOperand(1).getReg());
+      break;
+
+    case RISCV::ADDI64:
+      if (MI->getOperand(1).isReg() &&
+          MI->getOperand(1).getReg() == RISCV::zero_64 &&
+          MI->getOperand(2).isImm())
+        break;
+      return false;
+
+    case RISCV::SRAI64:
+      if (MI->getOperand(2).isImm() && MI->getOperand(2).getImm() >= 32)
+        break;
+      return false;
+
+    case RISCV::SRLI64:
+      if (MI->getOperand(2).isImm() && MI->getOperand(2).getImm() > 32)
+        break;
+      return false;
+
+    case RISCV::LW64:
+    case RISCV::LH64:
+    case RISCV::LHU64:
+    case RISCV::LB64:
+    case RISCV::LBU64:
+      break;
+
+    default:
+      // Everything else that writes a GR32 leaves it sign-extended.
+      if (!RISCV::GR32BitRegClass.hasSubClassEq(MRI->getRegClass(Reg)))
+        return false;
+      break;
+    }
+  }
+  return true;
+}
+
+bool RISCVSExtElimination::runOnMachineFunction(MachineFunction &Fn) {
+  if (!EnableSExtElim || skipFunction(*Fn.getFunction()))
+    return false;
+  if (!Fn.getSubtarget<RISCVSubtarget>().isRV64())
+    return false;
+  MRI = &Fn.getRegInfo();
+  if (!MRI->isSSA())
+    return false;
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : Fn)
+    for (MachineBasicBlock::iterator I = MBB.begin(), E = MBB.end(); I != E;) {
+      MachineInstr &MI = *I++;
+      if (MI.getOpcode() != RISCV::ADDIW || !MI.getOperand(2).isImm() ||
+          MI.getOperand(2).getImm() != 0)
+        continue;
+      unsigned DstReg = MI.getOperand(0).getReg();
+      unsigned SrcReg = MI.getOperand(1).getReg();
+      if (!TargetRegisterInfo::isVirtualRegister(SrcReg) ||
+          !isSignExtended(SrcReg) ||
+          !MRI->constrainRegClass(SrcReg, MRI->getRegClass(DstReg)))
+        continue;
+
+      DEBUG(dbgs() << "Removing " << MI);
+      MRI->replaceRegWith(DstReg, SrcReg);
+      MRI->clearKillFlags(SrcReg);
+      MI.eraseFromParent();
+      ++NumEliminated;
+      Changed = true;
+    }
+  return Changed;
+}
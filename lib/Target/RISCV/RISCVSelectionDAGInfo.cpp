@@ -0,0 +1,141 @@
+//===-- RISCVSelectionDAGInfo.cpp - RISCV SelectionDAG Info ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the RISCVSelectionDAGInfo class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVSelectionDAGInfo.h"
+#include "RISCVSubtarget.h"
+#include "RISCVVectorInstrBuilder.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-selectiondag-info"
+
+static cl::opt<bool>
+EnableXvecMemcpy("riscv-xvec-memcpy", cl::init(true), cl::Hidden,
+                 cl::desc("Copy constant-sized blocks through the Xvec "
+                          "vector bank instead of calling memcpy"));
+
+static cl::opt<unsigned>
+MaxMemsetStores("riscv-memset-max-stores", cl::init(32), cl::Hidden,
+                cl::desc("Maximum number of stores emitted inline for a "
+                         "constant-sized memset"));
+
+// Return the size of the block operation if it is a constant that a block
+// copy through the Xvec bank can handle, or 0 otherwise.  Every element is
+// addressed with a 12-bit offset from the original pointers, which bounds the
+// size of the block.
+static uint64_t getXvecCopySize(SelectionDAG &DAG, SDValue Size,
+                                bool IsVolatile) {
+  const RISCVSubtarget &Subtarget =
+      DAG.getMachineFunction().getSubtarget<RISCVSubtarget>();
+  if (!EnableXvecMemcpy || IsVolatile || !Subtarget.isRV32())
+    return 0;
+
+  auto *CSize = dyn_cast<ConstantSDNode>(Size);
+  if (!CSize || CSize->getZExtValue() > XVEC_BLOCK_COPY_MAX)
+    return 0;
+  return CSize->getZExtValue();
+}
+
+// Emit an XVEC_MEMCPY node, which is expanded after register allocation into
+// loads of up to XVEC_AVAIL_REGS elements into the vector bank followed by
+// their stores.  Elements are as wide as Align allows.
+static SDValue emitXvecCopy(SelectionDAG &DAG, const SDLoc &DL, SDValue Chain,
+                            SDValue Dst, SDValue Src, uint64_t Size,
+                            unsigned Align) {
+  return DAG.getNode(RISCVISD::XVEC_MEMCPY, DL, MVT::Other, Chain, Dst, Src,
+                     DAG.getTargetConstant(Size, DL, MVT::i32),
+                     DAG.getTargetConstant(Align, DL, MVT::i32));
+}
+
+// Small copies are expanded into loads and stores by the target-independent
+// code before this hook is reached, so whatever gets here would otherwise be
+// a call to memcpy.
+SDValue RISCVSelectionDAGInfo::EmitTargetCodeForMemcpy(
+    SelectionDAG &DAG, const SDLoc &DL, SDValue Chain, SDValue Dst, SDValue Src,
+    SDValue Size, unsigned Align, bool IsVolatile, bool AlwaysInline,
+    MachinePointerInfo DstPtrInfo, MachinePointerInfo SrcPtrInfo) const {
+  uint64_t Bytes = getXvecCopySize(DAG, Size, IsVolatile);
+  if (!Bytes)
+    return SDValue();
+  return emitXvecCopy(DAG, DL, Chain, Dst, Src, Bytes, Align);
+}
+
+// A block copy loads a whole chunk before storing any of it, so blocks that
+// fit in a single chunk may overlap.
+SDValue RISCVSelectionDAGInfo::EmitTargetCodeForMemmove(
+    SelectionDAG &DAG, const SDLoc &DL, SDValue Chain, SDValue Dst, SDValue Src,
+    SDValue Size, unsigned Align, bool IsVolatile,
+    MachinePointerInfo DstPtrInfo, MachinePointerInfo SrcPtrInfo) const {
+  uint64_t Bytes = getXvecCopySize(DAG, Size, IsVolatile);
+  if (!Bytes ||
+      RISCVVectorInstrBuilder::getBlockCopyElements(Bytes, Align) >
+          XVEC_AVAIL_REGS)
+    return SDValue();
+  return emitXvecCopy(DAG, DL, Chain, Dst, Src, Bytes, Align);
+}
+
+// The vector bank does not help with memset: Every element is stored from
+// the same register.  Splat the byte into a word and store it directly, with
+// a larger budget than the target-independent expansion allows.
+SDValue RISCVSelectionDAGInfo::EmitTargetCodeForMemset(
+    SelectionDAG &DAG, const SDLoc &DL, SDValue Chain, SDValue Dst,
+    SDValue Byte, SDValue Size, unsigned Align, bool IsVolatile,
+    MachinePointerInfo DstPtrInfo) const {
+  const RISCVSubtarget &Subtarget =
+      DAG.getMachineFunction().getSubtarget<RISCVSubtarget>();
+  auto *CSize = dyn_cast<ConstantSDNode>(Size);
+  if (IsVolatile || !Subtarget.isRV32() || !CSize)
+    return SDValue();
+
+  uint64_t Bytes = CSize->getZExtValue();
+  unsigned Width = Align >= 4 ? 4 : (Align >= 2 ? 2 : 1);
+  if (Bytes / Width + countPopulation(Bytes % Width) > MaxMemsetStores)
+    return SDValue();
+
+  SDValue Word;
+  if (auto *CByte = dyn_cast<ConstantSDNode>(Byte))
+    Word = DAG.getConstant((CByte->getZExtValue() & 0xff) * 0x01010101, DL,
+                           MVT::i32);
+  else {
+    Word = DAG.getNode(ISD::AND, DL, MVT::i32,
+                       DAG.getZExtOrTrunc(Byte, DL, MVT::i32),
+                       DAG.getConstant(0xff, DL, MVT::i32));
+    Word = DAG.getNode(ISD::OR, DL, MVT::i32, Word,
+                       DAG.getNode(ISD::SHL, DL, MVT::i32, Word,
+                                   DAG.getConstant(8, DL, MVT::i32)));
+    Word = DAG.getNode(ISD::OR, DL, MVT::i32, Word,
+                       DAG.getNode(ISD::SHL, DL, MVT::i32, Word,
+                                   DAG.getConstant(16, DL, MVT::i32)));
+  }
+
+  EVT PtrVT = Dst.getValueType();
+  SmallVector<SDValue, 32> Stores;
+  for (uint64_t Offset = 0; Offset < Bytes; Offset += Width) {
+    while (Offset + Width > Bytes)
+      Width /= 2;
+    SDValue Addr = DAG.getNode(ISD::ADD, DL, PtrVT, Dst,
+                               DAG.getConstant(Offset, DL, PtrVT));
+    MachinePointerInfo PtrInfo = DstPtrInfo.getWithOffset(Offset);
+    unsigned StoreAlign = MinAlign(Align, Offset);
+    if (Width == 4)
+      Stores.push_back(DAG.getStore(Chain, DL, Word, Addr, PtrInfo,
+                                    false, false, StoreAlign));
+    else
+      Stores.push_back(DAG.getTruncStore(Chain, DL, Word, Addr, PtrInfo,
+                                         Width == 2 ? MVT::i16 : MVT::i8,
+                                         false, false, StoreAlign));
+  }
+  return DAG.getNode(ISD::TokenFactor, DL, MVT::Other, Stores);
+}
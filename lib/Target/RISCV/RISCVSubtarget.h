@@ -18,7 +18,7 @@
 #include "RISCVISelLowering.h"
 #include "RISCVInstrInfo.h"
 #include "RISCVRegisterInfo.h"
-#include "llvm/CodeGen/SelectionDAGTargetInfo.h"
+#include "RISCVSelectionDAGInfo.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Target/TargetFrameLowering.h"
@@ -45,14 +45,19 @@ protected:
   bool HasA;
   bool HasF;
   bool HasD;
+  bool HasC;
 
   bool UseSoftFloat;
 
+  bool EnableLinkerRelax;
+
+  bool EnableSaveRestore;
+
 private:
   Triple TargetTriple;
   RISCVInstrInfo InstrInfo;
   RISCVTargetLowering TLInfo;
-  SelectionDAGTargetInfo TSInfo;
+  RISCVSelectionDAGInfo TSInfo;
   RISCVFrameLowering FrameLowering;
 
   RISCVSubtarget &initializeSubtargetDependencies(StringRef CPU, StringRef FS);
@@ -67,7 +72,17 @@ public:
     return &InstrInfo.getRegisterInfo();
   }
   const RISCVTargetLowering *getTargetLowering() const { return &TLInfo; }
-  const SelectionDAGTargetInfo *getSelectionDAGInfo() const { return &TSInfo; }
+  const RISCVSelectionDAGInfo *getSelectionDAGInfo() const {
+    return &TSInfo;
+  }
+
+  // The in-order cores benefit from having load and multiply latencies
+  // hidden before register allocation.
+  bool enableMachineScheduler() const override { return true; }
+
+  // After register allocation, the hazard slots of the Xvec operations are
+  // filled with independent scalar work; see RISCVXvecHazardRecognizer.
+  bool enablePostRAScheduler() const override { return hasXvec(); }
 
   bool isRV32() const { return RISCVArchVersion == RV32; };
   bool isRV64() const { return RISCVArchVersion == RV64; };
@@ -76,9 +91,22 @@ public:
   bool hasA() const { return HasA; };
   bool hasF() const { return HasF; };
   bool hasD() const { return HasD; };
+  bool hasC() const { return HasC; };
 
   bool useSoftFloat() const { return UseSoftFloat; }
 
+  // The Xvec unit works on the 32-bit register file of the RV32 cores.
+  bool hasXvec() const { return isRV32(); }
+
+  // Calls are left as auipc/jalr pairs and relocations are marked with
+  // R_RISCV_RELAX, for the linker to shrink.
+  bool enableLinkerRelax() const { return EnableLinkerRelax; }
+
+  // Callee-saved registers are saved and restored by calls to the shared
+  // __riscv_save_N and __riscv_restore_N routines, which is smaller but
+  // slower.
+  bool enableSaveRestore() const { return EnableSaveRestore; }
+
   // Automatically generated by tblgen.
   void ParseSubtargetFeatures(StringRef CPU, StringRef FS);
 
@@ -8,6 +8,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "RISCVTargetMachine.h"
+#include "RISCVTargetObjectFile.h"
+#include "RISCVTargetTransformInfo.h"
+#include "llvm/CodeGen/MachineScheduler.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
@@ -19,6 +22,11 @@ extern "C" void LLVMInitializeRISCVTarget() {
   // Register the target.
   RegisterTargetMachine<RISCVTargetMachine> A(TheRISCVTarget);
   RegisterTargetMachine<RISCV64TargetMachine> B(TheRISCV64Target);
+
+  // Register the Xvec passes, so that -print-after and friends know them.
+  PassRegistry &PR = *PassRegistry::getPassRegistry();
+  initializeRISCVXvecVectorizePass(PR);
+  initializeRISCVXvecPaddingPass(PR);
 }
 
 static std::string computeDataLayout(const Triple &TT) {
@@ -79,6 +87,12 @@ RISCVTargetMachine::getSubtargetImpl(const Function &F) const {
   return I.get();
 }
 
+TargetIRAnalysis RISCVTargetMachine::getTargetIRAnalysis() {
+  return TargetIRAnalysis([this](const Function &F) {
+    return TargetTransformInfo(RISCVTTIImpl(this, F));
+  });
+}
+
 namespace {
 /// RISCV Code Generator Pass Configuration Options.
 class RISCVPassConfig : public TargetPassConfig {
@@ -90,17 +104,53 @@ public:
     return getTM<RISCVTargetMachine>();
   }
 
+  ScheduleDAGInstrs *
+  createMachineScheduler(MachineSchedContext *C) const override {
+    ScheduleDAGMILive *DAG = createGenericSchedLive(C);
+    const RISCVSubtarget &STI = C->MF->getSubtarget<RISCVSubtarget>();
+    if (auto Mutation = createRISCVXvecReductionMutation(STI))
+      DAG->addMutation(std::move(Mutation));
+    if (auto Mutation = createRISCVXvecElementMutation(STI))
+      DAG->addMutation(std::move(Mutation));
+    return DAG;
+  }
+
+  void addIRPasses() override;
   bool addInstSelector() override;
+  bool addILPOpts() override;
+  void addPreRegAlloc() override;
+  void addPreSched2() override;
   void addPreEmitPass() override;
 };
 } // end anonymous namespace
 
+void RISCVPassConfig::addIRPasses() {
+  addPass(createAtomicExpandPass(&getRISCVTargetMachine()));
+
+  TargetPassConfig::addIRPasses();
+}
+
 bool RISCVPassConfig::addInstSelector() {
   addPass(createRISCVISelDag(getRISCVTargetMachine(), getOptLevel()));
   return false;
 }
 
+bool RISCVPassConfig::addILPOpts() {
+  addPass(createRISCVEarlyIfConversionPass());
+  return true;
+}
+
+void RISCVPassConfig::addPreRegAlloc() {
+  if (getOptLevel() != CodeGenOpt::None)
+    addPass(createRISCVSExtEliminationPass());
+}
+
+void RISCVPassConfig::addPreSched2() {
+  addPass(createRISCVXvecVectorizePass());
+}
+
 void RISCVPassConfig::addPreEmitPass(){
+  addPass(createRISCVXvecPaddingPass());
   addPass(createRISCVBranchSelectionPass());
 }
 
@@ -35,6 +35,7 @@ public:
   const RISCVSubtarget *getSubtargetImpl(const Function &F) const override;
   // Override LLVMTargetMachine
   TargetPassConfig *createPassConfig(PassManagerBase &PM) override;
+  TargetIRAnalysis getTargetIRAnalysis() override;
   TargetLoweringObjectFile *getObjFileLowering() const override {
     return TLOF.get();
   }
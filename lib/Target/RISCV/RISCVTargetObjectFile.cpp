@@ -0,0 +1,77 @@
+//===-- RISCVTargetObjectFile.cpp - RISCV Object Info ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVTargetObjectFile.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+
+static cl::opt<bool>
+SmallData("riscv-small-data", cl::Hidden,
+          cl::desc("Put small globals in .sdata and .sbss and address them "
+                   "relative to gp"),
+          cl::init(false));
+
+static cl::opt<unsigned>
+SSThreshold("riscv-ssection-threshold", cl::Hidden,
+            cl::desc("Largest global, in bytes, that goes in .sdata or "
+                     ".sbss (default=8)"),
+            cl::init(8));
+
+void RISCVTargetObjectFile::Initialize(MCContext &Ctx,
+                                       const TargetMachine &TM) {
+  TargetLoweringObjectFileELF::Initialize(Ctx, TM);
+  InitializeELF(TM.Options.UseInitArray);
+
+  SmallDataSection = getContext().getELFSection(
+      ".sdata", ELF::SHT_PROGBITS, ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallBSSSection = getContext().getELFSection(
+      ".sbss", ELF::SHT_NOBITS, ELF::SHF_WRITE | ELF::SHF_ALLOC);
+}
+
+bool RISCVTargetObjectFile::isGlobalInSmallSection(
+    const GlobalValue *GV, const TargetMachine &TM) const {
+  if (!SmallData || TM.getRelocationModel() == Reloc::PIC_)
+    return false;
+
+  // Only variables we define and place ourselves.  The definition of a
+  // declaration, a common or a weak variable may end up anywhere, and so
+  // may a variable with an explicit section.
+  const GlobalVariable *GVA = dyn_cast<GlobalVariable>(GV);
+  if (!GVA || GVA->isDeclaration() || GVA->hasCommonLinkage() ||
+      GVA->isWeakForLinker() || GVA->hasSection() ||
+      GVA->isThreadLocal())
+    return false;
+
+  SectionKind Kind = getKindForGlobal(GVA, TM);
+  if (!Kind.isData() && !Kind.isBSS())
+    return false;
+
+  // Zero-sized objects have never been small data in GCC either.
+  uint64_t Size =
+      GVA->getParent()->getDataLayout().getTypeAllocSize(GVA->getValueType());
+  return Size > 0 && Size <= SSThreshold;
+}
+
+MCSection *
+RISCVTargetObjectFile::SelectSectionForGlobal(const GlobalValue *GV,
+                                              SectionKind Kind, Mangler &Mang,
+                                              const TargetMachine &TM) const {
+  if (isGlobalInSmallSection(GV, TM))
+    return Kind.isBSS() ? SmallBSSSection : SmallDataSection;
+
+  return TargetLoweringObjectFileELF::SelectSectionForGlobal(GV, Kind, Mang,
+                                                             TM);
+}
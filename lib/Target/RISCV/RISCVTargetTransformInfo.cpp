@@ -0,0 +1,272 @@
+//===-- RISCVTargetTransformInfo.cpp - RISCV-specific TTI -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a TargetTransformInfo analysis pass specific to the
+// RISCV target machine. It uses the target's detailed information to provide
+// more precise answers to certain TTI queries, while letting the target
+// independent and default TTI implementations handle the rest.
+//
+// The Xvec unit does not expose vector registers to the IR vectorizers: it
+// operates on the whole general purpose register file (XVEC_AVAIL_REGS lanes)
+// and is reached through RISCVXvecVectorize, which rewrites straight-line runs
+// of element-wise operations on i8, i16 or i32 arrays after register
+// allocation.  What the middle end can do for it is unroll simple array loops
+// into such runs, which is what the unrolling preferences below ask for when
+// the Xvec cost model would take the result.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVTargetTransformInfo.h"
+#include "MCTargetDesc/RISCVMatInt.h"
+#include "RISCVVectorInstrBuilder.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/BasicTTIImpl.h"
+#include "llvm/CodeGen/TargetSchedule.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetLowering.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "riscvtti"
+
+static cl::opt<bool>
+EnableXvecUnroll("riscv-xvec-unroll", cl::init(true), cl::Hidden,
+                 cl::desc("Unroll element-wise integer loops by the Xvec lane "
+                          "count"));
+
+//===----------------------------------------------------------------------===//
+//
+// RISCV cost model.
+//
+//===----------------------------------------------------------------------===//
+
+// Return true if Ty is an element type that RISCVXvecVectorize can move through
+// the vector bank. Narrow elements are extended by their loads and truncated by
+// their stores, so they still fill one lane each.
+static bool isXvecElementType(Type *Ty) {
+  return Ty->isIntegerTy(8) || Ty->isIntegerTy(16) || Ty->isIntegerTy(32);
+}
+
+// Return true if PN accumulates a value loaded in every iteration of L with an
+// operation RISCVXvecVectorize can reduce ("s = s op a[i]").
+static bool isXvecReduction(PHINode *PN, Loop *L) {
+  BinaryOperator *BO =
+      dyn_cast<BinaryOperator>(PN->getIncomingValueForBlock(L->getLoopLatch()));
+  if (!BO || !isXvecElementType(PN->getType()))
+    return false;
+
+  switch (BO->getOpcode()) {
+  case Instruction::Add:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+    break;
+  default:
+    return false;
+  }
+
+  // The induction variable is also stepped by an add, but by a constant.
+  Value *Other = BO->getOperand(0) == PN ? BO->getOperand(1)
+                                         : BO->getOperand(0);
+  return (BO->getOperand(0) == PN || BO->getOperand(1) == PN) &&
+         !isa<Constant>(Other);
+}
+
+// Return true if L is a single-block loop that only loads, stores and combines
+// integer elements with operations the Xvec unit implements, and nothing else,
+// or reduces the loaded elements into a register.  Class is set to the kind of
+// pattern an unrolled run of it would match.
+bool RISCVTTIImpl::isXvecCandidate(
+    Loop *L, RISCVVectorInstrBuilder::MatchClass &Class) const {
+  if (L->getNumBlocks() != 1)
+    return false;
+
+  bool HasStore = false, HasOp = false, HasReduction = false;
+  unsigned NumLoads = 0;
+  for (Instruction &I : *L->getHeader()) {
+    if (isa<CallInst>(I) || isa<InvokeInst>(I))
+      return false;
+    if (PHINode *PN = dyn_cast<PHINode>(&I)) {
+      HasReduction |= isXvecReduction(PN, L);
+      continue;
+    }
+    if (LoadInst *LI = dyn_cast<LoadInst>(&I)) {
+      if (!LI->isSimple() || !isXvecElementType(LI->getType()))
+        return false;
+      ++NumLoads;
+    } else if (StoreInst *SI = dyn_cast<StoreInst>(&I)) {
+      if (!SI->isSimple() ||
+          !isXvecElementType(SI->getValueOperand()->getType()))
+        return false;
+      HasStore = true;
+    } else if (isa<ICmpInst>(I)) {
+      // The exit test is the only comparison the unrolled run may keep.
+      if (!I.hasOneUse() || I.user_back() != L->getHeader()->getTerminator())
+        return false;
+    } else if (isXvecElementType(I.getType())) {
+      switch (I.getOpcode()) {
+      case Instruction::Add:
+      case Instruction::Sub:
+      case Instruction::Shl:
+      case Instruction::LShr:
+      case Instruction::AShr:
+      case Instruction::And:
+      case Instruction::Or:
+      case Instruction::Xor:
+        HasOp = true;
+        break;
+      case Instruction::ZExt:
+      case Instruction::SExt:
+      case Instruction::Trunc:
+        // Narrow elements are extended and truncated by their loads and
+        // stores.
+        break;
+      default:
+        // A single multiply, division or select leaves a run that
+        // RISCVXvecVectorize cannot substitute.
+        return false;
+      }
+    }
+  }
+  if (!NumLoads || !HasOp || !(HasStore || HasReduction))
+    return false;
+
+  if (!HasStore)
+    Class = RISCVVectorInstrBuilder::RED;
+  else
+    Class = NumLoads > 1 ? RISCVVectorInstrBuilder::RR
+                         : RISCVVectorInstrBuilder::RI;
+  return true;
+}
+
+// Constants cost what the sequence RISCVMatInt picks for them costs, so that
+// constant hoisting shares the expensive ones instead of loading them again
+// in every use.
+int RISCVTTIImpl::getIntImmCost(const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  // There is no cost model for constants with a bit size of 0 or of more
+  // than 64 bits.  Return TCC_Free so that constant hoisting ignores them.
+  if (BitSize == 0 || BitSize > 64)
+    return TTI::TCC_Free;
+  if (Imm == 0)
+    return TTI::TCC_Free;
+
+  // On RV32 a 64-bit constant is loaded a half at a time.
+  APInt Val = Imm.sextOrTrunc(64);
+  if (!ST->isRV64() && BitSize > 32) {
+    RISCVMatInt::InstSeq Lo, Hi;
+    RISCVMatInt::generateInstSeq(SignExtend64<32>(Val.getZExtValue()), false,
+                                 Lo);
+    RISCVMatInt::generateInstSeq(SignExtend64<32>(Val.getZExtValue() >> 32),
+                                 false, Hi);
+    return (Lo.size() + Hi.size()) * TTI::TCC_Basic;
+  }
+
+  RISCVMatInt::InstSeq Seq;
+  RISCVMatInt::generateInstSeq(ST->isRV64() ? Val.getSExtValue()
+                                            : SignExtend64<32>(
+                                                  Val.getZExtValue()),
+                               ST->isRV64(), Seq);
+  return Seq.size() * TTI::TCC_Basic;
+}
+
+int RISCVTTIImpl::getIntImmCost(unsigned Opcode, unsigned Idx,
+                                const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0 || BitSize > 64)
+    return TTI::TCC_Free;
+
+  switch (Opcode) {
+  case Instruction::Add:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::ICmp:
+    // These have forms with a 12-bit signed immediate, which is the second
+    // operand once the IR is canonical.
+    if (Idx == 1 && Imm.getMinSignedBits() <= 12)
+      return TTI::TCC_Free;
+    break;
+  case Instruction::Sub:
+    // Selected as an addi of the negated immediate.
+    if (Idx == 1 && Imm.getMinSignedBits() <= 12 &&
+        (-Imm).getMinSignedBits() <= 12)
+      return TTI::TCC_Free;
+    break;
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+    if (Idx == 1)
+      return TTI::TCC_Free;
+    break;
+  }
+
+  return getIntImmCost(Imm, Ty);
+}
+
+int RISCVTTIImpl::getIntImmCost(Intrinsic::ID IID, unsigned Idx,
+                                const APInt &Imm, Type *Ty) {
+  // Without this overload intrinsic calls would be costed as the opcode
+  // overload above.  Some intrinsic operands, like the size of a lifetime
+  // marker, must stay constants, so none is worth hoisting.
+  return TTI::TCC_Free;
+}
+
+void RISCVTTIImpl::getUnrollingPreferences(Loop *L,
+                                           TTI::UnrollingPreferences &UP) {
+  // The vector opcodes other than the comparisons and logic operations are
+  // RV32 only.
+  RISCVVectorInstrBuilder::MatchClass Class;
+  if (!EnableXvecUnroll || !ST->isRV32() || !isXvecCandidate(L, Class)) {
+    BaseT::getUnrollingPreferences(L, UP);
+    return;
+  }
+
+  // Unrolling only pays off if RISCVXvecVectorize substitutes the run it
+  // produces, so ask its cost model about a full bank of lanes.
+  TargetSchedModel SchedModel;
+  SchedModel.init(ST->getSchedModel(), ST, ST->getInstrInfo());
+  unsigned ScalarCost = RISCVVectorInstrBuilder::estimateScalarCost(
+      Class, XVEC_AVAIL_REGS, SchedModel);
+  unsigned VectorCost = RISCVVectorInstrBuilder::estimateVectorCost(
+      Class, XVEC_AVAIL_REGS, SchedModel);
+  unsigned LoopSize = L->getHeader()->size();
+  DEBUG(dbgs() << "RISCVTTI: Xvec candidate loop of " << LoopSize
+               << " instructions, class " << Class << ", cost " << ScalarCost
+               << " -> " << VectorCost << '\n');
+  if (VectorCost >= ScalarCost) {
+    BaseT::getUnrollingPreferences(L, UP);
+    return;
+  }
+
+  // Ask for a full bank of lanes per iteration, with a runtime remainder loop
+  // for trip counts that are unknown or not a multiple of the lane count.
+  // Without a count, runtime unrolling would settle for 8 iterations, a run
+  // the cost model rejects.
+  UP.Partial = UP.Runtime = UP.AllowRemainder = true;
+  UP.Count = UP.MaxCount = XVEC_AVAIL_REGS;
+  UP.PartialThreshold = UP.PartialOptSizeThreshold =
+      LoopSize * XVEC_AVAIL_REGS;
+}
+
+unsigned RISCVTTIImpl::getNumberOfRegisters(bool Vector) {
+  if (Vector)
+    return 0;
+  return 32;
+}
+
+unsigned RISCVTTIImpl::getRegisterBitWidth(bool Vector) {
+  return ST->isRV64() ? 64 : 32;
+}
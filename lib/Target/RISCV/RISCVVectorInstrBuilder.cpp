@@ -28,53 +28,71 @@
 /* ********************************************************************************************* */
 
 #include "RISCVVectorInstrBuilder.h"
+#include "RISCVHazardRecognizer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
+#include "llvm/CodeGen/TargetSchedule.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cmath>
 
-// TODO: Remove
-#include <iostream>
+#define DEBUG_TYPE "riscv-xvec"
 
 using namespace llvm;
 
-/**
- * @brief Get how many matches were found.
- */
-unsigned int RISCVVectorInstrBuilder::getListSize() {
-	return classVec.size();
-}
+namespace {
 
 /**
- * @brief Get match class for given match.
+ * @brief Check if an opcode loads a single element (LW, LH, LHU, LB or LBU). Narrow elements are
+ *        sign or zero extended by the load itself, so vector operations always see whole words.
  */
-unsigned int RISCVVectorInstrBuilder::getClassAt(unsigned int i) {
-	return classVec[i];
+bool isElementLoad(unsigned int opcode) {
+	return	(RISCV::LW == opcode) ||
+			(RISCV::LH == opcode) ||
+			(RISCV::LHU == opcode) ||
+			(RISCV::LB == opcode) ||
+			(RISCV::LBU == opcode);
 }
 
 /**
- * @brief Get match class for given match.
+ * @brief Get the latency of an opcode from the scheduling model of the core. Cores without a model
+ *        get the default latencies of the machine scheduler: The load latency for loads and one
+ *        cycle for everything else.
  */
-unsigned int RISCVVectorInstrBuilder::getStartPointAt(unsigned int i) {
-	return startPointVec[i];
+unsigned int getLatency(const TargetSchedModel &schedModel, unsigned int opcode) {
+	if(schedModel.hasInstrSchedModel())
+		return schedModel.computeInstrLatency(opcode);
+	return isElementLoad(opcode)? schedModel.getMCSchedModel()->LoadLatency : 1;
 }
 
 /**
- * @brief Get block size for given match.
+ * @brief Get how many cycles a vector operation takes: It waits for the last bank access before
+ *        it (a load, at worst) and then keeps the bank until its result is written back.
  */
-unsigned int RISCVVectorInstrBuilder::getBlockSizeAt(unsigned int i) {
-	return blockSizeVec[i];
+unsigned int getVectorOpCost(const TargetSchedModel &schedModel) {
+	unsigned int distance = RISCVXvecHazardRecognizer::getHazardDistance();
+
+	return std::max(distance, getLatency(schedModel, RISCV::LW) - 1) +
+		std::max(distance + 1, getLatency(schedModel, RISCV::ADDV));
 }
 
 /**
- * @brief Get opcode for given match.
+ * @brief Check if an opcode stores a single element (SW, SH or SB). Narrow elements are truncated
+ *        back by the store itself.
  */
-unsigned int RISCVVectorInstrBuilder::getOpcodeAt(unsigned int i) {
-	return opcodeVec[i];
+bool isElementStore(unsigned int opcode) {
+	return	(RISCV::SW == opcode) ||
+			(RISCV::SH == opcode) ||
+			(RISCV::SB == opcode);
 }
 
 /**
- * @brief Get equivalent vector opcode for given match. Example: If matched opcode is ADDI,
- *        this method will return ADDIV.
+ * @brief Get the vector opcode equivalent to a scalar one (e.g. ADDIV for ADDI), or the scalar
+ *        opcode itself if Xvec has none.
  */
-unsigned int RISCVVectorInstrBuilder::getEqVectorOpcodeAt(unsigned int i) {
-	switch(opcodeVec[i]) {
+unsigned int getVectorOpcode(unsigned int opcode) {
+	switch(opcode) {
 		case RISCV::ADD:
 			return RISCV::ADDV;
 		case RISCV::SUB:
@@ -114,50 +132,377 @@ unsigned int RISCVVectorInstrBuilder::getEqVectorOpcodeAt(unsigned int i) {
 		case RISCV::SRAI:
 			return RISCV::SRAIV;
 		default:
-			return opcodeVec[i];
+			return opcode;
 	}
 }
 
+/**
+ * @brief Check if the operands of an arithmetic operation may be swapped.
+ */
+bool isCommutable(unsigned int opcode) {
+	return	(RISCV::ADD == opcode) ||
+			(RISCV::XOR == opcode) ||
+			(RISCV::OR == opcode) ||
+			(RISCV::AND == opcode);
+}
+
+/**
+ * @brief Get how many instructions a pattern of given class and block size spans.
+ */
+unsigned int getMatchLength(RISCVVectorInstrBuilder::MatchClass matchClass, unsigned int blockSize) {
+	switch(matchClass) {
+		case RISCVVectorInstrBuilder::RR:
+			return blockSize * 4;
+		case RISCVVectorInstrBuilder::RI:
+			return blockSize * 3;
+		case RISCVVectorInstrBuilder::IR:
+			return ((blockSize - 1) * 3) + 4;
+		default:
+			return blockSize * 2;
+	}
+}
+
+/**
+ * @brief Get the width of the block copy element at a given offset: As wide as the alignment
+ *        allows, narrowing down at the tail of the block.
+ */
+unsigned int getBlockCopyWidth(unsigned int size, unsigned int align, unsigned int offset) {
+	unsigned int width = (align >= 4)? 4 : ((align >= 2)? 2 : 1);
+
+	while((offset + width) > size)
+		width /= 2;
+
+	return width;
+}
+
+}
+
+/**
+ * @brief Get how many matches were found.
+ */
+unsigned int RISCVVectorInstrBuilder::getListSize() {
+	return matchVec.size();
+}
+
+/**
+ * @brief Get match class for given match.
+ */
+unsigned int RISCVVectorInstrBuilder::getClassAt(unsigned int i) {
+	return matchVec[i].matchClass;
+}
+
+/**
+ * @brief Get the first matched instruction for given match.
+ */
+MachineBasicBlock::iterator RISCVVectorInstrBuilder::getFirstAt(unsigned int i) {
+	return matchVec[i].first;
+}
+
+/**
+ * @brief Get the last matched instruction for given match.
+ */
+MachineBasicBlock::iterator RISCVVectorInstrBuilder::getLastAt(unsigned int i) {
+	return matchVec[i].last;
+}
+
+/**
+ * @brief Get block size for given match.
+ */
+unsigned int RISCVVectorInstrBuilder::getBlockSizeAt(unsigned int i) {
+	return matchVec[i].blockSize;
+}
+
+/**
+ * @brief Get opcode for given match.
+ */
+unsigned int RISCVVectorInstrBuilder::getOpcodeAt(unsigned int i) {
+	return matchVec[i].opcode;
+}
+
+/**
+ * @brief Get equivalent vector opcode for given match. Example: If matched opcode is ADDI,
+ *        this method will return ADDIV.
+ */
+unsigned int RISCVVectorInstrBuilder::getEqVectorOpcodeAt(unsigned int i) {
+	return getVectorOpcode(matchVec[i].opcode);
+}
+
 /**
  * @brief Get xImm for given match.
  */
 int RISCVVectorInstrBuilder::getXImmAt(unsigned int i) {
-	return xImmVec[i];
+	return matchVec[i].xImm;
+}
+
+/**
+ * @brief Get xAcc for given match.
+ */
+int RISCVVectorInstrBuilder::getXAccAt(unsigned int i) {
+	return matchVec[i].xAcc;
 }
 
 /**
  * @brief Get xAIdx for given match.
  */
 int RISCVVectorInstrBuilder::getXAIdxAt(unsigned int i) {
-	return xAIdxVec[i];
+	return matchVec[i].idx[0];
 }
 
 /**
  * @brief Get xBIdx for given match.
  */
 int RISCVVectorInstrBuilder::getXBIdxAt(unsigned int i) {
-	return xBIdxVec[i];
+	return matchVec[i].idx[1];
 }
 
 /**
  * @brief Get xCIdx for given match.
  */
 int RISCVVectorInstrBuilder::getXCIdxAt(unsigned int i) {
-	return xCIdxVec[i];
+	return matchVec[i].idx[2];
+}
+
+/**
+ * @brief Get xAMemOpcode for given match.
+ */
+unsigned int RISCVVectorInstrBuilder::getXAMemOpcodeAt(unsigned int i) {
+	return matchVec[i].memOpcode[0];
+}
+
+/**
+ * @brief Get xBMemOpcode for given match.
+ */
+unsigned int RISCVVectorInstrBuilder::getXBMemOpcodeAt(unsigned int i) {
+	return matchVec[i].memOpcode[1];
+}
+
+/**
+ * @brief Get xCMemOpcode for given match.
+ */
+unsigned int RISCVVectorInstrBuilder::getXCMemOpcodeAt(unsigned int i) {
+	return matchVec[i].memOpcode[2];
+}
+
+/**
+ * @brief Get xAOffset for given match.
+ */
+int RISCVVectorInstrBuilder::getXAOffsetAt(unsigned int i) {
+	return matchVec[i].offset[0];
+}
+
+/**
+ * @brief Get xBOffset for given match.
+ */
+int RISCVVectorInstrBuilder::getXBOffsetAt(unsigned int i) {
+	return matchVec[i].offset[1];
+}
+
+/**
+ * @brief Get xCOffset for given match.
+ */
+int RISCVVectorInstrBuilder::getXCOffsetAt(unsigned int i) {
+	return matchVec[i].offset[2];
+}
+
+/**
+ * @brief Get xAStride for given match.
+ */
+int RISCVVectorInstrBuilder::getXAStrideAt(unsigned int i) {
+	return matchVec[i].stride[0];
+}
+
+/**
+ * @brief Get xBStride for given match.
+ */
+int RISCVVectorInstrBuilder::getXBStrideAt(unsigned int i) {
+	return matchVec[i].stride[1];
+}
+
+/**
+ * @brief Get xCStride for given match.
+ */
+int RISCVVectorInstrBuilder::getXCStrideAt(unsigned int i) {
+	return matchVec[i].stride[2];
+}
+
+/**
+ * @brief Check if a match takes one of its operands from the vector bank, as left by the previous
+ *        match.
+ */
+bool RISCVVectorInstrBuilder::isChainedAt(unsigned int i) {
+	return -1 != matchVec[i].chainedOperand;
+}
+
+/**
+ * @brief Mark a match so that it is not substituted.
+ */
+void RISCVVectorInstrBuilder::rejectMatchAt(unsigned int i) {
+	matchVec[i].rejected = true;
+
+	/* The matches around it can't be chained through it anymore */
+	matchVec[i].chainedOperand = -1;
+	if(((i + 1) < getListSize()) && (-1 != matchVec[i + 1].chainedOperand))
+		matchVec[i + 1].chainedOperand = -1;
+}
+
+/**
+ * @brief Estimate how many cycles the matched scalar instructions take on a single-issue, in-order
+ *        core: Each instruction issues a cycle after the previous one or once its operands are
+ *        ready, whichever comes last.
+ */
+unsigned int RISCVVectorInstrBuilder::getScalarCostAt(unsigned int i, const TargetSchedModel &schedModel) {
+	DenseMap<unsigned int, unsigned int> ready;
+	unsigned int cycle = 0;
+
+	for(MachineBasicBlock::iterator MI = getFirstAt(i); MI != std::next(getLastAt(i)); MI++) {
+		unsigned int issue = cycle;
+
+		for(const MachineOperand &MO : MI->explicit_operands()) {
+			if(MO.isReg() && MO.isUse() && ready.count(MO.getReg()))
+				issue = std::max(issue, ready[MO.getReg()]);
+		}
+		for(const MachineOperand &MO : MI->explicit_operands()) {
+			if(MO.isReg() && MO.isDef())
+				ready[MO.getReg()] = issue + schedModel.computeInstrLatency(&*MI);
+		}
+		cycle = issue + 1;
+	}
+
+	return cycle;
+}
+
+/**
+ * @brief Estimate how many cycles the Xvec sequence substituted for a match takes, including
+ *        index register moves, bank save/restore and hazard padding.
+ */
+unsigned int RISCVVectorInstrBuilder::getVectorCostAt(unsigned int i, const TargetSchedModel &schedModel) {
+	unsigned int elements = getBlockSizeAt(i);
+	unsigned int cost;
+	int idx[3] = {getXAIdxAt(i), getXBIdxAt(i), getXCIdxAt(i)};
+
+	/**
+	 * A chained match takes one operand from the vector bank. Saving and restoring the bank and
+	 * moving index registers are paid by the first match of the chain
+	 */
+	if(-1 != matchVec[i].chainedOperand) {
+		unsigned int chunks = std::ceil(elements / (double) XVEC_AVAIL_REGS);
+		unsigned int loads = (RR == getClassAt(i))? elements : 0;
+		unsigned int vectorOps = ((RR == getClassAt(i))? 2 : 1) * chunks;
+		return loads + elements + (vectorOps * getVectorOpCost(schedModel));
+	}
+
+	cost = estimateVectorCost((MatchClass) getClassAt(i), elements, schedModel);
+
+	/* Index registers and the accumulator outside x29-x31 are swapped in and out (at worst) */
+	for(unsigned int n = 0; n < 3; n++) {
+		if((idx[n] != -1) && !isOutsideBank(idx[n]))
+			cost += 6;
+	}
+	if((RED == getClassAt(i)) && !isOutsideBank(getXAccAt(i)))
+		cost += 6;
+
+	return cost;
+}
+
+/**
+ * @brief Estimate how many cycles a run of elements takes as scalar code, from the instruction
+ *        count of the pattern: The operation on each element waits for its last load.
+ */
+unsigned int RISCVVectorInstrBuilder::estimateScalarCost(MatchClass matchClass, unsigned int elements,
+		const TargetSchedModel &schedModel) {
+	return getMatchLength(matchClass, elements) + (elements * (getLatency(schedModel, RISCV::LW) - 1));
+}
+
+/**
+ * @brief Estimate how many cycles the Xvec sequence for a run of elements takes, with every index
+ *        register already outside the bank.
+ */
+unsigned int RISCVVectorInstrBuilder::estimateVectorCost(MatchClass matchClass, unsigned int elements,
+		const TargetSchedModel &schedModel) {
+	unsigned int chunks = std::ceil(elements / (double) XVEC_AVAIL_REGS);
+	unsigned int loads;
+	unsigned int stores = elements;
+	unsigned int scalarOps = 0;
+	unsigned int vectorOps;
+
+	switch(matchClass) {
+		case RR:
+			/* Save, restore, then a[] move and operation per chunk */
+			loads = 2 * elements;
+			vectorOps = 2 + (2 * chunks);
+			break;
+		case RI:
+			/* Save, restore, then operation per chunk */
+			loads = elements;
+			vectorOps = 2 + chunks;
+			break;
+		case IR:
+			/* Save, a[] move, restore, then operation per chunk. The immediate fills the whole bank */
+			loads = elements;
+			scalarOps += XVEC_AVAIL_REGS;
+			vectorOps = 3 + chunks;
+			break;
+		default:
+			/**
+			 * Save, accumulator move, restore, then operation per chunk. Lanes left over by the last
+			 * chunk are filled with the identity and all lanes are added up into the accumulator by
+			 * scalar operations
+			 */
+			loads = elements;
+			stores = 0;
+			scalarOps += ((chunks * XVEC_AVAIL_REGS) - elements) + XVEC_AVAIL_REGS;
+			vectorOps = 3 + chunks;
+			break;
+	}
+
+	/* Scalar instructions of the sequence issue back to back, since none reads the result of another */
+	return loads + stores + scalarOps + (vectorOps * getVectorOpCost(schedModel));
+}
+
+/**
+ * @brief Append a match to the matches list.
+ */
+void RISCVVectorInstrBuilder::appendMatch(enum MatchClass matchClass, MachineBasicBlock::iterator first,
+		unsigned int blockSize, unsigned int opcode, int xImm, int xAIdx, int xBIdx, int xCIdx,
+		const unsigned int memOpcode[3], const int offset[3], const int stride[3], int xAcc) {
+	Match match;
+
+	match.matchClass = matchClass;
+	match.first = first;
+	match.last = std::next(first, getMatchLength(matchClass, blockSize) - 1);
+	match.blockSize = blockSize;
+	match.opcode = opcode;
+	match.xImm = xImm;
+	match.xAcc = xAcc;
+	match.idx[0] = xAIdx;
+	match.idx[1] = xBIdx;
+	match.idx[2] = xCIdx;
+	for(unsigned int n = 0; n < 3; n++) {
+		match.memOpcode[n] = memOpcode[n];
+		match.offset[n] = offset[n];
+		match.stride[n] = stride[n];
+	}
+	match.chainedOperand = -1;
+	match.rejected = false;
+
+	matchVec.push_back(match);
 }
 
 /**
  * @brief Check a given basic block for patterns of class RR and appends them to the matches
- *        vectors.
+ *        list.
  */
-bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &MBB) {
+bool RISCVVectorInstrBuilder::checkForVectorPatternRR(MachineBasicBlock &MBB) {
 	bool rv = false;
 	unsigned int matchState = 0;
 	unsigned int point = 0;
 	bool overrideSlide = false;
 	unsigned int startPoint;
+	MachineBasicBlock::iterator first;
 	unsigned int opcode;
-	unsigned int offset;
+	unsigned int memOpcode[3] = {0, 0, 0};
+	int offset[3] = {0, 0, 0};
+	int stride[3] = {0, 0, 0};
 	int xAIdx;
 	int xBIdx;
 	int xCIdx;
@@ -180,7 +525,11 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 	/* Iterate through all instructions */
 	while(true) {
 		unsigned int iOpcode;
-		unsigned int iOffset;
+		unsigned int iMemOpcode[3] = {0, 0, 0};
+		int iOffset[3] = {0, 0, 0};
+		int iStride[3] = {0, 0, 0};
+		int blocks;
+		unsigned int n;
 		int ixA;
 		int ixB;
 		int ixC;
@@ -191,7 +540,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 		bool instructionsMatch;
 		bool registersMatch;
 		bool registersAreDifferent;
-		bool offsetsMatch;
+		bool accessesMatch;
 
 		/* Pattern state machine */
 		switch(matchState) {
@@ -215,7 +564,12 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 
 					/* Get arith opcode and operands for this block */
 					iOpcode = MI2->getOpcode();
-					iOffset = MI0->getOperand(1).getImm();
+					iMemOpcode[0] = MI0->getOpcode();
+					iMemOpcode[1] = MI1->getOpcode();
+					iMemOpcode[2] = MI3->getOpcode();
+					iOffset[0] = MI0->getOperand(1).getImm();
+					iOffset[1] = MI1->getOperand(1).getImm();
+					iOffset[2] = MI3->getOperand(1).getImm();
 					ixA = MI0->getOperand(0).getReg();
 					ixB = MI1->getOperand(0).getReg();
 					ixC = MI2->getOperand(0).getReg();
@@ -225,8 +579,8 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 
 					/* Check if instructions match (LW; LW; ADD/SUB/...; SW) */
 					instructionsMatch =	(
-											(RISCV::LW == MI0->getOpcode()) &&
-											(RISCV::LW == MI1->getOpcode()) &&
+											isElementLoad(MI0->getOpcode()) &&
+											isElementLoad(MI1->getOpcode()) &&
 											(
 												(RISCV::ADD == iOpcode) ||
 												(RISCV::SUB == iOpcode) ||
@@ -239,9 +593,24 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 												(RISCV::OR == iOpcode) ||
 												(RISCV::AND == iOpcode)
 											) &&
-											(RISCV::SW == MI3->getOpcode())
+											isElementStore(MI3->getOpcode())
 										);
 
+					/**
+					 * The operation may read xB first. This is fine for commutable operations. For the
+					 * others (e.g. SUB), swap the roles of both loads so that xA is always the first operand
+					 */
+					if(
+						!isCommutable(iOpcode) &&
+						((unsigned int) ixB == MI2->getOperand(1).getReg()) &&
+						((unsigned int) ixA == MI2->getOperand(2).getReg())
+					) {
+						std::swap(ixA, ixB);
+						std::swap(ixAIdx, ixBIdx);
+						std::swap(iMemOpcode[0], iMemOpcode[1]);
+						std::swap(iOffset[0], iOffset[1]);
+					}
+
 					/* Check if registers match */
 					registersMatch =	(
 											(
@@ -276,24 +645,22 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 												(ixAIdx != ixCIdx) &&
 												(ixBIdx != ixCIdx)
 											);
-
-					/* Check if address offset matches */
-					offsetsMatch =	(
-										(0 == iOffset) &&
-										(iOffset == MI1->getOperand(1).getImm()) &&
-										(iOffset == MI3->getOperand(1).getImm())
-									);
 				}
 				else {
 					operandsConsistent = false;
 				}
 
 				/* If all matches are true, we found a block! */
-				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent && offsetsMatch) {
+				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent) {
 					/* Save information */
 					startPoint = point;
+					first = MI0;
 					opcode = iOpcode;
-					offset = iOffset;
+					for(n = 0; n < 3; n++) {
+						memOpcode[n] = iMemOpcode[n];
+						offset[n] = iOffset[n];
+						stride[n] = 0;
+					}
 					xAIdx = ixAIdx;
 					xBIdx = ixBIdx;
 					xCIdx = ixCIdx;
@@ -336,7 +703,12 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 
 					/* Get arith opcode and operands for this block */
 					iOpcode = MI2->getOpcode();
-					iOffset = MI0->getOperand(1).getImm();
+					iMemOpcode[0] = MI0->getOpcode();
+					iMemOpcode[1] = MI1->getOpcode();
+					iMemOpcode[2] = MI3->getOpcode();
+					iOffset[0] = MI0->getOperand(1).getImm();
+					iOffset[1] = MI1->getOperand(1).getImm();
+					iOffset[2] = MI3->getOperand(1).getImm();
 					ixA = MI0->getOperand(0).getReg();
 					ixB = MI1->getOperand(0).getReg();
 					ixC = MI2->getOperand(0).getReg();
@@ -346,8 +718,8 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 
 					/* Check if instructions match (LW; LW; ADD/SUB/...; SW) */
 					instructionsMatch =	(
-											(RISCV::LW == MI0->getOpcode()) &&
-											(RISCV::LW == MI1->getOpcode()) &&
+											isElementLoad(MI0->getOpcode()) &&
+											isElementLoad(MI1->getOpcode()) &&
 											(
 												(RISCV::ADD == iOpcode) ||
 												(RISCV::SUB == iOpcode) ||
@@ -360,9 +732,24 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 												(RISCV::OR == iOpcode) ||
 												(RISCV::AND == iOpcode)
 											) &&
-											(RISCV::SW == MI3->getOpcode())
+											isElementStore(MI3->getOpcode())
 										);
 
+					/**
+					 * The operation may read xB first. This is fine for commutable operations. For the
+					 * others (e.g. SUB), swap the roles of both loads so that xA is always the first operand
+					 */
+					if(
+						!isCommutable(iOpcode) &&
+						((unsigned int) ixB == MI2->getOperand(1).getReg()) &&
+						((unsigned int) ixA == MI2->getOperand(2).getReg())
+					) {
+						std::swap(ixA, ixB);
+						std::swap(ixAIdx, ixBIdx);
+						std::swap(iMemOpcode[0], iMemOpcode[1]);
+						std::swap(iOffset[0], iOffset[1]);
+					}
+
 					/* Check if registers match */
 					registersMatch =	(
 											(
@@ -397,56 +784,46 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 												(ixAIdx != ixCIdx) &&
 												(ixBIdx != ixCIdx)
 											);
-
-					/* Check if address offset matches */
-					offsetsMatch =	(
-										(iOffset == MI1->getOperand(1).getImm()) &&
-										(iOffset == MI3->getOperand(1).getImm())
-									);
 				}
 				else {
 					operandsConsistent = false;
 				}
 
 				/* If all matches are true, we found a block! */
-				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent && offsetsMatch) {
-					/* Update offset */
-					offset += 4;
+				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent) {
+					/**
+					 * Elements may be any constant distance apart: It is given by the second block and
+					 * must be kept by the following ones. Widths must not change either.
+					 */
+					blocks = (point - startPoint) / 4;
+					accessesMatch = true;
+					for(n = 0; n < 3; n++) {
+						iStride[n] = (1 == blocks)? (iOffset[n] - offset[n]) : stride[n];
+						accessesMatch = accessesMatch && (memOpcode[n] == iMemOpcode[n]) && ((offset[n] + (blocks * iStride[n])) == iOffset[n]);
+					}
 
 					/* If any of these differs, it means that this match is over */
 					if(
 						(opcode != iOpcode) ||
 						(xAIdx != ixAIdx) || (xBIdx != ixBIdx) || (xCIdx != ixCIdx) ||
-						(offset != iOffset)
+						!accessesMatch
 					) {
 						/* We're finished with this match. Save information to the lists */
-						classVec.push_back(MatchClass::RR);
-						startPointVec.push_back(startPoint);
-						blockSizeVec.push_back((point - startPoint) / 4);
-						opcodeVec.push_back(opcode);
-						xImmVec.push_back(-1);
-						xAIdxVec.push_back(xAIdx);
-						xBIdxVec.push_back(xBIdx);
-						xCIdxVec.push_back(xCIdx);
+						appendMatch(MatchClass::RR, first, (point - startPoint) / 4, opcode, -1, xAIdx, xBIdx, xCIdx, memOpcode, offset, stride);
 
 						rv = true;
 						overrideSlide = true;
 						matchState = 0;
 					}
 					else {
+						for(n = 0; n < 3; n++)
+							stride[n] = iStride[n];
 						matchState = 3;
 					}
 				}
 				else {
 					/* We're finished with this match. Save information to the lists */
-					classVec.push_back(MatchClass::RR);
-					startPointVec.push_back(startPoint);
-					blockSizeVec.push_back((point - startPoint) / 4);
-					opcodeVec.push_back(opcode);
-					xImmVec.push_back(-1);
-					xAIdxVec.push_back(xAIdx);
-					xBIdxVec.push_back(xBIdx);
-					xCIdxVec.push_back(xCIdx);
+					appendMatch(MatchClass::RR, first, (point - startPoint) / 4, opcode, -1, xAIdx, xBIdx, xCIdx, memOpcode, offset, stride);
 
 					rv = true;
 					overrideSlide = true;
@@ -471,8 +848,14 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 			MI0 = MI1;
 			MI1 = MI2;
 			MI2 = MI3;
-			if(MI == MBB.end())
+			if(MI == MBB.end()) {
+				/* The basic block ends within reach of the current match. Save the blocks found so far */
+				if(matchState) {
+					appendMatch(MatchClass::RR, first, ((point - startPoint) / 4) + 1, opcode, -1, xAIdx, xBIdx, xCIdx, memOpcode, offset, stride);
+					rv = true;
+				}
 				return rv;
+			}
 			MI3 = MI++;
 
 			point++;
@@ -487,16 +870,19 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRR(const MachineBasicBlock &M
 
 /**
  * @brief Check a given basic block for patterns of class RI and appends them to the matches
- *        vectors.
+ *        list.
  */
-bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &MBB) {
+bool RISCVVectorInstrBuilder::checkForVectorPatternRI(MachineBasicBlock &MBB) {
 	bool rv = false;
 	unsigned int matchState = 0;
 	unsigned int point = 0;
 	bool overrideSlide = false;
 	unsigned int startPoint;
+	MachineBasicBlock::iterator first;
 	unsigned int opcode;
-	unsigned int offset;
+	unsigned int memOpcode[3] = {0, 0, 0};
+	int offset[3] = {0, 0, 0};
+	int stride[3] = {0, 0, 0};
 	int xImm;
 	int xAIdx;
 	int xCIdx;
@@ -516,7 +902,11 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 	/* Iterate through all instructions */
 	while(true) {
 		unsigned int iOpcode;
-		unsigned int iOffset;
+		unsigned int iMemOpcode[3] = {0, 0, 0};
+		int iOffset[3] = {0, 0, 0};
+		int iStride[3] = {0, 0, 0};
+		int blocks;
+		unsigned int n;
 		int ixA;
 		int ixImm;
 		int ixC;
@@ -526,7 +916,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 		bool instructionsMatch;
 		bool registersMatch;
 		bool registersAreDifferent;
-		bool offsetsMatch;
+		bool accessesMatch;
 
 		/* Pattern state machine */
 		switch(matchState) {
@@ -548,7 +938,10 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 
 					/* Get arith opcode and operands for this block */
 					iOpcode = MI1->getOpcode();
-					iOffset = MI0->getOperand(1).getImm();
+					iMemOpcode[0] = MI0->getOpcode();
+					iMemOpcode[2] = MI2->getOpcode();
+					iOffset[0] = MI0->getOperand(1).getImm();
+					iOffset[2] = MI2->getOperand(1).getImm();
 					ixA = MI0->getOperand(0).getReg();
 					ixImm = MI1->getOperand(2).getImm();
 					ixC = MI1->getOperand(0).getReg();
@@ -557,7 +950,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 
 					/* Check if instructions match (LW; ADDI/SUBI/...; SW) */
 					instructionsMatch =	(
-											(RISCV::LW == MI0->getOpcode()) &&
+											isElementLoad(MI0->getOpcode()) &&
 											(
 												(RISCV::ADDI == iOpcode) ||
 												(RISCV::SLTI == iOpcode) ||
@@ -569,7 +962,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 												(RISCV::SRLI == iOpcode) ||
 												(RISCV::SRAI == iOpcode)
 											) &&
-											(RISCV::SW == MI2->getOpcode())
+											isElementStore(MI2->getOpcode())
 										);
 
 					/* Check if registers match */
@@ -587,12 +980,6 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 												(ixA != ixCIdx) &&
 												(ixAIdx != ixCIdx)
 											);
-
-					/* Check if address offset matches */
-					offsetsMatch =	(
-										(0 == iOffset) &&
-										(iOffset == MI2->getOperand(1).getImm())
-									);
 				}
 				else {
 					operandsConsistent = false;
@@ -600,11 +987,16 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 
 			
 				/* If all matches are true, we found a block! */
-				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent && offsetsMatch) {
+				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent) {
 					/* Save information */
 					startPoint = point;
+					first = MI0;
 					opcode = iOpcode;
-					offset = iOffset;
+					for(n = 0; n < 3; n += 2) {
+						memOpcode[n] = iMemOpcode[n];
+						offset[n] = iOffset[n];
+						stride[n] = 0;
+					}
 					xImm = ixImm;
 					xAIdx = ixAIdx;
 					xCIdx = ixCIdx;
@@ -645,7 +1037,10 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 
 					/* Get arith opcode and operands for this block */
 					iOpcode = MI1->getOpcode();
-					iOffset = MI0->getOperand(1).getImm();
+					iMemOpcode[0] = MI0->getOpcode();
+					iMemOpcode[2] = MI2->getOpcode();
+					iOffset[0] = MI0->getOperand(1).getImm();
+					iOffset[2] = MI2->getOperand(1).getImm();
 					ixA = MI0->getOperand(0).getReg();
 					ixImm = MI1->getOperand(2).getImm();
 					ixC = MI1->getOperand(0).getReg();
@@ -654,7 +1049,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 
 					/* Check if instructions match (LW; ADDI/SUBI/...; SW) */
 					instructionsMatch =	(
-											(RISCV::LW == MI0->getOpcode()) &&
+											isElementLoad(MI0->getOpcode()) &&
 											(
 												(RISCV::ADDI == iOpcode) ||
 												(RISCV::SLTI == iOpcode) ||
@@ -666,12 +1061,12 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 												(RISCV::SRLI == iOpcode) ||
 												(RISCV::SRAI == iOpcode)
 											) &&
-											(RISCV::SW == MI2->getOpcode())
+											isElementStore(MI2->getOpcode())
 										);
 
 					/* Check if registers match */
 					registersMatch =	(
-											((unsigned int) ixA == MI1->getOperand(0).getReg()) &&
+											((unsigned int) ixA == MI1->getOperand(1).getReg()) &&
 											((unsigned int) ixC == MI2->getOperand(0).getReg())
 										);
 
@@ -684,56 +1079,47 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 												(ixA != ixCIdx) &&
 												(ixAIdx != ixCIdx)
 											);
-
-					/* Check if address offset matches */
-					offsetsMatch =	(
-										(iOffset == MI2->getOperand(1).getImm())
-									);
 				}
 				else {
 					operandsConsistent = false;
 				}
 
 				/* If all matches are true, we found a block! */
-				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent && offsetsMatch) {
-					/* Update offset */
-					offset += 4;
+				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent) {
+					/**
+					 * Elements may be any constant distance apart: It is given by the second block and
+					 * must be kept by the following ones. Widths must not change either.
+					 */
+					blocks = (point - startPoint) / 3;
+					accessesMatch = true;
+					for(n = 0; n < 3; n += 2) {
+						iStride[n] = (1 == blocks)? (iOffset[n] - offset[n]) : stride[n];
+						accessesMatch = accessesMatch && (memOpcode[n] == iMemOpcode[n]) && ((offset[n] + (blocks * iStride[n])) == iOffset[n]);
+					}
 
 					/* If any of these differs, it means that this match is over */
 					if(
 						(opcode != iOpcode) ||
 						(xImm != ixImm) ||
 						(xAIdx != ixAIdx) || (xCIdx != ixCIdx) ||
-						(offset != iOffset)
+						!accessesMatch
 					) {
 						/* We're finished with this match. Save information to the lists */
-						classVec.push_back(MatchClass::RI);
-						startPointVec.push_back(startPoint);
-						blockSizeVec.push_back((point - startPoint) / 3);
-						opcodeVec.push_back(opcode);
-						xImmVec.push_back(xImm);
-						xAIdxVec.push_back(xAIdx);
-						xBIdxVec.push_back(-1);
-						xCIdxVec.push_back(xCIdx);
+						appendMatch(MatchClass::RI, first, (point - startPoint) / 3, opcode, xImm, xAIdx, -1, xCIdx, memOpcode, offset, stride);
 
 						rv = true;
 						overrideSlide = true;
 						matchState = 0;
 					}
 					else {
+						for(n = 0; n < 3; n += 2)
+							stride[n] = iStride[n];
 						matchState = 3;
 					}
 				}
 				else {
 					/* We're finished with this match. Save information to the lists */
-					classVec.push_back(MatchClass::RI);
-					startPointVec.push_back(startPoint);
-					blockSizeVec.push_back((point - startPoint) / 3);
-					opcodeVec.push_back(opcode);
-					xImmVec.push_back(xImm);
-					xAIdxVec.push_back(xAIdx);
-					xBIdxVec.push_back(-1);
-					xCIdxVec.push_back(xCIdx);
+					appendMatch(MatchClass::RI, first, (point - startPoint) / 3, opcode, xImm, xAIdx, -1, xCIdx, memOpcode, offset, stride);
 
 					rv = true;
 					overrideSlide = true;
@@ -757,8 +1143,14 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 		if(!overrideSlide) {
 			MI0 = MI1;
 			MI1 = MI2;
-			if(MI == MBB.end())
+			if(MI == MBB.end()) {
+				/* The basic block ends within reach of the current match. Save the blocks found so far */
+				if(matchState) {
+					appendMatch(MatchClass::RI, first, ((point - startPoint) / 3) + 1, opcode, xImm, xAIdx, -1, xCIdx, memOpcode, offset, stride);
+					rv = true;
+				}
 				return rv;
+			}
 			MI2 = MI++;
 
 			point++;
@@ -773,16 +1165,19 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternRI(const MachineBasicBlock &M
 
 /**
  * @brief Check a given basic block for patterns of class IR and appends them to the matches
- *        vectors.
+ *        list.
  */
-bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &MBB) {
+bool RISCVVectorInstrBuilder::checkForVectorPatternIR(MachineBasicBlock &MBB) {
 	bool rv = false;
 	unsigned int matchState = 0;
 	unsigned int point = 0;
 	bool overrideSlide = false;
 	unsigned int startPoint;
+	MachineBasicBlock::iterator first;
 	unsigned int opcode;
-	unsigned int offset;
+	unsigned int memOpcode[3] = {0, 0, 0};
+	int offset[3] = {0, 0, 0};
+	int stride[3] = {0, 0, 0};
 	int xA;
 	int xImm;
 	int xBIdx;
@@ -806,7 +1201,11 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 	/* Iterate through all instructions */
 	while(true) {
 		unsigned int iOpcode;
-		unsigned int iOffset;
+		unsigned int iMemOpcode[3] = {0, 0, 0};
+		int iOffset[3] = {0, 0, 0};
+		int iStride[3] = {0, 0, 0};
+		int blocks;
+		unsigned int n;
 		int ixA;
 		int ixImm;
 		int ixB;
@@ -817,7 +1216,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 		bool instructionsMatch;
 		bool registersMatch;
 		bool registersAreDifferent;
-		bool offsetsMatch;
+		bool accessesMatch;
 
 		/* Pattern state machine */
 		switch(matchState) {
@@ -841,7 +1240,10 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 
 					/* Get arith opcode and operands for this block */
 					iOpcode = MI2->getOpcode();
-					iOffset = MI0->getOperand(1).getImm();
+					iMemOpcode[1] = MI0->getOpcode();
+					iMemOpcode[2] = MI3->getOpcode();
+					iOffset[1] = MI0->getOperand(1).getImm();
+					iOffset[2] = MI3->getOperand(1).getImm();
 					ixA = MI1->getOperand(0).getReg();
 					ixImm = MI1->getOperand(1).getImm();
 					ixB = MI0->getOperand(0).getReg();
@@ -851,7 +1253,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 
 					/* Check if instructions match (LW; LI; ADD/SUB/...; SW) */
 					instructionsMatch =	(
-											(RISCV::LW == MI0->getOpcode()) &&
+											isElementLoad(MI0->getOpcode()) &&
 											(RISCV::LI == MI1->getOpcode()) &&
 											(
 												(RISCV::ADD == iOpcode) ||
@@ -865,7 +1267,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 												(RISCV::OR == iOpcode) ||
 												(RISCV::AND == iOpcode)
 											) &&
-											(RISCV::SW == MI3->getOpcode())
+											isElementStore(MI3->getOpcode())
 										);
 
 					/* Check if registers match */
@@ -889,23 +1291,22 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 												(ixC != ixCIdx) &&
 												(ixBIdx != ixCIdx)
 											);
-
-					/* Check if address offset matches */
-					offsetsMatch =	(
-										(0 == iOffset) &&
-										(iOffset == MI3->getOperand(1).getImm())
-									);
 				}
 				else {
 					operandsConsistent = false;
 				}
 
 				/* If all matches are true, we found a block! */
-				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent && offsetsMatch) {
+				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent) {
 					/* Save information */
 					startPoint = point;
+					first = MI0;
 					opcode = iOpcode;
-					offset = iOffset;
+					for(n = 1; n < 3; n++) {
+						memOpcode[n] = iMemOpcode[n];
+						offset[n] = iOffset[n];
+						stride[n] = 0;
+					}
 					xA = ixA;
 					xImm = ixImm;
 					xBIdx = ixBIdx;
@@ -944,7 +1345,10 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 
 					/* Get arith opcode and operands for this block */
 					iOpcode = MI1->getOpcode();
-					iOffset = MI0->getOperand(1).getImm();
+					iMemOpcode[1] = MI0->getOpcode();
+					iMemOpcode[2] = MI2->getOpcode();
+					iOffset[1] = MI0->getOperand(1).getImm();
+					iOffset[2] = MI2->getOperand(1).getImm();
 					ixA = MI1->getOperand(1).getReg();
 					ixB = MI0->getOperand(0).getReg();
 					ixC = MI1->getOperand(0).getReg();
@@ -953,7 +1357,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 
 					/* Check if instructions match (LW; ADD/SUB/...; SW) */
 					instructionsMatch =	(
-											(RISCV::LW == MI0->getOpcode()) &&
+											isElementLoad(MI0->getOpcode()) &&
 											(
 												(RISCV::ADD == iOpcode) ||
 												(RISCV::SUB == iOpcode) ||
@@ -966,7 +1370,7 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 												(RISCV::OR == iOpcode) ||
 												(RISCV::AND == iOpcode)
 											) &&
-											(RISCV::SW == MI2->getOpcode())
+											isElementStore(MI2->getOpcode())
 										);
 
 					/* Check if registers match */
@@ -990,56 +1394,47 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 												(ixC != ixCIdx) &&
 												(ixBIdx != ixCIdx)
 											);
-
-					/* Check if address offset matches */
-					offsetsMatch =	(
-										(iOffset == MI2->getOperand(1).getImm())
-									);
 				}
 				else {
 					operandsConsistent = false;
 				}
 
 				/* If all matches are true, we found a block! */
-				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent && offsetsMatch) {
-					/* Update offset */
-					offset += 4;
+				if(operandsConsistent && instructionsMatch && registersMatch && registersAreDifferent) {
+					/**
+					 * Elements may be any constant distance apart: It is given by the second block and
+					 * must be kept by the following ones. Widths must not change either.
+					 */
+					blocks = ((point - (startPoint + 4)) / 3) + 1;
+					accessesMatch = true;
+					for(n = 1; n < 3; n++) {
+						iStride[n] = (1 == blocks)? (iOffset[n] - offset[n]) : stride[n];
+						accessesMatch = accessesMatch && (memOpcode[n] == iMemOpcode[n]) && ((offset[n] + (blocks * iStride[n])) == iOffset[n]);
+					}
 
 					/* If any of these differs, it means that this match is over */
 					if(
 						(opcode != iOpcode) ||
 						(xA != ixA) ||
 						(xBIdx != ixBIdx) || (xCIdx != ixCIdx) ||
-						(offset != iOffset)
+						!accessesMatch
 					) {
 						/* We're finished with this match. Save information to the lists */
-						classVec.push_back(MatchClass::IR);
-						startPointVec.push_back(startPoint);
-						blockSizeVec.push_back(((point - (startPoint + 4)) / 3) + 1);
-						opcodeVec.push_back(opcode);
-						xImmVec.push_back(xImm);
-						xAIdxVec.push_back(-1);
-						xBIdxVec.push_back(xBIdx);
-						xCIdxVec.push_back(xCIdx);
+						appendMatch(MatchClass::IR, first, ((point - (startPoint + 4)) / 3) + 1, opcode, xImm, -1, xBIdx, xCIdx, memOpcode, offset, stride);
 
 						rv = true;
 						overrideSlide = true;
 						matchState = 0;
 					}
 					else {
+						for(n = 1; n < 3; n++)
+							stride[n] = iStride[n];
 						matchState = 3;
 					}
 				}
 				else {
 					/* We're finished with this match. Save information to the lists */
-					classVec.push_back(MatchClass::IR);
-					startPointVec.push_back(startPoint);
-					blockSizeVec.push_back(((point - (startPoint + 4)) / 3) + 1);
-					opcodeVec.push_back(opcode);
-					xImmVec.push_back(xImm);
-					xAIdxVec.push_back(-1);
-					xBIdxVec.push_back(xBIdx);
-					xCIdxVec.push_back(xCIdx);
+					appendMatch(MatchClass::IR, first, ((point - (startPoint + 4)) / 3) + 1, opcode, xImm, -1, xBIdx, xCIdx, memOpcode, offset, stride);
 
 					rv = true;
 					overrideSlide = true;
@@ -1064,8 +1459,14 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 			MI0 = MI1;
 			MI1 = MI2;
 			MI2 = MI3;
-			if(MI == MBB.end())
+			if(MI == MBB.end()) {
+				/* The basic block ends within reach of the current match. Save the blocks found so far */
+				if(matchState) {
+					appendMatch(MatchClass::IR, first, (1 == matchState)? 1 : (((point - (startPoint + 4)) / 3) + 2), opcode, xImm, -1, xBIdx, xCIdx, memOpcode, offset, stride);
+					rv = true;
+				}
 				return rv;
+			}
 			MI3 = MI++;
 
 			point++;
@@ -1079,46 +1480,212 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 }
 
 /**
- * @brief Expansion macro: Insert 3 NOPs.
+ * @brief Check a given basic block for patterns of class RED and appends them to the matches
+ *        list.
+ */
+bool RISCVVectorInstrBuilder::checkForVectorPatternRED(MachineBasicBlock &MBB) {
+	bool rv = false;
+	unsigned int blocks = 0;
+	MachineBasicBlock::iterator first;
+	unsigned int opcode;
+	unsigned int memOpcode[3] = {0, 0, 0};
+	int offset[3] = {0, 0, 0};
+	int stride[3] = {0, 0, 0};
+	int xAIdx;
+	int xAcc;
+
+	/* Iterate through all instructions, 2 at a time while a match goes on */
+	MachineBasicBlock::iterator MI = MBB.begin();
+	while(MI != MBB.end()) {
+		MachineBasicBlock::iterator MI0 = MI;
+		MachineBasicBlock::iterator MI1 = std::next(MI);
+		unsigned int iOpcode;
+		unsigned int iMemOpcode = 0;
+		int iOffset = 0;
+		int iStride;
+		int ixA;
+		int ixAIdx;
+		int ixAcc;
+		bool blockFound = false;
+
+		/**
+		 * Check if both instructions are consistent regarding number of operands and their types. If
+		 * instructions are consistent, we can then check if everything fits.
+		 */
+		if(
+			(MI1 != MBB.end()) &&
+			(3 == MI0->getNumOperands()) &&
+			(3 == MI1->getNumOperands()) &&
+			(MI0->getOperand(0).isReg() && MI0->getOperand(1).isImm() && MI0->getOperand(2).isReg()) &&
+			(MI1->getOperand(0).isReg() && MI1->getOperand(1).isReg() && MI1->getOperand(2).isReg())
+		) {
+			/* Get arith opcode and operands for this block */
+			iOpcode = MI1->getOpcode();
+			iMemOpcode = MI0->getOpcode();
+			iOffset = MI0->getOperand(1).getImm();
+			ixA = MI0->getOperand(0).getReg();
+			ixAIdx = MI0->getOperand(2).getReg();
+			ixAcc = MI1->getOperand(0).getReg();
+
+			/**
+			 * Check if instructions match (LW; ADD/XOR/OR/AND), the operation accumulating the loaded
+			 * element (in any operand order, since all these operations are commutable). Found
+			 * registers must be different among them.
+			 */
+			blockFound =	(
+								isElementLoad(iMemOpcode) &&
+								(
+									(RISCV::ADD == iOpcode) ||
+									(RISCV::XOR == iOpcode) ||
+									(RISCV::OR == iOpcode) ||
+									(RISCV::AND == iOpcode)
+								) &&
+								(
+									(
+										((unsigned int) ixAcc == MI1->getOperand(1).getReg()) &&
+										((unsigned int) ixA == MI1->getOperand(2).getReg())
+									) ||
+									(
+										((unsigned int) ixA == MI1->getOperand(1).getReg()) &&
+										((unsigned int) ixAcc == MI1->getOperand(2).getReg())
+									)
+								) &&
+								(ixA != ixAcc) &&
+								(ixA != ixAIdx) &&
+								(ixAcc != ixAIdx)
+							);
+		}
+
+		/* If the block continues the current match, go on to the next one */
+		if(blockFound && blocks) {
+			iStride = (1 == blocks)? (iOffset - offset[0]) : stride[0];
+
+			if(
+				(opcode == iOpcode) &&
+				(xAIdx == ixAIdx) && (xAcc == ixAcc) &&
+				(memOpcode[0] == iMemOpcode) && ((offset[0] + ((int) blocks * iStride)) == iOffset)
+			) {
+				stride[0] = iStride;
+				blocks++;
+				MI = std::next(MI1);
+				continue;
+			}
+		}
+
+		/* Otherwise we're finished with the current match. Save information to the lists */
+		if(blocks) {
+			appendMatch(MatchClass::RED, first, blocks, opcode, -1, xAIdx, -1, -1, memOpcode, offset, stride, xAcc);
+			rv = true;
+			blocks = 0;
+		}
+
+		/* A block that does not continue a match may start a new one */
+		if(blockFound) {
+			first = MI0;
+			blocks = 1;
+			opcode = iOpcode;
+			memOpcode[0] = iMemOpcode;
+			offset[0] = iOffset;
+			stride[0] = 0;
+			xAIdx = ixAIdx;
+			xAcc = ixAcc;
+			MI = std::next(MI1);
+		}
+		else {
+			MI++;
+		}
+	}
+
+	/* The basic block ends within the current match. Save information to the lists */
+	if(blocks) {
+		appendMatch(MatchClass::RED, first, blocks, opcode, -1, xAIdx, -1, -1, memOpcode, offset, stride, xAcc);
+		rv = true;
+	}
+
+	return rv;
+}
+
+/**
+ * @brief Check if a load and the operation consuming it may form one element of a RED pattern.
  */
-#define EXPAND_3NOP() {\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(RISCV::ADDI), rvRegs[0])\
-			.addReg(rvRegs[0]).addImm(0);\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(RISCV::ADDI), rvRegs[0])\
-			.addReg(rvRegs[0]).addImm(0);\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(RISCV::ADDI), rvRegs[0])\
-			.addReg(rvRegs[0]).addImm(0);\
+bool RISCVVectorInstrBuilder::isReductionStep(const MachineInstr &load, const MachineInstr &op) {
+	return	isElementLoad(load.getOpcode()) &&
+			(
+				(RISCV::ADD == op.getOpcode()) ||
+				(RISCV::XOR == op.getOpcode()) ||
+				(RISCV::OR == op.getOpcode()) ||
+				(RISCV::AND == op.getOpcode())
+			);
+}
+
+/**
+ * @brief Check if a load, the operation consuming it and the store of its result may form one
+ *        element of an RR, RI or IR pattern.
+ */
+bool RISCVVectorInstrBuilder::isElementStep(const MachineInstr &load, const MachineInstr &op,
+		const MachineInstr &store) {
+	return	isElementLoad(load.getOpcode()) &&
+			(getVectorOpcode(op.getOpcode()) != op.getOpcode()) &&
+			isElementStore(store.getOpcode());
+}
+
+/**
+ * @brief Mark the registers of the vector bank as implicitly read by a vector operation that reads
+ *        bank 1 and as implicitly written by one that writes it, so that post-RA passes do not move
+ *        scalar code across it. Operations between other banks only depend on their named banks.
+ */
+void RISCVVectorInstrBuilder::addVectorBankOperands(MachineInstrBuilder &MIB) {
+	bool readsBank = false;
+	bool writesBank = rvRegs[1] == MIB->getOperand(0).getReg();
+	for(unsigned int i = 1; i < MIB->getNumOperands(); i++) {
+		const MachineOperand &MO = MIB->getOperand(i);
+		if(MO.isReg() && (rvRegs[1] == MO.getReg()))
+			readsBank = true;
+	}
+
+	for(unsigned int l = 1; l <= XVEC_AVAIL_REGS; l++) {
+		if(readsBank)
+			MIB.addReg(rvRegs[l], RegState::Implicit);
+		if(writesBank)
+			MIB.addReg(rvRegs[l], RegState::ImplicitDefine);
+	}
 }
 
 /**
  * @brief Expansion macro: Insert an immediate vector arithmetic operation.
  */
 #define EXPAND_OPIV(op, rc, ra, ib) {\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op), rc)\
+	MachineInstrBuilder MIB = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op), rc)\
 			.addReg(ra).addImm(ib);\
+	addVectorBankOperands(MIB);\
+	MI = MIB;\
 }
 
 /**
- * @brief Expansion macro: Insert a word store.
+ * @brief Expansion macro: Insert an element store (SW, SH or SB).
+ * @note The stored register is a use, not a def, or the post-RA passes would
+ * take the store for the last write of the bank lane.
  */
-#define EXPAND_SW(ra, off, rc) {\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(RISCV::SW), ra)\
-			.addImm(off).addReg(rc);\
+#define EXPAND_STORE(op, ra, off, rc) {\
+	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op))\
+			.addReg(ra).addImm(off).addReg(rc);\
 }
 
 /**
  * @brief Expansion macro: Insert a vector arithmetic operation.
  */
 #define EXPAND_OPV(op, rc, ra, rb) {\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op), rc)\
+	MachineInstrBuilder MIB = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op), rc)\
 			.addReg(ra).addReg(rb);\
+	addVectorBankOperands(MIB);\
+	MI = MIB;\
 }
 
 /**
- * @brief Expansion macro: Insert a word load.
+ * @brief Expansion macro: Insert an element load (LW, LH, LHU, LB or LBU).
  */
-#define EXPAND_LW(rc, off, ra) {\
-	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(RISCV::LW), rc)\
+#define EXPAND_LOAD(op, rc, off, ra) {\
+	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op), rc)\
 			.addImm(off).addReg(ra);\
 }
 
@@ -1130,6 +1697,14 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 			.addReg(ra).addReg(rb);\
 }
 
+/**
+ * @brief Expansion macro: Insert an immediate arithmetic operation.
+ */
+#define EXPAND_OPI(op, rc, ra, ib) {\
+	MI = BuildMI(*MBB, MI, DL, Subtarget->getInstrInfo()->get(op), rc)\
+			.addReg(ra).addImm(ib);\
+}
+
 /**
  * @brief Expansion macro: Insert an immediate load.
  */
@@ -1139,266 +1714,517 @@ bool RISCVVectorInstrBuilder::checkForVectorPatternIR(const MachineBasicBlock &M
 }
 
 /**
- * @brief Substitute all present matches in the matches vectors.
+ * @brief Expansion macro: Move index register idx out of the vector bank, into rel. If rel is dead
+ *        after the sequence a single copy suffices, since the bank restore brings idx back.
+ *        Otherwise both registers are swapped.
  */
-void RISCVVectorInstrBuilder::substituteAllMatches(MachineBasicBlock *MBB, const RISCVSubtarget *Subtarget) {
+#define EXPAND_IDX_SAVE(idx, rel, copy) {\
+	if((unsigned int) (idx) != (rel)) {\
+		if(copy) {\
+			EXPAND_OPI(RISCV::ADDI, rel, idx, 0);\
+		}\
+		else {\
+			EXPAND_OP(RISCV::XOR, rel, rel, idx);\
+			EXPAND_OP(RISCV::XOR, idx, idx, rel);\
+			EXPAND_OP(RISCV::XOR, rel, rel, idx);\
+		}\
+	}\
+}
+
+/**
+ * @brief Expansion macro: Undo EXPAND_IDX_SAVE after the vector sequence.
+ */
+#define EXPAND_IDX_RESTORE(idx, rel, copy) {\
+	if(((unsigned int) (idx) != (rel)) && !(copy)) {\
+		EXPAND_OP(RISCV::XOR, rel, rel, idx);\
+		EXPAND_OP(RISCV::XOR, idx, idx, rel);\
+		EXPAND_OP(RISCV::XOR, rel, rel, idx);\
+	}\
+}
+
+/**
+ * @brief Expansion macro: Bring the accumulator of a reduction back from rel, where EXPAND_IDX_SAVE
+ *        moved it. Unlike index registers, the accumulator must not keep its value from before the
+ *        sequence.
+ */
+#define EXPAND_ACC_RESTORE(acc, rel, copy) {\
+	if((unsigned int) (acc) != (rel)) {\
+		if(copy) {\
+			EXPAND_OPI(RISCV::ADDI, acc, rel, 0);\
+		}\
+		else {\
+			EXPAND_OP(RISCV::XOR, rel, rel, acc);\
+			EXPAND_OP(RISCV::XOR, acc, acc, rel);\
+			EXPAND_OP(RISCV::XOR, rel, rel, acc);\
+		}\
+	}\
+}
+
+/**
+ * @brief Get how many instructions of the basic block a given match spans.
+ */
+unsigned int RISCVVectorInstrBuilder::getMatchLengthAt(unsigned int i) {
+	return getMatchLength(matchVec[i].matchClass, matchVec[i].blockSize);
+}
+
+/**
+ * @brief Check if a register is left untouched by vector operations.
+ */
+bool RISCVVectorInstrBuilder::isOutsideBank(unsigned int reg) {
+	return (rvRegs[0] == reg) || (rvRegs[29] == reg) || (rvRegs[30] == reg) || (rvRegs[31] == reg);
+}
+
+/**
+ * @brief Put the matches list in basic block order.
+ */
+void RISCVVectorInstrBuilder::sortMatches(MachineBasicBlock &MBB) {
+	DenseMap<const MachineInstr *, unsigned int> matchAt;
+	std::vector<Match> sorted;
+	unsigned int seen = 0;
+	const MachineInstr *busyUntil = nullptr;
+
 	/**
-	 * The beginning of a block is stored in the matches list as the position of first instruction.
-	 * This means that substituting from top to bottom of a basic block would invalidate such data
-	 * (since the number of instructions will vary from before to after). Thus, we iterate the list
-	 * in reverse, substituting from bottom to top.
+	 * Matches are appended class by class, and each one is found by its first instruction. Patterns
+	 * of classes RR, RI and IR never share instructions: RI is the only class with immediate
+	 * operations, IR is the only one with LI and a continued IR block (LW; OP; SW) can't follow a RR
+	 * block. A RED block (LW; OP) however may also be the tail of a RR or IR block whose result
+	 * overwrites an operand. In that case the match that starts first is kept
 	 */
-	for(int i = (getListSize() - 1); i >= 0; i--) {
-		unsigned int j = 0;
-		bool isInside = false;
-		DebugLoc DL;
-
-		/* First step: Remove matched instructions */
-		// TODO: Implement some sort of lower limitant: If the block size is too small, there is no reason to perform substitution.
-		for(MachineBasicBlock::iterator MI = MBB->begin(); MI != MBB->end(); j++) {
-			/* Each case must be dealt separately, since block sizes varies */
-			switch(getClassAt(i)) {
-				case RR:
-					isInside = (j >= getStartPointAt(i) && j < (getStartPointAt(i) + (getBlockSizeAt(i) * 4)));
-					break;
-				case RI:
-					isInside = (j >= getStartPointAt(i) && j < (getStartPointAt(i) + (getBlockSizeAt(i) * 3)));
-					break;
-				case IR:
-					isInside = (j >= getStartPointAt(i) && j < (getStartPointAt(i) + ((getBlockSizeAt(i) - 1) * 3) + 4));
-					break;
+	for(unsigned int i = 0; i < getListSize(); i++)
+		matchAt[&*getFirstAt(i)] = i;
+	for(MachineBasicBlock::iterator MI = MBB.begin(); (MI != MBB.end()) && (seen < matchAt.size()); MI++) {
+		auto found = matchAt.find(&*MI);
+		if(found != matchAt.end()) {
+			seen++;
+			if(busyUntil) {
+				DEBUG(dbgs() << "Dropping match overlapping a previous one at " << *MI);
 			}
+			else {
+				sorted.push_back(matchVec[found->second]);
+				busyUntil = &*sorted.back().last;
+			}
+		}
+		if(busyUntil == &*MI)
+			busyUntil = nullptr;
+	}
+
+	matchVec.swap(sorted);
+}
+
+/**
+ * @brief Add the index registers of a match to a set of at most 3 registers.
+ */
+bool RISCVVectorInstrBuilder::addIndexRegisters(const Match &match, int regs[3], unsigned int &amt) {
+	int newRegs[3];
+	unsigned int newAmt = amt;
+
+	for(unsigned int j = 0; j < amt; j++)
+		newRegs[j] = regs[j];
+	for(unsigned int n = 0; n < 3; n++) {
+		unsigned int j;
+
+		if(-1 == match.idx[n])
+			continue;
+		for(j = 0; j < newAmt; j++) {
+			if(newRegs[j] == match.idx[n])
+				break;
+		}
+		if(j < newAmt)
+			continue;
+		if(3 == newAmt)
+			return false;
+		newRegs[newAmt++] = match.idx[n];
+	}
+
+	for(unsigned int j = 0; j < newAmt; j++)
+		regs[j] = newRegs[j];
+	amt = newAmt;
+	return true;
+}
+
+/**
+ * @brief Check if a match may take one of its operands from the vector bank, as left by the
+ *        previous match.
+ */
+int RISCVVectorInstrBuilder::getChainedOperand(const Match &prev, const Match &cur) {
+	/**
+	 * Both matches must be adjacent and span the same elements. The intermediate result must be
+	 * whole words, since the vector bank does not truncate narrow elements as SH or SB would. IR
+	 * keeps its immediate in x2 throughout the sequence and RED its partial results, so both are
+	 * left out of chains.
+	 */
+	if(
+		(std::next(prev.last) != cur.first) ||
+		(prev.blockSize != cur.blockSize) ||
+		(IR == prev.matchClass) || (IR == cur.matchClass) ||
+		(RED == prev.matchClass) || (RED == cur.matchClass) ||
+		(RISCV::SW != prev.memOpcode[2])
+	)
+		return -1;
+
+	for(unsigned int n = 0; n < ((RR == cur.matchClass)? 2 : 1); n++) {
+		if(
+			(RISCV::LW == cur.memOpcode[n]) &&
+			(prev.idx[2] == cur.idx[n]) &&
+			(prev.offset[2] == cur.offset[n]) &&
+			(prev.stride[2] == cur.stride[n])
+		)
+			return n;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Find matches that read the result of the match right before them and chain them.
+ */
+void RISCVVectorInstrBuilder::chainMatches(MachineBasicBlock &MBB) {
+	int regs[3];
+	unsigned int amt = 0;
+
+	sortMatches(MBB);
+
+	/* Every index register of a chain must fit in x29 to x31 for the whole sequence */
+	for(unsigned int i = 0; i < getListSize(); i++) {
+		int operand = i? getChainedOperand(matchVec[i - 1], matchVec[i]) : -1;
+
+		if((-1 == operand) || !addIndexRegisters(matchVec[i], regs, amt)) {
+			operand = -1;
+			amt = 0;
+			addIndexRegisters(matchVec[i], regs, amt);
+		}
+		matchVec[i].chainedOperand = operand;
+	}
+}
+
+/**
+ * @brief Expand one chunk of XVEC_AVAIL_REGS elements (or less) of a match. Instructions are added
+ *        in reverse order, before MI.
+ */
+void RISCVVectorInstrBuilder::expandChunk(MachineBasicBlock *MBB, MachineBasicBlock::iterator &MI, const DebugLoc &DL,
+		const RISCVSubtarget *Subtarget, unsigned int i, unsigned int k, unsigned int opsCur, const unsigned int rel[3]) {
+	/* Element accesses of a[], b[] and c[]: Element e is accessed at offset[n] + (e * stride[n]) */
+	const Match &match = matchVec[i];
+	const unsigned int *memOpcode = match.memOpcode;
+	const int *offset = match.offset;
+	const int *stride = match.stride;
+
+	/* Store results */
+	if(RED != match.matchClass) {
+		for(int l = opsCur - 1; l >= 0; l--)
+			EXPAND_STORE(memOpcode[2], rvRegs[l + 1], offset[2] + (stride[2] * ((XVEC_AVAIL_REGS * k) + l)), rel[2]);
+	}
 
-			/* We're inside the block. Remove instructions */
-			if(isInside) {
-				// TODO: Remove
-				std::cout << "Removing " << MI->getOpcode() << " at position " << j << " with DebugLoc " << MI->getDebugLoc() << std::endl;
-				DL = MI->getDebugLoc();
-				MI = MBB->erase(MI);
+	switch(match.matchClass) {
+		case RR:
+			if(1 == match.chainedOperand) {
+				/* Vector operation: c[] = a[] OP b[], b[] being the previous result */
+				EXPAND_OPV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[1], rvRegs[2]);
+				/* Load a[] operands */
+				for(int l = opsCur - 1; l >= 0; l--)
+					EXPAND_LOAD(memOpcode[0], rvRegs[l + 1], offset[0] + (stride[0] * ((XVEC_AVAIL_REGS * k) + l)), rel[0]);
+				/* ADDIV: Move b[] operands */
+				EXPAND_OPIV(RISCV::ADDIV, rvRegs[2], rvRegs[1], 0);
+				break;
+			}
+
+			/* Vector operation: c[] = a[] OP b[] */
+			EXPAND_OPV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[2], rvRegs[1]);
+			/* Load b[] operands */
+			for(int l = opsCur - 1; l >= 0; l--)
+				EXPAND_LOAD(memOpcode[1], rvRegs[l + 1], offset[1] + (stride[1] * ((XVEC_AVAIL_REGS * k) + l)), rel[1]);
+			/* ADDIV: Move a[] operands */
+			EXPAND_OPIV(RISCV::ADDIV, rvRegs[2], rvRegs[1], 0);
+			/* Load a[] operands, unless they are the previous result */
+			if(-1 == match.chainedOperand) {
+				for(int l = opsCur - 1; l >= 0; l--)
+					EXPAND_LOAD(memOpcode[0], rvRegs[l + 1], offset[0] + (stride[0] * ((XVEC_AVAIL_REGS * k) + l)), rel[0]);
+			}
+			break;
+		case RI:
+			/* Vector operation: c[] = a[] OPI b */
+			EXPAND_OPIV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[1], getXImmAt(i));
+			/* Load a[] operands, unless they are the previous result */
+			if(-1 == match.chainedOperand) {
+				for(int l = opsCur - 1; l >= 0; l--)
+					EXPAND_LOAD(memOpcode[0], rvRegs[l + 1], offset[0] + (stride[0] * ((XVEC_AVAIL_REGS * k) + l)), rel[0]);
+			}
+			break;
+		case IR:
+			/* Vector operation: c[] = a OP b[] */
+			EXPAND_OPV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[2], rvRegs[1]);
+			/* Load b[] operands */
+			for(int l = opsCur - 1; l >= 0; l--)
+				EXPAND_LOAD(memOpcode[1], rvRegs[l + 1], offset[1] + (stride[1] * ((XVEC_AVAIL_REGS * k) + l)), rel[1]);
+			break;
+		case RED:
+			/* Vector operation: Accumulate a[] in x2 (the first chunk just initialises it) */
+			if(k) {
+				EXPAND_OPV(getEqVectorOpcodeAt(i), rvRegs[2], rvRegs[2], rvRegs[1]);
 			}
 			else {
-				++MI;
+				EXPAND_OPIV(RISCV::ADDIV, rvRegs[2], rvRegs[1], 0);
+			}
+			/* Lanes left over by a partial chunk take the identity of the operation */
+			for(int l = XVEC_AVAIL_REGS - 1; l >= (int) opsCur; l--)
+				EXPAND_LI(rvRegs[l + 1], (RISCV::AND == match.opcode)? -1 : 0);
+			/* Load a[] operands */
+			for(int l = opsCur - 1; l >= 0; l--)
+				EXPAND_LOAD(memOpcode[0], rvRegs[l + 1], offset[0] + (stride[0] * ((XVEC_AVAIL_REGS * k) + l)), rel[0]);
+			break;
+	}
+}
+
+/**
+ * @brief Substitute all matches that were not rejected, in a single bottom to top pass over the
+ *        basic block.
+ */
+void RISCVVectorInstrBuilder::substituteAllMatches(MachineBasicBlock *MBB, const RISCVSubtarget *Subtarget) {
+	sortMatches(*MBB);
+
+	/**
+	 * Matches are substituted from bottom to top, so that the registers live after each of them are
+	 * known from a single backward walk over the basic block. A match is only reached through its
+	 * first and last instructions, which substituting the matches below it leaves untouched.
+	 * Matches that are not worth substituting were already rejected by RISCVXvecVectorize (see
+	 * getScalarCostAt() and getVectorCostAt()).
+	 */
+	LivePhysRegs live(Subtarget->getRegisterInfo());
+	MachineBasicBlock::iterator liveCursor = MBB->end();
+	live.addLiveOuts(*MBB);
+
+	for(int t = (getListSize() - 1); t >= 0; t--) {
+		int h;
+		unsigned int j;
+		unsigned int n;
+		unsigned int r;
+
+		if(matchVec[t].rejected)
+			continue;
+
+		/**
+		 * Matches h to t form a chain: Each one takes an operand from the vector bank, as left by the
+		 * previous one. They are substituted by a single vector sequence, one chunk at a time.
+		 */
+		for(h = t; -1 != matchVec[h].chainedOperand; h--);
+
+		MachineBasicBlock::iterator MI = std::next(getLastAt(t));
+		DebugLoc DL = getLastAt(t)->getDebugLoc();
+
+		/* Registers live right after the chain decide how index registers are moved around */
+		while(liveCursor != MI)
+			live.stepBackward(*(--liveCursor));
+
+		/**
+		 * Index registers of the chain and where they are kept during the vector sequence. Registers
+		 * x29 to x31 are left untouched by vector operations, so index registers that are already
+		 * there need not be moved. The others take whatever is left.
+		 */
+		int idx[3];
+		unsigned int idxAmt = 0;
+		unsigned int rel[3] = {0, 0, 0};
+		bool copy[3] = {false, false, false};
+		for(int m = h; m <= t; m++)
+			addIndexRegisters(matchVec[m], idx, idxAmt);
+
+		/* The accumulator of a reduction is moved out of the vector bank just like index registers */
+		int accAt = -1;
+		if(RED == getClassAt(h)) {
+			accAt = idxAmt;
+			idx[idxAmt++] = getXAccAt(h);
+		}
+		for(j = 0; j < idxAmt; j++) {
+			if(isOutsideBank(idx[j]))
+				rel[j] = idx[j];
+		}
+		for(j = 0; j < idxAmt; j++) {
+			if(rel[j])
+				continue;
+			for(r = 29; r < 31; r++) {
+				if((rel[0] != rvRegs[r]) && (rel[1] != rvRegs[r]) && (rel[2] != rvRegs[r]))
+					break;
 			}
+			rel[j] = rvRegs[r];
+			copy[j] = !live.contains(rel[j]);
 		}
 
-		/* Second step: Add new instructions */
-		j = 0;
-		for(MachineBasicBlock::iterator MI = MBB->begin(); MI != MBB->end(); j++) {
-			if(getStartPointAt(i) == j) {
-				/* Calculate how many unrolls will be performed, since only XVEC_AVAIL_REGS are available at a time */
-				unsigned int opsAmt = std::ceil(getBlockSizeAt(i) / (double) XVEC_AVAIL_REGS);
-				unsigned int opsRem = getBlockSizeAt(i) % XVEC_AVAIL_REGS;
-				unsigned int opsCur;
+		/* First step: Remove matched instructions, carrying liveness over them */
+		while(liveCursor != getFirstAt(h))
+			live.stepBackward(*(--liveCursor));
+		for(MachineBasicBlock::iterator J = getFirstAt(h); J != MI;) {
+			DEBUG(dbgs() << "Removing " << *J);
+			J = MBB->erase(J);
+		}
 
-				/* opsRem == 0 means that a whole full of XVEC_AVAIL_REGS registers should be operated */
-				if(!opsRem)
-					opsRem = XVEC_AVAIL_REGS;
+		/* Second step: Add new instructions, right where the matched ones were */
 
-				/**
-				 * Note: all instructions are added in reverse order!
-				 */
-				switch(getClassAt(i)) {
-					case RR:
-						/* Swap (restore) c[] indexer register with register 31 if both are different */
-						if(getXCIdxAt(i) != rvRegs[31]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXCIdxAt(i), getXCIdxAt(i), rvRegs[31]);
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-						}
-						/* Swap (restore) b[] indexer register with register 30 if both are different */
-						if(getXBIdxAt(i) != rvRegs[30]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXBIdxAt(i), getXBIdxAt(i), rvRegs[30]);
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-						}
-						/* Swap (restore) a[] indexer register with register 29 if both are different */
-						if(getXAIdxAt(i) != rvRegs[29]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXAIdxAt(i), getXAIdxAt(i), rvRegs[29]);
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-						}
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Restore general purpose registers */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[1], rvRegs[3], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Iterate every XVEC_AVAIL_REGS */
-						for(int k = opsAmt - 1; k >= 0; k--) {
-							opsCur = ((opsAmt - 1) == (unsigned int) k)? opsRem : XVEC_AVAIL_REGS;
-
-							/* Store results */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_SW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[31]);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Vector operation: c[] = a[] OP b[] */
-							EXPAND_OPV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[2], rvRegs[1]);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Load b[] operands */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_LW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[30]);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* ADDIV: Move a[] operands */
-							EXPAND_OPIV(RISCV::ADDIV, rvRegs[2], rvRegs[1], 0);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Load a[] operands */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_LW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[29]);
-						}
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Save general purpose registers */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[3], rvRegs[1], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Swap c[] indexer register with register 31 if both are different */
-						if(getXCIdxAt(i) != rvRegs[31]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXCIdxAt(i), getXCIdxAt(i), rvRegs[31]);
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-						}
-						/* Swap b[] indexer register with register 30 if both are different */
-						if(getXBIdxAt(i) != rvRegs[30]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXBIdxAt(i), getXBIdxAt(i), rvRegs[30]);
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-						}
-						/* Swap a[] indexer register with register 29 if both are different */
-						if(getXAIdxAt(i) != rvRegs[29]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXAIdxAt(i), getXAIdxAt(i), rvRegs[29]);
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-						}
-						break;
-					case RI:
-						/* Swap (restore) c[] indexer register with register 31 if both are different */
-						if(getXCIdxAt(i) != rvRegs[31]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXCIdxAt(i), getXCIdxAt(i), rvRegs[31]);
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-						}
-						/* Swap (restore) a[] indexer register with register 29 if both are different */
-						if(getXAIdxAt(i) != rvRegs[29]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXAIdxAt(i), getXAIdxAt(i), rvRegs[29]);
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-						}
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Restore general purpose registers */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[1], rvRegs[3], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Iterate every XVEC_AVAIL_REGS */
-						for(int k = opsAmt - 1; k >= 0; k--) {
-							opsCur = ((opsAmt - 1) == (unsigned int) k)? opsRem : XVEC_AVAIL_REGS;
-
-							/* Store results */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_SW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[31]);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Vector operation: c[] = a[] OPI b */
-							EXPAND_OPIV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[1], getXImmAt(i));
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Load a[] operands */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_LW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[29]);
-						}
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Save general purpose registers */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[3], rvRegs[1], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Swap c[] indexer register with register 31 if both are different */
-						if(getXCIdxAt(i) != rvRegs[31]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXCIdxAt(i), getXCIdxAt(i), rvRegs[31]);
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-						}
-						/* Swap a[] indexer register with register 29 if both are different */
-						if(getXAIdxAt(i) != rvRegs[29]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXAIdxAt(i), getXAIdxAt(i), rvRegs[29]);
-							EXPAND_OP(RISCV::XOR, rvRegs[29], rvRegs[29], getXAIdxAt(i));
-						}
-						break;
-					case IR:
-						/* Swap (restore) c[] indexer register with register 31 if both are different */
-						if(getXCIdxAt(i) != rvRegs[31]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXCIdxAt(i), getXCIdxAt(i), rvRegs[31]);
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-						}
-						/* Swap (restore) b[] indexer register with register 30 if both are different */
-						if(getXBIdxAt(i) != rvRegs[30]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXBIdxAt(i), getXBIdxAt(i), rvRegs[30]);
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-						}
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Restore general purpose registers */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[1], rvRegs[3], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Iterate every XVEC_AVAIL_REGS */
-						for(int k = opsAmt - 1; k >= 0; k--) {
-							opsCur = ((opsAmt - 1) == (unsigned int) k)? opsRem : XVEC_AVAIL_REGS;
-
-							/* Store results */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_SW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[31]);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Vector operation: c[] = a OP b[] */
-							EXPAND_OPV(getEqVectorOpcodeAt(i), rvRegs[1], rvRegs[2], rvRegs[1]);
-							/* Isolation of vector operation with 3 NOPs */
-							EXPAND_3NOP();
-							/* Load b[] operands */
-							for(int l = opsCur - 1; l >= 0; l--)
-								EXPAND_LW(rvRegs[l + 1], (4 * ((XVEC_AVAIL_REGS * k) + l)), rvRegs[30]);
-						}
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Move a[] operands */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[2], rvRegs[1], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Load a[] operands */
-						for(int l = XVEC_AVAIL_REGS; l > 0; l--)
-							EXPAND_LI(rvRegs[l], getXImmAt(i));
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* ADDIV: Save general purpose registers */
-						EXPAND_OPIV(RISCV::ADDIV, rvRegs[3], rvRegs[1], 0);
-						/* Isolation of vector operation with 3 NOPs */
-						EXPAND_3NOP();
-						/* Swap c[] indexer register with register 31 if both are different */
-						if(getXCIdxAt(i) != rvRegs[31]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXCIdxAt(i), getXCIdxAt(i), rvRegs[31]);
-							EXPAND_OP(RISCV::XOR, rvRegs[31], rvRegs[31], getXCIdxAt(i));
-						}
-						/* Swap b[] indexer register with register 30 if both are different */
-						if(getXBIdxAt(i) != rvRegs[30]) {
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-							EXPAND_OP(RISCV::XOR, getXBIdxAt(i), getXBIdxAt(i), rvRegs[30]);
-							EXPAND_OP(RISCV::XOR, rvRegs[30], rvRegs[30], getXBIdxAt(i));
-						}
-						break;
-				}
-				break;
+		/* Calculate how many unrolls will be performed, since only XVEC_AVAIL_REGS are available at a time */
+		unsigned int opsAmt = std::ceil(getBlockSizeAt(h) / (double) XVEC_AVAIL_REGS);
+		unsigned int opsRem = getBlockSizeAt(h) % XVEC_AVAIL_REGS;
+		unsigned int opsCur;
+
+		/* opsRem == 0 means that a whole full of XVEC_AVAIL_REGS registers should be operated */
+		if(!opsRem)
+			opsRem = XVEC_AVAIL_REGS;
+
+		/**
+		 * Note: all instructions are added in reverse order! Vector operations are not isolated
+		 * here: RISCVXvecPadding pads them afterwards, according to RISCVXvecHazardRecognizer.
+		 */
+
+		/* Move (restore) indexer registers and the accumulator back */
+		for(j = 0; j < idxAmt; j++) {
+			if((int) j == accAt) {
+				EXPAND_ACC_RESTORE(idx[j], rel[j], copy[j]);
 			}
 			else {
-				++MI;
+				EXPAND_IDX_RESTORE(idx[j], rel[j], copy[j]);
+			}
+		}
+		/* ADDIV: Restore general purpose registers */
+		EXPAND_OPIV(RISCV::ADDIV, rvRegs[1], rvRegs[3], 0);
+		if(RED == getClassAt(h)) {
+			/**
+			 * Add the partial results up: Half of the lanes are accumulated into the other half until a
+			 * single lane is left, which is accumulated into the accumulator. Lanes of x1 are plain
+			 * registers, so scalar operations do it
+			 */
+			SmallVector<std::pair<unsigned int, unsigned int>, XVEC_AVAIL_REGS> steps;
+			for(unsigned int w = XVEC_AVAIL_REGS; w > 1; w -= (w / 2)) {
+				for(unsigned int l = 0; l < (w / 2); l++)
+					steps.push_back(std::make_pair(l + 1, l + 1 + (w - (w / 2))));
+			}
+			EXPAND_OP(getOpcodeAt(h), rel[accAt], rel[accAt], rvRegs[1]);
+			for(auto step = steps.rbegin(); step != steps.rend(); step++)
+				EXPAND_OP(getOpcodeAt(h), rvRegs[step->first], rvRegs[step->first], rvRegs[step->second]);
+			/* ADDIV: Move partial results */
+			EXPAND_OPIV(RISCV::ADDIV, rvRegs[1], rvRegs[2], 0);
+		}
+		/* Iterate every XVEC_AVAIL_REGS, running the whole chain on each chunk */
+		for(int k = opsAmt - 1; k >= 0; k--) {
+			opsCur = ((opsAmt - 1) == (unsigned int) k)? opsRem : XVEC_AVAIL_REGS;
+
+			for(int m = t; m >= h; m--) {
+				unsigned int mRel[3] = {0, 0, 0};
+
+				for(n = 0; n < 3; n++) {
+					for(j = 0; j < idxAmt; j++) {
+						if(idx[j] == matchVec[m].idx[n])
+							mRel[n] = rel[j];
+					}
+				}
+				expandChunk(MBB, MI, DL, Subtarget, m, k, opsCur, mRel);
 			}
 		}
+		if(IR == getClassAt(h)) {
+			/* ADDIV: Move a[] operands */
+			EXPAND_OPIV(RISCV::ADDIV, rvRegs[2], rvRegs[1], 0);
+			/* Load a[] operands */
+			for(int l = XVEC_AVAIL_REGS; l > 0; l--)
+				EXPAND_LI(rvRegs[l], getXImmAt(h));
+		}
+		/* ADDIV: Save general purpose registers */
+		EXPAND_OPIV(RISCV::ADDIV, rvRegs[3], rvRegs[1], 0);
+		/* Move indexer registers and the accumulator out of the vector bank */
+		for(j = idxAmt; j-- > 0;)
+			EXPAND_IDX_SAVE(idx[j], rel[j], copy[j]);
+
+		/* Liveness above the chain is carried on from its first new instruction */
+		liveCursor = MI;
+		t = h;
+	}
+}
+
+unsigned int RISCVVectorInstrBuilder::getBlockCopyElements(unsigned int size, unsigned int align) {
+	unsigned int elements = 0;
+
+	for(unsigned int offset = 0; offset < size; offset += getBlockCopyWidth(size, align, offset))
+		elements++;
+
+	return elements;
+}
+
+void RISCVVectorInstrBuilder::expandBlockCopy(MachineInstr &copyMI, const RISCVSubtarget *Subtarget) {
+	MachineBasicBlock *MBB = copyMI.getParent();
+	MachineBasicBlock::iterator MI = copyMI;
+	DebugLoc DL = copyMI.getDebugLoc();
+	unsigned int size = copyMI.getOperand(2).getImm();
+	unsigned int align = copyMI.getOperand(3).getImm();
+	unsigned int j;
+	unsigned int r;
+
+	/* Registers live right after the copy decide how the address registers are moved around */
+	LivePhysRegs live(Subtarget->getRegisterInfo());
+	live.addLiveOuts(*MBB);
+	for(MachineBasicBlock::iterator J = MBB->end(); J != std::next(MI);)
+		live.stepBackward(*(--J));
+
+	/**
+	 * Address registers (destination and source) and where they are kept during the copy, just like
+	 * index registers of a match (see substituteAllMatches()).
+	 */
+	int idx[2] = {(int) copyMI.getOperand(0).getReg(), (int) copyMI.getOperand(1).getReg()};
+	unsigned int idxAmt = (idx[0] == idx[1])? 1 : 2;
+	unsigned int rel[2] = {0, 0};
+	bool copy[2] = {false, false};
+	for(j = 0; j < idxAmt; j++) {
+		if(isOutsideBank(idx[j]))
+			rel[j] = idx[j];
+	}
+	for(j = 0; j < idxAmt; j++) {
+		if(rel[j])
+			continue;
+		for(r = 29; r < 31; r++) {
+			if((rel[0] != rvRegs[r]) && (rel[1] != rvRegs[r]))
+				break;
+		}
+		rel[j] = rvRegs[r];
+		copy[j] = !live.contains(rel[j]);
+	}
+	unsigned int dstRel = rel[0];
+	unsigned int srcRel = rel[idxAmt - 1];
+
+	/* Elements of the block, as (offset, width) */
+	SmallVector<std::pair<unsigned int, unsigned int>, XVEC_AVAIL_REGS> elements;
+	for(unsigned int offset = 0; offset < size;) {
+		unsigned int width = getBlockCopyWidth(size, align, offset);
+		elements.push_back(std::make_pair(offset, width));
+		offset += width;
+	}
+	unsigned int opsAmt = std::ceil(elements.size() / (double) XVEC_AVAIL_REGS);
+
+	/**
+	 * Note: all instructions are added in reverse order! Vector operations are padded afterwards, just
+	 * like those of substituted matches.
+	 */
+
+	/* Move (restore) address registers back */
+	for(j = 0; j < idxAmt; j++)
+		EXPAND_IDX_RESTORE(idx[j], rel[j], copy[j]);
+	/* ADDIV: Restore general purpose registers */
+	EXPAND_OPIV(RISCV::ADDIV, rvRegs[1], rvRegs[3], 0);
+	/* Iterate every XVEC_AVAIL_REGS: Load a whole chunk, then store it */
+	for(int k = opsAmt - 1; k >= 0; k--) {
+		unsigned int base = XVEC_AVAIL_REGS * k;
+		unsigned int opsCur = std::min<unsigned int>(XVEC_AVAIL_REGS, elements.size() - base);
+
+		for(int l = opsCur - 1; l >= 0; l--) {
+			const std::pair<unsigned int, unsigned int> &e = elements[base + l];
+			unsigned int op = (4 == e.second)? RISCV::SW : ((2 == e.second)? RISCV::SH : RISCV::SB);
+			EXPAND_STORE(op, rvRegs[l + 1], e.first, dstRel);
+		}
+		for(int l = opsCur - 1; l >= 0; l--) {
+			const std::pair<unsigned int, unsigned int> &e = elements[base + l];
+			unsigned int op = (4 == e.second)? RISCV::LW : ((2 == e.second)? RISCV::LHU : RISCV::LBU);
+			EXPAND_LOAD(op, rvRegs[l + 1], e.first, srcRel);
+		}
 	}
+	/* ADDIV: Save general purpose registers */
+	EXPAND_OPIV(RISCV::ADDIV, rvRegs[3], rvRegs[1], 0);
+	/* Move address registers out of the vector bank */
+	for(j = idxAmt; j-- > 0;)
+		EXPAND_IDX_SAVE(idx[j], rel[j], copy[j]);
+
+	DEBUG(dbgs() << "Expanding " << copyMI);
+	copyMI.eraseFromParent();
 }
@@ -30,15 +30,19 @@
 #ifndef LLVM_LIB_TARGET_RISCV_RISCVVECTORINSTRBUILDER_H
 #define LLVM_LIB_TARGET_RISCV_RISCVVECTORINSTRBUILDER_H
 
-#include "RISCVAsmPrinter.h"
+#include "RISCVSubtarget.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
-#include "llvm/CodeGen/MachineModuleInfoImpls.h"
 
 /* Maximum available registers for one vector operation */
 #define XVEC_AVAIL_REGS 28
 
+/* Maximum size of a block copy, so that every element is reached by a 12-bit load/store offset */
+#define XVEC_BLOCK_COPY_MAX 2048
+
 namespace llvm {
 
+class TargetSchedModel;
+
 class RISCVVectorInstrBuilder {
 public:
 	/**
@@ -47,62 +51,191 @@ public:
 	enum MatchClass {
 		RR,
 		RI,
-		IR
+		IR,
+		RED
 	};
 
 private:
 	/**
-	 * @brief Vector with classes of each matched pattern.
+	 * @brief A matched pattern: Which instructions of the basic block it spans and what the vector
+	 *        sequence substituted for them looks like.
 	 */
-	std::vector<enum MatchClass> classVec;
+	struct Match {
+		/**
+		 * @brief Class of the pattern.
+		 */
+		enum MatchClass matchClass;
+
+		/**
+		 * @brief First instruction of the pattern within the basic block.
+		 */
+		MachineBasicBlock::iterator first;
+
+		/**
+		 * @brief Last instruction of the pattern within the basic block. The last instruction is kept
+		 *        instead of the one following it, since the latter may belong to the next match and be
+		 *        erased when that one is substituted.
+		 */
+		MachineBasicBlock::iterator last;
+
+		/**
+		 * @brief Number of elements (blocks) of the pattern.
+		 */
+		unsigned int blockSize;
+
+		/**
+		 * @brief Operation opcode.
+		 */
+		unsigned int opcode;
+
+		/**
+		 * @brief Identified immediate (first or second operand). -1 for cases RR and RED.
+		 */
+		int xImm;
+
+		/**
+		 * @brief Accumulator register of case RED. -1 for the other cases.
+		 */
+		int xAcc;
+
+		/**
+		 * @brief Index registers (indexed load or store) of xA (first operand), xB (second operand)
+		 *        and xC (result).
+		 * @note For case IR there's no xA load, for case RI there's no xB load and for case RED
+		 *       there's neither xB load nor xC store. Therefore -1 will be stored instead.
+		 */
+		int idx[3];
+
+		/**
+		 * @brief Load opcodes (LW, LH, LHU, LB or LBU) of xA and xB and store opcode (SW, SH or SB) of
+		 *        xC.
+		 * @note 0 is stored for operands that are not loaded.
+		 */
+		unsigned int memOpcode[3];
+
+		/**
+		 * @brief Address offset of the first element of xA, xB and xC.
+		 * @note 0 is stored for operands that are not loaded.
+		 */
+		int offset[3];
+
+		/**
+		 * @brief Distance in bytes between consecutive elements of xA, xB and xC.
+		 * @note 0 is stored for operands that are not loaded and for single element matches.
+		 */
+		int stride[3];
+
+		/**
+		 * @brief Operand (0 for xA, 1 for xB) that is not loaded, but taken from the vector bank as
+		 *        left by the previous match (see chainMatches()). -1 if the match is not chained.
+		 */
+		int chainedOperand;
+
+		/**
+		 * @brief Whether the pattern was rejected (see rejectMatchAt()).
+		 */
+		bool rejected;
+	};
 
 	/**
-	 * @brief Vector with start point (first instruction within basic block) of each matched pattern.
-	 *        Start point counts include pseudo instructions.
+	 * @brief Matched patterns, in the order they were found.
 	 */
-	std::vector<unsigned int> startPointVec;
+	std::vector<Match> matchVec;
 
 	/**
-	 * @brief Vector with block size of each matched pattern.
+	 * @brief Mapping of RV32I general-purpose registers.
+	 * @note x8 is fp: its alias s0 is in no register class, which the verifier rejects.
 	 */
-	std::vector<unsigned int> blockSizeVec;
+	unsigned int rvRegs[32] = {
+		RISCV::zero, RISCV::ra, RISCV::sp, RISCV::gp, RISCV::tp, RISCV::t0, RISCV::t1, RISCV::t2,
+		RISCV::fp, RISCV::s1, RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3, RISCV::a4, RISCV::a5,
+		RISCV::a6, RISCV::a7, RISCV::s2, RISCV::s3, RISCV::s4, RISCV::s5, RISCV::s6, RISCV::s7,
+		RISCV::s8, RISCV::s9, RISCV::s10, RISCV::s11, RISCV::t3, RISCV::t4, RISCV::t5, RISCV::t6
+	};
 
 	/**
-	 * @brief Vector with operation opcode of each matched pattern.
+	 * @brief Add the vector bank (x1 to x28) as implicit uses of a vector operation reading bank 1
+	 *        and as implicit definitions of one writing it.
+	 *
+	 * @param MIB The builder of the vector operation.
 	 */
-	std::vector<unsigned int> opcodeVec;
+	void addVectorBankOperands(MachineInstrBuilder &MIB);
 
 	/**
-	 * @brief Vector with identified immediates (first or second operands) of each matched pattern.
+	 * @brief Append a match to the matches list.
+	 *
+	 * @param matchClass Class of the match.
+	 * @param first First instruction of the match.
+	 * @param blockSize Block size of the match.
+	 * @param opcode Operation opcode of the match.
+	 * @param xImm xImm of the match (-1 for case RR).
+	 * @param xAIdx xAIdx of the match.
+	 * @param xBIdx xBIdx of the match.
+	 * @param xCIdx xCIdx of the match.
+	 * @param memOpcode xAMemOpcode, xBMemOpcode and xCMemOpcode of the match.
+	 * @param offset xAOffset, xBOffset and xCOffset of the match.
+	 * @param stride xAStride, xBStride and xCStride of the match.
+	 * @param xAcc xAcc of the match (-1 except for case RED).
 	 */
-	std::vector<int> xImmVec;
+	void appendMatch(enum MatchClass matchClass, MachineBasicBlock::iterator first, unsigned int blockSize,
+			unsigned int opcode, int xImm, int xAIdx, int xBIdx, int xCIdx, const unsigned int memOpcode[3],
+			const int offset[3], const int stride[3], int xAcc = -1);
 
 	/**
-	 * @brief Vector with index register (indexed load) for xA (first operand) of each matched pattern.
-	 * @note For case IR, there's no such indexed load. Therefore -1 will be stored instead.
+	 * @brief Put the matches list in basic block order, dropping matches that start within a
+	 *        previous one.
+	 *
+	 * @param MBB The MachineBasicBlock where the matches were found.
 	 */
-	std::vector<int> xAIdxVec;
+	void sortMatches(MachineBasicBlock &MBB);
 
 	/**
-	 * @brief Vector with index register (indexed load) for xB (second operand) of each matched pattern.
-	 * @note For case RI, there's no such indexed load. Therefore -1 will be stored instead.
+	 * @brief Add the index registers of a match to a set of registers, unless the set would grow
+	 *        beyond 3 registers (x29 to x31).
+	 *
+	 * @param match The match.
+	 * @param regs The set of registers.
+	 * @param amt Number of registers in the set.
+	 *
+	 * @return true if the registers were added, false if they don't fit (the set is left untouched).
 	 */
-	std::vector<int> xBIdxVec;
+	bool addIndexRegisters(const Match &match, int regs[3], unsigned int &amt);
 
 	/**
-	 * @brief Vector with index register (indexed store) for xA (result) of each matched pattern.
+	 * @brief Check if a match may take one of its operands from the vector bank, as left by the
+	 *        previous match.
+	 *
+	 * @param prev The previous match in the basic block.
+	 * @param cur The match.
+	 *
+	 * @return The chained operand (0 for xA, 1 for xB) or -1 if the matches can't be chained.
 	 */
-	std::vector<int> xCIdxVec;
+	int getChainedOperand(const Match &prev, const Match &cur);
 
 	/**
-	 * @brief Mapping of RV32I general-purpose registers.
+	 * @brief Expand one chunk of a match. Instructions are added in reverse order.
+	 *
+	 * @param MBB The MachineBasicBlock where substitutions are performed.
+	 * @param MI Insertion point. Updated to the first added instruction.
+	 * @param DL Debug location of the added instructions.
+	 * @param Subtarget A RISCVSubtarget description of the function being rewritten.
+	 * @param i Match position in list.
+	 * @param k Chunk number.
+	 * @param opsCur Number of elements in this chunk.
+	 * @param rel Where index registers of a[], b[] and c[] are kept during the vector sequence.
 	 */
-	unsigned int rvRegs[32] = {
-		RISCV::zero, RISCV::ra, RISCV::sp, RISCV::gp, RISCV::tp, RISCV::t0, RISCV::t1, RISCV::t2,
-		RISCV::s0, RISCV::s1, RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3, RISCV::a4, RISCV::a5,
-		RISCV::a6, RISCV::a7, RISCV::s2, RISCV::s3, RISCV::s4, RISCV::s5, RISCV::s6, RISCV::s7,
-		RISCV::s8, RISCV::s9, RISCV::s10, RISCV::s11, RISCV::t3, RISCV::t4, RISCV::t5, RISCV::t6
-	};
+	void expandChunk(MachineBasicBlock *MBB, MachineBasicBlock::iterator &MI, const DebugLoc &DL,
+			const RISCVSubtarget *Subtarget, unsigned int i, unsigned int k, unsigned int opsCur,
+			const unsigned int rel[3]);
+
+	/**
+	 * @brief Check if a register is left untouched by vector operations (x0 and x29 to x31).
+	 *
+	 * @param reg The register.
+	 *
+	 * @return true if reg is outside the vector bank, false otherwise.
+	 */
+	bool isOutsideBank(unsigned int reg);
 
 public:
 	/**
@@ -115,25 +248,34 @@ public:
 	/**
 	 * @brief Get match class for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
-	 * @return A MatchClass value (RR, RI or IR).
+	 * @return A MatchClass value (RR, RI, IR or RED).
 	 */
 	unsigned int getClassAt(unsigned int i);
 
 	/**
-	 * @brief Get match class for given match.
+	 * @brief Get the first matched instruction for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
-	 * @return The start point.
+	 * @return An iterator to the first instruction.
 	 */
-	unsigned int getStartPointAt(unsigned int i);
+	MachineBasicBlock::iterator getFirstAt(unsigned int i);
+
+	/**
+	 * @brief Get the last matched instruction for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return An iterator to the last instruction.
+	 */
+	MachineBasicBlock::iterator getLastAt(unsigned int i);
 
 	/**
 	 * @brief Get block size for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return The block size.
 	 */
@@ -142,7 +284,7 @@ public:
 	/**
 	 * @brief Get opcode for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return The block size.
 	 */
@@ -152,7 +294,7 @@ public:
 	 * @brief Get equivalent vector opcode for given match. Example: If matched opcode is ADDI,
 	 *        this method will return ADDIV.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return The equivalent vector opcode.
 	 */
@@ -161,85 +303,347 @@ public:
 	/**
 	 * @brief Get xImm for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return xImm.
 	 *
-	 * @note See definition of @v xImmVec for further details about xImm.
+	 * @note See definition of @v Match for further details about xImm.
 	 */
 	int getXImmAt(unsigned int i);
 
+	/**
+	 * @brief Get xAcc for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xAcc.
+	 *
+	 * @note See definition of @v Match for further details about xAcc.
+	 */
+	int getXAccAt(unsigned int i);
+
 	/**
 	 * @brief Get xAIdx for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return xAIdx.
 	 *
-	 * @note See definition of @v xAIdxVec for further details about xAIdx.
+	 * @note See definition of @v Match for further details about xAIdx.
 	 */
 	int getXAIdxAt(unsigned int i);
 
 	/**
 	 * @brief Get xBIdx for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return xBIdx.
 	 *
-	 * @note See definition of @v xBIdxVec for further details about xBIdx.
+	 * @note See definition of @v Match for further details about xBIdx.
 	 */
 	int getXBIdxAt(unsigned int i);
 
 	/**
 	 * @brief Get xCIdx for given match.
 	 *
-	 * @param i Match position in vectors.
+	 * @param i Match position in list.
 	 *
 	 * @return xCIdx.
 	 *
-	 * @note See definition of @v xCIdxVec for further details about xCIdx.
+	 * @note See definition of @v Match for further details about xCIdx.
 	 */
 	int getXCIdxAt(unsigned int i);
 
+	/**
+	 * @brief Get xAMemOpcode for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xAMemOpcode.
+	 *
+	 * @note See definition of @v Match for further details about xAMemOpcode.
+	 */
+	unsigned int getXAMemOpcodeAt(unsigned int i);
+
+	/**
+	 * @brief Get xBMemOpcode for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xBMemOpcode.
+	 *
+	 * @note See definition of @v Match for further details about xBMemOpcode.
+	 */
+	unsigned int getXBMemOpcodeAt(unsigned int i);
+
+	/**
+	 * @brief Get xCMemOpcode for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xCMemOpcode.
+	 *
+	 * @note See definition of @v Match for further details about xCMemOpcode.
+	 */
+	unsigned int getXCMemOpcodeAt(unsigned int i);
+
+	/**
+	 * @brief Get xAOffset for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xAOffset.
+	 *
+	 * @note See definition of @v Match for further details about xAOffset.
+	 */
+	int getXAOffsetAt(unsigned int i);
+
+	/**
+	 * @brief Get xBOffset for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xBOffset.
+	 *
+	 * @note See definition of @v Match for further details about xBOffset.
+	 */
+	int getXBOffsetAt(unsigned int i);
+
+	/**
+	 * @brief Get xCOffset for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xCOffset.
+	 *
+	 * @note See definition of @v Match for further details about xCOffset.
+	 */
+	int getXCOffsetAt(unsigned int i);
+
+	/**
+	 * @brief Get xAStride for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xAStride.
+	 *
+	 * @note See definition of @v Match for further details about xAStride.
+	 */
+	int getXAStrideAt(unsigned int i);
+
+	/**
+	 * @brief Get xBStride for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xBStride.
+	 *
+	 * @note See definition of @v Match for further details about xBStride.
+	 */
+	int getXBStrideAt(unsigned int i);
+
+	/**
+	 * @brief Get xCStride for given match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return xCStride.
+	 *
+	 * @note See definition of @v Match for further details about xCStride.
+	 */
+	int getXCStrideAt(unsigned int i);
+
+	/**
+	 * @brief Get how many instructions of the basic block a given match spans.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return The number of matched instructions.
+	 */
+	unsigned int getMatchLengthAt(unsigned int i);
+
+	/**
+	 * @brief Check if a match takes one of its operands from the vector bank, as left by the previous
+	 *        match.
+	 *
+	 * @param i Match position in list.
+	 *
+	 * @return true if the match is chained, false otherwise.
+	 */
+	bool isChainedAt(unsigned int i);
+
+	/**
+	 * @brief Mark a match so that it is not substituted. Positions of the other matches are kept, but
+	 *        chains through the match are broken.
+	 *
+	 * @param i Match position in list.
+	 */
+	void rejectMatchAt(unsigned int i);
+
+	/**
+	 * @brief Estimate how many cycles the matched scalar instructions take.
+	 *
+	 * @param i Match position in list.
+	 * @param schedModel The scheduling model of the core, which gives the latencies.
+	 *
+	 * @return The estimated cycle count.
+	 */
+	unsigned int getScalarCostAt(unsigned int i, const TargetSchedModel &schedModel);
+
+	/**
+	 * @brief Estimate how many cycles the Xvec sequence substituted for a match takes, including
+	 *        index register moves, bank save/restore and hazard padding.
+	 *
+	 * @param i Match position in list.
+	 * @param schedModel The scheduling model of the core, which gives the latencies.
+	 *
+	 * @return The estimated cycle count.
+	 */
+	unsigned int getVectorCostAt(unsigned int i, const TargetSchedModel &schedModel);
+
+	/**
+	 * @brief Estimate how many cycles a run of elements of a given class takes as scalar code, before
+	 *        the instructions exist (e.g. to decide how far to unroll a loop).
+	 *
+	 * @param matchClass Class of the pattern.
+	 * @param elements Number of elements.
+	 * @param schedModel The scheduling model of the core, which gives the latencies.
+	 *
+	 * @return The estimated cycle count.
+	 */
+	static unsigned int estimateScalarCost(MatchClass matchClass, unsigned int elements,
+			const TargetSchedModel &schedModel);
+
+	/**
+	 * @brief Estimate how many cycles the Xvec sequence for a run of elements of a given class
+	 *        takes, before the instructions exist. Index registers are assumed to be outside the
+	 *        bank already.
+	 *
+	 * @param matchClass Class of the pattern.
+	 * @param elements Number of elements.
+	 * @param schedModel The scheduling model of the core, which gives the latencies.
+	 *
+	 * @return The estimated cycle count.
+	 */
+	static unsigned int estimateVectorCost(MatchClass matchClass, unsigned int elements,
+			const TargetSchedModel &schedModel);
+
 	/**
 	 * @brief Check a given basic block for patterns of class RR and appends them to the matches
-	 *        vectors.
+	 *        list.
 	 *
 	 * @param MBB A reference to a MachineBasicBlock.
 	 *
 	 * @return true if matches were found, false otherwise.
+	 *
+	 * @note Elements may be words, halfwords or bytes, placed any constant distance apart.
 	 */
-	bool checkForVectorPatternRR(const MachineBasicBlock &MBB);
+	bool checkForVectorPatternRR(MachineBasicBlock &MBB);
 
 	/**
 	 * @brief Check a given basic block for patterns of class RI and appends them to the matches
-	 *        vectors.
+	 *        list.
 	 *
 	 * @param MBB A reference to a MachineBasicBlock.
 	 *
 	 * @return true if matches were found, false otherwise.
+	 *
+	 * @note Elements may be words, halfwords or bytes, placed any constant distance apart.
 	 */
-	bool checkForVectorPatternRI(const MachineBasicBlock &MBB);
+	bool checkForVectorPatternRI(MachineBasicBlock &MBB);
 
 	/**
 	 * @brief Check a given basic block for patterns of class IR and appends them to the matches
-	 *        vectors.
+	 *        list.
+	 *
+	 * @param MBB A reference to a MachineBasicBlock.
+	 *
+	 * @return true if matches were found, false otherwise.
+	 *
+	 * @note Elements may be words, halfwords or bytes, placed any constant distance apart.
+	 */
+	bool checkForVectorPatternIR(MachineBasicBlock &MBB);
+
+	/**
+	 * @brief Check a given basic block for patterns of class RED (s = s OP a[i], OP being ADD, XOR,
+	 *        OR or AND) and appends them to the matches list.
 	 *
 	 * @param MBB A reference to a MachineBasicBlock.
 	 *
 	 * @return true if matches were found, false otherwise.
+	 *
+	 * @note Elements may be words, halfwords or bytes, placed any constant distance apart.
+	 */
+	bool checkForVectorPatternRED(MachineBasicBlock &MBB);
+
+	/**
+	 * @brief Check if a load and the operation consuming it may form one element of a RED pattern.
+	 *
+	 * @param load The load of the element.
+	 * @param op The operation that accumulates it.
+	 *
+	 * @return true if the opcodes fit, false otherwise.
+	 *
+	 * @note Only opcodes are checked, so that this may be asked before register allocation.
+	 */
+	static bool isReductionStep(const MachineInstr &load, const MachineInstr &op);
+
+	/**
+	 * @brief Check if a load, the operation consuming it and the store of its result may form one
+	 *        element of an RR, RI or IR pattern.
+	 *
+	 * @param load The load of an element operand.
+	 * @param op The operation on the element.
+	 * @param store The store of its result.
+	 *
+	 * @return true if the opcodes fit, false otherwise.
+	 *
+	 * @note Only opcodes are checked, so that this may be asked before register allocation.
+	 */
+	static bool isElementStep(const MachineInstr &load, const MachineInstr &op,
+			const MachineInstr &store);
+
+	/**
+	 * @brief Sort the matches list in basic block order and chain matches that read the result of
+	 *        the match right before them (e.g. c[] = a[] + b[] followed by d[] = c[] ^ k). A chain is
+	 *        substituted by a single vector sequence: The intermediate result is stored, but not
+	 *        loaded back.
+	 *
+	 * @param MBB The MachineBasicBlock where the matches were found.
 	 */
-	bool checkForVectorPatternIR(const MachineBasicBlock &MBB);
+	void chainMatches(MachineBasicBlock &MBB);
 
 	/**
-	 * @brief Substitute all present matches in the matches vectors.
+	 * @brief Substitute all matches that were not rejected, in a single bottom to top pass over the
+	 *        basic block.
 	 *
 	 * @param MBB The MachineBasicBlock where substitutions will be performed.
-	 * @param Subtarget A RISCVSubtarget description. Using @v Subtarget attribute from
-	 *        RISCVAsmPrinter should suffice.
+	 * @param Subtarget A RISCVSubtarget description of the function being rewritten.
 	 */
 	void substituteAllMatches(MachineBasicBlock *MBB, const RISCVSubtarget *Subtarget);
+
+	/**
+	 * @brief Get how many elements a block copy is split into. Elements are as wide as the alignment
+	 *        allows (words, halfwords or bytes), with narrower elements for the tail of the block.
+	 *
+	 * @param size Block size in bytes.
+	 * @param align Alignment of both source and destination.
+	 *
+	 * @return The element count.
+	 */
+	static unsigned int getBlockCopyElements(unsigned int size, unsigned int align);
+
+	/**
+	 * @brief Expand an XVEC_MEMCPY pseudo instruction: The block is loaded into the vector bank and
+	 *        stored back, XVEC_AVAIL_REGS elements at a time, between a bank save and restore.
+	 *
+	 * @param MI The XVEC_MEMCPY instruction, which is erased.
+	 * @param Subtarget A RISCVSubtarget description of the function being rewritten.
+	 *
+	 * @note Vector operations are not padded here; RISCVXvecPadding does it for every basic block.
+	 */
+	void expandBlockCopy(MachineInstr &MI, const RISCVSubtarget *Subtarget);
 };
 
 }
@@ -0,0 +1,114 @@
+//===-- RISCVXvecPadding.cpp - Pad Xvec operations with no-ops ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains a pass that inserts the no-ops RISCVXvecHazardRecognizer
+// asks for around Xvec vector operations.  The post-RA scheduler fills most
+// hazard slots with independent scalar work, but it does not run at -O0, it
+// assumes nothing is in flight at the start of each of its regions and it
+// never sees the calls and terminators that end them.  This pass walks the
+// final order of every block that holds a vector operation, so it runs just
+// before the branch selector, which must measure the no-ops.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "riscv-xvec-padding"
+#include "RISCV.h"
+#include "RISCVHazardRecognizer.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+using namespace llvm;
+
+STATISTIC(NumNoops, "Number of no-ops inserted for Xvec hazards");
+
+namespace {
+  struct RISCVXvecPadding : public MachineFunctionPass {
+    static char ID;
+    RISCVXvecPadding() : MachineFunctionPass(ID) {
+      initializeRISCVXvecPaddingPass(*PassRegistry::getPassRegistry());
+    }
+
+    const RISCVInstrInfo *TII;
+
+    bool runOnMachineFunction(MachineFunction &Fn) override;
+
+    bool padBlock(MachineBasicBlock &MBB);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesCFG();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    const char *getPassName() const override {
+      return "RISCV Xvec Padding";
+    }
+  };
+  char RISCVXvecPadding::ID = 0;
+}
+
+INITIALIZE_PASS(RISCVXvecPadding, "riscv-xvec-padding", "RISCV Xvec Padding",
+                false, false)
+
+/// createRISCVXvecPaddingPass - returns an instance of the Xvec hazard
+/// padding pass.
+///
+FunctionPass *llvm::createRISCVXvecPaddingPass() {
+  return new RISCVXvecPadding();
+}
+
+/// padBlock - Walk MBB in issue order and pad the Xvec operations with as
+/// many no-ops as RISCVXvecHazardRecognizer asks for. Calls and terminators
+/// lead to unknown code, so no vector operation may still be in flight when
+/// they issue. Return true if any no-op was inserted.
+bool RISCVXvecPadding::padBlock(MachineBasicBlock &MBB) {
+  RISCVXvecHazardRecognizer HazardRec(&TII->getRegisterInfo());
+  bool Changed = false;
+
+  for (MachineBasicBlock::iterator MBBI = MBB.begin(), E = MBB.end();
+       MBBI != E; ++MBBI) {
+    if (MBBI->isDebugValue() || MBBI->isCFIInstruction() ||
+        MBBI->isKill() || MBBI->isImplicitDef())
+      continue;
+
+    unsigned Noops = HazardRec.PreEmitNoops(&*MBBI);
+    if (MBBI->isCall() || MBBI->isTerminator() || MBBI->isInlineAsm())
+      Noops = std::max(Noops, HazardRec.getTrailingNoops());
+    for (unsigned i = 0; i != Noops; ++i) {
+      TII->insertNoop(MBB, MBBI);
+      HazardRec.EmitNoop();
+      Changed = true;
+    }
+    NumNoops += Noops;
+
+    HazardRec.EmitInstruction(&*MBBI);
+    HazardRec.AdvanceCycle();
+  }
+
+  for (unsigned i = 0, e = HazardRec.getTrailingNoops(); i != e; ++i) {
+    TII->insertNoop(MBB, MBB.end());
+    ++NumNoops;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool RISCVXvecPadding::runOnMachineFunction(MachineFunction &Fn) {
+  TII = Fn.getSubtarget<RISCVSubtarget>().getInstrInfo();
+  bool Changed = false;
+
+  for (MachineBasicBlock &MBB : Fn)
+    for (const MachineInstr &MI : MBB)
+      if (RISCVXvecHazardRecognizer::isVectorOp(&MI)) {
+        Changed |= padBlock(MBB);
+        break;
+      }
+
+  return Changed;
+}
@@ -0,0 +1,827 @@
+//===-- RISCVXvecVectorize.cpp - Substitute Xvec vector operations --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains a pass that scans each basic block for unrolled
+// load/operate/store sequences (see RISCVVectorInstrBuilder) and replaces them
+// with equivalent Xvec vector operations.  Sequences that consume the result
+// of the previous one are chained, so that it is not loaded back.
+// Single-block counted loops whose body is such a sequence are first
+// strip-mined into a loop that handles XVEC_AVAIL_REGS iterations per trip,
+// so that they benefit regardless of how far the middle end unrolled them.
+// The pass runs after register allocation and prologue/epilogue insertion,
+// ahead of the post-RA scheduler, which fills the hazard slots of the vector
+// operations; RISCVXvecPadding pads what is left with no-ops.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "riscv-xvec"
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVSubtarget.h"
+#include "RISCVVectorInstrBuilder.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/MachineScheduler.h"
+#include "llvm/CodeGen/TargetSchedule.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <tuple>
+using namespace llvm;
+
+STATISTIC(NumMatchesRR,  "Number of register-register patterns substituted");
+STATISTIC(NumMatchesRI,  "Number of register-immediate patterns substituted");
+STATISTIC(NumMatchesIR,  "Number of immediate-register patterns substituted");
+STATISTIC(NumMatchesRED, "Number of reduction patterns substituted");
+STATISTIC(NumChained,    "Number of patterns chained through the bank");
+STATISTIC(NumElements,   "Number of scalar elements moved to the Xvec unit");
+STATISTIC(NumRejected,   "Number of patterns left scalar by the cost model");
+STATISTIC(NumOverlapping, "Number of patterns left scalar by memory overlap");
+STATISTIC(NumLoops,      "Number of loops strip-mined for the Xvec unit");
+
+static cl::opt<bool>
+EnableXvec("riscv-xvec", cl::init(true), cl::Hidden,
+           cl::desc("Substitute unrolled scalar sequences with Xvec vector "
+                    "operations"));
+
+static cl::opt<unsigned>
+XvecMinElements("riscv-xvec-min-elements", cl::init(2), cl::Hidden,
+                cl::desc("Minimum number of elements of a pattern before it "
+                         "is considered for Xvec substitution"));
+
+static cl::opt<bool>
+EnableXvecLoops("riscv-xvec-loops", cl::init(true), cl::Hidden,
+                cl::desc("Strip-mine counted loops into chunks of Xvec "
+                         "operations"));
+
+static cl::opt<bool>
+XvecCostModel("riscv-xvec-cost-model", cl::init(true), cl::Hidden,
+              cl::desc("Only substitute patterns that the Xvec cost model "
+                       "finds profitable"));
+
+namespace {
+  struct RISCVXvecVectorize : public MachineFunctionPass {
+    static char ID;
+    RISCVXvecVectorize() : MachineFunctionPass(ID) {
+      initializeRISCVXvecVectorizePass(*PassRegistry::getPassRegistry());
+    }
+
+    const RISCVSubtarget *Subtarget;
+    const RISCVInstrInfo *TII;
+    AliasAnalysis *AA;
+    TargetSchedModel SchedModel;
+
+    bool runOnMachineFunction(MachineFunction &Fn) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.addRequired<AAResultsWrapperPass>();
+      AU.addRequired<MachineLoopInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    bool isProfitable(RISCVVectorInstrBuilder &Builder, unsigned i,
+                      MachineBasicBlock &MBB);
+
+    bool preservesMemoryOrder(RISCVVectorInstrBuilder &Builder, unsigned i,
+                              MachineBasicBlock &MBB);
+
+    bool vectorizeLoop(MachineLoop *L, MachineBasicBlock *&VecBody);
+
+    const char *getPassName() const override {
+      return "RISCV Xvec Vectorize";
+    }
+  };
+  char RISCVXvecVectorize::ID = 0;
+}
+
+INITIALIZE_PASS_BEGIN(RISCVXvecVectorize, "riscv-xvec-vectorize",
+                      "RISCV Xvec Vectorize", false, false)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_END(RISCVXvecVectorize, "riscv-xvec-vectorize",
+                    "RISCV Xvec Vectorize", false, false)
+
+/// createRISCVXvecVectorizePass - returns an instance of the Xvec
+/// substitution pass.
+///
+FunctionPass *llvm::createRISCVXvecVectorizePass() {
+  return new RISCVXvecVectorize();
+}
+
+namespace {
+  // The machine scheduler hoists the element loads of an unrolled reduction
+  // above the chain of operations to hide their latency, which leaves no
+  // load/operate pairs for checkForVectorPatternRED to find.  Keep each load
+  // between the step that produces the accumulator and the step that consumes
+  // the element, but only in reductions that the Xvec pass will take; the
+  // others are better off with their loads hoisted.
+  struct RISCVXvecReductionMutation : public ScheduleDAGMutation {
+    void apply(ScheduleDAGInstrs *DAGInstrs) override;
+  };
+
+  // Once the element stores are known not to alias the loads, nothing keeps
+  // the scheduler from hoisting the loads of later elements above the
+  // stores of earlier ones, and the LW; LW; OP; SW blocks that the RR, RI and
+  // IR matchers look for are gone.  Keep each element after the store of the
+  // previous one, in runs that the Xvec pass will take.
+  struct RISCVXvecElementMutation : public ScheduleDAGMutation {
+    void apply(ScheduleDAGInstrs *DAGInstrs) override;
+  };
+}
+
+// Return the only instruction that reads the value defined by SU, or null.
+static SUnit *getSingleDataSucc(SUnit &SU) {
+  SUnit *User = nullptr;
+  for (const SDep &Succ : SU.Succs) {
+    if (Succ.getKind() != SDep::Data)
+      continue;
+    if (User && User != Succ.getSUnit())
+      return nullptr;
+    User = Succ.getSUnit();
+  }
+  return User;
+}
+
+void RISCVXvecReductionMutation::apply(ScheduleDAGInstrs *DAGInstrs) {
+  ScheduleDAGMI *DAG = static_cast<ScheduleDAGMI*>(DAGInstrs);
+
+  // Find the steps of every reduction, the element loads they consume and
+  // the previous step of the same reduction, if any.  The first step takes
+  // its accumulator from elsewhere.
+  DenseMap<SUnit *, SmallVector<SUnit *, 2>> Loads;
+  DenseMap<SUnit *, SUnit *> PrevSteps;
+  SmallPtrSet<SUnit *, 16> HasNextStep;
+  for (SUnit &SU : DAG->SUnits) {
+    SUnit *Step = getSingleDataSucc(SU);
+    if (!Step || Step->isBoundaryNode() ||
+        !RISCVVectorInstrBuilder::isReductionStep(*SU.getInstr(),
+                                                  *Step->getInstr()))
+      continue;
+    Loads[Step].push_back(&SU);
+    if (PrevSteps.count(Step))
+      continue;
+
+    SUnit *PrevStep = nullptr;
+    for (const SDep &Pred : Step->Preds)
+      if (Pred.getKind() == SDep::Data && Pred.getSUnit() != &SU &&
+          !Pred.getSUnit()->isBoundaryNode() &&
+          Pred.getSUnit()->getInstr()->getOpcode() ==
+            Step->getInstr()->getOpcode())
+        PrevStep = Pred.getSUnit();
+    PrevSteps[Step] = PrevStep;
+    if (PrevStep)
+      HasNextStep.insert(PrevStep);
+  }
+
+  for (SUnit &Last : DAG->SUnits) {
+    if (!PrevSteps.count(&Last) || HasNextStep.count(&Last))
+      continue;
+
+    // Walk the reduction back from its last step.  Runs that are too short,
+    // or that the cost model turns down, are left to the scheduler.
+    SmallVector<SUnit *, 32> Steps;
+    unsigned Elements = 0;
+    for (SUnit *Step = &Last; Step && Loads.count(Step);
+         Step = PrevSteps.lookup(Step)) {
+      Steps.push_back(Step);
+      Elements += Loads[Step].size();
+    }
+    if (Elements < XvecMinElements)
+      continue;
+    if (XvecCostModel &&
+        RISCVVectorInstrBuilder::estimateVectorCost(
+            RISCVVectorInstrBuilder::RED, Elements, *DAG->getSchedModel()) >=
+        RISCVVectorInstrBuilder::estimateScalarCost(
+            RISCVVectorInstrBuilder::RED, Elements, *DAG->getSchedModel()))
+      continue;
+
+    for (SUnit *Step : Steps) {
+      SUnit *PrevStep = PrevSteps.lookup(Step);
+      if (!PrevStep)
+        continue;
+      for (SUnit *Load : Loads[Step]) {
+        DEBUG(dbgs() << "Keep SU(" << Load->NodeNum << ") between SU("
+                     << PrevStep->NodeNum << ") and SU(" << Step->NodeNum
+                     << ")\n");
+        DAG->addEdge(Load, SDep(PrevStep, SDep::Artificial));
+        DAG->addEdge(Step, SDep(Load, SDep::Cluster));
+      }
+    }
+  }
+}
+
+void RISCVXvecElementMutation::apply(ScheduleDAGInstrs *DAGInstrs) {
+  ScheduleDAGMI *DAG = static_cast<ScheduleDAGMI*>(DAGInstrs);
+
+  // Find every store of an operation result whose operands are element loads
+  // that nothing else reads.  The elements of a run share the operation and
+  // come in program order.
+  struct Element {
+    SUnit *Op;
+    SUnit *Store;
+    SmallVector<SUnit *, 2> Loads;
+  };
+  MapVector<unsigned, SmallVector<Element, 32>> Runs;
+  for (SUnit &Store : DAG->SUnits) {
+    MachineInstr *StoreMI = Store.getInstr();
+    if (!StoreMI->mayStore() || !StoreMI->getOperand(0).isReg())
+      continue;
+
+    SUnit *Op = nullptr;
+    for (const SDep &Pred : Store.Preds)
+      if (Pred.getKind() == SDep::Data &&
+          Pred.getReg() == StoreMI->getOperand(0).getReg() &&
+          !Pred.getSUnit()->isBoundaryNode() &&
+          getSingleDataSucc(*Pred.getSUnit()) == &Store)
+        Op = Pred.getSUnit();
+    if (!Op)
+      continue;
+
+    Element E = {Op, &Store, {}};
+    for (const SDep &Pred : Op->Preds)
+      if (Pred.getKind() == SDep::Data && !Pred.getSUnit()->isBoundaryNode() &&
+          getSingleDataSucc(*Pred.getSUnit()) == Op &&
+          RISCVVectorInstrBuilder::isElementStep(*Pred.getSUnit()->getInstr(),
+                                                 *Op->getInstr(), *StoreMI))
+        E.Loads.push_back(Pred.getSUnit());
+    if (E.Loads.empty())
+      continue;
+    std::sort(E.Loads.begin(), E.Loads.end(),
+              [](SUnit *A, SUnit *B) { return A->NodeNum < B->NodeNum; });
+    Runs[Op->getInstr()->getOpcode()].push_back(E);
+  }
+
+  for (auto &Run : Runs) {
+    SmallVectorImpl<Element> &Elements = Run.second;
+    if (Elements.size() < XvecMinElements)
+      continue;
+
+    RISCVVectorInstrBuilder::MatchClass Class = RISCVVectorInstrBuilder::IR;
+    if (Elements[0].Loads.size() == 2)
+      Class = RISCVVectorInstrBuilder::RR;
+    else if (Elements[0].Op->getInstr()->getOperand(2).isImm())
+      Class = RISCVVectorInstrBuilder::RI;
+    if (XvecCostModel &&
+        RISCVVectorInstrBuilder::estimateVectorCost(
+            Class, Elements.size(), *DAG->getSchedModel()) >=
+        RISCVVectorInstrBuilder::estimateScalarCost(
+            Class, Elements.size(), *DAG->getSchedModel()))
+      continue;
+
+    // Edges that would close a cycle, e.g. through a store that may alias a
+    // later load, are refused by addEdge and leave the run to the scheduler.
+    for (unsigned k = 0, e = Elements.size(); k != e; ++k) {
+      SmallVectorImpl<SUnit *> &Loads = Elements[k].Loads;
+      for (unsigned l = 1, le = Loads.size(); l != le; ++l)
+        DAG->addEdge(Loads[l], SDep(Loads[l - 1], SDep::Artificial));
+      if (!k)
+        continue;
+      SUnit *PrevStore = Elements[k - 1].Store;
+      for (SUnit *Load : Loads) {
+        DEBUG(dbgs() << "Keep SU(" << Load->NodeNum << ") after SU("
+                     << PrevStore->NodeNum << ")\n");
+        DAG->addEdge(Load, SDep(PrevStore, SDep::Artificial));
+      }
+    }
+  }
+}
+
+/// createRISCVXvecReductionMutation - returns the DAG mutation that keeps
+/// unrolled reductions in the shape the Xvec pass looks for, or null if the
+/// pass is disabled or STI has no Xvec unit.
+///
+std::unique_ptr<ScheduleDAGMutation>
+llvm::createRISCVXvecReductionMutation(const RISCVSubtarget &STI) {
+  if (!EnableXvec || !STI.hasXvec())
+    return nullptr;
+  return make_unique<RISCVXvecReductionMutation>();
+}
+
+/// createRISCVXvecElementMutation - returns the DAG mutation that keeps
+/// element-wise operations in the shape the Xvec pass looks for, or null if
+/// the pass is disabled or STI has no Xvec unit.
+///
+std::unique_ptr<ScheduleDAGMutation>
+llvm::createRISCVXvecElementMutation(const RISCVSubtarget &STI) {
+  if (!EnableXvec || !STI.hasXvec())
+    return nullptr;
+  return make_unique<RISCVXvecElementMutation>();
+}
+
+/// isProfitable - Decide whether match i of Builder, found in MBB, is worth
+/// substituting, and report the decision as an optimization remark.
+bool RISCVXvecVectorize::isProfitable(RISCVVectorInstrBuilder &Builder,
+                                      unsigned i, MachineBasicBlock &MBB) {
+  const Function &F = *MBB.getParent()->getFunction();
+  unsigned Elements = Builder.getBlockSizeAt(i);
+  if (Elements < XvecMinElements)
+    return false;
+
+  unsigned ScalarCost = Builder.getScalarCostAt(i, SchedModel);
+  unsigned VectorCost = Builder.getVectorCostAt(i, SchedModel);
+  const DebugLoc &DL = Builder.getFirstAt(i)->getDebugLoc();
+  DEBUG(dbgs() << "Xvec match in BB#" << MBB.getNumber()
+               << ": class " << Builder.getClassAt(i)
+               << ", size " << Elements
+               << ", opcode " << Builder.getOpcodeAt(i)
+               << (Builder.isChainedAt(i) ? ", chained" : "")
+               << ", cost " << ScalarCost << " -> " << VectorCost << '\n');
+
+  // llc prints every remark it is handed, so only emit the ones that
+  // -pass-remarks and -pass-remarks-missed ask for.
+  if (XvecCostModel && VectorCost >= ScalarCost) {
+    if (DiagnosticInfoOptimizationRemarkMissed(DEBUG_TYPE, F, DL, "")
+            .isEnabled())
+      emitOptimizationRemarkMissed(
+          F.getContext(), DEBUG_TYPE, F, DL,
+          "not vectorized: " + Twine(Elements) + " elements would take " +
+              Twine(VectorCost) + " cycles on Xvec instead of " +
+              Twine(ScalarCost));
+    ++NumRejected;
+    return false;
+  }
+
+  if (DiagnosticInfoOptimizationRemark(DEBUG_TYPE, F, DL, "").isEnabled())
+    emitOptimizationRemark(
+        F.getContext(), DEBUG_TYPE, F, DL,
+        "vectorized " + Twine(Elements) + " elements with Xvec (" +
+            Twine(VectorCost) + " cycles instead of " + Twine(ScalarCost) +
+            ")");
+  switch (Builder.getClassAt(i)) {
+  case RISCVVectorInstrBuilder::RR: ++NumMatchesRR; break;
+  case RISCVVectorInstrBuilder::RI: ++NumMatchesRI; break;
+  case RISCVVectorInstrBuilder::IR: ++NumMatchesIR; break;
+  case RISCVVectorInstrBuilder::RED: ++NumMatchesRED; break;
+  }
+  if (Builder.isChainedAt(i))
+    ++NumChained;
+  NumElements += Elements;
+  return true;
+}
+
+/// isLoopIncrement - Return true if MI bumps a register that nothing else in
+/// its block defines by a constant ("addi r, r, imm").
+static bool isLoopIncrement(const MachineInstr &MI,
+                            const DenseMap<unsigned, unsigned> &NumDefs) {
+  return MI.getOpcode() == RISCV::ADDI && MI.getOperand(0).isReg() &&
+         MI.getOperand(1).isReg() && MI.getOperand(2).isImm() &&
+         MI.getOperand(0).getReg() == MI.getOperand(1).getReg() &&
+         NumDefs.lookup(MI.getOperand(0).getReg()) == 1;
+}
+
+/// getUnderlyingObject - Return the IR object that MI accesses, or null if it
+/// is not known.
+static const Value *getUnderlyingObject(const MachineInstr &MI,
+                                        const DataLayout &DL) {
+  if (!MI.hasOneMemOperand())
+    return nullptr;
+  const MachineMemOperand *MMO = *MI.memoperands_begin();
+  if (!MMO->getValue() || MMO->isVolatile())
+    return nullptr;
+  return GetUnderlyingObject(MMO->getValue(), DL);
+}
+
+namespace {
+  // An element load or store of a match, with the block it belongs to.
+  struct ElementAccess {
+    MachineInstr *MI;
+    const Value *Obj;
+    unsigned Match;
+    unsigned Block;
+    bool IsStore;
+  };
+}
+
+/// getAccessWidth - Return how many bytes the element load or store MI
+/// accesses.
+static unsigned getAccessWidth(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  case RISCV::LW: case RISCV::SW: return 4;
+  case RISCV::LH: case RISCV::LHU: case RISCV::SH: return 2;
+  default: return 1;
+  }
+}
+
+/// isScalarOrder - Return true if the scalar code performs A before B: match
+/// by match, block by block, with the loads of a block before its store.
+static bool isScalarOrder(const ElementAccess &A, const ElementAccess &B) {
+  return std::make_tuple(A.Match, A.Block, A.IsStore) <
+         std::make_tuple(B.Match, B.Block, B.IsStore);
+}
+
+/// isVectorOrder - Return true if the vector sequence performs A before B: it
+/// runs the whole chain on one chunk of XVEC_AVAIL_REGS elements at a time,
+/// loading every element of a match in the chunk before storing any.
+static bool isVectorOrder(const ElementAccess &A, const ElementAccess &B) {
+  return std::make_tuple(A.Block / XVEC_AVAIL_REGS, A.Match, A.IsStore,
+                         A.Block) <
+         std::make_tuple(B.Block / XVEC_AVAIL_REGS, B.Match, B.IsStore,
+                         B.Block);
+}
+
+/// preservesMemoryOrder - Return true if substituting match i, together with
+/// the matches it is chained to, cannot move a store across an access to the
+/// same memory.  Every pair that changes order must be provably disjoint:
+/// either off the same index register with non-overlapping offsets, or into
+/// objects that alias analysis keeps apart, as vectorizeLoop requires.
+bool RISCVXvecVectorize::preservesMemoryOrder(RISCVVectorInstrBuilder &Builder,
+                                              unsigned i,
+                                              MachineBasicBlock &MBB) {
+  const DataLayout &DL = MBB.getParent()->getDataLayout();
+  unsigned Head = i;
+  while (Builder.isChainedAt(Head))
+    --Head;
+
+  // Each block of an RR, RI or IR match ends with its only store.
+  SmallVector<ElementAccess, 64> Accesses;
+  SmallSet<unsigned, 16> Defs;
+  for (unsigned m = Head; m <= i; ++m) {
+    unsigned Block = 0;
+    for (MachineBasicBlock::iterator MI = Builder.getFirstAt(m),
+                                     E = std::next(Builder.getLastAt(m));
+         MI != E; ++MI) {
+      for (const MachineOperand &MO : MI->operands())
+        if (MO.isReg() && MO.isDef())
+          Defs.insert(MO.getReg());
+      if (!MI->mayLoad() && !MI->mayStore())
+        continue;
+      ElementAccess A = {&*MI, getUnderlyingObject(*MI, DL), m, Block,
+                         MI->mayStore()};
+      Accesses.push_back(A);
+      if (A.IsStore)
+        ++Block;
+    }
+  }
+
+  // The pairs within the earlier matches of the chain were already checked.
+  DenseMap<std::pair<const Value *, const Value *>, bool> NoAliasCache;
+  for (const ElementAccess &A : Accesses) {
+    if (A.Match != i)
+      continue;
+    for (const ElementAccess &B : Accesses) {
+      if ((!A.IsStore && !B.IsStore) ||
+          isScalarOrder(A, B) == isVectorOrder(A, B))
+        continue;
+
+      // Loads and stores both take the index register as operand 2 and the
+      // offset as operand 1.
+      const MachineOperand &BaseA = A.MI->getOperand(2);
+      const MachineOperand &BaseB = B.MI->getOperand(2);
+      if (BaseA.isReg() && BaseB.isReg() &&
+          BaseA.getReg() == BaseB.getReg() && !Defs.count(BaseA.getReg())) {
+        int64_t OffA = A.MI->getOperand(1).getImm();
+        int64_t OffB = B.MI->getOperand(1).getImm();
+        if (OffA + getAccessWidth(*A.MI) <= OffB ||
+            OffB + getAccessWidth(*B.MI) <= OffA)
+          continue;
+      } else if (A.Obj && B.Obj) {
+        auto Key = std::make_pair(A.Obj, B.Obj);
+        auto It = NoAliasCache.find(Key);
+        if (It == NoAliasCache.end())
+          It = NoAliasCache
+                   .insert(std::make_pair(
+                       Key, AA->alias(MemoryLocation(A.Obj),
+                                      MemoryLocation(B.Obj)) == NoAlias))
+                   .first;
+        if (It->second)
+          continue;
+      }
+
+      DEBUG(dbgs() << "Xvec match in BB#" << MBB.getNumber()
+                   << " may reorder " << *B.MI << "  and " << *A.MI);
+      const Function &F = *MBB.getParent()->getFunction();
+      unsigned Elements = Builder.getBlockSizeAt(i);
+      const DebugLoc &Loc = Builder.getFirstAt(i)->getDebugLoc();
+      if (Elements >= XvecMinElements &&
+          DiagnosticInfoOptimizationRemarkMissed(DEBUG_TYPE, F, Loc, "")
+              .isEnabled())
+        emitOptimizationRemarkMissed(
+            F.getContext(), DEBUG_TYPE, F, Loc,
+            "not vectorized: the stores of " + Twine(Elements) +
+                " elements may overlap the loads");
+      ++NumOverlapping;
+      return false;
+    }
+  }
+  return true;
+}
+
+/// vectorizeLoop - Strip-mine L into chunks of XVEC_AVAIL_REGS iterations
+/// when it is a single block of the form
+///
+///   Header:  <element-wise RR, RI or IR pattern>
+///            addi r, r, step(r)     for each induction register r
+///            bne  iv, limit, Header
+///
+/// A new loop is inserted in front of it, and the original one is left in
+/// place to run the remaining iterations:
+///
+///   VecHeader:  t = |limit - iv|
+///               if (t < XVEC_AVAIL_REGS * |step(iv)|) goto Header
+///   VecBody:    XVEC_AVAIL_REGS iterations worth of Xvec operations
+///               addi r, r, XVEC_AVAIL_REGS * step(r)
+///               if (iv == limit) goto Exit
+///               goto VecHeader
+///
+/// The Xvec operations are obtained by writing the iterations out as one
+/// straight-line pattern and substituting it, so VecBody is only kept if
+/// RISCVVectorInstrBuilder matches all of it and the cost model agrees.
+bool RISCVXvecVectorize::vectorizeLoop(MachineLoop *L,
+                                       MachineBasicBlock *&VecBody) {
+  MachineBasicBlock *Header = L->getHeader();
+  MachineBasicBlock *Exit = L->getExitBlock();
+  if (L->getNumBlocks() != 1 || !Exit)
+    return false;
+  MachineFunction &MF = *Header->getParent();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  // VecHeader becomes the preheader, so the blocks that enter the loop need
+  // not be dedicated to it; a guard that skips the loop is typical.  They
+  // only need branches that can be redirected.
+  MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+  SmallVector<MachineOperand, 4> Cond;
+  SmallVector<MachineBasicBlock *, 2> Entries;
+  for (MachineBasicBlock *Pred : Header->predecessors()) {
+    if (Pred == Header)
+      continue;
+    if (TII->AnalyzeBranch(*Pred, TBB, FBB, Cond, false))
+      return false;
+    Entries.push_back(Pred);
+  }
+  if (Entries.empty())
+    return false;
+
+  // The loop must count an induction register up or down to a limit.
+  TBB = FBB = nullptr;
+  Cond.clear();
+  if (TII->AnalyzeBranch(*Header, TBB, FBB, Cond, false) || Cond.size() != 4)
+    return false;
+  if (!(Cond[0].getImm() == RISCV::CCMASK_CMP_NE && TBB == Header) &&
+      !(Cond[0].getImm() == RISCV::CCMASK_CMP_EQ && TBB == Exit &&
+        FBB == Header))
+    return false;
+  unsigned IV = Cond[2].getReg();
+  unsigned Limit = Cond[3].getReg();
+
+  DenseMap<unsigned, unsigned> NumDefs;
+  for (const MachineInstr &MI : *Header)
+    for (const MachineOperand &MO : MI.operands())
+      if (MO.isReg() && MO.isDef())
+        ++NumDefs[MO.getReg()];
+
+  DenseMap<unsigned, int> Steps;
+  SmallVector<MachineInstr *, 16> Loads, Stores;
+  for (MachineInstr &MI : *Header) {
+    if (MI.isDebugValue() || MI.isTerminator())
+      continue;
+    if (isLoopIncrement(MI, NumDefs)) {
+      Steps[MI.getOperand(0).getReg()] = MI.getOperand(2).getImm();
+      continue;
+    }
+    if (MI.mayLoad())
+      Loads.push_back(&MI);
+    if (MI.mayStore())
+      Stores.push_back(&MI);
+
+    // Elements are not carried from one iteration to the next, nor out of the
+    // loop, since the Xvec sequence leaves them as it found them.
+    for (const MachineOperand &MO : MI.operands())
+      if (MO.isReg() && MO.isDef() &&
+          (Header->isLiveIn(MO.getReg()) || Exit->isLiveIn(MO.getReg())))
+        return false;
+  }
+
+  if (!Steps.count(IV))
+    std::swap(IV, Limit);
+  if (!Steps.count(IV) || NumDefs.count(Limit) || !Steps[IV])
+    return false;
+  int IVStep = Steps[IV];
+  if (!isUInt<11>(XVEC_AVAIL_REGS * std::abs(IVStep)))
+    return false;
+  for (const auto &Step : Steps)
+    if (!isInt<12>(XVEC_AVAIL_REGS * Step.second))
+      return false;
+
+  // A chunk loads every a[] and b[] element before storing any c[] element,
+  // so c[] must not be one of the arrays the loop reads.
+  const DataLayout &DL = MF.getDataLayout();
+  for (MachineInstr *Store : Stores) {
+    const Value *StoreObj = getUnderlyingObject(*Store, DL);
+    if (!StoreObj)
+      return false;
+    for (MachineInstr *Load : Loads) {
+      const Value *LoadObj = getUnderlyingObject(*Load, DL);
+      if (!LoadObj ||
+          AA->alias(MemoryLocation(StoreObj), MemoryLocation(LoadObj)) !=
+              NoAlias)
+        return false;
+    }
+  }
+
+  // Pick a scratch register for the trip count check. It must be free on
+  // entry to the loop and not need saving in the prologue.
+  static const MCPhysReg ScratchRegs[] = {
+    RISCV::t0, RISCV::t1, RISCV::t2, RISCV::t3, RISCV::t4, RISCV::t5,
+    RISCV::t6, RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3, RISCV::a4,
+    RISCV::a5, RISCV::a6, RISCV::a7
+  };
+  unsigned Scratch = 0;
+  for (MCPhysReg Reg : ScratchRegs)
+    if (!Header->isLiveIn(Reg) && !MRI.isReserved(Reg)) {
+      Scratch = Reg;
+      break;
+    }
+  if (!Scratch)
+    return false;
+
+  // Write XVEC_AVAIL_REGS iterations out into VecBody. Memory offsets absorb
+  // the induction steps taken so far, so every access keeps its address.
+  MachineBasicBlock *VecHeader =
+      MF.CreateMachineBasicBlock(Header->getBasicBlock());
+  VecBody = MF.CreateMachineBasicBlock(Header->getBasicBlock());
+  MF.insert(Header->getIterator(), VecHeader);
+  MF.insert(Header->getIterator(), VecBody);
+
+  DebugLoc BranchDL = Header->getFirstTerminator()->getDebugLoc();
+  bool Valid = true;
+  for (int Iter = 0; Valid && Iter != XVEC_AVAIL_REGS; ++Iter) {
+    DenseMap<unsigned, int> Taken;
+    for (MachineInstr &MI : *Header) {
+      if (MI.isDebugValue() || MI.isTerminator())
+        continue;
+      if (isLoopIncrement(MI, NumDefs)) {
+        Taken[MI.getOperand(0).getReg()] += MI.getOperand(2).getImm();
+        continue;
+      }
+
+      MachineInstr *Copy = MF.CloneMachineInstr(&MI);
+      VecBody->push_back(Copy);
+      for (MachineOperand &MO : Copy->operands())
+        if (MO.isReg() && MO.isUse())
+          MO.setIsKill(false);
+      if (!Copy->mayLoad() && !Copy->mayStore())
+        continue;
+
+      if (Copy->getNumOperands() != 3 || !Copy->getOperand(1).isImm() ||
+          !Copy->getOperand(2).isReg()) {
+        Valid = false;
+        break;
+      }
+      unsigned Base = Copy->getOperand(2).getReg();
+      int64_t Offset = Copy->getOperand(1).getImm() + Taken.lookup(Base) +
+                       Iter * Steps.lookup(Base);
+      if (!isInt<12>(Offset)) {
+        Valid = false;
+        break;
+      }
+      Copy->getOperand(1).setImm(Offset);
+    }
+  }
+
+  for (MachineInstr &MI : *Header)
+    if (!MI.isDebugValue() && !MI.isTerminator() &&
+        isLoopIncrement(MI, NumDefs))
+      BuildMI(VecBody, MI.getDebugLoc(), TII->get(RISCV::ADDI),
+              MI.getOperand(0).getReg())
+          .addReg(MI.getOperand(1).getReg())
+          .addImm(XVEC_AVAIL_REGS * MI.getOperand(2).getImm());
+  BuildMI(VecBody, BranchDL, TII->get(RISCV::BEQ))
+      .addMBB(Exit).addReg(IV).addReg(Limit);
+  BuildMI(VecBody, BranchDL, TII->get(RISCV::J)).addMBB(VecHeader);
+
+  RISCVVectorInstrBuilder Builder;
+  if (Valid) {
+    Builder.checkForVectorPatternRR(*VecBody);
+    Builder.checkForVectorPatternRI(*VecBody);
+    Builder.checkForVectorPatternIR(*VecBody);
+    Valid = (Builder.getListSize() == 1) &&
+            (Builder.getFirstAt(0) == VecBody->begin()) &&
+            (Builder.getMatchLengthAt(0) ==
+             VecBody->size() - Steps.size() - 2);
+  }
+  if (!Valid || !isProfitable(Builder, 0, *VecBody)) {
+    MF.erase(VecBody);
+    MF.erase(VecHeader);
+    VecBody = nullptr;
+    return false;
+  }
+
+  // Enough iterations left for a whole chunk? The distance to the limit is
+  // an exact multiple of the step, so an unsigned comparison is safe.
+  if (IVStep > 0)
+    BuildMI(VecHeader, BranchDL, TII->get(RISCV::SUB), Scratch)
+        .addReg(Limit).addReg(IV);
+  else
+    BuildMI(VecHeader, BranchDL, TII->get(RISCV::SUB), Scratch)
+        .addReg(IV).addReg(Limit);
+  BuildMI(VecHeader, BranchDL, TII->get(RISCV::SLTIU), Scratch)
+      .addReg(Scratch).addImm(XVEC_AVAIL_REGS * std::abs(IVStep));
+  BuildMI(VecHeader, BranchDL, TII->get(RISCV::BNE))
+      .addMBB(Header).addReg(Scratch).addReg(RISCV::zero);
+
+  for (const auto &LI : Header->liveins()) {
+    VecHeader->addLiveIn(LI);
+    VecBody->addLiveIn(LI);
+  }
+  for (MachineBasicBlock *Entry : Entries)
+    Entry->ReplaceUsesOfBlockWith(Header, VecHeader);
+  VecHeader->addSuccessor(Header);
+  VecHeader->addSuccessor(VecBody);
+  VecBody->addSuccessor(Exit);
+  VecBody->addSuccessor(VecHeader);
+
+  Builder.substituteAllMatches(VecBody, Subtarget);
+  ++NumLoops;
+  return true;
+}
+
+bool RISCVXvecVectorize::runOnMachineFunction(MachineFunction &Fn) {
+  if (!EnableXvec || skipFunction(*Fn.getFunction()))
+    return false;
+
+  Subtarget = &Fn.getSubtarget<RISCVSubtarget>();
+  TII = Subtarget->getInstrInfo();
+  AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
+  SchedModel.init(Subtarget->getSchedModel(), Subtarget, TII);
+  bool Changed = false;
+
+  // Strip-mine innermost loops first, while the live-in lists computed by the
+  // register allocator still describe the code.
+  SmallPtrSet<MachineBasicBlock *, 8> Substituted;
+  if (EnableXvecLoops && Subtarget->isRV32()) {
+    SmallVector<MachineLoop *, 8> Worklist(
+        getAnalysis<MachineLoopInfo>().begin(),
+        getAnalysis<MachineLoopInfo>().end());
+    while (!Worklist.empty()) {
+      MachineLoop *L = Worklist.pop_back_val();
+      Worklist.append(L->begin(), L->end());
+      MachineBasicBlock *VecBody;
+      if (!L->empty() || !vectorizeLoop(L, VecBody))
+        continue;
+      Substituted.insert(VecBody);
+      Changed = true;
+    }
+  }
+
+  for (MachineFunction::iterator MFI = Fn.begin(), E = Fn.end(); MFI != E;
+       ++MFI) {
+    MachineBasicBlock &MBB = *MFI;
+    if (Substituted.count(&MBB))
+      continue;
+
+    // Matches are recorded as instruction ranges within a single block, so
+    // every block gets its own builder.
+    RISCVVectorInstrBuilder Builder;
+    bool RRFound = Builder.checkForVectorPatternRR(MBB);
+    bool RIFound = Builder.checkForVectorPatternRI(MBB);
+    bool IRFound = Builder.checkForVectorPatternIR(MBB);
+    bool REDFound = Builder.checkForVectorPatternRED(MBB);
+    if (!RRFound && !RIFound && !IRFound && !REDFound)
+      continue;
+
+    // Matches that consume the result of the previous one are substituted
+    // together with it, keeping the intermediate result in the vector bank.
+    Builder.chainMatches(MBB);
+
+    // A match whose stores may clobber elements that it, or the rest of its
+    // chain, still has to read is dropped before the cost model sees it.
+    bool Profitable = false;
+    for (unsigned i = 0, e = Builder.getListSize(); i != e; ++i) {
+      if (preservesMemoryOrder(Builder, i, MBB) &&
+          isProfitable(Builder, i, MBB))
+        Profitable = true;
+      else
+        Builder.rejectMatchAt(i);
+    }
+    if (!Profitable)
+      continue;
+
+    Builder.substituteAllMatches(&MBB, Subtarget);
+    Changed = true;
+  }
+
+  // The substituted sequences move the index registers through x29-x31 and
+  // spill the whole register file into the vector bank, so the kill flags left
+  // by the register allocator no longer describe the code.
+  if (Changed)
+    Fn.getRegInfo().invalidateLiveness();
+
+  return Changed;
+}
@@ -0,0 +1,42 @@
+# Compile-time benchmark for the Xvec pattern matcher and substitution.
+# RUN: python %s | llc -march=riscv -riscv-xvec-cost-model=false -o /dev/null
+#
+# Construct a single basic block with 12288 elements, operated in runs of 28
+# (one Xvec chunk).  Consecutive runs alternate between register-register and
+# register-immediate operations, so the block holds hundreds of matches.
+# Matching and substitution must take time linear in the size of the block:
+# pass the number of elements as an argument and compare -time-passes output
+# for the "RISCV Xvec Vectorize" pass, e.g.
+#
+#   python xvec-compile-time.py 12288 | llc -march=riscv -riscv-xvec-cost-model=false -time-passes
+#   python xvec-compile-time.py 24576 | llc -march=riscv -riscv-xvec-cost-model=false -time-passes
+
+import sys
+
+elements = 12288
+if len(sys.argv) > 1:
+    elements = int(sys.argv[1])
+run = 28
+rr_ops = ['add', 'sub', 'xor', 'or', 'and']
+ri_ops = [('add', 7), ('xor', 255), ('or', 16), ('and', 15), ('shl', 2)]
+
+print('define void @f1(i32 *noalias %a, i32 *noalias %b, i32 *noalias %c) {')
+print('entry:')
+
+for i in range(elements):
+    r = i // run
+    print('  %%pa%d = getelementptr i32, i32 *%%a, i32 %d' % (i, i))
+    print('  %%va%d = load i32, i32 *%%pa%d, align 4' % (i, i))
+    if r % 2 == 0:
+        op = rr_ops[(r // 2) % len(rr_ops)]
+        print('  %%pb%d = getelementptr i32, i32 *%%b, i32 %d' % (i, i))
+        print('  %%vb%d = load i32, i32 *%%pb%d, align 4' % (i, i))
+        print('  %%vc%d = %s i32 %%va%d, %%vb%d' % (i, op, i, i))
+    else:
+        op, imm = ri_ops[(r // 2) % len(ri_ops)]
+        print('  %%vc%d = %s i32 %%va%d, %d' % (i, op, i, imm))
+    print('  %%pc%d = getelementptr i32, i32 *%%c, i32 %d' % (i, i))
+    print('  store i32 %%vc%d, i32 *%%pc%d, align 4' % (i, i))
+
+print('  ret void')
+print('}')
@@ -0,0 +1,43 @@
+; RUN: llc -march=riscv -mattr=+a -show-mc-encoding < %s | FileCheck %s
+; RUN: llc -march=riscv -show-mc-encoding < %s | FileCheck %s
+
+; Atomic loads and stores are plain accesses with the fences of the ISA
+; manual's mapping: fence r,rw after an acquire load, fence rw,rw before a
+; seq_cst load and fence rw,w before a release store.
+define i32 @load_store(i32* %p, i32 %v) {
+; CHECK-LABEL: load_store:
+; CHECK: lw {{x[0-9]+}}, 0(x10)
+; CHECK-NEXT: fence r, rw # encoding: [0x0f,0x00,0x30,0x02]
+; CHECK: fence rw, rw # encoding: [0x0f,0x00,0x30,0x03]
+; CHECK-NEXT: lw {{x[0-9]+}}, 4(x10)
+; CHECK-NEXT: fence r, rw # encoding: [0x0f,0x00,0x30,0x02]
+; CHECK: fence rw, w # encoding: [0x0f,0x00,0x10,0x03]
+; CHECK-NEXT: sw x11, 8(x10)
+; CHECK: fence rw, w # encoding: [0x0f,0x00,0x10,0x03]
+; CHECK: sh x11, 12(x10)
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  %h3 = bitcast i32* %p3 to i16*
+  %t = trunc i32 %v to i16
+  %a = load atomic i32, i32* %p acquire, align 4
+  %b = load atomic i32, i32* %p1 seq_cst, align 4
+  store atomic i32 %v, i32* %p2 release, align 4
+  store atomic i16 %t, i16* %h3 seq_cst, align 2
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+define void @fences() {
+; CHECK-LABEL: fences:
+; CHECK: fence r, rw # encoding: [0x0f,0x00,0x30,0x02]
+; CHECK-NEXT: fence rw, w # encoding: [0x0f,0x00,0x10,0x03]
+; CHECK-NEXT: fence rw, rw # encoding: [0x0f,0x00,0x30,0x03]
+; CHECK-NEXT: fence rw, rw # encoding: [0x0f,0x00,0x30,0x03]
+  fence acquire
+  fence release
+  fence acq_rel
+  fence seq_cst
+  ret void
+}
+
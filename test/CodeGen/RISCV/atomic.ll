@@ -0,0 +1,114 @@
+; RUN: llc -march=riscv -mattr=+a < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I -mattr=+a < %s \
+; RUN:   | FileCheck %s -check-prefix=RV64
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=NOA
+
+; AMOs take their ordering from the aq and rl bits.
+define i32 @amo(i32* %p, i32 %v) {
+; CHECK-LABEL: amo:
+; CHECK: amoadd.w x{{[0-9]+}}, x11, 0(x10)
+; CHECK: amoswap.w.aq x{{[0-9]+}}, x11, 0(x10)
+; CHECK: amoor.w.rl x{{[0-9]+}}, x11, 0(x10)
+; CHECK: amomaxu.w.aqrl x{{[0-9]+}}, x11, 0(x10)
+; CHECK: amomin.w.aqrl x{{[0-9]+}}, x11, 0(x10)
+; CHECK: sub [[NEG:x[0-9]+]], x0, x11
+; CHECK: amoadd.w.aq x{{[0-9]+}}, [[NEG]], 0(x10)
+; NOA-LABEL: amo:
+; NOA: __sync_fetch_and_add_4
+  %a = atomicrmw add i32* %p, i32 %v monotonic
+  %b = atomicrmw xchg i32* %p, i32 %v acquire
+  %c = atomicrmw or i32* %p, i32 %v release
+  %d = atomicrmw umax i32* %p, i32 %v acq_rel
+  %e = atomicrmw min i32* %p, i32 %v seq_cst
+  %f = atomicrmw sub i32* %p, i32 %v acquire
+  %s1 = add i32 %a, %b
+  %s2 = add i32 %s1, %c
+  %s3 = add i32 %s2, %d
+  %s4 = add i32 %s3, %e
+  %s5 = add i32 %s4, %f
+  ret i32 %s5
+}
+
+; cmpxchg and nand are LR/SC loops, with the LR acquiring and the SC
+; releasing.  On RV64 the word loops compare the sign-extended word that
+; lr.w loads with the sign-extended i32 operand.
+define i32 @cas(i32* %p, i32 %c, i32 %n) {
+; CHECK-LABEL: cas:
+; CHECK: [[LOOP:Ltmp[0-9]+]]:
+; CHECK-NEXT: lr.w.aq [[RES:x[0-9]+]], 0(x10)
+; CHECK-NEXT: bne [[RES]], x11, [[DONE:Ltmp[0-9]+]]
+; CHECK-NEXT: sc.w.rl [[FAIL:x[0-9]+]], x12, 0(x10)
+; CHECK-NEXT: bne [[FAIL]], x0, [[LOOP]]
+; CHECK-NEXT: [[DONE]]:
+; RV64-LABEL: cas:
+; RV64: [[LOOP:Ltmp[0-9]+]]:
+; RV64-NEXT: lr.w.aq [[RES:x[0-9]+]], 0(x10)
+; RV64-NEXT: bne [[RES]], x11, [[DONE:Ltmp[0-9]+]]
+; RV64-NEXT: sc.w.rl [[FAIL:x[0-9]+]], x12, 0(x10)
+; RV64-NEXT: bne [[FAIL]], x0, [[LOOP]]
+; RV64-NEXT: [[DONE]]:
+; RV64-NOT: __sync_val_compare_and_swap_4
+; NOA-LABEL: cas:
+; NOA: __sync_val_compare_and_swap_4
+  %r = cmpxchg i32* %p, i32 %c, i32 %n acq_rel monotonic
+  %v = extractvalue { i32, i1 } %r, 0
+  ret i32 %v
+}
+
+define i32 @nand(i32* %p, i32 %v) {
+; CHECK-LABEL: nand:
+; CHECK: [[LOOP:Ltmp[0-9]+]]:
+; CHECK-NEXT: lr.w.aqrl [[RES:x[0-9]+]], 0(x10)
+; CHECK-NEXT: and [[TMP:x[0-9]+]], [[RES]], x11
+; CHECK-NEXT: xori [[TMP]], [[TMP]], -1
+; CHECK-NEXT: sc.w.rl [[TMP]], [[TMP]], 0(x10)
+; CHECK-NEXT: bne [[TMP]], x0, [[LOOP]]
+; RV64-LABEL: nand:
+; RV64: [[LOOP:Ltmp[0-9]+]]:
+; RV64-NEXT: lr.w.aqrl [[RES:x[0-9]+]], 0(x10)
+; RV64-NEXT: and [[TMP:x[0-9]+]], [[RES]], x11
+; RV64-NEXT: xori [[TMP]], [[TMP]], -1
+; RV64-NEXT: sc.w.rl [[TMP]], [[TMP]], 0(x10)
+; RV64-NEXT: bne [[TMP]], x0, [[LOOP]]
+  %r = atomicrmw nand i32* %p, i32 %v seq_cst
+  ret i32 %r
+}
+
+; Sub-word operations work on the containing word.
+define i8 @add8(i8* %p, i8 %v) {
+; CHECK-LABEL: add8:
+; CHECK: andi [[WORD:x[0-9]+]], x10, -4
+; CHECK: lr.w.aqrl {{x[0-9]+}}, 0([[WORD]])
+; CHECK: sc.w.rl {{x[0-9]+}}, {{x[0-9]+}}, 0([[WORD]])
+; RV64-LABEL: add8:
+; RV64: andi [[WORD:x[0-9]+]], x10, -4
+; RV64: addiw [[OLD:x[0-9]+]], {{x[0-9]+}}, 0
+; RV64: lr.w.aqrl [[RES:x[0-9]+]], 0([[WORD]])
+; RV64-NEXT: bne [[RES]], [[OLD]],
+; RV64-NEXT: sc.w.rl {{x[0-9]+}}, {{x[0-9]+}}, 0([[WORD]])
+; NOA-LABEL: add8:
+; NOA: __sync_fetch_and_add_1
+  %r = atomicrmw add i8* %p, i8 %v seq_cst
+  ret i8 %r
+}
+
+; RV32 has no doubleword atomics.
+define i64 @amo64(i64* %p, i64 %v) {
+; CHECK-LABEL: amo64:
+; CHECK: %hi(__atomic_fetch_add_8)
+; RV64-LABEL: amo64:
+; RV64: amoadd.d.aqrl x{{[0-9]+}}, x11, 0(x10)
+; RV64: [[LOOP:Ltmp[0-9]+]]:
+; RV64-NEXT: lr.d [[RES:x[0-9]+]], 0(x10)
+; RV64-NEXT: bne [[RES]], {{x[0-9]+}}, [[DONE:Ltmp[0-9]+]]
+; RV64-NEXT: sc.d [[FAIL:x[0-9]+]], x11, 0(x10)
+; RV64-NEXT: bne [[FAIL]], x0, [[LOOP]]
+; RV64: ld {{x[0-9]+}}, 0(x10)
+; RV64: fence
+  %a = atomicrmw add i64* %p, i64 %v seq_cst
+  %r = cmpxchg i64* %p, i64 %a, i64 %v monotonic monotonic
+  %b = extractvalue { i64, i1 } %r, 0
+  %c = load atomic i64, i64* %p acquire, align 8
+  %s = add i64 %b, %c
+  ret i64 %s
+}
@@ -0,0 +1,27 @@
+; RUN: llc -march=riscv < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s -check-prefix=RV64
+
+declare i32 @g(i32)
+
+; The call clobbers the argument and temporary registers, so %y has to be
+; kept in a callee-saved register, which is itself saved and restored.
+define i32 @live_across_call(i32 %x, i32 %y) {
+; CHECK-LABEL: live_across_call:
+; CHECK: sw x8, [[SLOT:[0-9]+]](x2)
+; CHECK: addi x8, x11, 0
+; CHECK: jalr x1
+; CHECK-NEXT: add x10, x10, x8
+; CHECK: lw x8, [[SLOT]](x2)
+; CHECK: ret
+
+; RV64-LABEL: live_across_call:
+; RV64: sd x8, [[SLOT:[0-9]+]](x2)
+; RV64: addi x8, x11, 0
+; RV64: jalr x1
+; RV64-NEXT: addw x10, x10, x8
+; RV64: ld x8, [[SLOT]](x2)
+; RV64: ret
+  %a = call i32 @g(i32 %x)
+  %s = add i32 %a, %y
+  ret i32 %s
+}
@@ -0,0 +1,39 @@
+; RUN: llc -march=riscv -mcpu=vscale -riscv-xvec-loops=false -filetype=obj < %s \
+; RUN:   -o %t
+; RUN: llvm-readobj -h %t | FileCheck %s -check-prefix=HEADER
+; RUN: llvm-objdump -d %t | FileCheck %s
+
+; RV32 objects are 32-bit and little-endian, and branches to labels in the
+; same section are resolved in place.  objdump picks RV32 from the ELF class.
+; The loop is not strip-mined for Xvec, so that it stays small.
+
+; HEADER: Format: ELF32-riscv
+; HEADER: Class: 32-bit
+; HEADER: DataEncoding: LittleEndian
+
+define void @add(i32* noalias %a, i32* noalias %b, i32* noalias %c, i32 %n) {
+; CHECK-LABEL: add:
+; CHECK:       0: 93 02 10 00 addi x5, x0, 1
+; CHECK-NEXT:  4: 63 52 4a 03 blt x13, x5, .+40
+; CHECK:      28: e3 c0 41 fb bne x13, x0, .-32
+; CHECK-NEXT: 2c: 6b 00 40 00 ret
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  %pa = getelementptr i32, i32* %a, i32 %i
+  %pb = getelementptr i32, i32* %b, i32 %i
+  %pc = getelementptr i32, i32* %c, i32 %i
+  %va = load i32, i32* %pa
+  %vb = load i32, i32* %pb
+  %s = add i32 %va, %vb
+  store i32 %s, i32* %pc
+  %inc = add i32 %i, 1
+  %done = icmp eq i32 %inc, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
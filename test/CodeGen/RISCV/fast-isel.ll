@@ -0,0 +1,145 @@
+; RUN: llc -march=riscv -O0 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -march=riscv -mattr=+relax -O0 < %s | FileCheck %s -check-prefix=RELAX
+; RUN: llc -march=riscv -O0 -fast-isel-verbose < %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s -check-prefix=VERBOSE
+
+; Only the float function needs SelectionDAG.
+; VERBOSE-NOT: FastISel missed
+; VERBOSE: FastISel missed terminator: ret float
+; VERBOSE-NOT: FastISel missed
+
+@g = global i32 0
+@arr = global [100 x i32] zeroinitializer
+
+declare i32 @ext(i32, i32)
+declare i32 @many(i32, i32, i32, i32, i32, i32, i32, i32, i32, i32)
+
+define i32 @alu(i32 %a, i32 %b) {
+; CHECK-LABEL: alu:
+; CHECK: lui [[HI:x[0-9]+]], 24
+; CHECK: addi [[IMM:x[0-9]+]], [[HI]], 1696
+; CHECK: add [[R:x[0-9]+]], x10, x11
+; CHECK: sub [[R]], [[R]], x11
+; CHECK: andi [[R]], [[R]], 255
+; CHECK: or [[R]], [[R]], x10
+; CHECK: xori [[R]], [[R]], -1
+; CHECK: slli [[R]], [[R]], 3
+; CHECK: srl [[R]], [[R]], x11
+; CHECK: srai [[R]], [[R]], 2
+; CHECK: add x10, [[R]], [[IMM]]
+; CHECK: ret
+  %1 = add i32 %a, %b
+  %2 = sub i32 %1, %b
+  %3 = and i32 %2, 255
+  %4 = or i32 %3, %a
+  %5 = xor i32 %4, -1
+  %6 = shl i32 %5, 3
+  %7 = lshr i32 %6, %b
+  %8 = ashr i32 %7, 2
+  %9 = add i32 %8, 100000
+  ret i32 %9
+}
+
+; Constant offsets and frame indices are folded into the loads and stores.
+define void @mem(i32* %p, i8* %q) {
+; CHECK-LABEL: mem:
+; CHECK: lui [[ARRHI:x[0-9]+]], %hi(arr)
+; CHECK: addi [[ARR:x[0-9]+]], [[ARRHI]], %lo(arr)
+; CHECK: lui [[GHI:x[0-9]+]], %hi(g)
+; CHECK: addi [[G:x[0-9]+]], [[GHI]], %lo(g)
+; CHECK: lw [[V:x[0-9]+]], 0(x10)
+; CHECK: sw [[V]], 8(x2)
+; CHECK: lhu [[H:x[0-9]+]], 4(x2)
+; CHECK: lbu [[B:x[0-9]+]], 0(x11)
+; CHECK: andi [[B]], [[B]], 255
+; CHECK: slli [[H]], [[H]], 16
+; CHECK: srai [[H]], [[H]], 16
+; CHECK: sw {{x[0-9]+}}, 12(x10)
+; CHECK: lw [[GV:x[0-9]+]], 0([[G]])
+; CHECK: sw [[GV]], 20([[ARR]])
+  %x = alloca i32
+  %y = alloca [4 x i16]
+  %v = load i32, i32* %p
+  store i32 %v, i32* %x
+  %e = getelementptr [4 x i16], [4 x i16]* %y, i32 0, i32 2
+  %w = load i16, i16* %e
+  %c = load i8, i8* %q
+  %cz = zext i8 %c to i32
+  %ws = sext i16 %w to i32
+  %s = add i32 %cz, %ws
+  %gp = getelementptr i32, i32* %p, i32 3
+  store i32 %s, i32* %gp
+  %gv = load i32, i32* @g
+  store i32 %gv, i32* getelementptr ([100 x i32], [100 x i32]* @arr, i32 0, i32 5)
+  ret void
+}
+
+; Conditions are computed into a register and tested against zero.  Calls
+; go through a register unless the linker may relax them.
+define i32 @branch(i32 %a, i32 %b) {
+; CHECK-LABEL: branch:
+; CHECK: slt [[C:x[0-9]+]], x10, x11
+; CHECK: bne [[C]], x0, [[T:LBB[0-9_]+]]
+; CHECK: j [[F:LBB[0-9_]+]]
+; CHECK: [[T]]:
+; CHECK: lui [[HI:x[0-9]+]], %hi(ext)
+; CHECK: addi [[EXT:x[0-9]+]], [[HI]], %lo(ext)
+; CHECK: addi x11, x0, 1
+; CHECK: jalr x1, [[EXT]], 0
+; CHECK: [[F]]:
+; CHECK: sltu [[U:x[0-9]+]], {{x[0-9]+}}, {{x[0-9]+}}
+; CHECK: xori [[U]], [[U]], 1
+; CHECK: andi x10, [[U]], 1
+; RELAX-LABEL: branch:
+; RELAX: call ext
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %t, label %f
+t:
+  %r = call i32 @ext(i32 %a, i32 1)
+  ret i32 %r
+f:
+  %u = icmp ule i32 %a, %b
+  %z = zext i1 %u to i32
+  ret i32 %z
+}
+
+; The generic code selects the negation as an xori with -1, which leaves the
+; high bits of the i1 set, so only its low bit is branched on and stored.
+define i32 @not(i32 %a, i32 %b, i1* %p) {
+; CHECK-LABEL: not:
+; CHECK: slt [[C:x[0-9]+]], x10, x11
+; CHECK: xori [[N:x[0-9]+]], [[C]], -1
+; CHECK: andi [[S:x[0-9]+]], [[N]], 1
+; CHECK: sb [[S]], 0(x12)
+; CHECK: andi [[B:x[0-9]+]], [[N]], 1
+; CHECK: bne [[B]], x0, [[T:LBB[0-9_]+]]
+; CHECK: j [[F:LBB[0-9_]+]]
+entry:
+  %c = icmp slt i32 %a, %b
+  %n = xor i1 %c, true
+  store i1 %n, i1* %p
+  br i1 %n, label %t, label %f
+t:
+  ret i32 1
+f:
+  ret i32 0
+}
+
+; Arguments beyond a7 go in 8-byte stack slots.
+define i32 @stackargs(i32 %a) {
+; CHECK-LABEL: stackargs:
+; CHECK: addi x17, x0, 7
+; CHECK: sw {{x[0-9]+}}, 0(x2)
+; CHECK: sw {{x[0-9]+}}, 8(x2)
+; CHECK: jalr x1
+  %r = call i32 @many(i32 %a, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7, i32 8, i32 9)
+  ret i32 %r
+}
+
+define float @fp(float %a) {
+; CHECK-LABEL: fp:
+; CHECK: __addsf3
+  %r = fadd float %a, %a
+  ret float %r
+}
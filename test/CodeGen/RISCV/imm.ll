@@ -0,0 +1,61 @@
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=RV32
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s -check-prefix=RV64
+; RUN: llc -march=riscv -filetype=obj < %s -o /dev/null
+
+define i32 @lui_addi() {
+; RV32-LABEL: lui_addi:
+; RV32: lui x10, 74565
+; RV32-NEXT: addi x10, x10, 1656
+  ret i32 305419896 ;0x12345678
+}
+
+define i32 @round_up() {
+; RV32-LABEL: round_up:
+; RV32: lui x10, 524288
+; RV32-NEXT: addi x10, x10, -1
+  ret i32 2147483647 ;0x7fffffff
+}
+
+define i64 @shifted_mask() {
+; RV64-LABEL: shifted_mask:
+; RV64: addi x10, x0, -1
+; RV64-NEXT: slli x10, x10, 63
+  ret i64 -9223372036854775808 ;0x8000000000000000
+}
+
+define i64 @leading_zeros() {
+; RV64-LABEL: leading_zeros:
+; RV64: addi x10, x0, -16
+; RV64-NEXT: srli x10, x10, 4
+  ret i64 1152921504606846975 ;0x0fffffffffffffff
+}
+
+define i64 @trailing_zeros() {
+; RV64-LABEL: trailing_zeros:
+; RV64: addi x10, x0, 291
+; RV64-NEXT: slli x10, x10, 40
+  ret i64 319957883682816 ;0x123 << 40
+}
+
+; The constant is loaded once, outside the loop.
+define void @hoist(i32* %p, i32 %n) {
+; RV32-LABEL: hoist:
+; RV32: lui [[REG:x[0-9]+]], 74565
+; RV32-NEXT: addi [[REG]], [[REG]], 1656
+; RV32: LBB{{[0-9_]+}}:
+; RV32-NOT: lui
+; RV32: xor {{x[0-9]+}}, {{x[0-9]+}}, [[REG]]
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %a = getelementptr i32, i32* %p, i32 %i
+  %v = load i32, i32* %a
+  %x = xor i32 %v, 305419896
+  store i32 %x, i32* %a
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret void
+}
@@ -0,0 +1,41 @@
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=NORELAX
+; RUN: llc -march=riscv -mattr=+relax < %s | FileCheck %s -check-prefix=RELAX
+; RUN: llc -march=riscv -mattr=+relax -filetype=obj < %s -o - \
+; RUN:   | llvm-readobj -r - | FileCheck %s -check-prefix=RELOC
+
+@g = global i32 0
+
+declare void @ext()
+
+define void @calls() {
+; NORELAX-LABEL: calls:
+; NORELAX-NOT: {{[[:space:]]}}call{{[[:space:]]}}
+; NORELAX: jalr
+; RELAX-LABEL: calls:
+; RELAX: call{{[[:space:]]+}}ext
+; RELAX: call{{[[:space:]]+}}calls
+  call void @ext()
+  call void @calls()
+  ret void
+}
+
+define void @store(i32 %x) {
+  store i32 %x, i32* @g
+  ret void
+}
+
+define void @aligned() align 16 {
+  ret void
+}
+
+; RELOC: Section ({{[0-9]+}}) .rela.text {
+; RELOC-NEXT: R_RISCV_CALL ext 0x0
+; RELOC-NEXT: R_RISCV_RELAX - 0x0
+; RELOC-NEXT: R_RISCV_CALL calls 0x0
+; RELOC-NEXT: R_RISCV_RELAX - 0x0
+; RELOC-NEXT: R_RISCV_HI20 g 0x0
+; RELOC-NEXT: R_RISCV_RELAX - 0x0
+; RELOC-NEXT: R_RISCV_LO12_I g 0x0
+; RELOC-NEXT: R_RISCV_RELAX - 0x0
+; RELOC-NEXT: R_RISCV_ALIGN - 0xC
+; RELOC-NEXT: }
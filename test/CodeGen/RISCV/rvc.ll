@@ -0,0 +1,695 @@
+; RUN: llc -march=riscv -mattr=+c -show-mc-encoding < %s | FileCheck %s
+; RUN: llc -march=riscv -mattr=+c -filetype=obj < %s \
+; RUN:   | llvm-objdump -d - | FileCheck %s -check-prefix=OBJ
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=NORVC
+
+; CHECK-LABEL: sum:
+; CHECK:      lw x5, 0(x10) # encoding: [0x03,0x01,0x80,0x2a]
+; CHECK:      c.add x5, x6 # encoding: [0x9a,0x92]
+; CHECK-NEXT: xor x5, x5, x11 # encoding: [0xb3,0xc2,0xb2,0x00]
+; CHECK-NEXT: andi x5, x5, 15 # encoding: [0x93,0xf2,0xf2,0x00]
+; CHECK-NEXT: c.slli x5, 3 # encoding: [0x8e,0x02]
+; CHECK-NEXT: sw x5, 4(x10) # encoding: [0x23,0x11,0x8a,0x02]
+; CHECK-NEXT: c.mv x10, x5 # encoding: [0x16,0x85]
+; CHECK-NEXT: c.jr x1 # encoding: [0x82,0x80]
+; OBJ-LABEL:  sum:
+; OBJ-NEXT:   0: 03 01 80 2a lw x5, 0(x10)
+; OBJ-NEXT:   4: 03 11 80 32 lw x6, 4(x10)
+; OBJ-NEXT:   8: 9a 92
+; OBJ-NEXT:   a: b3 c2 b2 00 xor x5, x5, x11
+; OBJ-NEXT:   e: 93 f2 f2 00 andi x5, x5, 15
+; OBJ-NEXT:  12: 8e 02
+; OBJ-NEXT:  14: 23 11 8a 02 sw x5, 4(x10)
+; OBJ-NEXT:  18: 16 85
+; OBJ-NEXT:  1a: 82 80
+define i32 @sum(i32* %p, i32 %n) {
+entry:
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %a = load i32, i32* %p, align 4
+  %b = load i32, i32* %p1, align 4
+  %s = add i32 %a, %b
+  %x = xor i32 %s, %n
+  %y = and i32 %x, 15
+  %z = shl i32 %y, 3
+  store i32 %z, i32* %p1, align 4
+  ret i32 %z
+}
+
+; The branch offsets count the compressed instructions.
+; CHECK-LABEL: loop:
+; CHECK:      c.addi x11, -1 # encoding: [0xfd,0x15]
+; CHECK-NEXT: c.addi x5, 1 # encoding: [0x85,0x02]
+; CHECK:      c.addi x10, 4 # encoding: [0x11,0x05]
+; OBJ-LABEL:  loop:
+; OBJ-NEXT:  1c: 63 2c c0 02 beq x11, x0, .+22
+; OBJ:       2e: e3 e4 c1 fa bne x11, x0, .-14
+; OBJ-NEXT:  32: 82 80
+define void @loop(i32* %p, i32 %n) {
+entry:
+  %cmp = icmp eq i32 %n, 0
+  br i1 %cmp, label %exit, label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %inc, %body ]
+  %q = getelementptr i32, i32* %p, i32 %i
+  %v = load i32, i32* %q, align 4
+  %w = add i32 %v, 1
+  store i32 %w, i32* %q, align 4
+  %inc = add i32 %i, 1
+  %done = icmp eq i32 %inc, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret void
+}
+
+
+; The loop body is about 1.2 KiB with RVC and 2.4 KiB without, so the branch
+; selector only has to turn the backward branch into a long one when the
+; instructions are not compressed.
+; CHECK-LABEL: far:
+; CHECK:       c.addi x5, -1
+; CHECK-NEXT:  add x10, x6, x11
+; CHECK-NEXT:  bne x5, x0, LBB2_1
+; OBJ-LABEL:   far:
+; OBJ:         e3 94 40 d9 bne x5, x0, .-1206
+; OBJ-NEXT:    82 80
+; NORVC-LABEL: far:
+; NORVC:       addi x5, x5, -1
+; NORVC-NEXT:  add x10, x6, x11
+; NORVC-NEXT:  beq x5, x0, .+8
+; NORVC-NEXT:  j LBB2_1
+define i32 @far(i32 %x, i32 %n) {
+entry:
+  br label %body
+
+body:
+  %acc = phi i32 [ %x, %entry ], [ %v299, %body ]
+  %i = phi i32 [ %n, %entry ], [ %dec, %body ]
+  %s0 = shl i32 %acc, 1
+  %v0 = add i32 %s0, %n
+  %s1 = shl i32 %v0, 1
+  %v1 = add i32 %s1, %n
+  %s2 = shl i32 %v1, 1
+  %v2 = add i32 %s2, %n
+  %s3 = shl i32 %v2, 1
+  %v3 = add i32 %s3, %n
+  %s4 = shl i32 %v3, 1
+  %v4 = add i32 %s4, %n
+  %s5 = shl i32 %v4, 1
+  %v5 = add i32 %s5, %n
+  %s6 = shl i32 %v5, 1
+  %v6 = add i32 %s6, %n
+  %s7 = shl i32 %v6, 1
+  %v7 = add i32 %s7, %n
+  %s8 = shl i32 %v7, 1
+  %v8 = add i32 %s8, %n
+  %s9 = shl i32 %v8, 1
+  %v9 = add i32 %s9, %n
+  %s10 = shl i32 %v9, 1
+  %v10 = add i32 %s10, %n
+  %s11 = shl i32 %v10, 1
+  %v11 = add i32 %s11, %n
+  %s12 = shl i32 %v11, 1
+  %v12 = add i32 %s12, %n
+  %s13 = shl i32 %v12, 1
+  %v13 = add i32 %s13, %n
+  %s14 = shl i32 %v13, 1
+  %v14 = add i32 %s14, %n
+  %s15 = shl i32 %v14, 1
+  %v15 = add i32 %s15, %n
+  %s16 = shl i32 %v15, 1
+  %v16 = add i32 %s16, %n
+  %s17 = shl i32 %v16, 1
+  %v17 = add i32 %s17, %n
+  %s18 = shl i32 %v17, 1
+  %v18 = add i32 %s18, %n
+  %s19 = shl i32 %v18, 1
+  %v19 = add i32 %s19, %n
+  %s20 = shl i32 %v19, 1
+  %v20 = add i32 %s20, %n
+  %s21 = shl i32 %v20, 1
+  %v21 = add i32 %s21, %n
+  %s22 = shl i32 %v21, 1
+  %v22 = add i32 %s22, %n
+  %s23 = shl i32 %v22, 1
+  %v23 = add i32 %s23, %n
+  %s24 = shl i32 %v23, 1
+  %v24 = add i32 %s24, %n
+  %s25 = shl i32 %v24, 1
+  %v25 = add i32 %s25, %n
+  %s26 = shl i32 %v25, 1
+  %v26 = add i32 %s26, %n
+  %s27 = shl i32 %v26, 1
+  %v27 = add i32 %s27, %n
+  %s28 = shl i32 %v27, 1
+  %v28 = add i32 %s28, %n
+  %s29 = shl i32 %v28, 1
+  %v29 = add i32 %s29, %n
+  %s30 = shl i32 %v29, 1
+  %v30 = add i32 %s30, %n
+  %s31 = shl i32 %v30, 1
+  %v31 = add i32 %s31, %n
+  %s32 = shl i32 %v31, 1
+  %v32 = add i32 %s32, %n
+  %s33 = shl i32 %v32, 1
+  %v33 = add i32 %s33, %n
+  %s34 = shl i32 %v33, 1
+  %v34 = add i32 %s34, %n
+  %s35 = shl i32 %v34, 1
+  %v35 = add i32 %s35, %n
+  %s36 = shl i32 %v35, 1
+  %v36 = add i32 %s36, %n
+  %s37 = shl i32 %v36, 1
+  %v37 = add i32 %s37, %n
+  %s38 = shl i32 %v37, 1
+  %v38 = add i32 %s38, %n
+  %s39 = shl i32 %v38, 1
+  %v39 = add i32 %s39, %n
+  %s40 = shl i32 %v39, 1
+  %v40 = add i32 %s40, %n
+  %s41 = shl i32 %v40, 1
+  %v41 = add i32 %s41, %n
+  %s42 = shl i32 %v41, 1
+  %v42 = add i32 %s42, %n
+  %s43 = shl i32 %v42, 1
+  %v43 = add i32 %s43, %n
+  %s44 = shl i32 %v43, 1
+  %v44 = add i32 %s44, %n
+  %s45 = shl i32 %v44, 1
+  %v45 = add i32 %s45, %n
+  %s46 = shl i32 %v45, 1
+  %v46 = add i32 %s46, %n
+  %s47 = shl i32 %v46, 1
+  %v47 = add i32 %s47, %n
+  %s48 = shl i32 %v47, 1
+  %v48 = add i32 %s48, %n
+  %s49 = shl i32 %v48, 1
+  %v49 = add i32 %s49, %n
+  %s50 = shl i32 %v49, 1
+  %v50 = add i32 %s50, %n
+  %s51 = shl i32 %v50, 1
+  %v51 = add i32 %s51, %n
+  %s52 = shl i32 %v51, 1
+  %v52 = add i32 %s52, %n
+  %s53 = shl i32 %v52, 1
+  %v53 = add i32 %s53, %n
+  %s54 = shl i32 %v53, 1
+  %v54 = add i32 %s54, %n
+  %s55 = shl i32 %v54, 1
+  %v55 = add i32 %s55, %n
+  %s56 = shl i32 %v55, 1
+  %v56 = add i32 %s56, %n
+  %s57 = shl i32 %v56, 1
+  %v57 = add i32 %s57, %n
+  %s58 = shl i32 %v57, 1
+  %v58 = add i32 %s58, %n
+  %s59 = shl i32 %v58, 1
+  %v59 = add i32 %s59, %n
+  %s60 = shl i32 %v59, 1
+  %v60 = add i32 %s60, %n
+  %s61 = shl i32 %v60, 1
+  %v61 = add i32 %s61, %n
+  %s62 = shl i32 %v61, 1
+  %v62 = add i32 %s62, %n
+  %s63 = shl i32 %v62, 1
+  %v63 = add i32 %s63, %n
+  %s64 = shl i32 %v63, 1
+  %v64 = add i32 %s64, %n
+  %s65 = shl i32 %v64, 1
+  %v65 = add i32 %s65, %n
+  %s66 = shl i32 %v65, 1
+  %v66 = add i32 %s66, %n
+  %s67 = shl i32 %v66, 1
+  %v67 = add i32 %s67, %n
+  %s68 = shl i32 %v67, 1
+  %v68 = add i32 %s68, %n
+  %s69 = shl i32 %v68, 1
+  %v69 = add i32 %s69, %n
+  %s70 = shl i32 %v69, 1
+  %v70 = add i32 %s70, %n
+  %s71 = shl i32 %v70, 1
+  %v71 = add i32 %s71, %n
+  %s72 = shl i32 %v71, 1
+  %v72 = add i32 %s72, %n
+  %s73 = shl i32 %v72, 1
+  %v73 = add i32 %s73, %n
+  %s74 = shl i32 %v73, 1
+  %v74 = add i32 %s74, %n
+  %s75 = shl i32 %v74, 1
+  %v75 = add i32 %s75, %n
+  %s76 = shl i32 %v75, 1
+  %v76 = add i32 %s76, %n
+  %s77 = shl i32 %v76, 1
+  %v77 = add i32 %s77, %n
+  %s78 = shl i32 %v77, 1
+  %v78 = add i32 %s78, %n
+  %s79 = shl i32 %v78, 1
+  %v79 = add i32 %s79, %n
+  %s80 = shl i32 %v79, 1
+  %v80 = add i32 %s80, %n
+  %s81 = shl i32 %v80, 1
+  %v81 = add i32 %s81, %n
+  %s82 = shl i32 %v81, 1
+  %v82 = add i32 %s82, %n
+  %s83 = shl i32 %v82, 1
+  %v83 = add i32 %s83, %n
+  %s84 = shl i32 %v83, 1
+  %v84 = add i32 %s84, %n
+  %s85 = shl i32 %v84, 1
+  %v85 = add i32 %s85, %n
+  %s86 = shl i32 %v85, 1
+  %v86 = add i32 %s86, %n
+  %s87 = shl i32 %v86, 1
+  %v87 = add i32 %s87, %n
+  %s88 = shl i32 %v87, 1
+  %v88 = add i32 %s88, %n
+  %s89 = shl i32 %v88, 1
+  %v89 = add i32 %s89, %n
+  %s90 = shl i32 %v89, 1
+  %v90 = add i32 %s90, %n
+  %s91 = shl i32 %v90, 1
+  %v91 = add i32 %s91, %n
+  %s92 = shl i32 %v91, 1
+  %v92 = add i32 %s92, %n
+  %s93 = shl i32 %v92, 1
+  %v93 = add i32 %s93, %n
+  %s94 = shl i32 %v93, 1
+  %v94 = add i32 %s94, %n
+  %s95 = shl i32 %v94, 1
+  %v95 = add i32 %s95, %n
+  %s96 = shl i32 %v95, 1
+  %v96 = add i32 %s96, %n
+  %s97 = shl i32 %v96, 1
+  %v97 = add i32 %s97, %n
+  %s98 = shl i32 %v97, 1
+  %v98 = add i32 %s98, %n
+  %s99 = shl i32 %v98, 1
+  %v99 = add i32 %s99, %n
+  %s100 = shl i32 %v99, 1
+  %v100 = add i32 %s100, %n
+  %s101 = shl i32 %v100, 1
+  %v101 = add i32 %s101, %n
+  %s102 = shl i32 %v101, 1
+  %v102 = add i32 %s102, %n
+  %s103 = shl i32 %v102, 1
+  %v103 = add i32 %s103, %n
+  %s104 = shl i32 %v103, 1
+  %v104 = add i32 %s104, %n
+  %s105 = shl i32 %v104, 1
+  %v105 = add i32 %s105, %n
+  %s106 = shl i32 %v105, 1
+  %v106 = add i32 %s106, %n
+  %s107 = shl i32 %v106, 1
+  %v107 = add i32 %s107, %n
+  %s108 = shl i32 %v107, 1
+  %v108 = add i32 %s108, %n
+  %s109 = shl i32 %v108, 1
+  %v109 = add i32 %s109, %n
+  %s110 = shl i32 %v109, 1
+  %v110 = add i32 %s110, %n
+  %s111 = shl i32 %v110, 1
+  %v111 = add i32 %s111, %n
+  %s112 = shl i32 %v111, 1
+  %v112 = add i32 %s112, %n
+  %s113 = shl i32 %v112, 1
+  %v113 = add i32 %s113, %n
+  %s114 = shl i32 %v113, 1
+  %v114 = add i32 %s114, %n
+  %s115 = shl i32 %v114, 1
+  %v115 = add i32 %s115, %n
+  %s116 = shl i32 %v115, 1
+  %v116 = add i32 %s116, %n
+  %s117 = shl i32 %v116, 1
+  %v117 = add i32 %s117, %n
+  %s118 = shl i32 %v117, 1
+  %v118 = add i32 %s118, %n
+  %s119 = shl i32 %v118, 1
+  %v119 = add i32 %s119, %n
+  %s120 = shl i32 %v119, 1
+  %v120 = add i32 %s120, %n
+  %s121 = shl i32 %v120, 1
+  %v121 = add i32 %s121, %n
+  %s122 = shl i32 %v121, 1
+  %v122 = add i32 %s122, %n
+  %s123 = shl i32 %v122, 1
+  %v123 = add i32 %s123, %n
+  %s124 = shl i32 %v123, 1
+  %v124 = add i32 %s124, %n
+  %s125 = shl i32 %v124, 1
+  %v125 = add i32 %s125, %n
+  %s126 = shl i32 %v125, 1
+  %v126 = add i32 %s126, %n
+  %s127 = shl i32 %v126, 1
+  %v127 = add i32 %s127, %n
+  %s128 = shl i32 %v127, 1
+  %v128 = add i32 %s128, %n
+  %s129 = shl i32 %v128, 1
+  %v129 = add i32 %s129, %n
+  %s130 = shl i32 %v129, 1
+  %v130 = add i32 %s130, %n
+  %s131 = shl i32 %v130, 1
+  %v131 = add i32 %s131, %n
+  %s132 = shl i32 %v131, 1
+  %v132 = add i32 %s132, %n
+  %s133 = shl i32 %v132, 1
+  %v133 = add i32 %s133, %n
+  %s134 = shl i32 %v133, 1
+  %v134 = add i32 %s134, %n
+  %s135 = shl i32 %v134, 1
+  %v135 = add i32 %s135, %n
+  %s136 = shl i32 %v135, 1
+  %v136 = add i32 %s136, %n
+  %s137 = shl i32 %v136, 1
+  %v137 = add i32 %s137, %n
+  %s138 = shl i32 %v137, 1
+  %v138 = add i32 %s138, %n
+  %s139 = shl i32 %v138, 1
+  %v139 = add i32 %s139, %n
+  %s140 = shl i32 %v139, 1
+  %v140 = add i32 %s140, %n
+  %s141 = shl i32 %v140, 1
+  %v141 = add i32 %s141, %n
+  %s142 = shl i32 %v141, 1
+  %v142 = add i32 %s142, %n
+  %s143 = shl i32 %v142, 1
+  %v143 = add i32 %s143, %n
+  %s144 = shl i32 %v143, 1
+  %v144 = add i32 %s144, %n
+  %s145 = shl i32 %v144, 1
+  %v145 = add i32 %s145, %n
+  %s146 = shl i32 %v145, 1
+  %v146 = add i32 %s146, %n
+  %s147 = shl i32 %v146, 1
+  %v147 = add i32 %s147, %n
+  %s148 = shl i32 %v147, 1
+  %v148 = add i32 %s148, %n
+  %s149 = shl i32 %v148, 1
+  %v149 = add i32 %s149, %n
+  %s150 = shl i32 %v149, 1
+  %v150 = add i32 %s150, %n
+  %s151 = shl i32 %v150, 1
+  %v151 = add i32 %s151, %n
+  %s152 = shl i32 %v151, 1
+  %v152 = add i32 %s152, %n
+  %s153 = shl i32 %v152, 1
+  %v153 = add i32 %s153, %n
+  %s154 = shl i32 %v153, 1
+  %v154 = add i32 %s154, %n
+  %s155 = shl i32 %v154, 1
+  %v155 = add i32 %s155, %n
+  %s156 = shl i32 %v155, 1
+  %v156 = add i32 %s156, %n
+  %s157 = shl i32 %v156, 1
+  %v157 = add i32 %s157, %n
+  %s158 = shl i32 %v157, 1
+  %v158 = add i32 %s158, %n
+  %s159 = shl i32 %v158, 1
+  %v159 = add i32 %s159, %n
+  %s160 = shl i32 %v159, 1
+  %v160 = add i32 %s160, %n
+  %s161 = shl i32 %v160, 1
+  %v161 = add i32 %s161, %n
+  %s162 = shl i32 %v161, 1
+  %v162 = add i32 %s162, %n
+  %s163 = shl i32 %v162, 1
+  %v163 = add i32 %s163, %n
+  %s164 = shl i32 %v163, 1
+  %v164 = add i32 %s164, %n
+  %s165 = shl i32 %v164, 1
+  %v165 = add i32 %s165, %n
+  %s166 = shl i32 %v165, 1
+  %v166 = add i32 %s166, %n
+  %s167 = shl i32 %v166, 1
+  %v167 = add i32 %s167, %n
+  %s168 = shl i32 %v167, 1
+  %v168 = add i32 %s168, %n
+  %s169 = shl i32 %v168, 1
+  %v169 = add i32 %s169, %n
+  %s170 = shl i32 %v169, 1
+  %v170 = add i32 %s170, %n
+  %s171 = shl i32 %v170, 1
+  %v171 = add i32 %s171, %n
+  %s172 = shl i32 %v171, 1
+  %v172 = add i32 %s172, %n
+  %s173 = shl i32 %v172, 1
+  %v173 = add i32 %s173, %n
+  %s174 = shl i32 %v173, 1
+  %v174 = add i32 %s174, %n
+  %s175 = shl i32 %v174, 1
+  %v175 = add i32 %s175, %n
+  %s176 = shl i32 %v175, 1
+  %v176 = add i32 %s176, %n
+  %s177 = shl i32 %v176, 1
+  %v177 = add i32 %s177, %n
+  %s178 = shl i32 %v177, 1
+  %v178 = add i32 %s178, %n
+  %s179 = shl i32 %v178, 1
+  %v179 = add i32 %s179, %n
+  %s180 = shl i32 %v179, 1
+  %v180 = add i32 %s180, %n
+  %s181 = shl i32 %v180, 1
+  %v181 = add i32 %s181, %n
+  %s182 = shl i32 %v181, 1
+  %v182 = add i32 %s182, %n
+  %s183 = shl i32 %v182, 1
+  %v183 = add i32 %s183, %n
+  %s184 = shl i32 %v183, 1
+  %v184 = add i32 %s184, %n
+  %s185 = shl i32 %v184, 1
+  %v185 = add i32 %s185, %n
+  %s186 = shl i32 %v185, 1
+  %v186 = add i32 %s186, %n
+  %s187 = shl i32 %v186, 1
+  %v187 = add i32 %s187, %n
+  %s188 = shl i32 %v187, 1
+  %v188 = add i32 %s188, %n
+  %s189 = shl i32 %v188, 1
+  %v189 = add i32 %s189, %n
+  %s190 = shl i32 %v189, 1
+  %v190 = add i32 %s190, %n
+  %s191 = shl i32 %v190, 1
+  %v191 = add i32 %s191, %n
+  %s192 = shl i32 %v191, 1
+  %v192 = add i32 %s192, %n
+  %s193 = shl i32 %v192, 1
+  %v193 = add i32 %s193, %n
+  %s194 = shl i32 %v193, 1
+  %v194 = add i32 %s194, %n
+  %s195 = shl i32 %v194, 1
+  %v195 = add i32 %s195, %n
+  %s196 = shl i32 %v195, 1
+  %v196 = add i32 %s196, %n
+  %s197 = shl i32 %v196, 1
+  %v197 = add i32 %s197, %n
+  %s198 = shl i32 %v197, 1
+  %v198 = add i32 %s198, %n
+  %s199 = shl i32 %v198, 1
+  %v199 = add i32 %s199, %n
+  %s200 = shl i32 %v199, 1
+  %v200 = add i32 %s200, %n
+  %s201 = shl i32 %v200, 1
+  %v201 = add i32 %s201, %n
+  %s202 = shl i32 %v201, 1
+  %v202 = add i32 %s202, %n
+  %s203 = shl i32 %v202, 1
+  %v203 = add i32 %s203, %n
+  %s204 = shl i32 %v203, 1
+  %v204 = add i32 %s204, %n
+  %s205 = shl i32 %v204, 1
+  %v205 = add i32 %s205, %n
+  %s206 = shl i32 %v205, 1
+  %v206 = add i32 %s206, %n
+  %s207 = shl i32 %v206, 1
+  %v207 = add i32 %s207, %n
+  %s208 = shl i32 %v207, 1
+  %v208 = add i32 %s208, %n
+  %s209 = shl i32 %v208, 1
+  %v209 = add i32 %s209, %n
+  %s210 = shl i32 %v209, 1
+  %v210 = add i32 %s210, %n
+  %s211 = shl i32 %v210, 1
+  %v211 = add i32 %s211, %n
+  %s212 = shl i32 %v211, 1
+  %v212 = add i32 %s212, %n
+  %s213 = shl i32 %v212, 1
+  %v213 = add i32 %s213, %n
+  %s214 = shl i32 %v213, 1
+  %v214 = add i32 %s214, %n
+  %s215 = shl i32 %v214, 1
+  %v215 = add i32 %s215, %n
+  %s216 = shl i32 %v215, 1
+  %v216 = add i32 %s216, %n
+  %s217 = shl i32 %v216, 1
+  %v217 = add i32 %s217, %n
+  %s218 = shl i32 %v217, 1
+  %v218 = add i32 %s218, %n
+  %s219 = shl i32 %v218, 1
+  %v219 = add i32 %s219, %n
+  %s220 = shl i32 %v219, 1
+  %v220 = add i32 %s220, %n
+  %s221 = shl i32 %v220, 1
+  %v221 = add i32 %s221, %n
+  %s222 = shl i32 %v221, 1
+  %v222 = add i32 %s222, %n
+  %s223 = shl i32 %v222, 1
+  %v223 = add i32 %s223, %n
+  %s224 = shl i32 %v223, 1
+  %v224 = add i32 %s224, %n
+  %s225 = shl i32 %v224, 1
+  %v225 = add i32 %s225, %n
+  %s226 = shl i32 %v225, 1
+  %v226 = add i32 %s226, %n
+  %s227 = shl i32 %v226, 1
+  %v227 = add i32 %s227, %n
+  %s228 = shl i32 %v227, 1
+  %v228 = add i32 %s228, %n
+  %s229 = shl i32 %v228, 1
+  %v229 = add i32 %s229, %n
+  %s230 = shl i32 %v229, 1
+  %v230 = add i32 %s230, %n
+  %s231 = shl i32 %v230, 1
+  %v231 = add i32 %s231, %n
+  %s232 = shl i32 %v231, 1
+  %v232 = add i32 %s232, %n
+  %s233 = shl i32 %v232, 1
+  %v233 = add i32 %s233, %n
+  %s234 = shl i32 %v233, 1
+  %v234 = add i32 %s234, %n
+  %s235 = shl i32 %v234, 1
+  %v235 = add i32 %s235, %n
+  %s236 = shl i32 %v235, 1
+  %v236 = add i32 %s236, %n
+  %s237 = shl i32 %v236, 1
+  %v237 = add i32 %s237, %n
+  %s238 = shl i32 %v237, 1
+  %v238 = add i32 %s238, %n
+  %s239 = shl i32 %v238, 1
+  %v239 = add i32 %s239, %n
+  %s240 = shl i32 %v239, 1
+  %v240 = add i32 %s240, %n
+  %s241 = shl i32 %v240, 1
+  %v241 = add i32 %s241, %n
+  %s242 = shl i32 %v241, 1
+  %v242 = add i32 %s242, %n
+  %s243 = shl i32 %v242, 1
+  %v243 = add i32 %s243, %n
+  %s244 = shl i32 %v243, 1
+  %v244 = add i32 %s244, %n
+  %s245 = shl i32 %v244, 1
+  %v245 = add i32 %s245, %n
+  %s246 = shl i32 %v245, 1
+  %v246 = add i32 %s246, %n
+  %s247 = shl i32 %v246, 1
+  %v247 = add i32 %s247, %n
+  %s248 = shl i32 %v247, 1
+  %v248 = add i32 %s248, %n
+  %s249 = shl i32 %v248, 1
+  %v249 = add i32 %s249, %n
+  %s250 = shl i32 %v249, 1
+  %v250 = add i32 %s250, %n
+  %s251 = shl i32 %v250, 1
+  %v251 = add i32 %s251, %n
+  %s252 = shl i32 %v251, 1
+  %v252 = add i32 %s252, %n
+  %s253 = shl i32 %v252, 1
+  %v253 = add i32 %s253, %n
+  %s254 = shl i32 %v253, 1
+  %v254 = add i32 %s254, %n
+  %s255 = shl i32 %v254, 1
+  %v255 = add i32 %s255, %n
+  %s256 = shl i32 %v255, 1
+  %v256 = add i32 %s256, %n
+  %s257 = shl i32 %v256, 1
+  %v257 = add i32 %s257, %n
+  %s258 = shl i32 %v257, 1
+  %v258 = add i32 %s258, %n
+  %s259 = shl i32 %v258, 1
+  %v259 = add i32 %s259, %n
+  %s260 = shl i32 %v259, 1
+  %v260 = add i32 %s260, %n
+  %s261 = shl i32 %v260, 1
+  %v261 = add i32 %s261, %n
+  %s262 = shl i32 %v261, 1
+  %v262 = add i32 %s262, %n
+  %s263 = shl i32 %v262, 1
+  %v263 = add i32 %s263, %n
+  %s264 = shl i32 %v263, 1
+  %v264 = add i32 %s264, %n
+  %s265 = shl i32 %v264, 1
+  %v265 = add i32 %s265, %n
+  %s266 = shl i32 %v265, 1
+  %v266 = add i32 %s266, %n
+  %s267 = shl i32 %v266, 1
+  %v267 = add i32 %s267, %n
+  %s268 = shl i32 %v267, 1
+  %v268 = add i32 %s268, %n
+  %s269 = shl i32 %v268, 1
+  %v269 = add i32 %s269, %n
+  %s270 = shl i32 %v269, 1
+  %v270 = add i32 %s270, %n
+  %s271 = shl i32 %v270, 1
+  %v271 = add i32 %s271, %n
+  %s272 = shl i32 %v271, 1
+  %v272 = add i32 %s272, %n
+  %s273 = shl i32 %v272, 1
+  %v273 = add i32 %s273, %n
+  %s274 = shl i32 %v273, 1
+  %v274 = add i32 %s274, %n
+  %s275 = shl i32 %v274, 1
+  %v275 = add i32 %s275, %n
+  %s276 = shl i32 %v275, 1
+  %v276 = add i32 %s276, %n
+  %s277 = shl i32 %v276, 1
+  %v277 = add i32 %s277, %n
+  %s278 = shl i32 %v277, 1
+  %v278 = add i32 %s278, %n
+  %s279 = shl i32 %v278, 1
+  %v279 = add i32 %s279, %n
+  %s280 = shl i32 %v279, 1
+  %v280 = add i32 %s280, %n
+  %s281 = shl i32 %v280, 1
+  %v281 = add i32 %s281, %n
+  %s282 = shl i32 %v281, 1
+  %v282 = add i32 %s282, %n
+  %s283 = shl i32 %v282, 1
+  %v283 = add i32 %s283, %n
+  %s284 = shl i32 %v283, 1
+  %v284 = add i32 %s284, %n
+  %s285 = shl i32 %v284, 1
+  %v285 = add i32 %s285, %n
+  %s286 = shl i32 %v285, 1
+  %v286 = add i32 %s286, %n
+  %s287 = shl i32 %v286, 1
+  %v287 = add i32 %s287, %n
+  %s288 = shl i32 %v287, 1
+  %v288 = add i32 %s288, %n
+  %s289 = shl i32 %v288, 1
+  %v289 = add i32 %s289, %n
+  %s290 = shl i32 %v289, 1
+  %v290 = add i32 %s290, %n
+  %s291 = shl i32 %v290, 1
+  %v291 = add i32 %s291, %n
+  %s292 = shl i32 %v291, 1
+  %v292 = add i32 %s292, %n
+  %s293 = shl i32 %v292, 1
+  %v293 = add i32 %s293, %n
+  %s294 = shl i32 %v293, 1
+  %v294 = add i32 %s294, %n
+  %s295 = shl i32 %v294, 1
+  %v295 = add i32 %s295, %n
+  %s296 = shl i32 %v295, 1
+  %v296 = add i32 %s296, %n
+  %s297 = shl i32 %v296, 1
+  %v297 = add i32 %s297, %n
+  %s298 = shl i32 %v297, 1
+  %v298 = add i32 %s298, %n
+  %s299 = shl i32 %v298, 1
+  %v299 = add i32 %s299, %n
+  %dec = add i32 %i, -1
+  %done = icmp eq i32 %dec, 0
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret i32 %v299
+}
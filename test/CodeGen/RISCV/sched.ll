@@ -0,0 +1,83 @@
+; RUN: llc -march=riscv -mcpu=vscale < %s | FileCheck %s -check-prefix=VSCALE
+; RUN: llc -march=riscv64 -mcpu=Rocket < %s | FileCheck %s -check-prefix=ROCKET
+
+; Rocket's loads take three cycles and its multiplier four, so every load
+; goes first.  vscale's multiplier takes 33 cycles, long enough to hide the
+; last two loads behind the first multiplications.
+; VSCALE-LABEL: dot3:
+; VSCALE:      lw x5, 0(x10)
+; VSCALE-NEXT: lw x6, 0(x11)
+; VSCALE-NEXT: lw x7, 4(x10)
+; VSCALE-NEXT: lw x12, 4(x11)
+; VSCALE-NEXT: mul x5, x5, x6
+; VSCALE-NEXT: mul x6, x7, x12
+; VSCALE-NEXT: lw x7, 8(x10)
+; VSCALE-NEXT: lw x10, 8(x11)
+; VSCALE-NEXT: mul x7, x7, x10
+; VSCALE-NEXT: add x5, x5, x6
+; VSCALE-NEXT: add x10, x5, x7
+; ROCKET-LABEL: dot3:
+; ROCKET:      lw x5, 0(x10)
+; ROCKET-NEXT: lw x6, 0(x11)
+; ROCKET-NEXT: lw x7, 4(x10)
+; ROCKET-NEXT: lw x12, 4(x11)
+; ROCKET-NEXT: lw x10, 8(x10)
+; ROCKET-NEXT: lw x11, 8(x11)
+; ROCKET-NEXT: mulw x5, x5, x6
+; ROCKET-NEXT: mulw x6, x7, x12
+; ROCKET-NEXT: mulw x7, x10, x11
+; ROCKET-NEXT: addw x5, x5, x6
+; ROCKET-NEXT: addw x10, x5, x7
+define i32 @dot3(i32* %a, i32* %b) {
+entry:
+  %pa1 = getelementptr i32, i32* %a, i32 1
+  %pa2 = getelementptr i32, i32* %a, i32 2
+  %pb1 = getelementptr i32, i32* %b, i32 1
+  %pb2 = getelementptr i32, i32* %b, i32 2
+  %a0 = load i32, i32* %a, align 4
+  %b0 = load i32, i32* %b, align 4
+  %a1 = load i32, i32* %pa1, align 4
+  %b1 = load i32, i32* %pb1, align 4
+  %a2 = load i32, i32* %pa2, align 4
+  %b2 = load i32, i32* %pb2, align 4
+  %m0 = mul i32 %a0, %b0
+  %m1 = mul i32 %a1, %b1
+  %m2 = mul i32 %a2, %b2
+  %s0 = add i32 %m0, %m1
+  %s1 = add i32 %s0, %m2
+  ret i32 %s1
+}
+
+; A reduction that the Xvec pass leaves scalar, because it is too short for
+; the cost model or because the core has no Xvec unit, is scheduled like any
+; other code: the loads are not kept next to the additions.
+; VSCALE-LABEL: sum4:
+; VSCALE:      lw x5, 0(x10)
+; VSCALE-NEXT: lw x6, 4(x10)
+; VSCALE-NEXT: add x5, x11, x5
+; VSCALE-NEXT: add x5, x5, x6
+; VSCALE-NEXT: lw x6, 8(x10)
+; VSCALE-NEXT: lw x7, 12(x10)
+; VSCALE-NOT:  addv
+; ROCKET-LABEL: sum4:
+; ROCKET:      lw x5, 0(x10)
+; ROCKET-NEXT: addw x5, x11, x5
+; ROCKET-NEXT: lw x6, 4(x10)
+; ROCKET-NEXT: lw x7, 8(x10)
+; ROCKET-NEXT: lw x10, 12(x10)
+; ROCKET-NEXT: addw x5, x5, x6
+define i32 @sum4(i32* %a, i32 %s) {
+entry:
+  %p1 = getelementptr i32, i32* %a, i32 1
+  %p2 = getelementptr i32, i32* %a, i32 2
+  %p3 = getelementptr i32, i32* %a, i32 3
+  %v0 = load i32, i32* %a, align 4
+  %s0 = add i32 %s, %v0
+  %v1 = load i32, i32* %p1, align 4
+  %s1 = add i32 %s0, %v1
+  %v2 = load i32, i32* %p2, align 4
+  %s2 = add i32 %s1, %v2
+  %v3 = load i32, i32* %p3, align 4
+  %s3 = add i32 %s2, %v3
+  ret i32 %s3
+}
@@ -0,0 +1,40 @@
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=NOSDATA
+; RUN: llc -march=riscv -riscv-small-data < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I -riscv-small-data < %s | FileCheck %s
+; RUN: llc -march=riscv -riscv-small-data -filetype=obj < %s -o - \
+; RUN:   | llvm-readobj -r - | FileCheck %s -check-prefix=RELOC
+
+@counter = global i32 0
+@state = global [2 x i32] [i32 1, i32 2]
+@big = global [4 x i32] zeroinitializer
+@ext = external global i32
+
+define void @tick() {
+; NOSDATA-LABEL: tick:
+; NOSDATA-NOT: gprel
+; CHECK-LABEL: tick:
+; CHECK: lw [[REG:x[0-9]+]], %gprel(counter)(x3)
+; CHECK: lw {{x[0-9]+}}, %gprel(state+4)(x3)
+; CHECK: sw [[REG]], %gprel(counter)(x3)
+; CHECK: lui {{x[0-9]+}}, %hi(big)
+; CHECK: lui {{x[0-9]+}}, %hi(ext)
+  %v = load i32, i32* @counter
+  %n = add i32 %v, 1
+  store i32 %n, i32* @counter
+  %s = load i32, i32* getelementptr ([2 x i32], [2 x i32]* @state, i32 0, i32 1)
+  store i32 %s, i32* getelementptr ([4 x i32], [4 x i32]* @big, i32 0, i32 0)
+  store i32 %s, i32* @ext
+  ret void
+}
+
+; CHECK-LABEL: .section .sbss
+; CHECK: counter:
+; CHECK-LABEL: .section .sdata
+; CHECK: state:
+; CHECK-LABEL: .section .bss
+; CHECK: big:
+
+; RELOC: R_RISCV_GPREL_I counter 0x0
+; RELOC: R_RISCV_GPREL_I state 0x4
+; RELOC: R_RISCV_GPREL_S counter 0x0
+; RELOC: R_RISCV_HI20 big 0x0
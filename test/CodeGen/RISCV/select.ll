@@ -0,0 +1,176 @@
+; RUN: llc -march=riscv < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s -check-prefix=RV64
+; RUN: llc -march=riscv -riscv-branchless-select=false -riscv-early-ifcvt=false \
+; RUN:   < %s | FileCheck %s -check-prefix=BRANCH
+; RUN: llc -march=riscv -mcpu=vscale < %s | FileCheck %s -check-prefix=VSCALE
+
+; Selects between values that are already there become masks.
+define i32 @smin(i32 %a, i32 %b) {
+; CHECK-LABEL: smin:
+; CHECK-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; CHECK-DAG: slt [[C:x[0-9]+]], x10, x11
+; CHECK-DAG: xor [[D:x[0-9]+]], x10, x11
+; CHECK-DAG: sub [[M:x[0-9]+]], x0, [[C]]
+; CHECK: and [[A:x[0-9]+]], [[D]], [[M]]
+; CHECK: xor x10, x11, [[A]]
+; CHECK-NEXT: ret
+; RV64-LABEL: smin:
+; RV64-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; RV64: subw {{x[0-9]+}}, x0,
+; RV64: ret
+; BRANCH-LABEL: smin:
+; BRANCH: bne
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %a, i32 %b
+  ret i32 %r
+}
+
+define i64 @umax64(i64 %a, i64 %b) {
+; RV64-LABEL: umax64:
+; RV64-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; RV64: sltu [[C:x[0-9]+]], x11, x10
+; RV64: sub [[M:x[0-9]+]], x0, [[C]]
+; RV64: ret
+  %c = icmp ugt i64 %a, %b
+  %r = select i1 %c, i64 %a, i64 %b
+  ret i64 %r
+}
+
+; An i1 argument is only known to have its low bit defined.
+define i32 @cond(i1 %c, i32 %a, i32 %b) {
+; CHECK-LABEL: cond:
+; CHECK-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; CHECK: andi [[C:x[0-9]+]], x10, 1
+; CHECK: sub {{x[0-9]+}}, x0, [[C]]
+; CHECK: ret
+  %r = select i1 %c, i32 %a, i32 %b
+  ret i32 %r
+}
+
+; A load that is only needed on one side stays behind the branch.
+define i32 @load(i32 %a, i32 %b, i32* %p) {
+; CHECK-LABEL: load:
+; CHECK: beq
+; CHECK: lw
+  %c = icmp eq i32 %a, %b
+  %v = load i32, i32* %p
+  %r = select i1 %c, i32 %v, i32 %b
+  ret i32 %r
+}
+
+; A multiplication takes the iterative unit as long as a division, so it is
+; only done when it is selected.
+define i32 @mul(i32 %a, i32 %b, i32 %c) {
+; VSCALE-LABEL: mul:
+; VSCALE: {{[[:space:]]b[a-z]+[[:space:]]}}
+; VSCALE: mul
+; VSCALE: ret
+  %x = mul i32 %a, %b
+  %cc = icmp eq i32 %c, 0
+  %r = select i1 %cc, i32 %x, i32 %c
+  ret i32 %r
+}
+
+; So is an operand that takes more instructions than a mispredicted branch
+; would cost.
+define i32 @deep(i32 %a, i32 %b, i32 %c) {
+; VSCALE-LABEL: deep:
+; VSCALE: {{[[:space:]]b[a-z]+[[:space:]]}}
+; VSCALE: ret
+  %x1 = add i32 %a, 1
+  %x2 = shl i32 %x1, 2
+  %x3 = xor i32 %x2, %b
+  %x4 = sub i32 %x3, %a
+  %x5 = or i32 %x4, 9
+  %x6 = and i32 %x5, %b
+  %x7 = add i32 %x6, %b
+  %x8 = xor i32 %x7, 11
+  %cc = icmp eq i32 %c, 0
+  %r = select i1 %cc, i32 %x8, i32 %c
+  ret i32 %r
+}
+
+; Small diamonds are flattened into both sides and a select, unless the
+; core's branches are cheap enough.
+define i32 @diamond(i32 %a, i32 %b) {
+; CHECK-LABEL: diamond:
+; CHECK-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; CHECK-DAG: sub
+; CHECK-DAG: slli
+; CHECK-DAG: sltu [[C:x[0-9]+]], x10, x11
+; CHECK: sub {{x[0-9]+}}, x0, [[C]]
+; CHECK: ret
+; RV64-LABEL: diamond:
+; RV64-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; RV64: ret
+; VSCALE-LABEL: diamond:
+; VSCALE: bgeu x10, x11
+entry:
+  %c = icmp ult i32 %a, %b
+  br i1 %c, label %t, label %f
+t:
+  %x = add i32 %a, 3
+  %x2 = shl i32 %x, 2
+  br label %j
+f:
+  %y = sub i32 %b, %a
+  %y2 = xor i32 %y, 5
+  br label %j
+j:
+  %r = phi i32 [%x2, %t], [%y2, %f]
+  ret i32 %r
+}
+
+define i32 @triangle(i32 %a, i32 %b) {
+; CHECK-LABEL: triangle:
+; CHECK-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; CHECK: addi
+; CHECK: ret
+entry:
+  %c = icmp sge i32 %a, %b
+  br i1 %c, label %t, label %j
+t:
+  %x = add i32 %a, 7
+  br label %j
+j:
+  %r = phi i32 [%x, %t], [%b, %entry]
+  ret i32 %r
+}
+
+define i32 @diamondeq(i32 %a, i32 %b) {
+; CHECK-LABEL: diamondeq:
+; CHECK-NOT: {{[[:space:]]b[a-z]+[[:space:]]}}
+; CHECK: xor [[D:x[0-9]+]], x10, x11
+; CHECK: sltu [[C:x[0-9]+]], x0, [[D]]
+; CHECK: sub {{x[0-9]+}}, x0, [[C]]
+; CHECK: ret
+entry:
+  %c = icmp eq i32 %a, %b
+  br i1 %c, label %t, label %f
+t:
+  %x = add i32 %a, 3
+  %x2 = shl i32 %x, 2
+  br label %j
+f:
+  %y = sub i32 %b, %a
+  %y2 = xor i32 %y, 5
+  br label %j
+j:
+  %r = phi i32 [%x2, %t], [%y2, %f]
+  ret i32 %r
+}
+
+; Stores can't be speculated.
+define void @store(i32 %a, i32* %p) {
+; CHECK-LABEL: store:
+; CHECK: {{[[:space:]]b[a-z]+[[:space:]]}}
+; CHECK: sw
+entry:
+  %c = icmp eq i32 %a, 0
+  br i1 %c, label %t, label %j
+t:
+  store i32 %a, i32* %p
+  br label %j
+j:
+  ret void
+}
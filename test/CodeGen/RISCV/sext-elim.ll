@@ -0,0 +1,106 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I -riscv-sext-elim=false < %s \
+; RUN:   | FileCheck %s -check-prefix=NOELIM
+
+; 32-bit values live sign-extended in 64-bit registers, so truncating an
+; arbitrary i64 needs a sext.w.
+define i64 @trunc(i64 %a, i64 %b) {
+; CHECK-LABEL: trunc:
+; CHECK: add [[S:x[0-9]+]], x10, x11
+; CHECK: addiw [[T:x[0-9]+]], [[S]], 0
+; CHECK: slti x10, [[T]], 7
+  %x = add i64 %a, %b
+  %t = trunc i64 %x to i32
+  %c = icmp slt i32 %t, 7
+  %z = zext i1 %c to i64
+  ret i64 %z
+}
+
+; i32 arguments already are.
+define i32 @arg(i32 %a) {
+; CHECK-LABEL: arg:
+; CHECK-NOT: addiw {{x[0-9]+}}, x10, 0
+; CHECK: addiw x10, x10, 1
+; CHECK-NEXT: ret
+  %x = add i32 %a, 1
+  ret i32 %x
+}
+
+; i32 return values and arguments are passed sign-extended.
+define i32 @ret(i64 %a, i1 %c) {
+; CHECK-LABEL: ret:
+; CHECK: addi [[S:x[0-9]+]], x10, 5
+; CHECK: addiw x10, [[S]], 0
+; CHECK: ret
+entry:
+  %m = add i64 %a, 5
+  br i1 %c, label %t, label %f
+t:
+  %t1 = trunc i64 %m to i32
+  ret i32 %t1
+f:
+  ret i32 0
+}
+
+declare void @callee(i32)
+
+define void @call(i64 %a) {
+; CHECK-LABEL: call:
+; CHECK: addiw x10, x10, 0
+; CHECK: jal
+  %t = trunc i64 %a to i32
+  call void @callee(i32 %t)
+  ret void
+}
+
+; The xor of sign-extended loads around the loop is still sign-extended
+; when it is truncated after the loop.
+define i32 @phi(i32* %p, i32 %n) {
+; CHECK-LABEL: phi:
+; CHECK: lw [[V:x[0-9]+]]
+; CHECK: xor [[S:x[0-9]+]], [[S]], [[V]]
+; CHECK: bne
+; CHECK-NOT: addiw
+; CHECK: ret
+; NOELIM-LABEL: phi:
+; NOELIM: bne
+; NOELIM: addiw x10, {{x[0-9]+}}, 0
+; NOELIM: ret
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [0, %entry], [%inc, %loop]
+  %s = phi i64 [0, %entry], [%s2, %loop]
+  %gep = getelementptr i32, i32* %p, i64 %i
+  %v = load i32, i32* %gep
+  %vw = sext i32 %v to i64
+  %s2 = xor i64 %s, %vw
+  %inc = add i64 %i, 1
+  %ti = trunc i64 %inc to i32
+  %done = icmp eq i32 %ti, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  %r = trunc i64 %s2 to i32
+  ret i32 %r
+}
+
+; A shift right by more than 32 leaves a sign-extended value, one by 32
+; or less doesn't.
+define i32 @shift(i64 %a, i64 %b, i1 %c) {
+; CHECK-LABEL: shift:
+; CHECK: srai [[A:x[0-9]+]], x10, 40
+; CHECK: srli [[B:x[0-9]+]], x11, 16
+; CHECK-NOT: addiw {{x[0-9]+}}, [[A]], 0
+; CHECK: addiw {{x[0-9]+}}, [[B]], 0
+; CHECK: ret
+entry:
+  %x = ashr i64 %a, 40
+  %y = lshr i64 %b, 16
+  br i1 %c, label %t, label %f
+t:
+  %tx = trunc i64 %x to i32
+  ret i32 %tx
+f:
+  %ty = trunc i64 %y to i32
+  ret i32 %ty
+}
@@ -0,0 +1,98 @@
+; RUN: llc -march=riscv < %s | FileCheck %s
+; RUN: llc -march=riscv -mattr=+save-restore < %s \
+; RUN:   | FileCheck %s -check-prefix=SAVE-RESTORE
+; RUN: llc -march=riscv64 -mcpu=RV64I -mattr=+save-restore -disable-fp-elim \
+; RUN:   < %s | FileCheck %s -check-prefix=RV64-FP
+; RUN: llc -march=riscv -mattr=+save-restore -filetype=obj < %s -o /dev/null
+
+declare i32 @h(i32)
+
+; %y lives across the calls in a callee-saved register, so the frame has
+; to be set up on both paths.
+define i32 @early_exit(i32 %x, i32 %y) {
+; CHECK-LABEL: early_exit:
+; CHECK: addi x2, x2, -16
+; CHECK: sw x1, 12(x2)
+; CHECK: sw x8, 8(x2)
+; CHECK: addi x8, x11, 0
+; CHECK: beq x10, x0, [[FAST:LBB[0-9_]+]]
+; CHECK: jalr x1
+; CHECK: jalr x1
+; CHECK: add x10, x10, x8
+; CHECK: [[FAST]]:
+; CHECK: addi x10, x8, 0
+; CHECK: lw x8, 8(x2)
+; CHECK: lw x1, 12(x2)
+; CHECK-NEXT: addi x2, x2, 16
+; CHECK-NEXT: ret
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %fast, label %slow
+fast:
+  ret i32 %y
+slow:
+  %a = call i32 @h(i32 %x)
+  %b = call i32 @h(i32 %a)
+  %s = add i32 %b, %y
+  ret i32 %s
+}
+
+; SAVE-RESTORE-LABEL: early_exit:
+; SAVE-RESTORE: call x5, __riscv_save_2
+; SAVE-RESTORE: beq x10, x0, [[FAST:LBB[0-9_]+]]
+; SAVE-RESTORE: tail __riscv_restore_2
+; SAVE-RESTORE: [[FAST]]:
+; SAVE-RESTORE-NOT: ret
+; SAVE-RESTORE: tail __riscv_restore_2
+
+; Nothing lives across the call, so the frame is only set up on the path
+; that makes it.
+define i32 @shrink_wrapped(i32 %x, i32 %y) {
+; CHECK-LABEL: shrink_wrapped:
+; CHECK-NOT: x2
+; CHECK: beq x10, x0, [[FAST:LBB[0-9_]+]]
+; CHECK: addi x2, x2, -16
+; CHECK: sw x1, 12(x2)
+; CHECK: jalr x1
+; CHECK: lw x1, 12(x2)
+; CHECK: addi x2, x2, 16
+; CHECK-NEXT: ret
+; CHECK: [[FAST]]:
+; CHECK-NOT: x2
+; CHECK: ret
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %fast, label %slow
+fast:
+  ret i32 %y
+slow:
+  %a = call i32 @h(i32 %x)
+  %s = add i32 %a, 1
+  ret i32 %s
+}
+
+; The libcalls save ra, allocate the frame and return for the function.
+; SAVE-RESTORE-LABEL: shrink_wrapped:
+; SAVE-RESTORE-NOT: x2
+; SAVE-RESTORE: beq x10, x0, [[FAST:LBB[0-9_]+]]
+; SAVE-RESTORE: call x5, __riscv_save_0
+; SAVE-RESTORE-NEXT: Ltmp{{[0-9]+}}:
+; SAVE-RESTORE-NEXT: .cfi_def_cfa_offset 16
+; SAVE-RESTORE-NOT: x2
+; SAVE-RESTORE: tail __riscv_restore_0
+; SAVE-RESTORE: [[FAST]]:
+; SAVE-RESTORE-NOT: x2
+; SAVE-RESTORE: ret
+
+; Saving fp as s0 needs __riscv_save_1, and fp is set after the call.
+define i32 @with_fp(i32 %x) {
+; RV64-FP-LABEL: with_fp:
+; RV64-FP: call x5, __riscv_save_1
+; RV64-FP: .cfi_def_cfa_offset 16
+; RV64-FP: .cfi_offset x8, -16
+; RV64-FP: add x8, x2, x0
+; RV64-FP: add x2, x8, x0
+; RV64-FP-NEXT: tail __riscv_restore_1
+  %a = call i32 @h(i32 %x)
+  ret i32 %a
+}
@@ -0,0 +1,103 @@
+; RUN: llc -march=riscv < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s -check-prefix=RV64
+; RUN: llc -march=riscv -mattr=+save-restore < %s \
+; RUN:   | FileCheck %s -check-prefix=SAVE-RESTORE
+; RUN: llc -march=riscv -tailcallopt < %s | FileCheck %s
+; RUN: llc -march=riscv -filetype=obj < %s -o /dev/null
+
+declare i32 @callee(i32, i32)
+declare i32 @callee_stack(i32, i32, i32, i32, i32, i32, i32, i32, i32, i32)
+
+define i32 @sibcall(i32 %a, i32 %b) {
+; CHECK-LABEL: sibcall:
+; CHECK-NOT: x2
+; CHECK: tail callee
+; CHECK-NOT: ret
+; RV64-LABEL: sibcall:
+; RV64: tail callee
+; SAVE-RESTORE-LABEL: sibcall:
+; SAVE-RESTORE: call x5, __riscv_save_0
+; SAVE-RESTORE: jalr x1
+; SAVE-RESTORE: tail __riscv_restore_0
+  %r = tail call i32 @callee(i32 %b, i32 %a)
+  ret i32 %r
+}
+
+; The target must be in a register that the epilogue doesn't restore.
+define i32 @indirect(i32 (i32, i32)* %f, i32 %a) {
+; CHECK-LABEL: indirect:
+; CHECK: addi [[REG:x(5|6|7|1[0-7]|2[89]|3[01])]], x10, 0
+; CHECK: jalr x0, [[REG]], 0
+  %r = tail call i32 %f(i32 %a, i32 %a)
+  ret i32 %r
+}
+
+; Self-recursion is a tail call like any other: the call pair jumps back to
+; the start of the function.
+define i32 @recurse(i32 %n, i32 %acc) {
+; CHECK-LABEL: recurse:
+; CHECK: tail recurse
+entry:
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %done, label %more
+more:
+  %n1 = add i32 %n, -1
+  %acc1 = add i32 %acc, %n
+  %r = tail call i32 @recurse(i32 %n1, i32 %acc1)
+  ret i32 %r
+done:
+  ret i32 %acc
+}
+
+; The frame is torn down before the jump.
+declare void @use(i32*)
+define i32 @with_frame(i32 %a) {
+; CHECK-LABEL: with_frame:
+; CHECK: addi x2, x2, -16
+; CHECK: jalr x1
+; CHECK: lw x1, 12(x2)
+; CHECK-NEXT: addi x2, x2, 16
+; CHECK-NEXT: tail callee
+  %p = alloca i32
+  call void @use(i32* %p)
+  %v = load i32, i32* %p
+  %r = tail call i32 @callee(i32 %v, i32 %a)
+  ret i32 %r
+}
+
+; Stack arguments go in our own incoming argument area.  Both are loaded
+; before either is overwritten.
+define i32 @swap_stack(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f,
+                       i32 %g, i32 %h, i32 %i, i32 %j) {
+; CHECK-LABEL: swap_stack:
+; CHECK: lw [[I:x[0-9]+]], [[IOFF:[0-9]+]](x2)
+; CHECK: lw [[J:x[0-9]+]], [[JOFF:[0-9]+]](x2)
+; CHECK: sw [[I]], [[JOFF]](x2)
+; CHECK: sw [[J]], [[IOFF]](x2)
+; CHECK-NEXT: tail callee_stack
+  %r = tail call i32 @callee_stack(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e,
+                                   i32 %f, i32 %g, i32 %h, i32 %j, i32 %i)
+  ret i32 %r
+}
+
+; We have no incoming stack arguments to overwrite.
+define i32 @no_room() {
+; CHECK-LABEL: no_room:
+; CHECK-NOT: tail callee_stack
+; CHECK: jalr x1
+; CHECK: ret
+  %r = tail call i32 @callee_stack(i32 1, i32 2, i32 3, i32 4, i32 5, i32 6,
+                                   i32 7, i32 8, i32 9, i32 10)
+  ret i32 %r
+}
+
+; A call whose result is used is not in tail position.
+define i32 @not_tail(i32 %a) {
+; CHECK-LABEL: not_tail:
+; CHECK-NOT: tail callee
+; CHECK: jalr x1
+; CHECK: ret
+  %r = call i32 @callee(i32 %a, i32 %a)
+  %s = add i32 %r, 1
+  ret i32 %s
+}
@@ -0,0 +1,762 @@
+; RUN: llc -march=riscv < %s | FileCheck %s
+; RUN: llc -march=riscv -riscv-xvec-cost-model=false < %s | FileCheck %s
+
+; c[] = a[] + b[] followed by a[] = c[] ^ b[]: the xor takes c[] straight from
+; the bank, so c[] is stored but not loaded back. Both patterns run on each
+; chunk of 28 elements before the next chunk is loaded.
+; CHECK-LABEL: addxor:
+; CHECK:      addi x29, x10, 0
+; CHECK-NEXT: addi x30, x11, 0
+; CHECK-NEXT: addi x31, x12, 0
+; CHECK:      lw x1, 0(x29)
+; CHECK:      addiv x2, x1, 0
+; CHECK:      lw x1, 0(x30)
+; CHECK:      addv x1, x2, x1
+; CHECK:      sw x1, 0(x31)
+; CHECK:      sw x28, 108(x31)
+; CHECK-NOT:  (x31)
+; CHECK:      addiv x2, x1, 0
+; CHECK-NOT:  (x31)
+; CHECK:      lw x1, 0(x30)
+; CHECK-NOT:  (x31)
+; CHECK:      xorv x1, x2, x1
+; CHECK-NOT:  (x31)
+; CHECK:      sw x1, 0(x29)
+; CHECK:      sw x28, 108(x29)
+; CHECK-NEXT: lw x1, 112(x29)
+; CHECK:      addv x1, x2, x1
+; CHECK:      sw x4, 124(x31)
+; CHECK-NOT:  (x31)
+; CHECK:      xorv x1, x2, x1
+; CHECK-NOT:  (x31)
+; CHECK:      sw x4, 124(x29)
+; CHECK-NOT:  addv
+; CHECK-NOT:  xorv
+; CHECK:      ret
+
+define void @addxor(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  %pa0 = getelementptr i32, i32* %a, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %b, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i32, i32* %a, i32 1
+  %va1 = load i32, i32* %pa1, align 4
+  %pb1 = getelementptr i32, i32* %b, i32 1
+  %vb1 = load i32, i32* %pb1, align 4
+  %vc1 = add i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %c, i32 1
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i32, i32* %a, i32 2
+  %va2 = load i32, i32* %pa2, align 4
+  %pb2 = getelementptr i32, i32* %b, i32 2
+  %vb2 = load i32, i32* %pb2, align 4
+  %vc2 = add i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %c, i32 2
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i32, i32* %a, i32 3
+  %va3 = load i32, i32* %pa3, align 4
+  %pb3 = getelementptr i32, i32* %b, i32 3
+  %vb3 = load i32, i32* %pb3, align 4
+  %vc3 = add i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %c, i32 3
+  store i32 %vc3, i32* %pc3, align 4
+  %pa4 = getelementptr i32, i32* %a, i32 4
+  %va4 = load i32, i32* %pa4, align 4
+  %pb4 = getelementptr i32, i32* %b, i32 4
+  %vb4 = load i32, i32* %pb4, align 4
+  %vc4 = add i32 %va4, %vb4
+  %pc4 = getelementptr i32, i32* %c, i32 4
+  store i32 %vc4, i32* %pc4, align 4
+  %pa5 = getelementptr i32, i32* %a, i32 5
+  %va5 = load i32, i32* %pa5, align 4
+  %pb5 = getelementptr i32, i32* %b, i32 5
+  %vb5 = load i32, i32* %pb5, align 4
+  %vc5 = add i32 %va5, %vb5
+  %pc5 = getelementptr i32, i32* %c, i32 5
+  store i32 %vc5, i32* %pc5, align 4
+  %pa6 = getelementptr i32, i32* %a, i32 6
+  %va6 = load i32, i32* %pa6, align 4
+  %pb6 = getelementptr i32, i32* %b, i32 6
+  %vb6 = load i32, i32* %pb6, align 4
+  %vc6 = add i32 %va6, %vb6
+  %pc6 = getelementptr i32, i32* %c, i32 6
+  store i32 %vc6, i32* %pc6, align 4
+  %pa7 = getelementptr i32, i32* %a, i32 7
+  %va7 = load i32, i32* %pa7, align 4
+  %pb7 = getelementptr i32, i32* %b, i32 7
+  %vb7 = load i32, i32* %pb7, align 4
+  %vc7 = add i32 %va7, %vb7
+  %pc7 = getelementptr i32, i32* %c, i32 7
+  store i32 %vc7, i32* %pc7, align 4
+  %pa8 = getelementptr i32, i32* %a, i32 8
+  %va8 = load i32, i32* %pa8, align 4
+  %pb8 = getelementptr i32, i32* %b, i32 8
+  %vb8 = load i32, i32* %pb8, align 4
+  %vc8 = add i32 %va8, %vb8
+  %pc8 = getelementptr i32, i32* %c, i32 8
+  store i32 %vc8, i32* %pc8, align 4
+  %pa9 = getelementptr i32, i32* %a, i32 9
+  %va9 = load i32, i32* %pa9, align 4
+  %pb9 = getelementptr i32, i32* %b, i32 9
+  %vb9 = load i32, i32* %pb9, align 4
+  %vc9 = add i32 %va9, %vb9
+  %pc9 = getelementptr i32, i32* %c, i32 9
+  store i32 %vc9, i32* %pc9, align 4
+  %pa10 = getelementptr i32, i32* %a, i32 10
+  %va10 = load i32, i32* %pa10, align 4
+  %pb10 = getelementptr i32, i32* %b, i32 10
+  %vb10 = load i32, i32* %pb10, align 4
+  %vc10 = add i32 %va10, %vb10
+  %pc10 = getelementptr i32, i32* %c, i32 10
+  store i32 %vc10, i32* %pc10, align 4
+  %pa11 = getelementptr i32, i32* %a, i32 11
+  %va11 = load i32, i32* %pa11, align 4
+  %pb11 = getelementptr i32, i32* %b, i32 11
+  %vb11 = load i32, i32* %pb11, align 4
+  %vc11 = add i32 %va11, %vb11
+  %pc11 = getelementptr i32, i32* %c, i32 11
+  store i32 %vc11, i32* %pc11, align 4
+  %pa12 = getelementptr i32, i32* %a, i32 12
+  %va12 = load i32, i32* %pa12, align 4
+  %pb12 = getelementptr i32, i32* %b, i32 12
+  %vb12 = load i32, i32* %pb12, align 4
+  %vc12 = add i32 %va12, %vb12
+  %pc12 = getelementptr i32, i32* %c, i32 12
+  store i32 %vc12, i32* %pc12, align 4
+  %pa13 = getelementptr i32, i32* %a, i32 13
+  %va13 = load i32, i32* %pa13, align 4
+  %pb13 = getelementptr i32, i32* %b, i32 13
+  %vb13 = load i32, i32* %pb13, align 4
+  %vc13 = add i32 %va13, %vb13
+  %pc13 = getelementptr i32, i32* %c, i32 13
+  store i32 %vc13, i32* %pc13, align 4
+  %pa14 = getelementptr i32, i32* %a, i32 14
+  %va14 = load i32, i32* %pa14, align 4
+  %pb14 = getelementptr i32, i32* %b, i32 14
+  %vb14 = load i32, i32* %pb14, align 4
+  %vc14 = add i32 %va14, %vb14
+  %pc14 = getelementptr i32, i32* %c, i32 14
+  store i32 %vc14, i32* %pc14, align 4
+  %pa15 = getelementptr i32, i32* %a, i32 15
+  %va15 = load i32, i32* %pa15, align 4
+  %pb15 = getelementptr i32, i32* %b, i32 15
+  %vb15 = load i32, i32* %pb15, align 4
+  %vc15 = add i32 %va15, %vb15
+  %pc15 = getelementptr i32, i32* %c, i32 15
+  store i32 %vc15, i32* %pc15, align 4
+  %pa16 = getelementptr i32, i32* %a, i32 16
+  %va16 = load i32, i32* %pa16, align 4
+  %pb16 = getelementptr i32, i32* %b, i32 16
+  %vb16 = load i32, i32* %pb16, align 4
+  %vc16 = add i32 %va16, %vb16
+  %pc16 = getelementptr i32, i32* %c, i32 16
+  store i32 %vc16, i32* %pc16, align 4
+  %pa17 = getelementptr i32, i32* %a, i32 17
+  %va17 = load i32, i32* %pa17, align 4
+  %pb17 = getelementptr i32, i32* %b, i32 17
+  %vb17 = load i32, i32* %pb17, align 4
+  %vc17 = add i32 %va17, %vb17
+  %pc17 = getelementptr i32, i32* %c, i32 17
+  store i32 %vc17, i32* %pc17, align 4
+  %pa18 = getelementptr i32, i32* %a, i32 18
+  %va18 = load i32, i32* %pa18, align 4
+  %pb18 = getelementptr i32, i32* %b, i32 18
+  %vb18 = load i32, i32* %pb18, align 4
+  %vc18 = add i32 %va18, %vb18
+  %pc18 = getelementptr i32, i32* %c, i32 18
+  store i32 %vc18, i32* %pc18, align 4
+  %pa19 = getelementptr i32, i32* %a, i32 19
+  %va19 = load i32, i32* %pa19, align 4
+  %pb19 = getelementptr i32, i32* %b, i32 19
+  %vb19 = load i32, i32* %pb19, align 4
+  %vc19 = add i32 %va19, %vb19
+  %pc19 = getelementptr i32, i32* %c, i32 19
+  store i32 %vc19, i32* %pc19, align 4
+  %pa20 = getelementptr i32, i32* %a, i32 20
+  %va20 = load i32, i32* %pa20, align 4
+  %pb20 = getelementptr i32, i32* %b, i32 20
+  %vb20 = load i32, i32* %pb20, align 4
+  %vc20 = add i32 %va20, %vb20
+  %pc20 = getelementptr i32, i32* %c, i32 20
+  store i32 %vc20, i32* %pc20, align 4
+  %pa21 = getelementptr i32, i32* %a, i32 21
+  %va21 = load i32, i32* %pa21, align 4
+  %pb21 = getelementptr i32, i32* %b, i32 21
+  %vb21 = load i32, i32* %pb21, align 4
+  %vc21 = add i32 %va21, %vb21
+  %pc21 = getelementptr i32, i32* %c, i32 21
+  store i32 %vc21, i32* %pc21, align 4
+  %pa22 = getelementptr i32, i32* %a, i32 22
+  %va22 = load i32, i32* %pa22, align 4
+  %pb22 = getelementptr i32, i32* %b, i32 22
+  %vb22 = load i32, i32* %pb22, align 4
+  %vc22 = add i32 %va22, %vb22
+  %pc22 = getelementptr i32, i32* %c, i32 22
+  store i32 %vc22, i32* %pc22, align 4
+  %pa23 = getelementptr i32, i32* %a, i32 23
+  %va23 = load i32, i32* %pa23, align 4
+  %pb23 = getelementptr i32, i32* %b, i32 23
+  %vb23 = load i32, i32* %pb23, align 4
+  %vc23 = add i32 %va23, %vb23
+  %pc23 = getelementptr i32, i32* %c, i32 23
+  store i32 %vc23, i32* %pc23, align 4
+  %pa24 = getelementptr i32, i32* %a, i32 24
+  %va24 = load i32, i32* %pa24, align 4
+  %pb24 = getelementptr i32, i32* %b, i32 24
+  %vb24 = load i32, i32* %pb24, align 4
+  %vc24 = add i32 %va24, %vb24
+  %pc24 = getelementptr i32, i32* %c, i32 24
+  store i32 %vc24, i32* %pc24, align 4
+  %pa25 = getelementptr i32, i32* %a, i32 25
+  %va25 = load i32, i32* %pa25, align 4
+  %pb25 = getelementptr i32, i32* %b, i32 25
+  %vb25 = load i32, i32* %pb25, align 4
+  %vc25 = add i32 %va25, %vb25
+  %pc25 = getelementptr i32, i32* %c, i32 25
+  store i32 %vc25, i32* %pc25, align 4
+  %pa26 = getelementptr i32, i32* %a, i32 26
+  %va26 = load i32, i32* %pa26, align 4
+  %pb26 = getelementptr i32, i32* %b, i32 26
+  %vb26 = load i32, i32* %pb26, align 4
+  %vc26 = add i32 %va26, %vb26
+  %pc26 = getelementptr i32, i32* %c, i32 26
+  store i32 %vc26, i32* %pc26, align 4
+  %pa27 = getelementptr i32, i32* %a, i32 27
+  %va27 = load i32, i32* %pa27, align 4
+  %pb27 = getelementptr i32, i32* %b, i32 27
+  %vb27 = load i32, i32* %pb27, align 4
+  %vc27 = add i32 %va27, %vb27
+  %pc27 = getelementptr i32, i32* %c, i32 27
+  store i32 %vc27, i32* %pc27, align 4
+  %pa28 = getelementptr i32, i32* %a, i32 28
+  %va28 = load i32, i32* %pa28, align 4
+  %pb28 = getelementptr i32, i32* %b, i32 28
+  %vb28 = load i32, i32* %pb28, align 4
+  %vc28 = add i32 %va28, %vb28
+  %pc28 = getelementptr i32, i32* %c, i32 28
+  store i32 %vc28, i32* %pc28, align 4
+  %pa29 = getelementptr i32, i32* %a, i32 29
+  %va29 = load i32, i32* %pa29, align 4
+  %pb29 = getelementptr i32, i32* %b, i32 29
+  %vb29 = load i32, i32* %pb29, align 4
+  %vc29 = add i32 %va29, %vb29
+  %pc29 = getelementptr i32, i32* %c, i32 29
+  store i32 %vc29, i32* %pc29, align 4
+  %pa30 = getelementptr i32, i32* %a, i32 30
+  %va30 = load i32, i32* %pa30, align 4
+  %pb30 = getelementptr i32, i32* %b, i32 30
+  %vb30 = load i32, i32* %pb30, align 4
+  %vc30 = add i32 %va30, %vb30
+  %pc30 = getelementptr i32, i32* %c, i32 30
+  store i32 %vc30, i32* %pc30, align 4
+  %pa31 = getelementptr i32, i32* %a, i32 31
+  %va31 = load i32, i32* %pa31, align 4
+  %pb31 = getelementptr i32, i32* %b, i32 31
+  %vb31 = load i32, i32* %pb31, align 4
+  %vc31 = add i32 %va31, %vb31
+  %pc31 = getelementptr i32, i32* %c, i32 31
+  store i32 %vc31, i32* %pc31, align 4
+  %lc0 = load i32, i32* %pc0, align 4
+  %lb0 = load i32, i32* %pb0, align 4
+  %vd0 = xor i32 %lc0, %lb0
+  store i32 %vd0, i32* %pa0, align 4
+  %lc1 = load i32, i32* %pc1, align 4
+  %lb1 = load i32, i32* %pb1, align 4
+  %vd1 = xor i32 %lc1, %lb1
+  store i32 %vd1, i32* %pa1, align 4
+  %lc2 = load i32, i32* %pc2, align 4
+  %lb2 = load i32, i32* %pb2, align 4
+  %vd2 = xor i32 %lc2, %lb2
+  store i32 %vd2, i32* %pa2, align 4
+  %lc3 = load i32, i32* %pc3, align 4
+  %lb3 = load i32, i32* %pb3, align 4
+  %vd3 = xor i32 %lc3, %lb3
+  store i32 %vd3, i32* %pa3, align 4
+  %lc4 = load i32, i32* %pc4, align 4
+  %lb4 = load i32, i32* %pb4, align 4
+  %vd4 = xor i32 %lc4, %lb4
+  store i32 %vd4, i32* %pa4, align 4
+  %lc5 = load i32, i32* %pc5, align 4
+  %lb5 = load i32, i32* %pb5, align 4
+  %vd5 = xor i32 %lc5, %lb5
+  store i32 %vd5, i32* %pa5, align 4
+  %lc6 = load i32, i32* %pc6, align 4
+  %lb6 = load i32, i32* %pb6, align 4
+  %vd6 = xor i32 %lc6, %lb6
+  store i32 %vd6, i32* %pa6, align 4
+  %lc7 = load i32, i32* %pc7, align 4
+  %lb7 = load i32, i32* %pb7, align 4
+  %vd7 = xor i32 %lc7, %lb7
+  store i32 %vd7, i32* %pa7, align 4
+  %lc8 = load i32, i32* %pc8, align 4
+  %lb8 = load i32, i32* %pb8, align 4
+  %vd8 = xor i32 %lc8, %lb8
+  store i32 %vd8, i32* %pa8, align 4
+  %lc9 = load i32, i32* %pc9, align 4
+  %lb9 = load i32, i32* %pb9, align 4
+  %vd9 = xor i32 %lc9, %lb9
+  store i32 %vd9, i32* %pa9, align 4
+  %lc10 = load i32, i32* %pc10, align 4
+  %lb10 = load i32, i32* %pb10, align 4
+  %vd10 = xor i32 %lc10, %lb10
+  store i32 %vd10, i32* %pa10, align 4
+  %lc11 = load i32, i32* %pc11, align 4
+  %lb11 = load i32, i32* %pb11, align 4
+  %vd11 = xor i32 %lc11, %lb11
+  store i32 %vd11, i32* %pa11, align 4
+  %lc12 = load i32, i32* %pc12, align 4
+  %lb12 = load i32, i32* %pb12, align 4
+  %vd12 = xor i32 %lc12, %lb12
+  store i32 %vd12, i32* %pa12, align 4
+  %lc13 = load i32, i32* %pc13, align 4
+  %lb13 = load i32, i32* %pb13, align 4
+  %vd13 = xor i32 %lc13, %lb13
+  store i32 %vd13, i32* %pa13, align 4
+  %lc14 = load i32, i32* %pc14, align 4
+  %lb14 = load i32, i32* %pb14, align 4
+  %vd14 = xor i32 %lc14, %lb14
+  store i32 %vd14, i32* %pa14, align 4
+  %lc15 = load i32, i32* %pc15, align 4
+  %lb15 = load i32, i32* %pb15, align 4
+  %vd15 = xor i32 %lc15, %lb15
+  store i32 %vd15, i32* %pa15, align 4
+  %lc16 = load i32, i32* %pc16, align 4
+  %lb16 = load i32, i32* %pb16, align 4
+  %vd16 = xor i32 %lc16, %lb16
+  store i32 %vd16, i32* %pa16, align 4
+  %lc17 = load i32, i32* %pc17, align 4
+  %lb17 = load i32, i32* %pb17, align 4
+  %vd17 = xor i32 %lc17, %lb17
+  store i32 %vd17, i32* %pa17, align 4
+  %lc18 = load i32, i32* %pc18, align 4
+  %lb18 = load i32, i32* %pb18, align 4
+  %vd18 = xor i32 %lc18, %lb18
+  store i32 %vd18, i32* %pa18, align 4
+  %lc19 = load i32, i32* %pc19, align 4
+  %lb19 = load i32, i32* %pb19, align 4
+  %vd19 = xor i32 %lc19, %lb19
+  store i32 %vd19, i32* %pa19, align 4
+  %lc20 = load i32, i32* %pc20, align 4
+  %lb20 = load i32, i32* %pb20, align 4
+  %vd20 = xor i32 %lc20, %lb20
+  store i32 %vd20, i32* %pa20, align 4
+  %lc21 = load i32, i32* %pc21, align 4
+  %lb21 = load i32, i32* %pb21, align 4
+  %vd21 = xor i32 %lc21, %lb21
+  store i32 %vd21, i32* %pa21, align 4
+  %lc22 = load i32, i32* %pc22, align 4
+  %lb22 = load i32, i32* %pb22, align 4
+  %vd22 = xor i32 %lc22, %lb22
+  store i32 %vd22, i32* %pa22, align 4
+  %lc23 = load i32, i32* %pc23, align 4
+  %lb23 = load i32, i32* %pb23, align 4
+  %vd23 = xor i32 %lc23, %lb23
+  store i32 %vd23, i32* %pa23, align 4
+  %lc24 = load i32, i32* %pc24, align 4
+  %lb24 = load i32, i32* %pb24, align 4
+  %vd24 = xor i32 %lc24, %lb24
+  store i32 %vd24, i32* %pa24, align 4
+  %lc25 = load i32, i32* %pc25, align 4
+  %lb25 = load i32, i32* %pb25, align 4
+  %vd25 = xor i32 %lc25, %lb25
+  store i32 %vd25, i32* %pa25, align 4
+  %lc26 = load i32, i32* %pc26, align 4
+  %lb26 = load i32, i32* %pb26, align 4
+  %vd26 = xor i32 %lc26, %lb26
+  store i32 %vd26, i32* %pa26, align 4
+  %lc27 = load i32, i32* %pc27, align 4
+  %lb27 = load i32, i32* %pb27, align 4
+  %vd27 = xor i32 %lc27, %lb27
+  store i32 %vd27, i32* %pa27, align 4
+  %lc28 = load i32, i32* %pc28, align 4
+  %lb28 = load i32, i32* %pb28, align 4
+  %vd28 = xor i32 %lc28, %lb28
+  store i32 %vd28, i32* %pa28, align 4
+  %lc29 = load i32, i32* %pc29, align 4
+  %lb29 = load i32, i32* %pb29, align 4
+  %vd29 = xor i32 %lc29, %lb29
+  store i32 %vd29, i32* %pa29, align 4
+  %lc30 = load i32, i32* %pc30, align 4
+  %lb30 = load i32, i32* %pb30, align 4
+  %vd30 = xor i32 %lc30, %lb30
+  store i32 %vd30, i32* %pa30, align 4
+  %lc31 = load i32, i32* %pc31, align 4
+  %lb31 = load i32, i32* %pb31, align 4
+  %vd31 = xor i32 %lc31, %lb31
+  store i32 %vd31, i32* %pa31, align 4
+  ret void
+}
+
+; d[] = c[] ^ 255 needs a fourth index register, which x29-x31 cannot hold
+; next to a[], b[] and c[], so the two patterns are not chained and c[] is
+; loaded back.
+; CHECK-LABEL: chain:
+; CHECK:      addv x1, x2, x1
+; CHECK:      sw x1, 0(x31)
+; CHECK:      addi x29, x12, 0
+; CHECK-NEXT: addi x30, x13, 0
+; CHECK:      lw x1, 0(x29)
+; CHECK:      xoriv x1, x1, 255
+; CHECK:      sw x1, 0(x30)
+; CHECK:      ret
+
+define void @chain(i32* noalias %a, i32* noalias %b, i32* noalias %c, i32* noalias %d) {
+entry:
+  %pa0 = getelementptr i32, i32* %a, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %b, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i32, i32* %a, i32 1
+  %va1 = load i32, i32* %pa1, align 4
+  %pb1 = getelementptr i32, i32* %b, i32 1
+  %vb1 = load i32, i32* %pb1, align 4
+  %vc1 = add i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %c, i32 1
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i32, i32* %a, i32 2
+  %va2 = load i32, i32* %pa2, align 4
+  %pb2 = getelementptr i32, i32* %b, i32 2
+  %vb2 = load i32, i32* %pb2, align 4
+  %vc2 = add i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %c, i32 2
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i32, i32* %a, i32 3
+  %va3 = load i32, i32* %pa3, align 4
+  %pb3 = getelementptr i32, i32* %b, i32 3
+  %vb3 = load i32, i32* %pb3, align 4
+  %vc3 = add i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %c, i32 3
+  store i32 %vc3, i32* %pc3, align 4
+  %pa4 = getelementptr i32, i32* %a, i32 4
+  %va4 = load i32, i32* %pa4, align 4
+  %pb4 = getelementptr i32, i32* %b, i32 4
+  %vb4 = load i32, i32* %pb4, align 4
+  %vc4 = add i32 %va4, %vb4
+  %pc4 = getelementptr i32, i32* %c, i32 4
+  store i32 %vc4, i32* %pc4, align 4
+  %pa5 = getelementptr i32, i32* %a, i32 5
+  %va5 = load i32, i32* %pa5, align 4
+  %pb5 = getelementptr i32, i32* %b, i32 5
+  %vb5 = load i32, i32* %pb5, align 4
+  %vc5 = add i32 %va5, %vb5
+  %pc5 = getelementptr i32, i32* %c, i32 5
+  store i32 %vc5, i32* %pc5, align 4
+  %pa6 = getelementptr i32, i32* %a, i32 6
+  %va6 = load i32, i32* %pa6, align 4
+  %pb6 = getelementptr i32, i32* %b, i32 6
+  %vb6 = load i32, i32* %pb6, align 4
+  %vc6 = add i32 %va6, %vb6
+  %pc6 = getelementptr i32, i32* %c, i32 6
+  store i32 %vc6, i32* %pc6, align 4
+  %pa7 = getelementptr i32, i32* %a, i32 7
+  %va7 = load i32, i32* %pa7, align 4
+  %pb7 = getelementptr i32, i32* %b, i32 7
+  %vb7 = load i32, i32* %pb7, align 4
+  %vc7 = add i32 %va7, %vb7
+  %pc7 = getelementptr i32, i32* %c, i32 7
+  store i32 %vc7, i32* %pc7, align 4
+  %pa8 = getelementptr i32, i32* %a, i32 8
+  %va8 = load i32, i32* %pa8, align 4
+  %pb8 = getelementptr i32, i32* %b, i32 8
+  %vb8 = load i32, i32* %pb8, align 4
+  %vc8 = add i32 %va8, %vb8
+  %pc8 = getelementptr i32, i32* %c, i32 8
+  store i32 %vc8, i32* %pc8, align 4
+  %pa9 = getelementptr i32, i32* %a, i32 9
+  %va9 = load i32, i32* %pa9, align 4
+  %pb9 = getelementptr i32, i32* %b, i32 9
+  %vb9 = load i32, i32* %pb9, align 4
+  %vc9 = add i32 %va9, %vb9
+  %pc9 = getelementptr i32, i32* %c, i32 9
+  store i32 %vc9, i32* %pc9, align 4
+  %pa10 = getelementptr i32, i32* %a, i32 10
+  %va10 = load i32, i32* %pa10, align 4
+  %pb10 = getelementptr i32, i32* %b, i32 10
+  %vb10 = load i32, i32* %pb10, align 4
+  %vc10 = add i32 %va10, %vb10
+  %pc10 = getelementptr i32, i32* %c, i32 10
+  store i32 %vc10, i32* %pc10, align 4
+  %pa11 = getelementptr i32, i32* %a, i32 11
+  %va11 = load i32, i32* %pa11, align 4
+  %pb11 = getelementptr i32, i32* %b, i32 11
+  %vb11 = load i32, i32* %pb11, align 4
+  %vc11 = add i32 %va11, %vb11
+  %pc11 = getelementptr i32, i32* %c, i32 11
+  store i32 %vc11, i32* %pc11, align 4
+  %pa12 = getelementptr i32, i32* %a, i32 12
+  %va12 = load i32, i32* %pa12, align 4
+  %pb12 = getelementptr i32, i32* %b, i32 12
+  %vb12 = load i32, i32* %pb12, align 4
+  %vc12 = add i32 %va12, %vb12
+  %pc12 = getelementptr i32, i32* %c, i32 12
+  store i32 %vc12, i32* %pc12, align 4
+  %pa13 = getelementptr i32, i32* %a, i32 13
+  %va13 = load i32, i32* %pa13, align 4
+  %pb13 = getelementptr i32, i32* %b, i32 13
+  %vb13 = load i32, i32* %pb13, align 4
+  %vc13 = add i32 %va13, %vb13
+  %pc13 = getelementptr i32, i32* %c, i32 13
+  store i32 %vc13, i32* %pc13, align 4
+  %pa14 = getelementptr i32, i32* %a, i32 14
+  %va14 = load i32, i32* %pa14, align 4
+  %pb14 = getelementptr i32, i32* %b, i32 14
+  %vb14 = load i32, i32* %pb14, align 4
+  %vc14 = add i32 %va14, %vb14
+  %pc14 = getelementptr i32, i32* %c, i32 14
+  store i32 %vc14, i32* %pc14, align 4
+  %pa15 = getelementptr i32, i32* %a, i32 15
+  %va15 = load i32, i32* %pa15, align 4
+  %pb15 = getelementptr i32, i32* %b, i32 15
+  %vb15 = load i32, i32* %pb15, align 4
+  %vc15 = add i32 %va15, %vb15
+  %pc15 = getelementptr i32, i32* %c, i32 15
+  store i32 %vc15, i32* %pc15, align 4
+  %pa16 = getelementptr i32, i32* %a, i32 16
+  %va16 = load i32, i32* %pa16, align 4
+  %pb16 = getelementptr i32, i32* %b, i32 16
+  %vb16 = load i32, i32* %pb16, align 4
+  %vc16 = add i32 %va16, %vb16
+  %pc16 = getelementptr i32, i32* %c, i32 16
+  store i32 %vc16, i32* %pc16, align 4
+  %pa17 = getelementptr i32, i32* %a, i32 17
+  %va17 = load i32, i32* %pa17, align 4
+  %pb17 = getelementptr i32, i32* %b, i32 17
+  %vb17 = load i32, i32* %pb17, align 4
+  %vc17 = add i32 %va17, %vb17
+  %pc17 = getelementptr i32, i32* %c, i32 17
+  store i32 %vc17, i32* %pc17, align 4
+  %pa18 = getelementptr i32, i32* %a, i32 18
+  %va18 = load i32, i32* %pa18, align 4
+  %pb18 = getelementptr i32, i32* %b, i32 18
+  %vb18 = load i32, i32* %pb18, align 4
+  %vc18 = add i32 %va18, %vb18
+  %pc18 = getelementptr i32, i32* %c, i32 18
+  store i32 %vc18, i32* %pc18, align 4
+  %pa19 = getelementptr i32, i32* %a, i32 19
+  %va19 = load i32, i32* %pa19, align 4
+  %pb19 = getelementptr i32, i32* %b, i32 19
+  %vb19 = load i32, i32* %pb19, align 4
+  %vc19 = add i32 %va19, %vb19
+  %pc19 = getelementptr i32, i32* %c, i32 19
+  store i32 %vc19, i32* %pc19, align 4
+  %pa20 = getelementptr i32, i32* %a, i32 20
+  %va20 = load i32, i32* %pa20, align 4
+  %pb20 = getelementptr i32, i32* %b, i32 20
+  %vb20 = load i32, i32* %pb20, align 4
+  %vc20 = add i32 %va20, %vb20
+  %pc20 = getelementptr i32, i32* %c, i32 20
+  store i32 %vc20, i32* %pc20, align 4
+  %pa21 = getelementptr i32, i32* %a, i32 21
+  %va21 = load i32, i32* %pa21, align 4
+  %pb21 = getelementptr i32, i32* %b, i32 21
+  %vb21 = load i32, i32* %pb21, align 4
+  %vc21 = add i32 %va21, %vb21
+  %pc21 = getelementptr i32, i32* %c, i32 21
+  store i32 %vc21, i32* %pc21, align 4
+  %pa22 = getelementptr i32, i32* %a, i32 22
+  %va22 = load i32, i32* %pa22, align 4
+  %pb22 = getelementptr i32, i32* %b, i32 22
+  %vb22 = load i32, i32* %pb22, align 4
+  %vc22 = add i32 %va22, %vb22
+  %pc22 = getelementptr i32, i32* %c, i32 22
+  store i32 %vc22, i32* %pc22, align 4
+  %pa23 = getelementptr i32, i32* %a, i32 23
+  %va23 = load i32, i32* %pa23, align 4
+  %pb23 = getelementptr i32, i32* %b, i32 23
+  %vb23 = load i32, i32* %pb23, align 4
+  %vc23 = add i32 %va23, %vb23
+  %pc23 = getelementptr i32, i32* %c, i32 23
+  store i32 %vc23, i32* %pc23, align 4
+  %pa24 = getelementptr i32, i32* %a, i32 24
+  %va24 = load i32, i32* %pa24, align 4
+  %pb24 = getelementptr i32, i32* %b, i32 24
+  %vb24 = load i32, i32* %pb24, align 4
+  %vc24 = add i32 %va24, %vb24
+  %pc24 = getelementptr i32, i32* %c, i32 24
+  store i32 %vc24, i32* %pc24, align 4
+  %pa25 = getelementptr i32, i32* %a, i32 25
+  %va25 = load i32, i32* %pa25, align 4
+  %pb25 = getelementptr i32, i32* %b, i32 25
+  %vb25 = load i32, i32* %pb25, align 4
+  %vc25 = add i32 %va25, %vb25
+  %pc25 = getelementptr i32, i32* %c, i32 25
+  store i32 %vc25, i32* %pc25, align 4
+  %pa26 = getelementptr i32, i32* %a, i32 26
+  %va26 = load i32, i32* %pa26, align 4
+  %pb26 = getelementptr i32, i32* %b, i32 26
+  %vb26 = load i32, i32* %pb26, align 4
+  %vc26 = add i32 %va26, %vb26
+  %pc26 = getelementptr i32, i32* %c, i32 26
+  store i32 %vc26, i32* %pc26, align 4
+  %pa27 = getelementptr i32, i32* %a, i32 27
+  %va27 = load i32, i32* %pa27, align 4
+  %pb27 = getelementptr i32, i32* %b, i32 27
+  %vb27 = load i32, i32* %pb27, align 4
+  %vc27 = add i32 %va27, %vb27
+  %pc27 = getelementptr i32, i32* %c, i32 27
+  store i32 %vc27, i32* %pc27, align 4
+  %pa28 = getelementptr i32, i32* %a, i32 28
+  %va28 = load i32, i32* %pa28, align 4
+  %pb28 = getelementptr i32, i32* %b, i32 28
+  %vb28 = load i32, i32* %pb28, align 4
+  %vc28 = add i32 %va28, %vb28
+  %pc28 = getelementptr i32, i32* %c, i32 28
+  store i32 %vc28, i32* %pc28, align 4
+  %pa29 = getelementptr i32, i32* %a, i32 29
+  %va29 = load i32, i32* %pa29, align 4
+  %pb29 = getelementptr i32, i32* %b, i32 29
+  %vb29 = load i32, i32* %pb29, align 4
+  %vc29 = add i32 %va29, %vb29
+  %pc29 = getelementptr i32, i32* %c, i32 29
+  store i32 %vc29, i32* %pc29, align 4
+  %pa30 = getelementptr i32, i32* %a, i32 30
+  %va30 = load i32, i32* %pa30, align 4
+  %pb30 = getelementptr i32, i32* %b, i32 30
+  %vb30 = load i32, i32* %pb30, align 4
+  %vc30 = add i32 %va30, %vb30
+  %pc30 = getelementptr i32, i32* %c, i32 30
+  store i32 %vc30, i32* %pc30, align 4
+  %pa31 = getelementptr i32, i32* %a, i32 31
+  %va31 = load i32, i32* %pa31, align 4
+  %pb31 = getelementptr i32, i32* %b, i32 31
+  %vb31 = load i32, i32* %pb31, align 4
+  %vc31 = add i32 %va31, %vb31
+  %pc31 = getelementptr i32, i32* %c, i32 31
+  store i32 %vc31, i32* %pc31, align 4
+  %lc0 = load i32, i32* %pc0, align 4
+  %vd0 = xor i32 %lc0, 255
+  %pd0 = getelementptr i32, i32* %d, i32 0
+  store i32 %vd0, i32* %pd0, align 4
+  %lc1 = load i32, i32* %pc1, align 4
+  %vd1 = xor i32 %lc1, 255
+  %pd1 = getelementptr i32, i32* %d, i32 1
+  store i32 %vd1, i32* %pd1, align 4
+  %lc2 = load i32, i32* %pc2, align 4
+  %vd2 = xor i32 %lc2, 255
+  %pd2 = getelementptr i32, i32* %d, i32 2
+  store i32 %vd2, i32* %pd2, align 4
+  %lc3 = load i32, i32* %pc3, align 4
+  %vd3 = xor i32 %lc3, 255
+  %pd3 = getelementptr i32, i32* %d, i32 3
+  store i32 %vd3, i32* %pd3, align 4
+  %lc4 = load i32, i32* %pc4, align 4
+  %vd4 = xor i32 %lc4, 255
+  %pd4 = getelementptr i32, i32* %d, i32 4
+  store i32 %vd4, i32* %pd4, align 4
+  %lc5 = load i32, i32* %pc5, align 4
+  %vd5 = xor i32 %lc5, 255
+  %pd5 = getelementptr i32, i32* %d, i32 5
+  store i32 %vd5, i32* %pd5, align 4
+  %lc6 = load i32, i32* %pc6, align 4
+  %vd6 = xor i32 %lc6, 255
+  %pd6 = getelementptr i32, i32* %d, i32 6
+  store i32 %vd6, i32* %pd6, align 4
+  %lc7 = load i32, i32* %pc7, align 4
+  %vd7 = xor i32 %lc7, 255
+  %pd7 = getelementptr i32, i32* %d, i32 7
+  store i32 %vd7, i32* %pd7, align 4
+  %lc8 = load i32, i32* %pc8, align 4
+  %vd8 = xor i32 %lc8, 255
+  %pd8 = getelementptr i32, i32* %d, i32 8
+  store i32 %vd8, i32* %pd8, align 4
+  %lc9 = load i32, i32* %pc9, align 4
+  %vd9 = xor i32 %lc9, 255
+  %pd9 = getelementptr i32, i32* %d, i32 9
+  store i32 %vd9, i32* %pd9, align 4
+  %lc10 = load i32, i32* %pc10, align 4
+  %vd10 = xor i32 %lc10, 255
+  %pd10 = getelementptr i32, i32* %d, i32 10
+  store i32 %vd10, i32* %pd10, align 4
+  %lc11 = load i32, i32* %pc11, align 4
+  %vd11 = xor i32 %lc11, 255
+  %pd11 = getelementptr i32, i32* %d, i32 11
+  store i32 %vd11, i32* %pd11, align 4
+  %lc12 = load i32, i32* %pc12, align 4
+  %vd12 = xor i32 %lc12, 255
+  %pd12 = getelementptr i32, i32* %d, i32 12
+  store i32 %vd12, i32* %pd12, align 4
+  %lc13 = load i32, i32* %pc13, align 4
+  %vd13 = xor i32 %lc13, 255
+  %pd13 = getelementptr i32, i32* %d, i32 13
+  store i32 %vd13, i32* %pd13, align 4
+  %lc14 = load i32, i32* %pc14, align 4
+  %vd14 = xor i32 %lc14, 255
+  %pd14 = getelementptr i32, i32* %d, i32 14
+  store i32 %vd14, i32* %pd14, align 4
+  %lc15 = load i32, i32* %pc15, align 4
+  %vd15 = xor i32 %lc15, 255
+  %pd15 = getelementptr i32, i32* %d, i32 15
+  store i32 %vd15, i32* %pd15, align 4
+  %lc16 = load i32, i32* %pc16, align 4
+  %vd16 = xor i32 %lc16, 255
+  %pd16 = getelementptr i32, i32* %d, i32 16
+  store i32 %vd16, i32* %pd16, align 4
+  %lc17 = load i32, i32* %pc17, align 4
+  %vd17 = xor i32 %lc17, 255
+  %pd17 = getelementptr i32, i32* %d, i32 17
+  store i32 %vd17, i32* %pd17, align 4
+  %lc18 = load i32, i32* %pc18, align 4
+  %vd18 = xor i32 %lc18, 255
+  %pd18 = getelementptr i32, i32* %d, i32 18
+  store i32 %vd18, i32* %pd18, align 4
+  %lc19 = load i32, i32* %pc19, align 4
+  %vd19 = xor i32 %lc19, 255
+  %pd19 = getelementptr i32, i32* %d, i32 19
+  store i32 %vd19, i32* %pd19, align 4
+  %lc20 = load i32, i32* %pc20, align 4
+  %vd20 = xor i32 %lc20, 255
+  %pd20 = getelementptr i32, i32* %d, i32 20
+  store i32 %vd20, i32* %pd20, align 4
+  %lc21 = load i32, i32* %pc21, align 4
+  %vd21 = xor i32 %lc21, 255
+  %pd21 = getelementptr i32, i32* %d, i32 21
+  store i32 %vd21, i32* %pd21, align 4
+  %lc22 = load i32, i32* %pc22, align 4
+  %vd22 = xor i32 %lc22, 255
+  %pd22 = getelementptr i32, i32* %d, i32 22
+  store i32 %vd22, i32* %pd22, align 4
+  %lc23 = load i32, i32* %pc23, align 4
+  %vd23 = xor i32 %lc23, 255
+  %pd23 = getelementptr i32, i32* %d, i32 23
+  store i32 %vd23, i32* %pd23, align 4
+  %lc24 = load i32, i32* %pc24, align 4
+  %vd24 = xor i32 %lc24, 255
+  %pd24 = getelementptr i32, i32* %d, i32 24
+  store i32 %vd24, i32* %pd24, align 4
+  %lc25 = load i32, i32* %pc25, align 4
+  %vd25 = xor i32 %lc25, 255
+  %pd25 = getelementptr i32, i32* %d, i32 25
+  store i32 %vd25, i32* %pd25, align 4
+  %lc26 = load i32, i32* %pc26, align 4
+  %vd26 = xor i32 %lc26, 255
+  %pd26 = getelementptr i32, i32* %d, i32 26
+  store i32 %vd26, i32* %pd26, align 4
+  %lc27 = load i32, i32* %pc27, align 4
+  %vd27 = xor i32 %lc27, 255
+  %pd27 = getelementptr i32, i32* %d, i32 27
+  store i32 %vd27, i32* %pd27, align 4
+  %lc28 = load i32, i32* %pc28, align 4
+  %vd28 = xor i32 %lc28, 255
+  %pd28 = getelementptr i32, i32* %d, i32 28
+  store i32 %vd28, i32* %pd28, align 4
+  %lc29 = load i32, i32* %pc29, align 4
+  %vd29 = xor i32 %lc29, 255
+  %pd29 = getelementptr i32, i32* %d, i32 29
+  store i32 %vd29, i32* %pd29, align 4
+  %lc30 = load i32, i32* %pc30, align 4
+  %vd30 = xor i32 %lc30, 255
+  %pd30 = getelementptr i32, i32* %d, i32 30
+  store i32 %vd30, i32* %pd30, align 4
+  %lc31 = load i32, i32* %pc31, align 4
+  %vd31 = xor i32 %lc31, 255
+  %pd31 = getelementptr i32, i32* %d, i32 31
+  store i32 %vd31, i32* %pd31, align 4
+  ret void
+}
@@ -0,0 +1,117 @@
+; RUN: llc -march=riscv < %s | FileCheck %s
+; RUN: llc -march=riscv -riscv-xvec-loops=false < %s \
+; RUN:   | FileCheck %s -check-prefix=NOLOOP
+
+; The loops are guarded, so the block in front of them is not a preheader.
+; The chunked loop takes its place, and the original loop runs whatever is
+; left over.
+
+; CHECK-LABEL: add:
+; CHECK:      blt x13, x5, [[EXIT:LBB[0-9_]+]]
+; CHECK-NEXT: [[VECHDR:LBB[0-9_]+]]:
+; CHECK:      sub x5, x13, x0
+; CHECK-NEXT: sltiu x5, x5, 28
+; CHECK-NEXT: bne x5, x0, [[LOOP:LBB[0-9_]+]]
+; CHECK:      addi x29, x10, 0
+; CHECK-NEXT: addi x30, x11, 0
+; CHECK-NEXT: addi x31, x12, 0
+; CHECK:      addiv x3, x1, 0
+; CHECK:      lw x28, 108(x29)
+; CHECK:      addiv x2, x1, 0
+; CHECK:      lw x28, 108(x30)
+; CHECK:      addv x1, x2, x1
+; CHECK:      sw x28, 108(x31)
+; CHECK:      addiv x1, x3, 0
+; CHECK:      addi x13, x13, -28
+; CHECK-NEXT: addi x12, x12, 112
+; CHECK-NEXT: addi x11, x11, 112
+; CHECK-NEXT: addi x10, x10, 112
+; CHECK-NEXT: bne x13, x0, [[VECHDR]]
+; CHECK-NEXT: j [[EXIT]]
+; CHECK-NEXT: [[LOOP]]:
+; CHECK:      lw x5, 0(x10)
+; CHECK-NEXT: lw x6, 0(x11)
+; CHECK:      add x5, x5, x6
+; CHECK-NEXT: sw x5, 0(x12)
+; CHECK:      bne x13, x0, [[LOOP]]
+; CHECK-NEXT: [[EXIT]]:
+; CHECK-NEXT: ret
+
+; NOLOOP-LABEL: add:
+; NOLOOP-NOT:  addv
+; NOLOOP:      lw x5, 0(x10)
+; NOLOOP-NEXT: lw x6, 0(x11)
+; NOLOOP:      add x5, x5, x6
+; NOLOOP-NEXT: sw x5, 0(x12)
+; NOLOOP-NOT:  addv
+; NOLOOP:      ret
+define void @add(i32* noalias %a, i32* noalias %b, i32* noalias %c, i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr i32, i32* %a, i32 %i
+  %va = load i32, i32* %pa, align 4
+  %pb = getelementptr i32, i32* %b, i32 %i
+  %vb = load i32, i32* %pb, align 4
+  %vc = add i32 %va, %vb
+  %pc = getelementptr i32, i32* %c, i32 %i
+  store i32 %vc, i32* %pc, align 4
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: xori:
+; CHECK:      blt x12, x5, [[EXIT:LBB[0-9_]+]]
+; CHECK-NEXT: [[VECHDR:LBB[0-9_]+]]:
+; CHECK:      sub x5, x12, x0
+; CHECK-NEXT: sltiu x5, x5, 28
+; CHECK-NEXT: bne x5, x0, [[LOOP:LBB[0-9_]+]]
+; CHECK:      addiv x3, x1, 0
+; CHECK:      lhu x1, 0(x29)
+; CHECK:      lhu x28, 54(x29)
+; CHECK:      xoriv x1, x1, 255
+; CHECK:      sh x1, 0(x30)
+; CHECK:      sh x28, 54(x30)
+; CHECK:      addiv x1, x3, 0
+; CHECK:      addi x12, x12, -28
+; CHECK-NEXT: addi x11, x11, 56
+; CHECK-NEXT: addi x10, x10, 56
+; CHECK-NEXT: bne x12, x0, [[VECHDR]]
+; CHECK-NEXT: j [[EXIT]]
+; CHECK-NEXT: [[LOOP]]:
+; CHECK:      lhu x5, 0(x10)
+; CHECK:      xori x5, x5, 255
+; CHECK-NEXT: sh x5, 0(x11)
+; CHECK:      bne x12, x0, [[LOOP]]
+; CHECK-NEXT: [[EXIT]]:
+; CHECK-NEXT: ret
+
+; NOLOOP-LABEL: xori:
+; NOLOOP-NOT:  xoriv
+; NOLOOP:      ret
+define void @xori(i16* noalias %a, i16* noalias %c, i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr i16, i16* %a, i32 %i
+  %va = load i16, i16* %pa, align 2
+  %vc = xor i16 %va, 255
+  %pc = getelementptr i16, i16* %c, i32 %i
+  store i16 %vc, i16* %pc, align 2
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
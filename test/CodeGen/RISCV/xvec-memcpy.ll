@@ -0,0 +1,149 @@
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=ALL -check-prefix=CHECK
+; RUN: llc -march=riscv -riscv-xvec-memcpy=false < %s \
+; RUN:   | FileCheck %s -check-prefix=ALL -check-prefix=NOXVEC
+
+declare void @llvm.memcpy.p0i8.p0i8.i32(i8*, i8*, i32, i32, i1)
+declare void @llvm.memmove.p0i8.p0i8.i32(i8*, i8*, i32, i32, i1)
+declare void @llvm.memset.p0i8.i32(i8*, i8, i32, i32, i1)
+
+; 62 words and a halfword: two full chunks of 28 elements through the bank
+; and a last one of 7, each loaded completely before it is stored.
+; ALL-LABEL:  copy_aligned:
+; NOXVEC:     jal x1, memcpy
+; CHECK-NOT:  memcpy
+; CHECK:      addi x30, x11, 0
+; CHECK-NEXT: addi x29, x10, 0
+; CHECK:      addiv x3, x1, 0
+; CHECK:      lw x1, 0(x30)
+; CHECK:      lw x28, 108(x30)
+; CHECK-NEXT: sw x1, 0(x29)
+; CHECK:      sw x28, 108(x29)
+; CHECK-NEXT: lw x1, 112(x30)
+; CHECK:      lw x28, 220(x30)
+; CHECK-NEXT: sw x1, 112(x29)
+; CHECK:      sw x28, 220(x29)
+; CHECK-NEXT: lw x1, 224(x30)
+; CHECK:      lw x6, 244(x30)
+; CHECK-NEXT: lhu x7, 248(x30)
+; CHECK-NEXT: sw x1, 224(x29)
+; CHECK:      sw x6, 244(x29)
+; CHECK-NEXT: sh x7, 248(x29)
+; CHECK:      addiv x1, x3, 0
+; CHECK-NOT:  memcpy
+; CHECK:      ret
+define void @copy_aligned(i8* %dst, i8* %src) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 250, i32 4, i1 false)
+  ret void
+}
+
+; Without alignment every byte takes a lane.
+; ALL-LABEL:  copy_unaligned:
+; NOXVEC:     jal x1, memcpy
+; CHECK:      lbu x1, 0(x30)
+; CHECK:      lbu x28, 27(x30)
+; CHECK-NEXT: sb x1, 0(x29)
+; CHECK:      sb x28, 27(x29)
+; CHECK:      lbu x5, 60(x30)
+; CHECK-NEXT: sb x1, 56(x29)
+; CHECK:      sb x5, 60(x29)
+; CHECK-NOT:  memcpy
+; CHECK:      ret
+define void @copy_unaligned(i8* %dst, i8* %src) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 61, i32 1, i1 false)
+  ret void
+}
+
+; 2048 bytes is the largest block whose offsets fit in 12 bits...
+; ALL-LABEL:  copy_max:
+; NOXVEC:     jal x1, memcpy
+; CHECK-NOT:  memcpy
+; CHECK:      lw x8, 2044(x30)
+; CHECK:      sw x8, 2044(x29)
+; CHECK-NOT:  memcpy
+; CHECK:      ret
+define void @copy_max(i8* %dst, i8* %src) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 2048, i32 4, i1 false)
+  ret void
+}
+
+; ...anything larger goes to the library.
+; ALL-LABEL:  copy_too_big:
+; ALL-NOT:    addiv
+; ALL:        jal x1, memcpy
+define void @copy_too_big(i8* %dst, i8* %src) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 2052, i32 4, i1 false)
+  ret void
+}
+
+; A memmove that fits in one chunk loads it all before it stores anything, so
+; the blocks may overlap.
+; ALL-LABEL:  move:
+; NOXVEC:     jal x1, memmove
+; CHECK-NOT:  memmove
+; CHECK:      lw x1, 0(x30)
+; CHECK:      lw x25, 96(x30)
+; CHECK-NEXT: sw x1, 0(x29)
+; CHECK:      sw x25, 96(x29)
+; CHECK-NOT:  memmove
+; CHECK:      ret
+define void @move(i8* %dst, i8* %src) {
+entry:
+  call void @llvm.memmove.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 100, i32 4, i1 false)
+  ret void
+}
+
+; 30 words take two chunks, and the second one could read what the first
+; one wrote.
+; ALL-LABEL:  move_too_big:
+; ALL-NOT:    addiv
+; ALL:        jal x1, memmove
+define void @move_too_big(i8* %dst, i8* %src) {
+entry:
+  call void @llvm.memmove.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 120, i32 4, i1 false)
+  ret void
+}
+
+; memset does not use the bank: the byte is splatted into a word, which is
+; stored directly, with -riscv-xvec-memcpy=false as well.
+; ALL-LABEL:  fill_words:
+; ALL:        andi x5, x11, 255
+; ALL-NEXT:   slli x6, x5, 8
+; ALL-NEXT:   or x5, x5, x6
+; ALL-NEXT:   slli x6, x5, 16
+; ALL-NEXT:   sh x5, 60(x10)
+; ALL-NEXT:   or x5, x5, x6
+; ALL-NEXT:   sw x5, 56(x10)
+; ALL:        sw x5, 0(x10)
+; ALL-NOT:    memset
+; ALL:        ret
+define void @fill_words(i8* %dst, i8 %c) {
+entry:
+  call void @llvm.memset.p0i8.i32(i8* %dst, i8 %c, i32 62, i32 4, i1 false)
+  ret void
+}
+
+; 0xabababab
+; ALL-LABEL:  fill_const:
+; ALL:        lui x5, 703163
+; ALL-NEXT:   addi x5, x5, -1109
+; ALL-NEXT:   sw x5, 4(x10)
+; ALL-NEXT:   sw x5, 0(x10)
+; ALL-NEXT:   ret
+define void @fill_const(i8* %dst) {
+entry:
+  call void @llvm.memset.p0i8.i32(i8* %dst, i8 -85, i32 8, i32 4, i1 false)
+  ret void
+}
+
+; 35 halfword stores are over the budget of -riscv-memset-max-stores.
+; ALL-LABEL:  fill:
+; ALL:        jal x1, memset
+define void @fill(i8* %dst, i8 %c) {
+entry:
+  call void @llvm.memset.p0i8.i32(i8* %dst, i8 %c, i32 70, i32 2, i1 false)
+  ret void
+}
@@ -0,0 +1,150 @@
+; RUN: llc -march=riscv < %s | FileCheck %s -check-prefix=SCALAR
+; RUN: llc -march=riscv -riscv-xvec-cost-model=false < %s | FileCheck %s
+
+; Four elements are too few for the cost model.
+; SCALAR-NOT: {{addv|xoriv|subv}}
+
+; Each byte gets a lane of its own: lbu extends it on the way in and sb
+; truncates the sum on the way out. The offset of 1 is kept.
+; CHECK-LABEL: bytes:
+; CHECK:      lbu x1, 1(x29)
+; CHECK-NEXT: lbu x2, 2(x29)
+; CHECK-NEXT: lbu x3, 3(x29)
+; CHECK-NEXT: lbu x4, 4(x29)
+; CHECK:      addiv x2, x1, 0
+; CHECK:      lbu x1, 1(x30)
+; CHECK-NEXT: lbu x2, 2(x30)
+; CHECK-NEXT: lbu x3, 3(x30)
+; CHECK-NEXT: lbu x4, 4(x30)
+; CHECK:      addv x1, x2, x1
+; CHECK:      sb x1, 1(x31)
+; CHECK-NEXT: sb x2, 2(x31)
+; CHECK-NEXT: sb x3, 3(x31)
+; CHECK-NEXT: sb x4, 4(x31)
+
+define void @bytes(i8* noalias %a, i8* noalias %b, i8* noalias %c) {
+entry:
+  %pa0 = getelementptr i8, i8* %a, i32 1
+  %va0 = load i8, i8* %pa0, align 1
+  %pb0 = getelementptr i8, i8* %b, i32 1
+  %vb0 = load i8, i8* %pb0, align 1
+  %vc0 = add i8 %va0, %vb0
+  %pc0 = getelementptr i8, i8* %c, i32 1
+  store i8 %vc0, i8* %pc0, align 1
+  %pa1 = getelementptr i8, i8* %a, i32 2
+  %va1 = load i8, i8* %pa1, align 1
+  %pb1 = getelementptr i8, i8* %b, i32 2
+  %vb1 = load i8, i8* %pb1, align 1
+  %vc1 = add i8 %va1, %vb1
+  %pc1 = getelementptr i8, i8* %c, i32 2
+  store i8 %vc1, i8* %pc1, align 1
+  %pa2 = getelementptr i8, i8* %a, i32 3
+  %va2 = load i8, i8* %pa2, align 1
+  %pb2 = getelementptr i8, i8* %b, i32 3
+  %vb2 = load i8, i8* %pb2, align 1
+  %vc2 = add i8 %va2, %vb2
+  %pc2 = getelementptr i8, i8* %c, i32 3
+  store i8 %vc2, i8* %pc2, align 1
+  %pa3 = getelementptr i8, i8* %a, i32 4
+  %va3 = load i8, i8* %pa3, align 1
+  %pb3 = getelementptr i8, i8* %b, i32 4
+  %vb3 = load i8, i8* %pb3, align 1
+  %vc3 = add i8 %va3, %vb3
+  %pc3 = getelementptr i8, i8* %c, i32 4
+  store i8 %vc3, i8* %pc3, align 1
+  ret void
+}
+
+; Every other halfword: a stride of 4 bytes on both sides.
+; CHECK-LABEL: halves:
+; CHECK:      lhu x1, 0(x29)
+; CHECK-NEXT: lhu x2, 4(x29)
+; CHECK-NEXT: lhu x3, 8(x29)
+; CHECK-NEXT: lhu x4, 12(x29)
+; CHECK:      xoriv x1, x1, 255
+; CHECK:      sh x1, 0(x30)
+; CHECK-NEXT: sh x2, 4(x30)
+; CHECK-NEXT: sh x3, 8(x30)
+; CHECK-NEXT: sh x4, 12(x30)
+define void @halves(i16* noalias %a, i16* noalias %c) {
+entry:
+  %pa0 = getelementptr i16, i16* %a, i32 0
+  %va0 = load i16, i16* %pa0, align 2
+  %vc0 = xor i16 %va0, 255
+  %pc0 = getelementptr i16, i16* %c, i32 0
+  store i16 %vc0, i16* %pc0, align 2
+  %pa1 = getelementptr i16, i16* %a, i32 2
+  %va1 = load i16, i16* %pa1, align 2
+  %vc1 = xor i16 %va1, 255
+  %pc1 = getelementptr i16, i16* %c, i32 2
+  store i16 %vc1, i16* %pc1, align 2
+  %pa2 = getelementptr i16, i16* %a, i32 4
+  %va2 = load i16, i16* %pa2, align 2
+  %vc2 = xor i16 %va2, 255
+  %pc2 = getelementptr i16, i16* %c, i32 4
+  store i16 %vc2, i16* %pc2, align 2
+  %pa3 = getelementptr i16, i16* %a, i32 6
+  %va3 = load i16, i16* %pa3, align 2
+  %vc3 = xor i16 %va3, 255
+  %pc3 = getelementptr i16, i16* %c, i32 6
+  store i16 %vc3, i16* %pc3, align 2
+  ret void
+}
+
+; Sign-extended bytes and halfwords, each with its own stride, into every
+; other word of c[] from offset 4.
+; CHECK-LABEL: signed:
+; CHECK:      lb x1, 0(x29)
+; CHECK-NEXT: lb x2, 2(x29)
+; CHECK-NEXT: lb x3, 4(x29)
+; CHECK-NEXT: lb x4, 6(x29)
+; CHECK:      addiv x2, x1, 0
+; CHECK:      lh x1, 0(x30)
+; CHECK-NEXT: lh x2, 2(x30)
+; CHECK-NEXT: lh x3, 4(x30)
+; CHECK-NEXT: lh x4, 6(x30)
+; CHECK:      subv x1, x2, x1
+; CHECK:      sw x1, 4(x31)
+; CHECK-NEXT: sw x2, 12(x31)
+; CHECK-NEXT: sw x3, 20(x31)
+; CHECK-NEXT: sw x4, 28(x31)
+define void @signed(i8* noalias %a, i16* noalias %b, i32* noalias %c) {
+entry:
+  %pa0 = getelementptr i8, i8* %a, i32 0
+  %la0 = load i8, i8* %pa0, align 1
+  %va0 = sext i8 %la0 to i32
+  %pb0 = getelementptr i16, i16* %b, i32 0
+  %lb0 = load i16, i16* %pb0, align 2
+  %vb0 = sext i16 %lb0 to i32
+  %vc0 = sub i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 1
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i8, i8* %a, i32 2
+  %la1 = load i8, i8* %pa1, align 1
+  %va1 = sext i8 %la1 to i32
+  %pb1 = getelementptr i16, i16* %b, i32 1
+  %lb1 = load i16, i16* %pb1, align 2
+  %vb1 = sext i16 %lb1 to i32
+  %vc1 = sub i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %c, i32 3
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i8, i8* %a, i32 4
+  %la2 = load i8, i8* %pa2, align 1
+  %va2 = sext i8 %la2 to i32
+  %pb2 = getelementptr i16, i16* %b, i32 2
+  %lb2 = load i16, i16* %pb2, align 2
+  %vb2 = sext i16 %lb2 to i32
+  %vc2 = sub i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %c, i32 5
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i8, i8* %a, i32 6
+  %la3 = load i8, i8* %pa3, align 1
+  %va3 = sext i8 %la3 to i32
+  %pb3 = getelementptr i16, i16* %b, i32 3
+  %lb3 = load i16, i16* %pb3, align 2
+  %vb3 = sext i16 %lb3 to i32
+  %vc3 = sub i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %c, i32 7
+  store i32 %vc3, i32* %pc3, align 4
+  ret void
+}
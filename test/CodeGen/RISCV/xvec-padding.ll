@@ -0,0 +1,157 @@
+; RUN: llc -march=riscv -riscv-xvec-cost-model=false -riscv-xvec-loops=false \
+; RUN:   < %s | FileCheck %s
+; RUN: llc -march=riscv -riscv-xvec-cost-model=false -riscv-xvec-loops=false \
+; RUN:   -riscv-xvec-index-hint=0 < %s | FileCheck %s -check-prefix=NOHINT
+; RUN: llc -march=riscv -riscv-xvec-cost-model=false -riscv-xvec-loops=false \
+; RUN:   -riscv-xvec-hazard-distance=1 < %s | FileCheck %s -check-prefix=DIST1
+
+; The loop is left to the block path, which sees the three distinct globals
+; apart.  The pointers are the base of eight word accesses each, so they are
+; allocated to x29-x31, outside the vector bank.  Their increments are the
+; only work that does not touch the bank, and the post-RA scheduler puts one
+; of them in the hazard slots in front of each vector operation.  The no-ops
+; fill the rest.
+; CHECK-LABEL: loop:
+; CHECK:      addi x29, x5, %lo(a)
+; CHECK:      addi x30, x5, %lo(b)
+; CHECK:      addi x31, x5, %lo(c)
+; CHECK:      addi x0, x0, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addiv x3, x1, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: lw x1, 0(x29)
+; CHECK:      lw x8, 28(x29)
+; CHECK-NEXT: addi x29, x29, 32
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addiv x2, x1, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: lw x1, 0(x30)
+; CHECK:      lw x8, 28(x30)
+; CHECK-NEXT: addi x30, x30, 32
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addv x1, x2, x1
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: sw x1, 0(x31)
+; CHECK:      sw x8, 28(x31)
+; CHECK-NEXT: addi x31, x31, 32
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addiv x1, x3, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addi x0, x0, 0
+; CHECK-NEXT: addi x10, x10, -1
+; CHECK-NEXT: bne x10, x0
+
+; Without the hint the pointers are copied to x29-x31 and back, and every
+; slot takes a no-op.
+; NOHINT-LABEL: loop:
+; NOHINT:      addi x29, x5, 0
+; NOHINT-NEXT: addi x30, x6, 0
+; NOHINT-NEXT: addi x31, x7, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addiv x3, x1, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: lw x1, 0(x29)
+; NOHINT:      sw x8, 28(x31)
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addiv x1, x3, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addi x0, x0, 0
+; NOHINT-NEXT: addi x10, x10, -1
+; NOHINT:      addi x5, x5, 32
+
+; With a distance of one slot, only the one in front of the first vector
+; operation is left, since the block may be entered right after a bank access.
+; DIST1-LABEL: loop:
+; DIST1:      addi x0, x0, 0
+; DIST1-NEXT: addiv x3, x1, 0
+; DIST1-NOT:  addi x0, x0, 0
+; DIST1:      ret
+@a = global [64 x i32] zeroinitializer, align 4
+@b = global [64 x i32] zeroinitializer, align 4
+@c = global [64 x i32] zeroinitializer, align 4
+
+define void @loop(i32 %n) {
+entry:
+  %a = getelementptr [64 x i32], [64 x i32]* @a, i32 0, i32 0
+  %b = getelementptr [64 x i32], [64 x i32]* @b, i32 0, i32 0
+  %c = getelementptr [64 x i32], [64 x i32]* @c, i32 0, i32 0
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = phi i32* [ %a, %entry ], [ %pa.next, %loop ]
+  %pb = phi i32* [ %b, %entry ], [ %pb.next, %loop ]
+  %pc = phi i32* [ %c, %entry ], [ %pc.next, %loop ]
+  %pa0 = getelementptr i32, i32* %pa, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %pb, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %pc, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i32, i32* %pa, i32 1
+  %va1 = load i32, i32* %pa1, align 4
+  %pb1 = getelementptr i32, i32* %pb, i32 1
+  %vb1 = load i32, i32* %pb1, align 4
+  %vc1 = add i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %pc, i32 1
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i32, i32* %pa, i32 2
+  %va2 = load i32, i32* %pa2, align 4
+  %pb2 = getelementptr i32, i32* %pb, i32 2
+  %vb2 = load i32, i32* %pb2, align 4
+  %vc2 = add i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %pc, i32 2
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i32, i32* %pa, i32 3
+  %va3 = load i32, i32* %pa3, align 4
+  %pb3 = getelementptr i32, i32* %pb, i32 3
+  %vb3 = load i32, i32* %pb3, align 4
+  %vc3 = add i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %pc, i32 3
+  store i32 %vc3, i32* %pc3, align 4
+  %pa4 = getelementptr i32, i32* %pa, i32 4
+  %va4 = load i32, i32* %pa4, align 4
+  %pb4 = getelementptr i32, i32* %pb, i32 4
+  %vb4 = load i32, i32* %pb4, align 4
+  %vc4 = add i32 %va4, %vb4
+  %pc4 = getelementptr i32, i32* %pc, i32 4
+  store i32 %vc4, i32* %pc4, align 4
+  %pa5 = getelementptr i32, i32* %pa, i32 5
+  %va5 = load i32, i32* %pa5, align 4
+  %pb5 = getelementptr i32, i32* %pb, i32 5
+  %vb5 = load i32, i32* %pb5, align 4
+  %vc5 = add i32 %va5, %vb5
+  %pc5 = getelementptr i32, i32* %pc, i32 5
+  store i32 %vc5, i32* %pc5, align 4
+  %pa6 = getelementptr i32, i32* %pa, i32 6
+  %va6 = load i32, i32* %pa6, align 4
+  %pb6 = getelementptr i32, i32* %pb, i32 6
+  %vb6 = load i32, i32* %pb6, align 4
+  %vc6 = add i32 %va6, %vb6
+  %pc6 = getelementptr i32, i32* %pc, i32 6
+  store i32 %vc6, i32* %pc6, align 4
+  %pa7 = getelementptr i32, i32* %pa, i32 7
+  %va7 = load i32, i32* %pa7, align 4
+  %pb7 = getelementptr i32, i32* %pb, i32 7
+  %vb7 = load i32, i32* %pb7, align 4
+  %vc7 = add i32 %va7, %vb7
+  %pc7 = getelementptr i32, i32* %pc, i32 7
+  store i32 %vc7, i32* %pc7, align 4
+  %pa.next = getelementptr i32, i32* %pa, i32 8
+  %pb.next = getelementptr i32, i32* %pb, i32 8
+  %pc.next = getelementptr i32, i32* %pc, i32 8
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
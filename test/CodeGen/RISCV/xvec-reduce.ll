@@ -0,0 +1,354 @@
+; RUN: llc -march=riscv < %s
+; RUN: llc -march=riscv -riscv-xvec-cost-model=false < %s | FileCheck %s
+
+; The machine scheduler would hoist the loads above the additions, but keeps
+; each of them next to the step that accumulates it, so that the reduction is
+; still found after register allocation.  The first step takes its
+; accumulator from %s and the last one returns in x10, so both stay scalar.
+
+; 58 elements: two full chunks and one of 2 lanes, whose other lanes are
+; zeroed, the identity of add.
+; CHECK-LABEL: sum:
+; CHECK:      lw x5, 0(x10)
+; CHECK-NEXT: addi x29, x10, 0
+; CHECK-NEXT: add x5, x11, x5
+; CHECK-NEXT: addi x30, x5, 0
+; CHECK:      addiv x3, x1, 0
+; CHECK:      lw x1, 4(x29)
+; CHECK:      lw x28, 112(x29)
+; CHECK:      addiv x2, x1, 0
+; CHECK:      lw x1, 116(x29)
+; CHECK:      lw x28, 224(x29)
+; CHECK:      addv x2, x2, x1
+; CHECK:      lw x1, 228(x29)
+; CHECK-NEXT: lw x2, 232(x29)
+; CHECK-NEXT: addi x3, x0, 0
+; CHECK:      addi x28, x0, 0
+; CHECK:      addv x2, x2, x1
+; CHECK:      addiv x1, x2, 0
+; The lanes are folded 28 -> 14 -> 7 -> 4 -> 2 -> 1 into the accumulator.
+; CHECK:      add x1, x1, x15
+; CHECK:      add x14, x14, x28
+; CHECK-NEXT: add x1, x1, x8
+; CHECK:      add x7, x7, x14
+; CHECK-NEXT: add x1, x1, x5
+; CHECK-NEXT: add x2, x2, x6
+; CHECK-NEXT: add x3, x3, x7
+; CHECK-NEXT: add x1, x1, x3
+; CHECK-NEXT: add x2, x2, x4
+; CHECK-NEXT: add x1, x1, x2
+; CHECK-NEXT: add x30, x30, x1
+; CHECK:      addiv x1, x3, 0
+; CHECK:      lw x6, 236(x10)
+; CHECK-NEXT: addi x5, x30, 0
+; CHECK-NEXT: add x10, x5, x6
+; CHECK-NEXT: ret
+
+define i32 @sum(i32* %a, i32 %s) {
+entry:
+  %p0 = getelementptr i32, i32* %a, i32 0
+  %v0 = load i32, i32* %p0
+  %s0 = add i32 %s, %v0
+  %p1 = getelementptr i32, i32* %a, i32 1
+  %v1 = load i32, i32* %p1
+  %s1 = add i32 %s0, %v1
+  %p2 = getelementptr i32, i32* %a, i32 2
+  %v2 = load i32, i32* %p2
+  %s2 = add i32 %s1, %v2
+  %p3 = getelementptr i32, i32* %a, i32 3
+  %v3 = load i32, i32* %p3
+  %s3 = add i32 %s2, %v3
+  %p4 = getelementptr i32, i32* %a, i32 4
+  %v4 = load i32, i32* %p4
+  %s4 = add i32 %s3, %v4
+  %p5 = getelementptr i32, i32* %a, i32 5
+  %v5 = load i32, i32* %p5
+  %s5 = add i32 %s4, %v5
+  %p6 = getelementptr i32, i32* %a, i32 6
+  %v6 = load i32, i32* %p6
+  %s6 = add i32 %s5, %v6
+  %p7 = getelementptr i32, i32* %a, i32 7
+  %v7 = load i32, i32* %p7
+  %s7 = add i32 %s6, %v7
+  %p8 = getelementptr i32, i32* %a, i32 8
+  %v8 = load i32, i32* %p8
+  %s8 = add i32 %s7, %v8
+  %p9 = getelementptr i32, i32* %a, i32 9
+  %v9 = load i32, i32* %p9
+  %s9 = add i32 %s8, %v9
+  %p10 = getelementptr i32, i32* %a, i32 10
+  %v10 = load i32, i32* %p10
+  %s10 = add i32 %s9, %v10
+  %p11 = getelementptr i32, i32* %a, i32 11
+  %v11 = load i32, i32* %p11
+  %s11 = add i32 %s10, %v11
+  %p12 = getelementptr i32, i32* %a, i32 12
+  %v12 = load i32, i32* %p12
+  %s12 = add i32 %s11, %v12
+  %p13 = getelementptr i32, i32* %a, i32 13
+  %v13 = load i32, i32* %p13
+  %s13 = add i32 %s12, %v13
+  %p14 = getelementptr i32, i32* %a, i32 14
+  %v14 = load i32, i32* %p14
+  %s14 = add i32 %s13, %v14
+  %p15 = getelementptr i32, i32* %a, i32 15
+  %v15 = load i32, i32* %p15
+  %s15 = add i32 %s14, %v15
+  %p16 = getelementptr i32, i32* %a, i32 16
+  %v16 = load i32, i32* %p16
+  %s16 = add i32 %s15, %v16
+  %p17 = getelementptr i32, i32* %a, i32 17
+  %v17 = load i32, i32* %p17
+  %s17 = add i32 %s16, %v17
+  %p18 = getelementptr i32, i32* %a, i32 18
+  %v18 = load i32, i32* %p18
+  %s18 = add i32 %s17, %v18
+  %p19 = getelementptr i32, i32* %a, i32 19
+  %v19 = load i32, i32* %p19
+  %s19 = add i32 %s18, %v19
+  %p20 = getelementptr i32, i32* %a, i32 20
+  %v20 = load i32, i32* %p20
+  %s20 = add i32 %s19, %v20
+  %p21 = getelementptr i32, i32* %a, i32 21
+  %v21 = load i32, i32* %p21
+  %s21 = add i32 %s20, %v21
+  %p22 = getelementptr i32, i32* %a, i32 22
+  %v22 = load i32, i32* %p22
+  %s22 = add i32 %s21, %v22
+  %p23 = getelementptr i32, i32* %a, i32 23
+  %v23 = load i32, i32* %p23
+  %s23 = add i32 %s22, %v23
+  %p24 = getelementptr i32, i32* %a, i32 24
+  %v24 = load i32, i32* %p24
+  %s24 = add i32 %s23, %v24
+  %p25 = getelementptr i32, i32* %a, i32 25
+  %v25 = load i32, i32* %p25
+  %s25 = add i32 %s24, %v25
+  %p26 = getelementptr i32, i32* %a, i32 26
+  %v26 = load i32, i32* %p26
+  %s26 = add i32 %s25, %v26
+  %p27 = getelementptr i32, i32* %a, i32 27
+  %v27 = load i32, i32* %p27
+  %s27 = add i32 %s26, %v27
+  %p28 = getelementptr i32, i32* %a, i32 28
+  %v28 = load i32, i32* %p28
+  %s28 = add i32 %s27, %v28
+  %p29 = getelementptr i32, i32* %a, i32 29
+  %v29 = load i32, i32* %p29
+  %s29 = add i32 %s28, %v29
+  %p30 = getelementptr i32, i32* %a, i32 30
+  %v30 = load i32, i32* %p30
+  %s30 = add i32 %s29, %v30
+  %p31 = getelementptr i32, i32* %a, i32 31
+  %v31 = load i32, i32* %p31
+  %s31 = add i32 %s30, %v31
+  %p32 = getelementptr i32, i32* %a, i32 32
+  %v32 = load i32, i32* %p32
+  %s32 = add i32 %s31, %v32
+  %p33 = getelementptr i32, i32* %a, i32 33
+  %v33 = load i32, i32* %p33
+  %s33 = add i32 %s32, %v33
+  %p34 = getelementptr i32, i32* %a, i32 34
+  %v34 = load i32, i32* %p34
+  %s34 = add i32 %s33, %v34
+  %p35 = getelementptr i32, i32* %a, i32 35
+  %v35 = load i32, i32* %p35
+  %s35 = add i32 %s34, %v35
+  %p36 = getelementptr i32, i32* %a, i32 36
+  %v36 = load i32, i32* %p36
+  %s36 = add i32 %s35, %v36
+  %p37 = getelementptr i32, i32* %a, i32 37
+  %v37 = load i32, i32* %p37
+  %s37 = add i32 %s36, %v37
+  %p38 = getelementptr i32, i32* %a, i32 38
+  %v38 = load i32, i32* %p38
+  %s38 = add i32 %s37, %v38
+  %p39 = getelementptr i32, i32* %a, i32 39
+  %v39 = load i32, i32* %p39
+  %s39 = add i32 %s38, %v39
+  %p40 = getelementptr i32, i32* %a, i32 40
+  %v40 = load i32, i32* %p40
+  %s40 = add i32 %s39, %v40
+  %p41 = getelementptr i32, i32* %a, i32 41
+  %v41 = load i32, i32* %p41
+  %s41 = add i32 %s40, %v41
+  %p42 = getelementptr i32, i32* %a, i32 42
+  %v42 = load i32, i32* %p42
+  %s42 = add i32 %s41, %v42
+  %p43 = getelementptr i32, i32* %a, i32 43
+  %v43 = load i32, i32* %p43
+  %s43 = add i32 %s42, %v43
+  %p44 = getelementptr i32, i32* %a, i32 44
+  %v44 = load i32, i32* %p44
+  %s44 = add i32 %s43, %v44
+  %p45 = getelementptr i32, i32* %a, i32 45
+  %v45 = load i32, i32* %p45
+  %s45 = add i32 %s44, %v45
+  %p46 = getelementptr i32, i32* %a, i32 46
+  %v46 = load i32, i32* %p46
+  %s46 = add i32 %s45, %v46
+  %p47 = getelementptr i32, i32* %a, i32 47
+  %v47 = load i32, i32* %p47
+  %s47 = add i32 %s46, %v47
+  %p48 = getelementptr i32, i32* %a, i32 48
+  %v48 = load i32, i32* %p48
+  %s48 = add i32 %s47, %v48
+  %p49 = getelementptr i32, i32* %a, i32 49
+  %v49 = load i32, i32* %p49
+  %s49 = add i32 %s48, %v49
+  %p50 = getelementptr i32, i32* %a, i32 50
+  %v50 = load i32, i32* %p50
+  %s50 = add i32 %s49, %v50
+  %p51 = getelementptr i32, i32* %a, i32 51
+  %v51 = load i32, i32* %p51
+  %s51 = add i32 %s50, %v51
+  %p52 = getelementptr i32, i32* %a, i32 52
+  %v52 = load i32, i32* %p52
+  %s52 = add i32 %s51, %v52
+  %p53 = getelementptr i32, i32* %a, i32 53
+  %v53 = load i32, i32* %p53
+  %s53 = add i32 %s52, %v53
+  %p54 = getelementptr i32, i32* %a, i32 54
+  %v54 = load i32, i32* %p54
+  %s54 = add i32 %s53, %v54
+  %p55 = getelementptr i32, i32* %a, i32 55
+  %v55 = load i32, i32* %p55
+  %s55 = add i32 %s54, %v55
+  %p56 = getelementptr i32, i32* %a, i32 56
+  %v56 = load i32, i32* %p56
+  %s56 = add i32 %s55, %v56
+  %p57 = getelementptr i32, i32* %a, i32 57
+  %v57 = load i32, i32* %p57
+  %s57 = add i32 %s56, %v57
+  %p58 = getelementptr i32, i32* %a, i32 58
+  %v58 = load i32, i32* %p58
+  %s58 = add i32 %s57, %v58
+  %p59 = getelementptr i32, i32* %a, i32 59
+  %v59 = load i32, i32* %p59
+  %s59 = add i32 %s58, %v59
+  ret i32 %s59
+}
+
+; 30 halfwords, zero extended by the loads.  The second chunk is combined
+; with xorv.
+; CHECK-LABEL: parity:
+; CHECK:      lhu x5, 0(x10)
+; CHECK-NEXT: addi x29, x10, 0
+; CHECK-NEXT: xor x5, x11, x5
+; CHECK:      addiv x3, x1, 0
+; CHECK:      lhu x1, 2(x29)
+; CHECK:      lhu x28, 56(x29)
+; CHECK:      addiv x2, x1, 0
+; CHECK:      lhu x1, 58(x29)
+; CHECK-NEXT: lhu x2, 60(x29)
+; CHECK-NEXT: addi x3, x0, 0
+; CHECK:      xorv x2, x2, x1
+; CHECK:      addiv x1, x2, 0
+; CHECK:      xor x1, x1, x15
+; CHECK:      xor x1, x1, x2
+; CHECK-NEXT: xor x30, x30, x1
+; CHECK:      addiv x1, x3, 0
+; CHECK:      lhu x6, 62(x10)
+; CHECK-NEXT: addi x5, x30, 0
+; CHECK-NEXT: xor x10, x5, x6
+; CHECK-NEXT: ret
+define i16 @parity(i16* %a, i16 %s) {
+entry:
+  %p0 = getelementptr i16, i16* %a, i32 0
+  %v0 = load i16, i16* %p0
+  %s0 = xor i16 %s, %v0
+  %p1 = getelementptr i16, i16* %a, i32 1
+  %v1 = load i16, i16* %p1
+  %s1 = xor i16 %s0, %v1
+  %p2 = getelementptr i16, i16* %a, i32 2
+  %v2 = load i16, i16* %p2
+  %s2 = xor i16 %s1, %v2
+  %p3 = getelementptr i16, i16* %a, i32 3
+  %v3 = load i16, i16* %p3
+  %s3 = xor i16 %s2, %v3
+  %p4 = getelementptr i16, i16* %a, i32 4
+  %v4 = load i16, i16* %p4
+  %s4 = xor i16 %s3, %v4
+  %p5 = getelementptr i16, i16* %a, i32 5
+  %v5 = load i16, i16* %p5
+  %s5 = xor i16 %s4, %v5
+  %p6 = getelementptr i16, i16* %a, i32 6
+  %v6 = load i16, i16* %p6
+  %s6 = xor i16 %s5, %v6
+  %p7 = getelementptr i16, i16* %a, i32 7
+  %v7 = load i16, i16* %p7
+  %s7 = xor i16 %s6, %v7
+  %p8 = getelementptr i16, i16* %a, i32 8
+  %v8 = load i16, i16* %p8
+  %s8 = xor i16 %s7, %v8
+  %p9 = getelementptr i16, i16* %a, i32 9
+  %v9 = load i16, i16* %p9
+  %s9 = xor i16 %s8, %v9
+  %p10 = getelementptr i16, i16* %a, i32 10
+  %v10 = load i16, i16* %p10
+  %s10 = xor i16 %s9, %v10
+  %p11 = getelementptr i16, i16* %a, i32 11
+  %v11 = load i16, i16* %p11
+  %s11 = xor i16 %s10, %v11
+  %p12 = getelementptr i16, i16* %a, i32 12
+  %v12 = load i16, i16* %p12
+  %s12 = xor i16 %s11, %v12
+  %p13 = getelementptr i16, i16* %a, i32 13
+  %v13 = load i16, i16* %p13
+  %s13 = xor i16 %s12, %v13
+  %p14 = getelementptr i16, i16* %a, i32 14
+  %v14 = load i16, i16* %p14
+  %s14 = xor i16 %s13, %v14
+  %p15 = getelementptr i16, i16* %a, i32 15
+  %v15 = load i16, i16* %p15
+  %s15 = xor i16 %s14, %v15
+  %p16 = getelementptr i16, i16* %a, i32 16
+  %v16 = load i16, i16* %p16
+  %s16 = xor i16 %s15, %v16
+  %p17 = getelementptr i16, i16* %a, i32 17
+  %v17 = load i16, i16* %p17
+  %s17 = xor i16 %s16, %v17
+  %p18 = getelementptr i16, i16* %a, i32 18
+  %v18 = load i16, i16* %p18
+  %s18 = xor i16 %s17, %v18
+  %p19 = getelementptr i16, i16* %a, i32 19
+  %v19 = load i16, i16* %p19
+  %s19 = xor i16 %s18, %v19
+  %p20 = getelementptr i16, i16* %a, i32 20
+  %v20 = load i16, i16* %p20
+  %s20 = xor i16 %s19, %v20
+  %p21 = getelementptr i16, i16* %a, i32 21
+  %v21 = load i16, i16* %p21
+  %s21 = xor i16 %s20, %v21
+  %p22 = getelementptr i16, i16* %a, i32 22
+  %v22 = load i16, i16* %p22
+  %s22 = xor i16 %s21, %v22
+  %p23 = getelementptr i16, i16* %a, i32 23
+  %v23 = load i16, i16* %p23
+  %s23 = xor i16 %s22, %v23
+  %p24 = getelementptr i16, i16* %a, i32 24
+  %v24 = load i16, i16* %p24
+  %s24 = xor i16 %s23, %v24
+  %p25 = getelementptr i16, i16* %a, i32 25
+  %v25 = load i16, i16* %p25
+  %s25 = xor i16 %s24, %v25
+  %p26 = getelementptr i16, i16* %a, i32 26
+  %v26 = load i16, i16* %p26
+  %s26 = xor i16 %s25, %v26
+  %p27 = getelementptr i16, i16* %a, i32 27
+  %v27 = load i16, i16* %p27
+  %s27 = xor i16 %s26, %v27
+  %p28 = getelementptr i16, i16* %a, i32 28
+  %v28 = load i16, i16* %p28
+  %s28 = xor i16 %s27, %v28
+  %p29 = getelementptr i16, i16* %a, i32 29
+  %v29 = load i16, i16* %p29
+  %s29 = xor i16 %s28, %v29
+  %p30 = getelementptr i16, i16* %a, i32 30
+  %v30 = load i16, i16* %p30
+  %s30 = xor i16 %s29, %v30
+  %p31 = getelementptr i16, i16* %a, i32 31
+  %v31 = load i16, i16* %p31
+  %s31 = xor i16 %s30, %v31
+  ret i16 %s31
+}
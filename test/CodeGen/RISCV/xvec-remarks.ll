@@ -0,0 +1,265 @@
+; RUN: llc -march=riscv -mcpu=vscale -pass-remarks=riscv-xvec < %s -o /dev/null \
+; RUN:   2>&1 | FileCheck %s -check-prefix=PASSED
+; RUN: llc -march=riscv -mcpu=vscale -pass-remarks-missed=riscv-xvec < %s \
+; RUN:   -enable-misched=false -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s -check-prefix=MISSED
+; RUN: llc -march=riscv -mcpu=vscale < %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s -allow-empty -check-prefix=QUIET
+
+; The latencies come from the vscale scheduling model.  A full bank of
+; additions wins, four of them don't pay for saving and restoring the bank,
+; and a single one is below -riscv-xvec-min-elements, so it is not reported.
+; Runs that the cost model turns down are otherwise left to the machine
+; scheduler, which interleaves their elements before the pass sees them.
+; PASSED: remark: <unknown>:0:0: vectorized 28 elements with Xvec (130 cycles instead of 140)
+; PASSED-NOT: remark
+; MISSED-NOT: vectorized 28
+; MISSED: remark: <unknown>:0:0: not vectorized: 4 elements would take 58 cycles on Xvec instead of 20
+; MISSED-NOT: remark
+; QUIET-NOT: remark
+
+define void @full(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  %pa0 = getelementptr i32, i32* %a, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %b, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i32, i32* %a, i32 1
+  %va1 = load i32, i32* %pa1, align 4
+  %pb1 = getelementptr i32, i32* %b, i32 1
+  %vb1 = load i32, i32* %pb1, align 4
+  %vc1 = add i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %c, i32 1
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i32, i32* %a, i32 2
+  %va2 = load i32, i32* %pa2, align 4
+  %pb2 = getelementptr i32, i32* %b, i32 2
+  %vb2 = load i32, i32* %pb2, align 4
+  %vc2 = add i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %c, i32 2
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i32, i32* %a, i32 3
+  %va3 = load i32, i32* %pa3, align 4
+  %pb3 = getelementptr i32, i32* %b, i32 3
+  %vb3 = load i32, i32* %pb3, align 4
+  %vc3 = add i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %c, i32 3
+  store i32 %vc3, i32* %pc3, align 4
+  %pa4 = getelementptr i32, i32* %a, i32 4
+  %va4 = load i32, i32* %pa4, align 4
+  %pb4 = getelementptr i32, i32* %b, i32 4
+  %vb4 = load i32, i32* %pb4, align 4
+  %vc4 = add i32 %va4, %vb4
+  %pc4 = getelementptr i32, i32* %c, i32 4
+  store i32 %vc4, i32* %pc4, align 4
+  %pa5 = getelementptr i32, i32* %a, i32 5
+  %va5 = load i32, i32* %pa5, align 4
+  %pb5 = getelementptr i32, i32* %b, i32 5
+  %vb5 = load i32, i32* %pb5, align 4
+  %vc5 = add i32 %va5, %vb5
+  %pc5 = getelementptr i32, i32* %c, i32 5
+  store i32 %vc5, i32* %pc5, align 4
+  %pa6 = getelementptr i32, i32* %a, i32 6
+  %va6 = load i32, i32* %pa6, align 4
+  %pb6 = getelementptr i32, i32* %b, i32 6
+  %vb6 = load i32, i32* %pb6, align 4
+  %vc6 = add i32 %va6, %vb6
+  %pc6 = getelementptr i32, i32* %c, i32 6
+  store i32 %vc6, i32* %pc6, align 4
+  %pa7 = getelementptr i32, i32* %a, i32 7
+  %va7 = load i32, i32* %pa7, align 4
+  %pb7 = getelementptr i32, i32* %b, i32 7
+  %vb7 = load i32, i32* %pb7, align 4
+  %vc7 = add i32 %va7, %vb7
+  %pc7 = getelementptr i32, i32* %c, i32 7
+  store i32 %vc7, i32* %pc7, align 4
+  %pa8 = getelementptr i32, i32* %a, i32 8
+  %va8 = load i32, i32* %pa8, align 4
+  %pb8 = getelementptr i32, i32* %b, i32 8
+  %vb8 = load i32, i32* %pb8, align 4
+  %vc8 = add i32 %va8, %vb8
+  %pc8 = getelementptr i32, i32* %c, i32 8
+  store i32 %vc8, i32* %pc8, align 4
+  %pa9 = getelementptr i32, i32* %a, i32 9
+  %va9 = load i32, i32* %pa9, align 4
+  %pb9 = getelementptr i32, i32* %b, i32 9
+  %vb9 = load i32, i32* %pb9, align 4
+  %vc9 = add i32 %va9, %vb9
+  %pc9 = getelementptr i32, i32* %c, i32 9
+  store i32 %vc9, i32* %pc9, align 4
+  %pa10 = getelementptr i32, i32* %a, i32 10
+  %va10 = load i32, i32* %pa10, align 4
+  %pb10 = getelementptr i32, i32* %b, i32 10
+  %vb10 = load i32, i32* %pb10, align 4
+  %vc10 = add i32 %va10, %vb10
+  %pc10 = getelementptr i32, i32* %c, i32 10
+  store i32 %vc10, i32* %pc10, align 4
+  %pa11 = getelementptr i32, i32* %a, i32 11
+  %va11 = load i32, i32* %pa11, align 4
+  %pb11 = getelementptr i32, i32* %b, i32 11
+  %vb11 = load i32, i32* %pb11, align 4
+  %vc11 = add i32 %va11, %vb11
+  %pc11 = getelementptr i32, i32* %c, i32 11
+  store i32 %vc11, i32* %pc11, align 4
+  %pa12 = getelementptr i32, i32* %a, i32 12
+  %va12 = load i32, i32* %pa12, align 4
+  %pb12 = getelementptr i32, i32* %b, i32 12
+  %vb12 = load i32, i32* %pb12, align 4
+  %vc12 = add i32 %va12, %vb12
+  %pc12 = getelementptr i32, i32* %c, i32 12
+  store i32 %vc12, i32* %pc12, align 4
+  %pa13 = getelementptr i32, i32* %a, i32 13
+  %va13 = load i32, i32* %pa13, align 4
+  %pb13 = getelementptr i32, i32* %b, i32 13
+  %vb13 = load i32, i32* %pb13, align 4
+  %vc13 = add i32 %va13, %vb13
+  %pc13 = getelementptr i32, i32* %c, i32 13
+  store i32 %vc13, i32* %pc13, align 4
+  %pa14 = getelementptr i32, i32* %a, i32 14
+  %va14 = load i32, i32* %pa14, align 4
+  %pb14 = getelementptr i32, i32* %b, i32 14
+  %vb14 = load i32, i32* %pb14, align 4
+  %vc14 = add i32 %va14, %vb14
+  %pc14 = getelementptr i32, i32* %c, i32 14
+  store i32 %vc14, i32* %pc14, align 4
+  %pa15 = getelementptr i32, i32* %a, i32 15
+  %va15 = load i32, i32* %pa15, align 4
+  %pb15 = getelementptr i32, i32* %b, i32 15
+  %vb15 = load i32, i32* %pb15, align 4
+  %vc15 = add i32 %va15, %vb15
+  %pc15 = getelementptr i32, i32* %c, i32 15
+  store i32 %vc15, i32* %pc15, align 4
+  %pa16 = getelementptr i32, i32* %a, i32 16
+  %va16 = load i32, i32* %pa16, align 4
+  %pb16 = getelementptr i32, i32* %b, i32 16
+  %vb16 = load i32, i32* %pb16, align 4
+  %vc16 = add i32 %va16, %vb16
+  %pc16 = getelementptr i32, i32* %c, i32 16
+  store i32 %vc16, i32* %pc16, align 4
+  %pa17 = getelementptr i32, i32* %a, i32 17
+  %va17 = load i32, i32* %pa17, align 4
+  %pb17 = getelementptr i32, i32* %b, i32 17
+  %vb17 = load i32, i32* %pb17, align 4
+  %vc17 = add i32 %va17, %vb17
+  %pc17 = getelementptr i32, i32* %c, i32 17
+  store i32 %vc17, i32* %pc17, align 4
+  %pa18 = getelementptr i32, i32* %a, i32 18
+  %va18 = load i32, i32* %pa18, align 4
+  %pb18 = getelementptr i32, i32* %b, i32 18
+  %vb18 = load i32, i32* %pb18, align 4
+  %vc18 = add i32 %va18, %vb18
+  %pc18 = getelementptr i32, i32* %c, i32 18
+  store i32 %vc18, i32* %pc18, align 4
+  %pa19 = getelementptr i32, i32* %a, i32 19
+  %va19 = load i32, i32* %pa19, align 4
+  %pb19 = getelementptr i32, i32* %b, i32 19
+  %vb19 = load i32, i32* %pb19, align 4
+  %vc19 = add i32 %va19, %vb19
+  %pc19 = getelementptr i32, i32* %c, i32 19
+  store i32 %vc19, i32* %pc19, align 4
+  %pa20 = getelementptr i32, i32* %a, i32 20
+  %va20 = load i32, i32* %pa20, align 4
+  %pb20 = getelementptr i32, i32* %b, i32 20
+  %vb20 = load i32, i32* %pb20, align 4
+  %vc20 = add i32 %va20, %vb20
+  %pc20 = getelementptr i32, i32* %c, i32 20
+  store i32 %vc20, i32* %pc20, align 4
+  %pa21 = getelementptr i32, i32* %a, i32 21
+  %va21 = load i32, i32* %pa21, align 4
+  %pb21 = getelementptr i32, i32* %b, i32 21
+  %vb21 = load i32, i32* %pb21, align 4
+  %vc21 = add i32 %va21, %vb21
+  %pc21 = getelementptr i32, i32* %c, i32 21
+  store i32 %vc21, i32* %pc21, align 4
+  %pa22 = getelementptr i32, i32* %a, i32 22
+  %va22 = load i32, i32* %pa22, align 4
+  %pb22 = getelementptr i32, i32* %b, i32 22
+  %vb22 = load i32, i32* %pb22, align 4
+  %vc22 = add i32 %va22, %vb22
+  %pc22 = getelementptr i32, i32* %c, i32 22
+  store i32 %vc22, i32* %pc22, align 4
+  %pa23 = getelementptr i32, i32* %a, i32 23
+  %va23 = load i32, i32* %pa23, align 4
+  %pb23 = getelementptr i32, i32* %b, i32 23
+  %vb23 = load i32, i32* %pb23, align 4
+  %vc23 = add i32 %va23, %vb23
+  %pc23 = getelementptr i32, i32* %c, i32 23
+  store i32 %vc23, i32* %pc23, align 4
+  %pa24 = getelementptr i32, i32* %a, i32 24
+  %va24 = load i32, i32* %pa24, align 4
+  %pb24 = getelementptr i32, i32* %b, i32 24
+  %vb24 = load i32, i32* %pb24, align 4
+  %vc24 = add i32 %va24, %vb24
+  %pc24 = getelementptr i32, i32* %c, i32 24
+  store i32 %vc24, i32* %pc24, align 4
+  %pa25 = getelementptr i32, i32* %a, i32 25
+  %va25 = load i32, i32* %pa25, align 4
+  %pb25 = getelementptr i32, i32* %b, i32 25
+  %vb25 = load i32, i32* %pb25, align 4
+  %vc25 = add i32 %va25, %vb25
+  %pc25 = getelementptr i32, i32* %c, i32 25
+  store i32 %vc25, i32* %pc25, align 4
+  %pa26 = getelementptr i32, i32* %a, i32 26
+  %va26 = load i32, i32* %pa26, align 4
+  %pb26 = getelementptr i32, i32* %b, i32 26
+  %vb26 = load i32, i32* %pb26, align 4
+  %vc26 = add i32 %va26, %vb26
+  %pc26 = getelementptr i32, i32* %c, i32 26
+  store i32 %vc26, i32* %pc26, align 4
+  %pa27 = getelementptr i32, i32* %a, i32 27
+  %va27 = load i32, i32* %pa27, align 4
+  %pb27 = getelementptr i32, i32* %b, i32 27
+  %vb27 = load i32, i32* %pb27, align 4
+  %vc27 = add i32 %va27, %vb27
+  %pc27 = getelementptr i32, i32* %c, i32 27
+  store i32 %vc27, i32* %pc27, align 4
+  ret void
+}
+
+define void @short(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  %pa0 = getelementptr i32, i32* %a, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %b, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i32, i32* %a, i32 1
+  %va1 = load i32, i32* %pa1, align 4
+  %pb1 = getelementptr i32, i32* %b, i32 1
+  %vb1 = load i32, i32* %pb1, align 4
+  %vc1 = add i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %c, i32 1
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i32, i32* %a, i32 2
+  %va2 = load i32, i32* %pa2, align 4
+  %pb2 = getelementptr i32, i32* %b, i32 2
+  %vb2 = load i32, i32* %pb2, align 4
+  %vc2 = add i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %c, i32 2
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i32, i32* %a, i32 3
+  %va3 = load i32, i32* %pa3, align 4
+  %pb3 = getelementptr i32, i32* %b, i32 3
+  %vb3 = load i32, i32* %pb3, align 4
+  %vc3 = add i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %c, i32 3
+  store i32 %vc3, i32* %pc3, align 4
+  ret void
+}
+
+define void @single(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  %pa0 = getelementptr i32, i32* %a, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %b, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  ret void
+}
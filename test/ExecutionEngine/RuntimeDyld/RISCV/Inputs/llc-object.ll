@@ -0,0 +1,19 @@
+@g = global i32 5
+@p = global i32* @g
+
+declare i32 @ext(i32)
+
+define i32 @f(i32 %x) {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %done, label %slow
+
+slow:
+  %v = load i32, i32* @g
+  %r = call i32 @ext(i32 %v)
+  br label %done
+
+done:
+  %s = phi i32 [ 0, %entry ], [ %r, %slow ]
+  ret i32 %s
+}
@@ -0,0 +1,11 @@
+# RUN: not llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32IMAFD 2>&1 \
+# RUN:   | FileCheck %s
+
+# CHECK: error: invalid operand for instruction
+lr.w		x5, x4
+# CHECK: error: expected a zero offset
+lr.w		x5, 4(x4)
+# CHECK: error: expected ')'
+amoadd.w	x9, x8, (x7
+# CHECK: error: invalid fence set
+fence		wr, rw
@@ -1,20 +1,73 @@
 # Instructions that are valid
 #
-# RUN: llvm-mc %s -triple=riscv-unknown-linux -show-encoding -mcpu=RV32IMAFD
-# XFAIL:
+# The address of an LR, SC or AMO is a base register in parentheses,
+# optionally after the zero offset that the printer writes.
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -show-encoding -mcpu=RV32IMAFD \
+# RUN:   | FileCheck %s
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -filetype=obj -mcpu=RV32IMAFD \
+# RUN:   | llvm-objdump -d -mattr=+a - | FileCheck -check-prefix=DIS %s
 
-lr.w		x5, x4
-sc.w		x6, x5
-amoswap.w	x8, x7, x6
-amoadd.w	x9, x8, x7
-amoxor.w	x10, x9, x8
-amoand.w	x11, x10, x9
-amoor.w		x12, x11, x10
-amomin.w	x13, x12, x11
-amomax.w	x14, x13, x12
-amominu.w	x15, x14, x13
-amomaxu.w	x16, x15, x14
+# CHECK: lr.w x5, 0(x4)             # encoding: [0xaf,0x22,0x02,0x10]
+# CHECK: sc.w x6, x7, 0(x5)         # encoding: [0x2f,0xa3,0x72,0x18]
+# CHECK: amoswap.w x8, x7, 0(x6)    # encoding: [0x2f,0x24,0x73,0x00]
+# CHECK: amoadd.w x9, x8, 0(x7)     # encoding: [0xaf,0xa4,0x83,0x08]
+# CHECK: amoxor.w x10, x9, 0(x8)    # encoding: [0x2f,0x25,0x94,0x20]
+# CHECK: amoand.w x11, x10, 0(x9)   # encoding: [0xaf,0xa5,0xa4,0x60]
+# CHECK: amoor.w x12, x11, 0(x10)   # encoding: [0x2f,0x26,0xb5,0x40]
+# CHECK: amomin.w x13, x12, 0(x11)  # encoding: [0xaf,0xa6,0xc5,0x80]
+# CHECK: amomax.w x14, x13, 0(x12)  # encoding: [0x2f,0x27,0xd6,0xa0]
+# CHECK: amominu.w x15, x14, 0(x13) # encoding: [0xaf,0xa7,0xe6,0xc0]
+# CHECK: amomaxu.w x16, x15, 0(x14) # encoding: [0x2f,0x28,0xf7,0xe0]
+# CHECK: lr.w.aq x5, 0(x4)          # encoding: [0xaf,0x22,0x02,0x14]
+# CHECK: sc.w.rl x6, x7, 0(x5)      # encoding: [0x2f,0xa3,0x72,0x1a]
+# CHECK: amoswap.w.aq x8, x7, 0(x6) # encoding: [0x2f,0x24,0x73,0x04]
+# CHECK: amoadd.w.rl x9, x8, 0(x7)  # encoding: [0xaf,0xa4,0x83,0x0a]
+# CHECK: amoor.w.aqrl x12, x11, 0(x10) # encoding: [0x2f,0x26,0xb5,0x46]
+# CHECK: fence r, rw                # encoding: [0x0f,0x00,0x30,0x02]
+# CHECK: fence rw, w                # encoding: [0x0f,0x00,0x10,0x03]
+# CHECK: fence iorw, iorw           # encoding: [0x0f,0x00,0xf0,0x0f]
+# CHECK: fence rw, rw               # encoding: [0x0f,0x00,0x30,0x03]
+# CHECK: fence iorw, iorw           # encoding: [0x0f,0x00,0xf0,0x0f]
 
+# DIS: lr.w x5, 0(x4)
+# DIS: sc.w x6, x7, 0(x5)
+# DIS: amomaxu.w x16, x15, 0(x14)
+# DIS: lr.w.aq x5, 0(x4)
+# DIS: sc.w.rl x6, x7, 0(x5)
+# DIS: amoswap.w.aq x8, x7, 0(x6)
+# DIS: amoadd.w.rl x9, x8, 0(x7)
+# DIS: amoor.w.aqrl x12, x11, 0(x10)
+# DIS: fence r, rw
+# DIS: fence rw, w
+# DIS: fence iorw, iorw
+# DIS: fence rw, rw
+# DIS: fence iorw, iorw
 
-#-- EOF
+lr.w		x5, (x4)
+sc.w		x6, x7, (x5)
+amoswap.w	x8, x7, (x6)
+amoadd.w	x9, x8, (x7)
+amoxor.w	x10, x9, (x8)
+amoand.w	x11, x10, (x9)
+amoor.w		x12, x11, (x10)
+amomin.w	x13, x12, (x11)
+amomax.w	x14, x13, (x12)
+amominu.w	x15, x14, (x13)
+amomaxu.w	x16, x15, (x14)
+
+#-- Orderings, and the zero offset that the printer writes
+lr.w.aq		x5, 0(x4)
+sc.w.rl		x6, x7, 0(x5)
+amoswap.w.aq	x8, x7, (x6)
+amoadd.w.rl	x9, x8, (x7)
+amoor.w.aqrl	x12, x11, (x10)
 
+#-- Fences
+fence		r, rw
+fence		rw, w
+fence		iorw, iorw
+fence		3, 3
+fence
+
+#-- EOF
@@ -1,33 +1,62 @@
 # Instructions that are valid
 #
-# RUN: llvm-mc %s -triple=riscv-unknown-linux -show-encoding -mcpu=RV64IMAFD
-# XFAIL:
+# RUN: llvm-mc %s -triple=riscv64-unknown-linux -show-encoding -mcpu=RV64IMAFD \
+# RUN:   | FileCheck %s
+# RUN: llvm-mc %s -triple=riscv64-unknown-linux -filetype=obj -mcpu=RV64IMAFD \
+# RUN:   | llvm-objdump -d -mattr=+a - | FileCheck -check-prefix=DIS %s
 
-lr.w		x5, x4
-sc.w		x6, x5
-amoswap.w	x8, x7, x6
-amoadd.w	x9, x8, x7
-amoxor.w	x10, x9, x8
-amoand.w	x11, x10, x9
-amoor.w		x12, x11, x10
-amomin.w	x13, x12, x11
-amomax.w	x14, x13, x12
-amominu.w	x15, x14, x13
-amomaxu.w	x16, x15, x14
+# CHECK: lr.w x5, 0(x4)             # encoding: [0xaf,0x22,0x02,0x10]
+# CHECK: sc.w x6, x7, 0(x5)         # encoding: [0x2f,0xa3,0x72,0x18]
+# CHECK: amoswap.w x8, x7, 0(x6)    # encoding: [0x2f,0x24,0x73,0x00]
+# CHECK: amomaxu.w x16, x15, 0(x14) # encoding: [0x2f,0x28,0xf7,0xe0]
+# CHECK: lr.d x5, 0(x4)             # encoding: [0xaf,0x32,0x02,0x10]
+# CHECK: sc.d x6, x7, 0(x5)         # encoding: [0x2f,0xb3,0x72,0x18]
+# CHECK: amoswap.d x8, x7, 0(x6)    # encoding: [0x2f,0x34,0x73,0x00]
+# CHECK: amoadd.d x9, x8, 0(x7)     # encoding: [0xaf,0xb4,0x83,0x08]
+# CHECK: amoxor.d x10, x9, 0(x8)    # encoding: [0x2f,0x35,0x94,0x20]
+# CHECK: amoand.d x11, x10, 0(x9)   # encoding: [0xaf,0xb5,0xa4,0x60]
+# CHECK: amoor.d x12, x11, 0(x10)   # encoding: [0x2f,0x36,0xb5,0x40]
+# CHECK: amomin.d x13, x12, 0(x11)  # encoding: [0xaf,0xb6,0xc5,0x80]
+# CHECK: amomax.d x14, x13, 0(x12)  # encoding: [0x2f,0x37,0xd6,0xa0]
+# CHECK: amominu.d x15, x14, 0(x13) # encoding: [0xaf,0xb7,0xe6,0xc0]
+# CHECK: amomaxu.d x16, x15, 0(x14) # encoding: [0x2f,0x38,0xf7,0xe0]
+# CHECK: lr.w.aqrl x5, 0(x4)        # encoding: [0xaf,0x22,0x02,0x16]
+# CHECK: lr.d.aq x5, 0(x4)          # encoding: [0xaf,0x32,0x02,0x14]
+# CHECK: sc.d.rl x6, x7, 0(x5)      # encoding: [0x2f,0xb3,0x72,0x1a]
+# CHECK: amoadd.d.aqrl x9, x8, 0(x7) # encoding: [0xaf,0xb4,0x83,0x0e]
+
+# DIS: lr.w x5, 0(x4)
+# DIS: amomaxu.w x16, x15, 0(x14)
+# DIS: lr.d x5, 0(x4)
+# DIS: sc.d x6, x7, 0(x5)
+# DIS: amomaxu.d x16, x15, 0(x14)
+# DIS: lr.w.aqrl x5, 0(x4)
+# DIS: lr.d.aq x5, 0(x4)
+# DIS: sc.d.rl x6, x7, 0(x5)
+# DIS: amoadd.d.aqrl x9, x8, 0(x7)
+
+lr.w		x5, (x4)
+sc.w		x6, x7, (x5)
+amoswap.w	x8, x7, (x6)
+amomaxu.w	x16, x15, (x14)
 
 #-- rv64imafd only
-lr.d		x5, x4
-sc.d		x6, x5
-amoswap.d	x8, x7, x6
-amoadd.d	x9, x8, x7
-amoxor.d	x10, x9, x8
-amoand.d	x11, x10, x9
-amoor.d		x12, x11, x10
-amomin.d	x13, x12, x11
-amomax.d	x14, x13, x12
-amominu.d	x15, x14, x13
-amomaxu.d	x16, x15, x14
+lr.d		x5, (x4)
+sc.d		x6, x7, (x5)
+amoswap.d	x8, x7, (x6)
+amoadd.d	x9, x8, (x7)
+amoxor.d	x10, x9, (x8)
+amoand.d	x11, x10, (x9)
+amoor.d		x12, x11, (x10)
+amomin.d	x13, x12, (x11)
+amomax.d	x14, x13, (x12)
+amominu.d	x15, x14, (x13)
+amomaxu.d	x16, x15, (x14)
 
+#-- Orderings, and the zero offset that the printer writes
+lr.w.aqrl	x5, 0(x4)
+lr.d.aq		x5, 0(x4)
+sc.d.rl		x6, x7, 0(x5)
+amoadd.d.aqrl	x9, x8, (x7)
 
 #-- EOF
-
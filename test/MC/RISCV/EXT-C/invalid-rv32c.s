@@ -0,0 +1,24 @@
+# Operands that the compressed encodings cannot hold
+#
+# RUN: not llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -mattr=+c 2>&1 | FileCheck %s
+
+# CHECK: error: invalid operands for compressed instruction
+	c.addi	x10, 0
+# CHECK: error: invalid operands for compressed instruction
+	c.addi	x10, 32
+# CHECK: error: invalid operands for compressed instruction
+	c.lw	x16, 4(x8)
+# CHECK: error: invalid operands for compressed instruction
+	c.lw	x8, 2(x9)
+# CHECK: error: invalid operands for compressed instruction
+	c.lwsp	x1, 4(x3)
+# CHECK: error: invalid operands for compressed instruction
+	c.addi16sp	x2, 8
+# CHECK: error: invalid operands for compressed instruction
+	c.lui	x2, 1
+# CHECK: error: invalid operands for compressed instruction
+	c.sub	x7, x8
+# CHECK: error: invalid operands for compressed instruction
+	c.jr	x0
+
+#-- EOF
@@ -0,0 +1,67 @@
+# Instructions that are valid
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -show-encoding -mcpu=RV32I -mattr=+c | FileCheck --check-prefix=CHECK32 %s
+
+# CHECK32: c.nop                         # encoding: [0x01,0x00]
+# CHECK32: c.addi x10, -32               # encoding: [0x01,0x15]
+# CHECK32: c.addi x2, 31                 # encoding: [0x7d,0x01]
+# CHECK32: c.li x1, -1                   # encoding: [0xfd,0x50]
+# CHECK32: c.lui x15, 31                 # encoding: [0xfd,0x67]
+# CHECK32: c.lui x15, 1048575            # encoding: [0xfd,0x77]
+# CHECK32: c.addi16sp x2, -512           # encoding: [0x01,0x71]
+# CHECK32: c.addi16sp x2, 496            # encoding: [0x7d,0x61]
+# CHECK32: c.addi4spn x8, x2, 1020       # encoding: [0xe0,0x1f]
+# CHECK32: c.lw x9, 124(x15)             # encoding: [0xe4,0x5f]
+# CHECK32: c.sw x8, 4(x10)               # encoding: [0x40,0xc1]
+# CHECK32: c.lwsp x1, 252(x2)            # encoding: [0xfe,0x50]
+# CHECK32: c.swsp x31, 16(x2)            # encoding: [0x7e,0xc8]
+# CHECK32: c.srli x8, 31                 # encoding: [0x7d,0x80]
+# CHECK32: c.srai x9, 1                  # encoding: [0x85,0x84]
+# CHECK32: c.andi x10, -1                # encoding: [0x7d,0x99]
+# CHECK32: c.sub x11, x12                # encoding: [0x91,0x8d]
+# CHECK32: c.xor x13, x14                # encoding: [0xb9,0x8e]
+# CHECK32: c.or x15, x8                  # encoding: [0xc1,0x8f]
+# CHECK32: c.and x8, x9                  # encoding: [0x65,0x8c]
+# CHECK32: c.slli x31, 5                 # encoding: [0x96,0x0f]
+# CHECK32: c.j -2048                     # encoding: [0x01,0xb0]
+# CHECK32: c.jal 2046                    # encoding: [0xfd,0x2f]
+# CHECK32: c.beqz x8, -256               # encoding: [0x01,0xd0]
+# CHECK32: c.bnez x15, 254               # encoding: [0xfd,0xef]
+# CHECK32: c.jr x1                       # encoding: [0x82,0x80]
+# CHECK32: c.jalr x5                     # encoding: [0x82,0x92]
+# CHECK32: c.mv x10, x11                 # encoding: [0x2e,0x85]
+# CHECK32: c.add x2, x31                 # encoding: [0x7e,0x91]
+# CHECK32: c.ebreak                      # encoding: [0x02,0x90]
+
+	c.nop
+	c.addi	x10, -32
+	c.addi	x2, 31
+	c.li	x1, -1
+	c.lui	x15, 31
+	c.lui	x15, 1048575
+	c.addi16sp	x2, -512
+	c.addi16sp	x2, 496
+	c.addi4spn	x8, x2, 1020
+	c.lw	x9, 124(x15)
+	c.sw	x8, 4(x10)
+	c.lwsp	x1, 252(x2)
+	c.swsp	x31, 16(x2)
+	c.srli	x8, 31
+	c.srai	x9, 1
+	c.andi	x10, -1
+	c.sub	x11, x12
+	c.xor	x13, x14
+	c.or	x15, x8
+	c.and	x8, x9
+	c.slli	x31, 5
+	c.j	-2048
+	c.jal	2046
+	c.beqz	x8, -256
+	c.bnez	x15, 254
+	c.jr	x1
+	c.jalr	x5
+	c.mv	x10, x11
+	c.add	x2, x31
+	c.ebreak
+
+#-- EOF
@@ -0,0 +1,26 @@
+# Branch offsets are byte offsets from the branch, printed as .+N or .-N,
+# and what the disassembler prints assembles back to the same bytes.
+# objdump picks RV32 from the ELF class when no -mcpu is given.
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -filetype=obj -o %t
+# RUN: llvm-objdump -d %t | FileCheck %s
+# RUN: llvm-objdump -d %t | grep '^ *[0-9a-f]*:' | cut -f 3- \
+# RUN:   | llvm-mc -triple=riscv-unknown-linux -mcpu=RV32I -filetype=obj -o %t2
+# RUN: cmp %t %t2
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -show-encoding \
+# RUN:   | FileCheck -check-prefix=ENC %s
+
+# CHECK:  0: 63 20 96 02 beq x10, x11, .+16
+# CHECK:  4: e3 f0 97 fa bne x10, x11, .-8
+# CHECK:  8: 63 02 44 80 blt x1, x2, .-4096
+# CHECK:  c: e3 fe 45 78 bge x1, x2, .+4094
+# CHECK: 10: 63 07 7c 07 bltu x29, x30, .+2
+
+# ENC: blt x1, x2, .-4096 # encoding: [0x63,0x02,0x44,0x80]
+# ENC: bge x1, x2, .+4094 # encoding: [0xe3,0xfe,0x45,0x78]
+
+	beq	x10, x11, .+16
+	bne	x10, x11, .-8
+	blt	x1, x2, -4096
+	bge	x1, x2, 4094
+	bltu	x29, x30, 2
@@ -0,0 +1,28 @@
+# j is jal x0.  Both use the standard jal format, with the offset scattered
+# as imm[20|10:1|11|19:12], and the assembler resolves local targets.
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -show-encoding \
+# RUN:   | FileCheck %s
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -filetype=obj \
+# RUN:   | llvm-objdump -d -mcpu=RV32I - | FileCheck -check-prefix=DIS %s
+
+# CHECK: j Ltmp0          # encoding: [0x6f,0bAAAA0000,A,A]
+# CHECK-NEXT: #   fixup A - offset: 0, value: Ltmp0, kind: fixup_riscv_jal
+# CHECK: jal x1, Ltmp1    # encoding: [0xef,0bAAAA0000,A,A]
+# CHECK-NEXT: #   fixup A - offset: 0, value: Ltmp1, kind: fixup_riscv_jal
+
+# DIS:  0: 6f 00 c0 00 j 12
+# DIS:  c: ef f0 df ff jal x1, -4
+# DIS: 10: 6f f0 9f ff j -8
+# DIS: 14: ef 12 40 00 jal x5, 4100
+
+	j	1f
+	addi	x0, x0, 0
+2:
+	addi	x0, x0, 0
+1:
+	jal	x1, 2b
+	j	2b
+	jal	x5, 3f
+	.fill	1024, 4, 0x13
+3:
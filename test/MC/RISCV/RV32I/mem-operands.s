@@ -0,0 +1,29 @@
+# The offset and base of a memory operand land in their own fields: loads
+# keep rd in bits 31-27, the base in 26-22 and imm[11:7]/imm[6:0] in 21-17
+# and 16-10; stores move imm[11:7] up to 31-27 for rs2; jalr is standard.
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -show-encoding \
+# RUN:   | FileCheck %s
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -filetype=obj \
+# RUN:   | llvm-objdump -d -mcpu=RV32I - | FileCheck -check-prefix=DIS %s
+
+# CHECK: lw x10, 12(x11)     # encoding: [0x03,0x31,0xc0,0x52]
+# CHECK: lbu x5, -3(x6)      # encoding: [0x03,0xf6,0xbf,0x29]
+# CHECK: lh x1, 2047(x2)     # encoding: [0x83,0xfc,0x9f,0x08]
+# CHECK: sw x10, 12(x11)     # encoding: [0x23,0x31,0xd4,0x02]
+# CHECK: sb x7, -2048(x8)    # encoding: [0x23,0x00,0x0e,0x82]
+# CHECK: jalr x1, x5, 16     # encoding: [0xe7,0x80,0x02,0x01]
+
+# DIS: lw x10, 12(x11)
+# DIS: lbu x5, -3(x6)
+# DIS: lh x1, 2047(x2)
+# DIS: sw x10, 12(x11)
+# DIS: sb x7, -2048(x8)
+# DIS: jalr x1, x5, 16
+
+	lw	x10, 12(x11)
+	lbu	x5, -3(x6)
+	lh	x1, 2047(x2)
+	sw	x10, 12(x11)
+	sb	x7, -2048(x8)
+	jalr	x1, 16(x5)
@@ -0,0 +1,26 @@
+# Branches to labels of the same section are resolved by the assembler,
+# and their offset is split over the two immediate fields of this tree's
+# branch format: imm[11:7] in bits 31-27 and imm[6:0] in bits 16-10.
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -filetype=obj -o %t
+# RUN: llvm-objdump -s -section=.text %t | FileCheck %s
+# RUN: llvm-readobj -r %t | FileCheck -check-prefix=RELOC %s
+
+# beq x10, x11, .+16, addi x0, x0, 0 (x3), bne x10, x11, .-8,
+# blt x1, x2, .+4092.
+# CHECK: 0000 63209602 13000000 13000000 13000000
+# CHECK: 0010 e3f097fa 63fa4578 13000000 13000000
+
+# RELOC: Relocations [
+# RELOC-NEXT: ]
+
+	beq	x10, x11, 1f
+	addi	x0, x0, 0
+2:
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+1:
+	bne	x10, x11, 2b
+	blt	x1, x2, 3f
+	.fill	1022, 4, 0x13
+3:
@@ -0,0 +1,28 @@
+# RV32 objects are ELF32 and RV64 objects ELF64, and both are little-endian,
+# data fixups included.
+#
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV32I -filetype=obj -o %t.32
+# RUN: llvm-readobj -h %t.32 | FileCheck -check-prefix=ELF32 %s
+# RUN: llvm-objdump -s -section=.data %t.32 | FileCheck -check-prefix=DATA %s
+# RUN: llvm-mc %s -triple=riscv64-unknown-linux -mcpu=RV64I -filetype=obj -o %t.64
+# RUN: llvm-readobj -h %t.64 | FileCheck -check-prefix=ELF64 %s
+# RUN: llvm-objdump -s -section=.data %t.64 | FileCheck -check-prefix=DATA %s
+
+# ELF32: Format: ELF32-riscv
+# ELF32: Class: 32-bit
+# ELF32: DataEncoding: LittleEndian
+# ELF32: Machine: 0xF3
+
+# ELF64: Format: ELF64-riscv
+# ELF64: Class: 64-bit
+# ELF64: DataEncoding: LittleEndian
+# ELF64: Machine: 0xF3
+
+# DATA: 0000 44332211 0a000000 0600
+
+	.data
+1:
+	.long	0x11223344
+	.long	2f-1b
+	.short	2f-1b-4
+2:
@@ -0,0 +1,101 @@
+; RUN: opt < %s -S -mtriple=riscv -loop-unroll | FileCheck %s
+; RUN: opt < %s -S -mtriple=riscv -mcpu=vscale -loop-unroll \
+; RUN:   | FileCheck %s -check-prefix=VSCALE
+; RUN: opt < %s -S -mtriple=riscv -riscv-xvec-unroll=false -loop-unroll \
+; RUN:   | FileCheck %s -check-prefix=NOXVEC
+
+; Loops are unrolled by the Xvec lane count, with a remainder loop for the
+; trip counts that are not a multiple of it, as long as the Xvec cost model
+; takes a full bank of their elements.
+
+; CHECK-LABEL: @add(
+; CHECK:      %xtraiter = urem i32 %{{[0-9]+}}, 28
+; CHECK:      %vc.27 = add i32 %va.27, %vb.27
+; CHECK-NOT:  %vc.28 =
+; CHECK:      loop.epil:
+; VSCALE-LABEL: @add(
+; VSCALE:     %vc.27 = add i32 %va.27, %vb.27
+; VSCALE-NOT: %vc.28 =
+; NOXVEC-LABEL: @add(
+; NOXVEC-NOT: %vc.1 =
+
+define void @add(i32* noalias %a, i32* noalias %b, i32* noalias %c, i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr i32, i32* %a, i32 %i
+  %va = load i32, i32* %pa, align 4
+  %pb = getelementptr i32, i32* %b, i32 %i
+  %vb = load i32, i32* %pb, align 4
+  %vc = add i32 %va, %vb
+  %pc = getelementptr i32, i32* %c, i32 %i
+  store i32 %vc, i32* %pc, align 4
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; On vscale the loads do not stall long enough for the scalar reduction to
+; lose to the Xvec sequence, so it is left alone.
+; CHECK-LABEL: @sum(
+; CHECK:      %s.next.27 = add i32 %s.next.26, %va.27
+; CHECK-NOT:  %s.next.28 =
+; VSCALE-LABEL: @sum(
+; VSCALE-NOT: %s.next.1 =
+; NOXVEC-LABEL: @sum(
+; NOXVEC-NOT: %s.next.1 =
+define i32 @sum(i32* noalias %a, i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %pa = getelementptr i32, i32* %a, i32 %i
+  %va = load i32, i32* %pa, align 4
+  %s.next = add i32 %s, %va
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  ret i32 %r
+}
+
+; Xvec has no multiply, so a loop that multiplies as well as adds leaves a
+; run that is never substituted, and is left alone.
+; CHECK-LABEL: @addmul(
+; CHECK-NOT:  %vd.1 =
+; VSCALE-LABEL: @addmul(
+; VSCALE-NOT: %vd.1 =
+define void @addmul(i32* noalias %a, i32* noalias %b, i32* noalias %c,
+                    i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr i32, i32* %a, i32 %i
+  %va = load i32, i32* %pa, align 4
+  %pb = getelementptr i32, i32* %b, i32 %i
+  %vb = load i32, i32* %pb, align 4
+  %vc = add i32 %va, %vb
+  %vd = mul i32 %vc, %vb
+  %pc = getelementptr i32, i32* %c, i32 %i
+  store i32 %vd, i32* %pc, align 4
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,72 @@
+; RUN: llc -march=riscv -mcpu=vscale -filetype=obj < %s -o %t.o
+; RUN: llvm-riscv-iss -entry=kernel -arg=10 -arg=-7 -dump %t.o | FileCheck %s
+; RUN: llvm-riscv-iss -entry=fill -arg=buf:1000 %t.o \
+; RUN:   | FileCheck %s -check-prefix=FILL
+
+; The loop calls a function of the same object that reads a global, and the
+; quotient and remainder are those of signed division.  The sum is
+; 10*0 - 20*1 + 30*2 - 40*3 + 10*4 - ... + 10*8 - 20*9 = -340, and
+; -340 / -7 * 1000 + -340 % -7 = 48000 - 4.
+
+; CHECK:      Instructions:
+; CHECK:      Branches:          11 (9 taken)
+; CHECK:      Return value:      0x0000bb7c
+; CHECK:      .data ({{.*}}, 16 bytes):
+; CHECK-NEXT:   0000000a ffffffec 0000001e ffffffd8
+; CHECK:      .bss ({{.*}}, 4 bytes):
+; CHECK-NEXT:   0000000a
+
+; A large memset is a call to memset, which the simulator provides.
+
+; FILL:       Builtin calls:     1
+; FILL:       Return value:      0x000003e8
+
+@table = global [4 x i32] [i32 10, i32 -20, i32 30, i32 -40]
+@calls = global i32 0
+
+define internal i32 @weight(i32 %i) noinline {
+entry:
+  %c = load i32, i32* @calls
+  %c1 = add i32 %c, 1
+  store i32 %c1, i32* @calls
+  %m = and i32 %i, 3
+  %p = getelementptr [4 x i32], [4 x i32]* @table, i32 0, i32 %m
+  %w = load i32, i32* %p
+  ret i32 %w
+}
+
+define i32 @kernel(i32 %n, i32 %d) {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  %w = call i32 @weight(i32 %i)
+  %t = mul i32 %w, %i
+  %s1 = add i32 %s, %t
+  %i1 = add i32 %i, 1
+  %cmp = icmp slt i32 %i1, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %sum = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  %q = sdiv i32 %sum, %d
+  %r = srem i32 %sum, %d
+  %q1000 = mul i32 %q, 1000
+  %res = add i32 %q1000, %r
+  ret i32 %res
+}
+
+declare void @llvm.memset.p0i8.i32(i8*, i8, i32, i32, i1)
+
+define i32 @fill(i8* %p) {
+entry:
+  call void @llvm.memset.p0i8.i32(i8* %p, i8 1, i32 1000, i32 4, i1 false)
+  %q = getelementptr i8, i8* %p, i32 999
+  %v = load i8, i8* %q
+  %z = zext i8 %v to i32
+  %r = mul i32 %z, 1000
+  ret i32 %r
+}
@@ -0,0 +1,34 @@
+; RUN: llc -march=riscv -mcpu=vscale -riscv-small-data -filetype=obj < %s \
+; RUN:   -o %t.o
+; RUN: llvm-readobj -r %t.o | FileCheck %s -check-prefix=RELOC
+; RUN: llvm-riscv-iss -entry=tick -arg=5 -dump %t.o | FileCheck %s
+
+; Loads from small data are R_RISCV_GPREL_I and stores R_RISCV_GPREL_S, both
+; installed in the split immediates of loads and stores.  The simulator
+; puts gp 0x800 past the start of the small data.
+
+; RELOC:      .rela.text {
+; RELOC-NEXT:   R_RISCV_GPREL_I counter
+; RELOC-NEXT:   R_RISCV_GPREL_I state 0x4
+; RELOC-NEXT:   R_RISCV_GPREL_S counter
+; RELOC-NEXT:   R_RISCV_GPREL_S state 0x0
+; RELOC-NEXT: }
+
+; The counter goes from 41 to 46 and state[0] becomes state[1] * 2.
+
+; CHECK:      Return value:      0x0000002e
+; CHECK:      .sdata ({{.*}}, 12 bytes):
+; CHECK-NEXT:   0000002e 00000004 00000002
+
+@counter = global i32 41
+@state = global [2 x i32] [i32 1, i32 2]
+
+define i32 @tick(i32 %n) {
+  %v = load i32, i32* @counter
+  %s = load i32, i32* getelementptr ([2 x i32], [2 x i32]* @state, i32 0, i32 1)
+  %c = add i32 %v, %n
+  store i32 %c, i32* @counter
+  %d = shl i32 %s, 1
+  store i32 %d, i32* getelementptr ([2 x i32], [2 x i32]* @state, i32 0, i32 0)
+  ret i32 %c
+}
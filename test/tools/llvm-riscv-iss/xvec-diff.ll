@@ -0,0 +1,78 @@
+; RUN: llc -march=riscv -mcpu=vscale -riscv-xvec=false -filetype=obj < %s -o %t.scalar.o
+; RUN: llc -march=riscv -mcpu=vscale -riscv-xvec-cost-model=false -filetype=obj \
+; RUN:   < %s -o %t.xvec.o
+; RUN: llvm-riscv-iss -entry=chain -arg=buf:32:3 -arg=buf:32:4 -arg=buf:32 \
+; RUN:   -return-registers=0 -dump %t.scalar.o %t.xvec.o | FileCheck %s
+
+; The scalar and the vectorized code leave the same state behind.
+
+; CHECK:      File: {{.*}}.scalar.o
+; CHECK:      Vector operations: 0
+; CHECK:      arg2 ({{.*}}, 32 bytes):
+; CHECK-NEXT:   00000007 00000007 00000007 00000007 00000007 00000007 00000007 00000007
+; CHECK:      File: {{.*}}.xvec.o
+; CHECK:      Vector operations: 4
+; CHECK:      arg2 ({{.*}}, 32 bytes):
+; CHECK-NEXT:   00000007 00000007 00000007 00000007 00000007 00000007 00000007 00000007
+; CHECK:      Differences: 0
+
+define void @chain(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  %pa0 = getelementptr i32, i32* %a, i32 0
+  %va0 = load i32, i32* %pa0, align 4
+  %pb0 = getelementptr i32, i32* %b, i32 0
+  %vb0 = load i32, i32* %pb0, align 4
+  %vc0 = add i32 %va0, %vb0
+  %pc0 = getelementptr i32, i32* %c, i32 0
+  store i32 %vc0, i32* %pc0, align 4
+  %pa1 = getelementptr i32, i32* %a, i32 1
+  %va1 = load i32, i32* %pa1, align 4
+  %pb1 = getelementptr i32, i32* %b, i32 1
+  %vb1 = load i32, i32* %pb1, align 4
+  %vc1 = add i32 %va1, %vb1
+  %pc1 = getelementptr i32, i32* %c, i32 1
+  store i32 %vc1, i32* %pc1, align 4
+  %pa2 = getelementptr i32, i32* %a, i32 2
+  %va2 = load i32, i32* %pa2, align 4
+  %pb2 = getelementptr i32, i32* %b, i32 2
+  %vb2 = load i32, i32* %pb2, align 4
+  %vc2 = add i32 %va2, %vb2
+  %pc2 = getelementptr i32, i32* %c, i32 2
+  store i32 %vc2, i32* %pc2, align 4
+  %pa3 = getelementptr i32, i32* %a, i32 3
+  %va3 = load i32, i32* %pa3, align 4
+  %pb3 = getelementptr i32, i32* %b, i32 3
+  %vb3 = load i32, i32* %pb3, align 4
+  %vc3 = add i32 %va3, %vb3
+  %pc3 = getelementptr i32, i32* %c, i32 3
+  store i32 %vc3, i32* %pc3, align 4
+  %pa4 = getelementptr i32, i32* %a, i32 4
+  %va4 = load i32, i32* %pa4, align 4
+  %pb4 = getelementptr i32, i32* %b, i32 4
+  %vb4 = load i32, i32* %pb4, align 4
+  %vc4 = add i32 %va4, %vb4
+  %pc4 = getelementptr i32, i32* %c, i32 4
+  store i32 %vc4, i32* %pc4, align 4
+  %pa5 = getelementptr i32, i32* %a, i32 5
+  %va5 = load i32, i32* %pa5, align 4
+  %pb5 = getelementptr i32, i32* %b, i32 5
+  %vb5 = load i32, i32* %pb5, align 4
+  %vc5 = add i32 %va5, %vb5
+  %pc5 = getelementptr i32, i32* %c, i32 5
+  store i32 %vc5, i32* %pc5, align 4
+  %pa6 = getelementptr i32, i32* %a, i32 6
+  %va6 = load i32, i32* %pa6, align 4
+  %pb6 = getelementptr i32, i32* %b, i32 6
+  %vb6 = load i32, i32* %pb6, align 4
+  %vc6 = add i32 %va6, %vb6
+  %pc6 = getelementptr i32, i32* %c, i32 6
+  store i32 %vc6, i32* %pc6, align 4
+  %pa7 = getelementptr i32, i32* %a, i32 7
+  %va7 = load i32, i32* %pa7, align 4
+  %pb7 = getelementptr i32, i32* %b, i32 7
+  %vb7 = load i32, i32* %pb7, align 4
+  %vc7 = add i32 %va7, %vb7
+  %pc7 = getelementptr i32, i32* %c, i32 7
+  store i32 %vc7, i32* %pc7, align 4
+  ret void
+}
@@ -0,0 +1,47 @@
+# RUN: llvm-mc -triple=riscv-unknown-linux -mcpu=vscale -filetype=obj %s -o %t.o
+# RUN: llvm-riscv-iss -entry=banks %t.o | FileCheck %s
+# RUN: llvm-riscv-iss -entry=banks -xvec-hazard-distance=0 %t.o \
+# RUN:   | FileCheck %s -check-prefix=NOCHECK
+
+# The operands of a vector operation name banks, bank 1 being x1-x28
+# themselves.  The bank is saved to bank 3 and restored from it, as the
+# vectorizer does, so ra survives.  x10 is 5, then (5 + 100) ^ 5 in bank 4
+# and bank 1, then 5 again, and ends up as 5 ^ 108.  The first two vector
+# operations follow an access to x10 and another vector operation too
+# closely.
+
+# CHECK:      Instructions:      24
+# CHECK-NEXT: Vector operations: 5
+# CHECK-NEXT: Padding no-ops:    15
+# CHECK:      Hazard violations: 2
+# CHECK-NEXT: Return value:      0x00000069
+
+# NOCHECK:    Hazard violations: 0
+
+	.text
+	.globl	banks
+banks:
+	addi	x10, x0, 5
+	addiv	x3, x1, 0
+	addiv	x2, x1, 100
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	xorv	x4, x2, x3
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addiv	x1, x4, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addi	x29, x10, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addiv	x1, x3, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	xor	x10, x10, x29
+	ret
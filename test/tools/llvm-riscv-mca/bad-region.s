@@ -0,0 +1,9 @@
+# RUN: not llvm-riscv-mca -region=missing %s 2>&1 | FileCheck %s
+# RUN: not llvm-riscv-mca -iterations=0 %s 2>&1 | FileCheck %s -check-prefix=ZERO
+
+# CHECK: no label named 'missing'
+# ZERO: -iterations must be at least 1
+
+	.text
+loop:
+	addi	x10, x10, 1
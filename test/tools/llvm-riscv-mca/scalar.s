@@ -0,0 +1,49 @@
+# RUN: llvm-riscv-mca -iterations=10 %s | FileCheck %s
+# RUN: llvm-riscv-mca -mcpu=Rocket -iterations=10 %s \
+# RUN:   | FileCheck %s -check-prefix=ROCKET
+# RUN: llvm-mc -triple=riscv-unknown-linux -mcpu=vscale -filetype=obj %s -o %t.o
+# RUN: llvm-riscv-mca -iterations=10 -region=loop %t.o \
+# RUN:   | FileCheck %s -check-prefix=OBJECT
+
+# The product is only ready 33 cycles after the multiply issues on vscale,
+# and the iterative unit is busy for all of them.
+
+# CHECK:      Iterations:        10
+# CHECK-NEXT: Instructions:      60
+# CHECK-NEXT: Total Cycles:      390
+# CHECK-NEXT: Issue Width:       1
+# CHECK-NEXT: IPC:               0.15
+# CHECK-NEXT: Block RThroughput: 33.0
+
+# CHECK:      Vector operations: 0
+# CHECK-NEXT: Padding no-ops:    0
+# CHECK-NEXT: Hazard violations: 0
+
+# CHECK:      [3] - VscaleUnitMulDiv
+# CHECK:      Resource pressure per iteration:
+# CHECK-NEXT: [0]    [1]    [2]    [3]    [4]
+# CHECK-NEXT: 2      1      2      33     -
+
+# CHECK:      [#]  [1]  [2]     [3]    [4]  [5]                   Instructions:
+# CHECK-NEXT: 0    2    0.00    10     -    -                     lw x5, 0(x10)
+# CHECK-NEXT: 1    33   1.00    10     -    data [0]              mul x5, x5, x11
+# CHECK-NEXT: 2    1    32.00   10     -    data [1]              sw x5, 0(x12)
+# CHECK-NEXT: 3    1    0.00    10     -    -                     addi x10, x10, 4
+# CHECK-NEXT: 4    1    0.00    10     -    -                     addi x12, x12, 4
+# CHECK-NEXT: 5    1    0.00    10     -    -                     bne x10, x13, loop
+
+# ROCKET: [5] - RocketUnitIMul
+# ROCKET: 1    4    2.00    10     -    data [0]              mul x5, x5, x11
+
+# OBJECT: Total Cycles:      390
+# OBJECT: 1    33   1.00    10     -    data [0]              mul x5, x5, x11
+# OBJECT: 5    1    0.00    10     -    -                     bne x10, x13, .-20
+
+	.text
+loop:
+	lw	x5, 0(x10)
+	mul	x5, x5, x11
+	sw	x5, 0(x12)
+	addi	x10, x10, 4
+	addi	x12, x12, 4
+	bne	x10, x13, loop
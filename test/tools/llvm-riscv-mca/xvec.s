@@ -0,0 +1,47 @@
+# RUN: llvm-riscv-mca -iterations=10 -region=padded %s | FileCheck %s
+# RUN: llvm-riscv-mca -iterations=10 -region=unpadded %s \
+# RUN:   | FileCheck %s -check-prefix=UNPADDED
+# RUN: llvm-riscv-mca -iterations=10 -region=padded \
+# RUN:   -xvec-hazard-distance=4 %s | FileCheck %s -check-prefix=DIST4
+
+# A vector add padded the way RISCVVectorInstrBuilder does it.  The no-ops
+# before the vector operation keep it away from the store of the previous
+# iteration.
+
+# CHECK:      Total Cycles:      70
+# CHECK:      Vector operations: 1
+# CHECK-NEXT: Padding no-ops:    4
+# CHECK-NEXT: Hazard violations: 0
+# CHECK:      [#]  [1]  [2]     [3]    [4]  [5]                   Instructions:
+# CHECK-NEXT: 0    1    0.00    10     P    -                     addi x0, x0, 0
+# CHECK-NEXT: 1    1    0.00    10     P    -                     addi x0, x0, 0
+# CHECK-NEXT: 2    4    0.00    10     V    -                     addv x1, x2, x1
+# CHECK-NEXT: 3    1    0.00    0      P    -                     addi x0, x0, 0
+# CHECK-NEXT: 4    1    0.00    0      P    -                     addi x0, x0, 0
+# CHECK-NEXT: 5    1    1.00    10     B    data [2]              sw x1, 0(x31)
+
+# The store has to wait for the bank anyway, but nothing keeps the next vector
+# operation away from it.
+
+# UNPADDED:      Vector operations: 1
+# UNPADDED-NEXT: Padding no-ops:    1
+# UNPADDED-NEXT: Hazard violations: 9
+# UNPADDED:      0    4    0.00    10     V!   -                     addv x1, x2, x1
+# UNPADDED-NEXT: 1    1    3.00    10     B    data [0]              sw x1, 0(x31)
+# UNPADDED-NEXT: 2    1    0.00    10     P    -                     addi x0, x0, 0
+
+# DIST4: Hazard violations: 9
+# DIST4: 2    4    0.00    10     V!   -                     addv x1, x2, x1
+
+	.text
+padded:
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	addv	x1, x2, x1
+	addi	x0, x0, 0
+	addi	x0, x0, 0
+	sw	x1, 0(x31)
+unpadded:
+	addv	x1, x2, x1
+	sw	x1, 0(x31)
+	addi	x0, x0, 0
@@ -0,0 +1,782 @@
+//===-- RISCVSimulator.cpp - Functional RV32IM and Xvec simulator ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Memory is a single array that starts at address 0.  The first page is
+// never handed out, so that null pointers fault, and holds the address that
+// calls return to and those of the builtin functions.  Blocks allocated
+// before the object is loaded come first, so that their addresses do not
+// depend on its size, then the executable sections, the other allocatable
+// sections and any later blocks.  The stack grows down from the end of
+// memory.
+//
+// Relocations are applied here rather than by RuntimeDyld, whose stubs and
+// relocation code assume the standard encodings of loads, stores and
+// branches.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVSimulator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace object;
+using namespace riscviss;
+
+namespace {
+enum Format : uint8_t {
+  F_Illegal,
+  F_Lui,
+  F_Auipc,
+  F_Jal,
+  F_Jalr,
+  F_Branch,  // Op is funct3.
+  F_Load,    // Op is funct3.
+  F_Store,   // Op is funct3.
+  F_OpImm,   // Op is an AluOp.
+  F_Op,      // Op is an AluOp.
+  F_VecImm,  // Op is an AluOp.
+  F_Vec,     // Op is an AluOp.
+  F_Fence,
+  F_Ecall,
+  F_Ebreak,
+  F_Counter  // rdcycle, rdtime and rdinstret, all of which count
+             // instructions.
+};
+
+enum AluOp : uint8_t {
+  Add, Sub, Sll, Slt, Sltu, Xor, Srl, Sra, Or, And,
+  Mul, Mulh, Mulhsu, Mulhu, Div, Divu, Rem, Remu
+};
+
+// The builtin functions, in the order of their addresses.
+enum Builtin { B_Memcpy, B_Memmove, B_Memset, NumBuiltins };
+const char *const BuiltinNames[NumBuiltins] = {"memcpy", "memmove", "memset"};
+} // end anonymous namespace
+
+const uint32_t PageSize = 0x1000;
+// Calls return to ExitAddress, and BuiltinBase + 4 * B is builtin B.
+const uint32_t ExitAddress = 0x100;
+const uint32_t BuiltinBase = 0x200;
+
+static Error makeError(const Twine &Message) {
+  return make_error<StringError>(Message, inconvertibleErrorCode());
+}
+
+static std::string hex(uint32_t Value) {
+  std::string S;
+  raw_string_ostream(S) << format("0x%08x", Value);
+  return S;
+}
+
+//===----------------------------------------------------------------------===//
+// Encodings
+//===----------------------------------------------------------------------===//
+
+// Loads, and the older jalr encoding that ret uses, keep rd in [31:27], the
+// base in [26:22] and their offset in [21:17] and [16:10].  Stores and
+// branches move the high part of their immediate to [31:27], making room for
+// rs2 in [21:17].  Branch offsets are in halfwords.
+static int32_t getSplitImm(uint32_t Insn, unsigned HiShift) {
+  return SignExtend32<12>(((Insn >> HiShift) & 0x1f) << 7 |
+                          ((Insn >> 10) & 0x7f));
+}
+
+static uint32_t setSplitImm(uint32_t Insn, unsigned HiShift, uint32_t Imm) {
+  Insn &= ~((0x1fu << HiShift) | (0x7fu << 10));
+  return Insn | ((Imm >> 7) & 0x1f) << HiShift | (Imm & 0x7f) << 10;
+}
+
+// Set the 12-bit immediate of an I-type instruction.  Loads, and the
+// hardcoded return, split it around their registers.
+static uint32_t setIImm(uint32_t Insn, uint32_t Imm) {
+  if ((Insn & 0x7f) == 0x03 || (Insn & 0x7f) == 0x6b)
+    return setSplitImm(Insn, 17, Imm);
+  return (Insn & 0xfffff) | Imm << 20;
+}
+
+static int32_t getJImm(uint32_t Insn) {
+  return SignExtend32<21>((Insn >> 31) << 20 | ((Insn >> 12) & 0xff) << 12 |
+                          ((Insn >> 20) & 1) << 11 |
+                          ((Insn >> 21) & 0x3ff) << 1);
+}
+
+static uint32_t setJImm(uint32_t Insn, uint32_t Imm) {
+  return (Insn & 0xfff) | ((Imm >> 20) & 1) << 31 |
+         ((Imm >> 1) & 0x3ff) << 21 | ((Imm >> 11) & 1) << 20 |
+         ((Imm >> 12) & 0xff) << 12;
+}
+
+// Set Op to the operation of an R-type instruction, which only the
+// OP major opcode has multiplies and divides for.
+static bool getRegOp(unsigned Funct7, unsigned Funct3, bool AllowM,
+                     uint8_t &Op) {
+  static const AluOp Base[8] = {Add, Sll, Slt, Sltu, Xor, Srl, Or, And};
+  static const AluOp MulDiv[8] = {Mul, Mulh, Mulhsu, Mulhu,
+                                  Div, Divu, Rem,    Remu};
+  if (Funct7 == 0)
+    Op = Base[Funct3];
+  else if (Funct7 == 0x20 && Funct3 == 0)
+    Op = Sub;
+  else if (Funct7 == 0x20 && Funct3 == 5)
+    Op = Sra;
+  else if (Funct7 == 1 && AllowM)
+    Op = MulDiv[Funct3];
+  else
+    return false;
+  return true;
+}
+
+// Set Op and Imm for an I-type ALU instruction.
+static bool getImmOp(uint32_t Insn, unsigned Funct3, uint8_t &Op,
+                     int32_t &Imm) {
+  static const AluOp Base[8] = {Add, Sll, Slt, Sltu, Xor, Srl, Or, And};
+  Op = Base[Funct3];
+  Imm = int32_t(Insn) >> 20;
+  if (Funct3 == 1 || Funct3 == 5) {
+    unsigned High = Insn >> 25;
+    if (Funct3 == 5 && High == 0x20)
+      Op = Sra;
+    else if (High != 0)
+      return false;
+    Imm &= 0x1f;
+  }
+  return true;
+}
+
+RISCVSimulator::DecodedInst RISCVSimulator::decode(uint32_t Insn) {
+  DecodedInst D;
+  D.Format = F_Illegal;
+  D.Op = 0;
+  D.Rd = (Insn >> 7) & 0x1f;
+  D.Rs1 = (Insn >> 15) & 0x1f;
+  D.Rs2 = (Insn >> 20) & 0x1f;
+  D.Imm = 0;
+  D.Valid = true;
+  unsigned Funct3 = (Insn >> 7) & 0x7;
+  bool ReadsRs1 = true, ReadsRs2 = false, WritesRd = true;
+
+  switch (Insn & 0x7f) {
+  case 0x37:
+  case 0x17:
+    D.Format = (Insn & 0x7f) == 0x37 ? F_Lui : F_Auipc;
+    D.Imm = Insn & 0xfffff000;
+    ReadsRs1 = false;
+    break;
+  case 0x6f:
+    D.Format = F_Jal;
+    D.Imm = getJImm(Insn);
+    ReadsRs1 = false;
+    break;
+  case 0x67:
+    if (((Insn >> 12) & 0x7) == 0) {
+      D.Format = F_Jalr;
+      D.Imm = int32_t(Insn) >> 20;
+    }
+    break;
+  case 0x6b:
+    // The older jalr encoding, which ret still uses.
+    if (Funct3 == 0) {
+      D.Format = F_Jalr;
+      D.Rd = Insn >> 27;
+      D.Rs1 = (Insn >> 22) & 0x1f;
+      D.Imm = getSplitImm(Insn, 17);
+    }
+    break;
+  case 0x63:
+    if (Funct3 != 2 && Funct3 != 3) {
+      D.Format = F_Branch;
+      D.Op = Funct3;
+      D.Rs1 = (Insn >> 22) & 0x1f;
+      D.Rs2 = (Insn >> 17) & 0x1f;
+      D.Imm = getSplitImm(Insn, 27) * 2;
+      ReadsRs2 = true;
+      WritesRd = false;
+    }
+    break;
+  case 0x03:
+    // lb, lh, lw, lbu and lhu.
+    if (Funct3 != 3 && Funct3 < 6) {
+      D.Format = F_Load;
+      D.Op = Funct3;
+      D.Rd = Insn >> 27;
+      D.Rs1 = (Insn >> 22) & 0x1f;
+      D.Imm = getSplitImm(Insn, 17);
+    }
+    break;
+  case 0x23:
+    if (Funct3 < 3) {
+      D.Format = F_Store;
+      D.Op = Funct3;
+      D.Rs1 = (Insn >> 22) & 0x1f;
+      D.Rs2 = (Insn >> 17) & 0x1f;
+      D.Imm = getSplitImm(Insn, 27);
+      ReadsRs2 = true;
+      WritesRd = false;
+    }
+    break;
+  case 0x13:
+  case 0x2b:
+    Funct3 = (Insn >> 12) & 0x7;
+    if (getImmOp(Insn, Funct3, D.Op, D.Imm))
+      D.Format = (Insn & 0x7f) == 0x13 ? F_OpImm : F_VecImm;
+    break;
+  case 0x33:
+  case 0x0b:
+    Funct3 = (Insn >> 12) & 0x7;
+    if (getRegOp(Insn >> 25, Funct3, (Insn & 0x7f) == 0x33, D.Op))
+      D.Format = (Insn & 0x7f) == 0x33 ? F_Op : F_Vec;
+    ReadsRs2 = true;
+    break;
+  case 0x0f:
+    D.Format = F_Fence;
+    ReadsRs1 = WritesRd = false;
+    break;
+  case 0x73:
+    ReadsRs1 = false;
+    if (Insn == 0x00000073) {
+      D.Format = F_Ecall;
+      WritesRd = false;
+    } else if (Insn == 0x00100073) {
+      D.Format = F_Ebreak;
+      WritesRd = false;
+    } else if ((Insn & 0x000ff07f) == 0x00002073) {
+      // csrrs rd, csr, x0 of the cycle, time and instret counters and of
+      // their high halves.
+      unsigned CSR = Insn >> 20;
+      if ((CSR & ~0x80u) <= 0xc02 && (CSR & ~0x80u) >= 0xc00) {
+        D.Format = F_Counter;
+        D.Op = CSR >> 7 & 1;
+      }
+    }
+    break;
+  }
+
+  // Vector operations name banks, not registers.
+  auto IsBankReg = [](unsigned Reg) {
+    return Reg >= FirstLane && Reg <= LastLane;
+  };
+  D.NamesBankReg = D.Format != F_Vec && D.Format != F_VecImm &&
+                   ((ReadsRs1 && IsBankReg(D.Rs1)) ||
+                    (ReadsRs2 && IsBankReg(D.Rs2)) ||
+                    (WritesRd && IsBankReg(D.Rd)));
+  return D;
+}
+
+static uint32_t evaluate(unsigned Op, uint32_t A, uint32_t B) {
+  switch (Op) {
+  case Add:    return A + B;
+  case Sub:    return A - B;
+  case Sll:    return A << (B & 31);
+  case Slt:    return int32_t(A) < int32_t(B);
+  case Sltu:   return A < B;
+  case Xor:    return A ^ B;
+  case Srl:    return A >> (B & 31);
+  case Sra:    return uint32_t(int32_t(A) >> (B & 31));
+  case Or:     return A | B;
+  case And:    return A & B;
+  case Mul:    return A * B;
+  case Mulh:
+    return uint32_t((int64_t(int32_t(A)) * int64_t(int32_t(B))) >> 32);
+  case Mulhsu:
+    return uint32_t((int64_t(int32_t(A)) * int64_t(B)) >> 32);
+  case Mulhu:
+    return uint32_t((uint64_t(A) * uint64_t(B)) >> 32);
+  // Division never traps: dividing by zero gives all ones and leaves the
+  // dividend as the remainder, and the one signed overflow wraps.
+  case Div:
+    if (B == 0)
+      return ~0u;
+    if (A == 0x80000000u && B == ~0u)
+      return A;
+    return uint32_t(int32_t(A) / int32_t(B));
+  case Divu:
+    return B == 0 ? ~0u : A / B;
+  case Rem:
+    if (B == 0)
+      return A;
+    if (A == 0x80000000u && B == ~0u)
+      return 0;
+    return uint32_t(int32_t(A) % int32_t(B));
+  case Remu:
+    return B == 0 ? A : A % B;
+  }
+  llvm_unreachable("Unknown ALU operation");
+}
+
+//===----------------------------------------------------------------------===//
+// Loading
+//===----------------------------------------------------------------------===//
+
+RISCVSimulator::RISCVSimulator(uint32_t MemorySize, unsigned HazardDistance)
+    : Memory(MemorySize), PC(0), HazardDistance(HazardDistance),
+      LastVector(0), LastBankAccess(0), HeapEnd(PageSize), CodeBase(PageSize),
+      CodeEnd(PageSize), GlobalPointer(0) {
+  std::fill(std::begin(X), std::end(X), 0);
+  for (auto &Bank : Banks)
+    std::fill(std::begin(Bank), std::end(Bank), 0);
+}
+
+Expected<uint32_t> RISCVSimulator::lookup(StringRef Name) const {
+  auto I = Symbols.find(Name);
+  if (I == Symbols.end())
+    return makeError("no symbol named '" + Name + "'");
+  return I->second;
+}
+
+Expected<uint32_t> RISCVSimulator::allocate(StringRef Name, uint32_t Size,
+                                            uint32_t Align) {
+  uint64_t Address = alignTo(HeapEnd, Align);
+  // Leave a page for the stack.
+  if (Address + Size + PageSize > Memory.size())
+    return makeError("out of memory allocating " + Twine(Size) +
+                     " bytes for " + Name);
+  HeapEnd = Address + Size;
+  Regions.push_back({Name, uint32_t(Address), Size, false});
+  return uint32_t(Address);
+}
+
+Expected<uint32_t>
+RISCVSimulator::getSymbolAddress(const SymbolRef &Sym,
+                                 const SectionAddressMap &SectionAddresses) {
+  Expected<StringRef> NameOrErr = Sym.getName();
+  if (!NameOrErr)
+    return NameOrErr.takeError();
+  StringRef Name = *NameOrErr;
+  uint32_t Flags = Sym.getFlags();
+
+  if (Flags & SymbolRef::SF_Common)
+    return lookup(Name);
+  if (Flags & SymbolRef::SF_Undefined) {
+    for (unsigned B = 0; B != NumBuiltins; ++B)
+      if (Name == BuiltinNames[B])
+        return BuiltinBase + 4 * B;
+    return makeError("undefined symbol '" + Name + "'");
+  }
+  if (Flags & SymbolRef::SF_Absolute)
+    return uint32_t(Sym.getValue());
+
+  Expected<section_iterator> SecOrErr = Sym.getSection();
+  if (!SecOrErr)
+    return SecOrErr.takeError();
+  auto I = SectionAddresses.find(**SecOrErr);
+  if (I == SectionAddresses.end())
+    return makeError("symbol '" + Name + "' is in a section that is not " +
+                     "loaded");
+  return uint32_t(I->second + Sym.getValue());
+}
+
+// The relocations are applied here rather than by RuntimeDyld, which has no
+// gp to resolve the R_RISCV_GPREL_I and R_RISCV_GPREL_S relocations of small
+// data against, and which asserts on out of range branches and jumps instead
+// of reporting them.
+Error RISCVSimulator::applyRelocation(const RelocationRef &Rel,
+                                      uint32_t Address,
+                                      const SectionAddressMap &
+                                          SectionAddresses) {
+  uint32_t Value = 0;
+  symbol_iterator Sym = Rel.getSymbol();
+  if (Sym != Rel.getObject()->symbol_end()) {
+    Expected<uint32_t> ValueOrErr = getSymbolAddress(*Sym, SectionAddresses);
+    if (!ValueOrErr)
+      return ValueOrErr.takeError();
+    Value = *ValueOrErr;
+  }
+  ErrorOr<int64_t> AddendOrErr = ELFRelocationRef(Rel).getAddend();
+  if (std::error_code EC = AddendOrErr.getError())
+    return errorCodeToError(EC);
+  Value += *AddendOrErr;
+  uint32_t Delta = Value - Address;
+
+  if (Address + 8 > Memory.size())
+    return makeError("relocation outside of memory");
+  uint8_t *Loc = &Memory[Address];
+  uint32_t Insn = support::endian::read32le(Loc);
+  switch (Rel.getType()) {
+  case ELF::R_RISCV_RELAX:
+    return Error::success();
+  case ELF::R_RISCV_32:
+    Insn = Value;
+    break;
+  case ELF::R_RISCV_HI20:
+    Insn = (Insn & 0xfff) | ((Value + 0x800) & 0xfffff000);
+    break;
+  case ELF::R_RISCV_LO12_I:
+    Insn = setIImm(Insn, Value);
+    break;
+  case ELF::R_RISCV_LO12_S:
+    Insn = setSplitImm(Insn, 27, Value);
+    break;
+  case ELF::R_RISCV_GPREL_I:
+  case ELF::R_RISCV_GPREL_S: {
+    // The offset from gp, installed as the %lo relocations install theirs.
+    uint32_t Offset = Value - GlobalPointer;
+    if (!GlobalPointer || !isInt<12>(int32_t(Offset)))
+      return makeError("small data out of reach of gp at " + hex(Address));
+    if (Rel.getType() == ELF::R_RISCV_GPREL_S)
+      Insn = setSplitImm(Insn, 27, Offset);
+    else
+      Insn = setIImm(Insn, Offset);
+    break;
+  }
+  case ELF::R_RISCV_BRANCH:
+    if (!isInt<13>(int32_t(Delta)))
+      return makeError("branch target out of range at " + hex(Address));
+    Insn = setSplitImm(Insn, 27, Delta >> 1);
+    break;
+  case ELF::R_RISCV_JAL:
+    if (!isInt<21>(int32_t(Delta)))
+      return makeError("jump target out of range at " + hex(Address));
+    Insn = setJImm(Insn, Delta);
+    break;
+  case ELF::R_RISCV_CALL:
+  case ELF::R_RISCV_CALL_PLT: {
+    // An auipc and a jalr.  The jalr adds its offset back sign-extended.
+    uint32_t Hi = (Delta + 0x800) & 0xfffff000;
+    Insn = (Insn & 0xfff) | Hi;
+    uint32_t Jalr = support::endian::read32le(Loc + 4);
+    Jalr = (Jalr & 0xfffff) | (Delta - Hi) << 20;
+    support::endian::write32le(Loc + 4, Jalr);
+    break;
+  }
+  default: {
+    SmallString<32> Name;
+    Rel.getTypeName(Name);
+    return makeError("unsupported relocation " + Name + " at " +
+                     hex(Address));
+  }
+  }
+  support::endian::write32le(Loc, Insn);
+  return Error::success();
+}
+
+Error RISCVSimulator::loadObject(const ObjectFile &Obj) {
+  const auto *ELFObj = dyn_cast<ELF32LEObjectFile>(&Obj);
+  if (!ELFObj || Obj.getArch() != Triple::riscv)
+    return makeError("not an RV32 object");
+  if (ELFObj->getELFFile()->getHeader()->e_type != ELF::ET_REL)
+    return makeError("not a relocatable object");
+
+  // Code goes first, so that it forms one range for the decode cache, and
+  // small data next, so that gp reaches all of it.  gp is 0x800 past the
+  // start of the small data, as the GNU linker places it.  Nothing unwinds,
+  // so .eh_frame is left out.
+  enum { CodePass, SmallDataPass, DataPass };
+  SectionAddressMap SectionAddresses;
+  CodeBase = alignTo(HeapEnd, 16);
+  uint32_t Next = CodeBase;
+  for (unsigned Pass : {CodePass, SmallDataPass, DataPass}) {
+    for (const SectionRef &Section : Obj.sections()) {
+      uint64_t Flags = ELFSectionRef(Section).getFlags();
+      StringRef Name;
+      if (std::error_code EC = Section.getName(Name))
+        return errorCodeToError(EC);
+      bool Code = Flags & ELF::SHF_EXECINSTR;
+      bool SmallData = Name.startswith(".sdata") || Name.startswith(".sbss");
+      if (!(Flags & ELF::SHF_ALLOC) || Name == ".eh_frame" ||
+          Pass != (Code ? CodePass : SmallData ? SmallDataPass : DataPass))
+        continue;
+
+      uint64_t Size = Section.getSize();
+      uint64_t Address = alignTo(Next, std::max<uint64_t>(
+                                           Section.getAlignment(), 4));
+      if (Address + Size + PageSize > Memory.size())
+        return makeError("section " + Name + " does not fit in memory");
+      if (!Section.isVirtual()) {
+        StringRef Contents;
+        if (std::error_code EC = Section.getContents(Contents))
+          return errorCodeToError(EC);
+        std::copy(Contents.begin(), Contents.end(), &Memory[Address]);
+      }
+      SectionAddresses[Section] = Address;
+      Regions.push_back({Name, uint32_t(Address), uint32_t(Size), Code});
+      if (SmallData && !GlobalPointer)
+        GlobalPointer = Address + 0x800;
+      Next = Address + Size;
+    }
+    if (Pass == CodePass) {
+      CodeEnd = alignTo(Next, 4);
+      Next = CodeEnd;
+    }
+  }
+  HeapEnd = Next;
+  Decoded.assign((CodeEnd - CodeBase) / 4, DecodedInst());
+
+  for (const SymbolRef &Sym : Obj.symbols()) {
+    uint32_t Flags = Sym.getFlags();
+    if (Flags & SymbolRef::SF_Undefined)
+      continue;
+    Expected<StringRef> NameOrErr = Sym.getName();
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    if (NameOrErr->empty())
+      continue;
+    if (Flags & SymbolRef::SF_Common) {
+      // The value of a common symbol is its alignment.
+      Expected<uint32_t> AddressOrErr = allocate(
+          *NameOrErr, ELFSymbolRef(Sym).getSize(), Sym.getValue());
+      if (!AddressOrErr)
+        return AddressOrErr.takeError();
+      Symbols[*NameOrErr] = *AddressOrErr;
+      continue;
+    }
+    Expected<SymbolRef::Type> TypeOrErr = Sym.getType();
+    if (!TypeOrErr)
+      return TypeOrErr.takeError();
+    if (*TypeOrErr == SymbolRef::ST_File || *TypeOrErr == SymbolRef::ST_Debug)
+      continue;
+    Expected<uint32_t> AddressOrErr = getSymbolAddress(Sym, SectionAddresses);
+    if (!AddressOrErr) {
+      // Symbols of sections that are not loaded are only an error once a
+      // relocation needs them.
+      consumeError(AddressOrErr.takeError());
+      continue;
+    }
+    Symbols[*NameOrErr] = *AddressOrErr;
+  }
+
+  for (const SectionRef &RelSection : Obj.sections()) {
+    section_iterator Target = RelSection.getRelocatedSection();
+    if (Target == Obj.section_end())
+      continue;
+    auto I = SectionAddresses.find(*Target);
+    if (I == SectionAddresses.end())
+      continue;
+    for (const RelocationRef &Rel : RelSection.relocations())
+      if (Error E = applyRelocation(Rel, I->second + Rel.getOffset(),
+                                    SectionAddresses))
+        return E;
+  }
+  return Error::success();
+}
+
+//===----------------------------------------------------------------------===//
+// Execution
+//===----------------------------------------------------------------------===//
+
+uint32_t RISCVSimulator::getBankReg(unsigned Bank, unsigned Lane) const {
+  assert(Lane >= FirstLane && Lane <= LastLane && "Not a lane of a bank");
+  if (Bank == 0)
+    return 0;
+  if (Bank == 1)
+    return X[Lane];
+  return Banks[Bank][Lane];
+}
+
+bool RISCVSimulator::checkAccess(uint32_t Address, uint32_t Size) {
+  if (Address >= PageSize && uint64_t(Address) + Size <= Memory.size())
+    return true;
+  if (Fault.empty())
+    Fault = "access to " + hex(Address) + " at " + hex(PC) +
+            " is outside of memory";
+  return false;
+}
+
+uint32_t RISCVSimulator::load(uint32_t Address, unsigned Size) {
+  if (!checkAccess(Address, Size))
+    return 0;
+  uint32_t Value = 0;
+  for (unsigned I = 0; I != Size; ++I)
+    Value |= uint32_t(Memory[Address + I]) << (8 * I);
+  return Value;
+}
+
+void RISCVSimulator::store(uint32_t Address, uint32_t Value, unsigned Size) {
+  if (!checkAccess(Address, Size))
+    return;
+  for (unsigned I = 0; I != Size; ++I)
+    Memory[Address + I] = uint8_t(Value >> (8 * I));
+  // Code that is written to is decoded again.
+  if (Address < CodeEnd && Address + Size > CodeBase) {
+    uint32_t First = (std::max(Address, CodeBase) - CodeBase) / 4;
+    uint32_t Last = (std::min(Address + Size, CodeEnd) - 1 - CodeBase) / 4;
+    for (uint32_t I = First; I <= Last; ++I)
+      Decoded[I].Valid = false;
+  }
+}
+
+// Run the builtin function at Address, if there is one, and return to ra.
+bool RISCVSimulator::runBuiltin(uint32_t Address) {
+  if (Address < BuiltinBase || Address >= BuiltinBase + 4 * NumBuiltins)
+    return false;
+  uint32_t Dst = X[10], Src = X[11], Size = X[12];
+  switch ((Address - BuiltinBase) / 4) {
+  case B_Memcpy:
+  case B_Memmove:
+    if (checkAccess(Dst, Size) && checkAccess(Src, Size))
+      std::memmove(&Memory[Dst], &Memory[Src], Size);
+    break;
+  case B_Memset:
+    if (checkAccess(Dst, Size))
+      std::memset(&Memory[Dst], int(Src & 0xff), Size);
+    break;
+  }
+  ++Stats.BuiltinCalls;
+  PC = X[1];
+  return true;
+}
+
+// The Xvec unit does not interlock, so the distances are only checked.
+void RISCVSimulator::checkHazard(bool IsVector, bool NamesBankReg) {
+  int64_t Now = Stats.Instructions;
+  int64_t Distance = HazardDistance;
+  if (IsVector) {
+    if (Now - LastVector < Distance || Now - LastBankAccess < Distance)
+      ++Stats.HazardViolations;
+    LastVector = Now;
+  } else if (NamesBankReg) {
+    if (Now - LastVector < Distance)
+      ++Stats.HazardViolations;
+    LastBankAccess = Now;
+  }
+}
+
+Error RISCVSimulator::call(uint32_t Entry, ArrayRef<uint32_t> Args,
+                           uint64_t MaxInstructions) {
+  if (Args.size() > 8)
+    return makeError("at most 8 arguments can be passed in registers");
+  std::copy(Args.begin(), Args.end(), &X[10]);
+  X[1] = ExitAddress;
+  X[2] = Memory.size() & ~15u;
+  X[3] = GlobalPointer;
+  PC = Entry;
+  Stats = SimStats();
+  LastVector = LastBankAccess = -int64_t(HazardDistance);
+  Fault.clear();
+
+  while (PC != ExitAddress) {
+    if (runBuiltin(PC)) {
+      if (!Fault.empty())
+        return makeError(Fault);
+      continue;
+    }
+    if (PC < CodeBase || PC >= CodeEnd || (PC & 3))
+      return makeError("jump to " + hex(PC) + ", which is not code");
+    if (Stats.Instructions == MaxInstructions)
+      return makeError("no return after " + Twine(MaxInstructions) +
+                       " instructions");
+
+    DecodedInst &D = Decoded[(PC - CodeBase) / 4];
+    if (!D.Valid)
+      D = decode(support::endian::read32le(&Memory[PC]));
+    if (Tracer)
+      Tracer(PC, support::endian::read32le(&Memory[PC]));
+    if (HazardDistance)
+      checkHazard(D.Format == F_Vec || D.Format == F_VecImm, D.NamesBankReg);
+    ++Stats.Instructions;
+
+    uint32_t A = X[D.Rs1], B = X[D.Rs2];
+    uint32_t NextPC = PC + 4;
+    uint32_t Result = 0;
+    bool WritesRd = true;
+    switch (D.Format) {
+    case F_Illegal:
+      return makeError("illegal instruction " +
+                       hex(support::endian::read32le(&Memory[PC])) + " at " +
+                       hex(PC));
+    case F_Lui:
+      Result = D.Imm;
+      break;
+    case F_Auipc:
+      Result = PC + D.Imm;
+      break;
+    case F_Jal:
+      Result = NextPC;
+      NextPC = PC + D.Imm;
+      ++Stats.Jumps;
+      break;
+    case F_Jalr:
+      Result = NextPC;
+      NextPC = (A + D.Imm) & ~1u;
+      ++Stats.Jumps;
+      break;
+    case F_Branch: {
+      bool Taken;
+      switch (D.Op) {
+      case 0: Taken = A == B; break;
+      case 1: Taken = A != B; break;
+      case 4: Taken = int32_t(A) < int32_t(B); break;
+      case 5: Taken = int32_t(A) >= int32_t(B); break;
+      case 6: Taken = A < B; break;
+      default: Taken = A >= B; break;
+      }
+      ++Stats.Branches;
+      if (Taken) {
+        ++Stats.TakenBranches;
+        NextPC = PC + D.Imm;
+      }
+      WritesRd = false;
+      break;
+    }
+    case F_Load: {
+      unsigned Size = 1 << (D.Op & 3);
+      Result = load(A + D.Imm, Size);
+      if (!(D.Op & 4) && Size < 4)
+        Result = SignExtend32(Result, 8 * Size);
+      ++Stats.Loads;
+      break;
+    }
+    case F_Store:
+      store(A + D.Imm, B, 1 << D.Op);
+      ++Stats.Stores;
+      WritesRd = false;
+      break;
+    case F_OpImm:
+      if (D.Op == Add && D.Rd == 0 && D.Rs1 == 0 && D.Imm == 0)
+        ++Stats.Padding;
+      Result = evaluate(D.Op, A, D.Imm);
+      break;
+    case F_Op:
+      Result = evaluate(D.Op, A, B);
+      break;
+    case F_VecImm:
+    case F_Vec: {
+      // All lanes are read before any is written, as the banks may be the
+      // same.
+      uint32_t Lanes[LastLane + 1];
+      for (unsigned L = FirstLane; L <= LastLane; ++L)
+        Lanes[L] = evaluate(D.Op, getBankReg(D.Rs1, L),
+                            D.Format == F_Vec ? getBankReg(D.Rs2, L)
+                                              : uint32_t(D.Imm));
+      if (D.Rd == 1)
+        std::copy(&Lanes[FirstLane], &Lanes[LastLane + 1], &X[FirstLane]);
+      else if (D.Rd != 0)
+        std::copy(&Lanes[FirstLane], &Lanes[LastLane + 1],
+                  &Banks[D.Rd][FirstLane]);
+      ++Stats.VectorOps;
+      WritesRd = false;
+      break;
+    }
+    case F_Fence:
+      WritesRd = false;
+      break;
+    case F_Ecall:
+      return makeError("ecall at " + hex(PC));
+    case F_Ebreak:
+      return makeError("ebreak at " + hex(PC));
+    case F_Counter:
+      Result = uint32_t(Stats.Instructions >> (D.Op ? 32 : 0));
+      break;
+    }
+
+    if (!Fault.empty())
+      return makeError(Fault);
+    if (WritesRd && D.Rd != 0)
+      X[D.Rd] = Result;
+    PC = NextPC;
+  }
+  return Error::success();
+}
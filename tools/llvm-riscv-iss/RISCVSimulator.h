@@ -0,0 +1,173 @@
+//===-- RISCVSimulator.h - Functional RV32IM and Xvec simulator -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares RISCVSimulator, an instruction set simulator for RV32IM
+// and the Xvec extension that runs the relocatable objects llc produces.
+//
+// The simulator is functional: every instruction completes before the next
+// one starts.  Instructions are decoded straight from their bits, with the
+// operand layouts this backend uses for loads, stores and branches, and the
+// decoded form is cached, so the MC layer is not involved at all.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_RISCV_ISS_RISCVSIMULATOR_H
+#define LLVM_TOOLS_LLVM_RISCV_ISS_RISCVSIMULATOR_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Error.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace riscviss {
+
+/// The register operands of an Xvec operation name banks of 28 registers.
+/// Bank 1 is x1-x28 themselves, bank 0 reads as zero and the others are
+/// only reachable through vector operations.
+const unsigned NumBanks = 32;
+const unsigned FirstLane = 1;
+const unsigned LastLane = 28;
+
+/// Dynamic counts of one call.
+struct SimStats {
+  uint64_t Instructions = 0; // Everything executed, padding included.
+  uint64_t VectorOps = 0;
+  uint64_t Padding = 0;      // addi x0, x0, 0
+  uint64_t Loads = 0;
+  uint64_t Stores = 0;
+  uint64_t Branches = 0;
+  uint64_t TakenBranches = 0;
+  uint64_t Jumps = 0;
+  uint64_t BuiltinCalls = 0;
+  uint64_t HazardViolations = 0;
+};
+
+/// A loaded allocatable section, or a block handed out by allocate().
+struct MemoryRegion {
+  std::string Name;
+  uint32_t Address;
+  uint32_t Size;
+  bool IsCode;
+};
+
+class RISCVSimulator {
+public:
+  /// The predecoded form of an instruction.
+  struct DecodedInst {
+    uint8_t Format;
+    uint8_t Op;
+    uint8_t Rd;
+    uint8_t Rs1;
+    uint8_t Rs2;
+    // Whether the instruction names one of x1-x28 outside of a vector
+    // operation, which the Xvec unit does not interlock against.
+    bool NamesBankReg;
+    bool Valid;
+    int32_t Imm;
+  };
+
+  /// Create a simulator with MemorySize bytes of memory, all of it zero.
+  /// Vector operations closer than HazardDistance instructions to each
+  /// other or to an access to x1-x28 are counted as hazard violations; 0
+  /// turns the check off.
+  RISCVSimulator(uint32_t MemorySize, unsigned HazardDistance);
+
+  /// Lay out the allocatable sections of Obj, which must be an RV32
+  /// relocatable ELF object, and apply its relocations.  Undefined symbols
+  /// may only name the builtin memcpy, memmove and memset.  gp is set up
+  /// for the small-data sections.
+  Error loadObject(const object::ObjectFile &Obj);
+
+  /// Return the address of the symbol Name of the loaded object.
+  Expected<uint32_t> lookup(StringRef Name) const;
+
+  /// Reserve Size bytes of memory for data that is passed to a call.  The
+  /// blocks reserved before loadObject() are at the same addresses whatever
+  /// the object.
+  Expected<uint32_t> allocate(StringRef Name, uint32_t Size,
+                              uint32_t Align = 16);
+
+  /// Run the function at Entry with Args in a0-a7 until it returns.  Fails
+  /// on illegal instructions, bad memory accesses, ecall and ebreak, and
+  /// once MaxInstructions instructions have run.
+  Error call(uint32_t Entry, ArrayRef<uint32_t> Args,
+             uint64_t MaxInstructions);
+
+  /// Call Tracer with the address and bits of every instruction before it
+  /// runs.
+  void setTracer(std::function<void(uint32_t, uint32_t)> Tracer) {
+    this->Tracer = std::move(Tracer);
+  }
+
+  uint32_t getReg(unsigned Reg) const { return X[Reg]; }
+  uint32_t getBankReg(unsigned Bank, unsigned Lane) const;
+  const SimStats &getStats() const { return Stats; }
+  ArrayRef<MemoryRegion> getRegions() const { return Regions; }
+  ArrayRef<uint8_t> getMemory(uint32_t Address, uint32_t Size) const {
+    return makeArrayRef(Memory).slice(Address, Size);
+  }
+  MutableArrayRef<uint8_t> getMutableMemory(uint32_t Address, uint32_t Size) {
+    return MutableArrayRef<uint8_t>(Memory).slice(Address, Size);
+  }
+
+private:
+  std::vector<uint8_t> Memory;
+  uint32_t X[32];
+  uint32_t Banks[NumBanks][LastLane + 1];
+  uint32_t PC;
+  SimStats Stats;
+  const unsigned HazardDistance;
+  // The instruction counts of the last vector operation and of the last
+  // access to x1-x28, for the hazard check.
+  int64_t LastVector;
+  int64_t LastBankAccess;
+
+  std::vector<MemoryRegion> Regions;
+  StringMap<uint32_t> Symbols;
+  // The next free address after the loaded sections and the blocks.
+  uint32_t HeapEnd;
+  // The executable sections are laid out together, from CodeBase to
+  // CodeEnd, and Decoded caches one entry for each of their words.
+  uint32_t CodeBase;
+  uint32_t CodeEnd;
+  std::vector<DecodedInst> Decoded;
+  // The value of gp, which small-data accesses are relative to, or 0 if the
+  // object has no small data.
+  uint32_t GlobalPointer;
+  std::function<void(uint32_t, uint32_t)> Tracer;
+  // Set by the memory accessors when an access is out of bounds.
+  std::string Fault;
+
+  // The addresses of the sections that have been loaded.
+  typedef std::map<object::SectionRef, uint32_t> SectionAddressMap;
+
+  static DecodedInst decode(uint32_t Insn);
+  Error applyRelocation(const object::RelocationRef &Rel, uint32_t Address,
+                        const SectionAddressMap &SectionAddresses);
+  Expected<uint32_t> getSymbolAddress(const object::SymbolRef &Sym,
+                                      const SectionAddressMap &
+                                          SectionAddresses);
+  bool runBuiltin(uint32_t Address);
+  void checkHazard(bool IsVector, bool NamesBankReg);
+
+  bool checkAccess(uint32_t Address, uint32_t Size);
+  uint32_t load(uint32_t Address, unsigned Size);
+  void store(uint32_t Address, uint32_t Value, unsigned Size);
+};
+
+} // end namespace riscviss
+} // end namespace llvm
+
+#endif
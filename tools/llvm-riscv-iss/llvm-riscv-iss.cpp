@@ -0,0 +1,405 @@
+//===-- llvm-riscv-iss.cpp - RISCV instruction set simulator --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility runs a function of an RV32 object that llc produced on a
+// functional simulator of RV32IM and the Xvec extension, and reports how
+// many instructions of each kind it executed.
+//
+// The arguments of the function are integers or buffers, which are filled
+// with the same pseudo-random words on every run.  Given two objects, such as
+// a kernel compiled with and without -riscv-xvec, the function is run in both
+// and the final state is compared: the buffers, the data sections of the
+// objects, and the registers that a call returns in or has to preserve.  Any
+// difference is reported and makes the exit status 1.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVSimulator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace object;
+using namespace riscviss;
+
+static cl::list<std::string>
+InputFilenames(cl::Positional, cl::OneOrMore,
+               cl::desc("<object> [<object to compare with>]"));
+
+static cl::opt<std::string>
+Entry("entry", cl::Required, cl::desc("Function to run"),
+      cl::value_desc("symbol"));
+
+static cl::list<std::string>
+Args("arg", cl::desc("Next argument of the function: an integer, or "
+                     "buf:<size>[:<word>] for a buffer of <size> bytes "
+                     "filled with <word> or pseudo-random words"),
+     cl::value_desc("value"));
+
+static cl::opt<unsigned>
+Seed("seed", cl::init(1), cl::desc("Seed of the buffer contents"));
+
+static cl::opt<unsigned>
+MemorySize("memory-size", cl::init(4 << 20),
+           cl::desc("Bytes of simulated memory"));
+
+static cl::opt<uint64_t>
+MaxInstructions("max-instructions", cl::init(100000000),
+                cl::desc("Give up after running this many instructions"));
+
+static cl::opt<unsigned>
+XvecHazardDistance("xvec-hazard-distance", cl::init(3),
+                   cl::desc("Instructions the Xvec unit needs between a "
+                            "vector operation and any other access to its "
+                            "bank (0 turns the check off)"));
+
+static cl::opt<unsigned>
+ReturnRegisters("return-registers", cl::init(1),
+                cl::desc("Number of registers from a0 on that the function "
+                         "returns its value in (0 for void functions)"));
+
+static cl::opt<bool>
+AllRegisters("all-registers",
+             cl::desc("Compare the temporary registers too"));
+
+static cl::opt<bool>
+Dump("dump", cl::desc("Print the buffers and data sections after the run"));
+
+static cl::opt<bool>
+Trace("trace", cl::desc("Disassemble every instruction as it runs"));
+
+static cl::opt<std::string>
+MCPU("mcpu", cl::desc("CPU to disassemble for with -trace"),
+     cl::value_desc("cpu-name"), cl::init("vscale"));
+
+static const char *ProgName;
+
+static void reportError(const Twine &Message) {
+  errs() << ProgName << ": " << Message << '\n';
+}
+
+namespace {
+// An argument of the function.
+struct ArgSpec {
+  bool IsBuffer;
+  uint32_t Value; // The integer, or the size of the buffer.
+  bool HasFill;
+  uint32_t Fill;
+};
+
+// The outcome of running the function in one object.
+struct RunResult {
+  OwningBinary<ObjectFile> Binary;
+  std::unique_ptr<RISCVSimulator> Sim;
+};
+
+// Disassembles the instructions that -trace prints.
+class Tracer {
+  std::unique_ptr<const MCRegisterInfo> MRI;
+  std::unique_ptr<const MCAsmInfo> MAI;
+  std::unique_ptr<const MCSubtargetInfo> STI;
+  std::unique_ptr<const MCInstrInfo> MII;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<const MCDisassembler> DisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+
+public:
+  bool init() {
+    std::string Error;
+    Triple TheTriple("riscv-unknown-linux");
+    const Target *TheTarget =
+        TargetRegistry::lookupTarget("", TheTriple, Error);
+    if (!TheTarget) {
+      reportError(Error);
+      return false;
+    }
+    MRI.reset(TheTarget->createMCRegInfo(TheTriple.getTriple()));
+    MAI.reset(TheTarget->createMCAsmInfo(*MRI, TheTriple.getTriple()));
+    STI.reset(
+        TheTarget->createMCSubtargetInfo(TheTriple.getTriple(), MCPU, ""));
+    MII.reset(TheTarget->createMCInstrInfo());
+    if (!MRI || !MAI || !STI || !MII) {
+      reportError("unable to create the target descriptions");
+      return false;
+    }
+    Ctx.reset(new MCContext(MAI.get(), MRI.get(), nullptr));
+    DisAsm.reset(TheTarget->createMCDisassembler(*STI, *Ctx));
+    IP.reset(TheTarget->createMCInstPrinter(TheTriple, 0, *MAI, *MII, *MRI));
+    if (!DisAsm || !IP) {
+      reportError("this target does not support disassembly");
+      return false;
+    }
+    return true;
+  }
+
+  void print(uint32_t PC, uint32_t Insn) {
+    uint8_t Bytes[4] = {uint8_t(Insn), uint8_t(Insn >> 8), uint8_t(Insn >> 16),
+                        uint8_t(Insn >> 24)};
+    MCInst Inst;
+    uint64_t Size;
+    outs() << format("%08x: %08x  ", PC, Insn);
+    if (DisAsm->getInstruction(Inst, Size, Bytes, PC, nulls(), nulls()) ==
+        MCDisassembler::Success)
+      IP->printInst(&Inst, outs(), "", *STI);
+    else
+      outs() << "<unknown>";
+    outs() << '\n';
+  }
+};
+} // end anonymous namespace
+
+static bool parseArgs(std::vector<ArgSpec> &Specs) {
+  for (StringRef Arg : Args) {
+    ArgSpec Spec = {false, 0, false, 0};
+    int64_t Value;
+    if (Arg.startswith("buf:")) {
+      StringRef Size, Fill;
+      std::tie(Size, Fill) = Arg.drop_front(4).split(':');
+      Spec.IsBuffer = true;
+      if (Size.getAsInteger(0, Spec.Value)) {
+        reportError("invalid buffer size in '" + Arg + "'");
+        return false;
+      }
+      if (!Fill.empty()) {
+        Spec.HasFill = true;
+        if (Fill.getAsInteger(0, Value)) {
+          reportError("invalid fill word in '" + Arg + "'");
+          return false;
+        }
+        Spec.Fill = uint32_t(Value);
+      }
+    } else if (!Arg.getAsInteger(0, Value)) {
+      Spec.Value = uint32_t(Value);
+    } else {
+      reportError("invalid argument '" + Arg + "'");
+      return false;
+    }
+    Specs.push_back(Spec);
+  }
+  return true;
+}
+
+// Load Filename into a new simulator and run the function in it.
+static bool run(StringRef Filename, ArrayRef<ArgSpec> Specs,
+                Tracer *Trace, RunResult &Result) {
+  Expected<OwningBinary<ObjectFile>> BinaryOrErr =
+      ObjectFile::createObjectFile(Filename);
+  if (!BinaryOrErr) {
+    reportError(Filename + ": " + toString(BinaryOrErr.takeError()));
+    return false;
+  }
+  Result.Binary = std::move(*BinaryOrErr);
+  Result.Sim.reset(new RISCVSimulator(MemorySize, XvecHazardDistance));
+  RISCVSimulator &Sim = *Result.Sim;
+
+  // The buffers are allocated before the object is loaded, so that every
+  // run passes the same addresses, and draws the same words for them.
+  std::vector<uint32_t> Values;
+  uint32_t State = Seed * 2654435761u + 1;
+  for (unsigned I = 0, E = Specs.size(); I != E; ++I) {
+    const ArgSpec &Spec = Specs[I];
+    if (!Spec.IsBuffer) {
+      Values.push_back(Spec.Value);
+      continue;
+    }
+    Expected<uint32_t> AddressOrErr =
+        Sim.allocate("arg" + utostr(I), Spec.Value);
+    if (!AddressOrErr) {
+      reportError(Filename + ": " + toString(AddressOrErr.takeError()));
+      return false;
+    }
+    MutableArrayRef<uint8_t> Buffer =
+        Sim.getMutableMemory(*AddressOrErr, Spec.Value);
+    for (unsigned J = 0, F = Buffer.size(); J != F; ++J) {
+      if (J % 4 == 0 && !Spec.HasFill) {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+      }
+      Buffer[J] = uint8_t((Spec.HasFill ? Spec.Fill : State) >> (8 * (J % 4)));
+    }
+    Values.push_back(*AddressOrErr);
+  }
+
+  if (Error E = Sim.loadObject(*Result.Binary.getBinary())) {
+    reportError(Filename + ": " + toString(std::move(E)));
+    return false;
+  }
+  Expected<uint32_t> EntryOrErr = Sim.lookup(Entry);
+  if (!EntryOrErr) {
+    reportError(Filename + ": " + toString(EntryOrErr.takeError()));
+    return false;
+  }
+
+  if (Trace)
+    Sim.setTracer([Trace](uint32_t PC, uint32_t Insn) {
+      Trace->print(PC, Insn);
+    });
+  if (Error E = Sim.call(*EntryOrErr, Values, MaxInstructions)) {
+    reportError(Filename + ": " + Entry + ": " + toString(std::move(E)));
+    return false;
+  }
+  return true;
+}
+
+static void printReport(StringRef Filename, const RISCVSimulator &Sim) {
+  const SimStats &S = Sim.getStats();
+  raw_ostream &OS = outs();
+  OS << "File:              " << Filename << '\n';
+  OS << "Instructions:      " << S.Instructions << '\n';
+  OS << "Vector operations: " << S.VectorOps << '\n';
+  OS << "Padding no-ops:    " << S.Padding << '\n';
+  OS << "Loads:             " << S.Loads << '\n';
+  OS << "Stores:            " << S.Stores << '\n';
+  OS << "Branches:          " << S.Branches << " (" << S.TakenBranches
+     << " taken)\n";
+  OS << "Jumps:             " << S.Jumps << '\n';
+  OS << "Builtin calls:     " << S.BuiltinCalls << '\n';
+  OS << "Hazard violations: " << S.HazardViolations << '\n';
+  OS << "Return value:      " << format("0x%08x", Sim.getReg(10)) << "\n";
+
+  if (Dump) {
+    for (const MemoryRegion &R : Sim.getRegions()) {
+      if (R.IsCode)
+        continue;
+      OS << R.Name << format(" (0x%08x, ", R.Address) << R.Size
+         << " bytes):";
+      ArrayRef<uint8_t> Bytes = Sim.getMemory(R.Address, R.Size);
+      for (unsigned I = 0, E = Bytes.size(); I < E; I += 4) {
+        if (I % 32 == 0)
+          OS << "\n ";
+        uint32_t Word = 0;
+        for (unsigned J = I; J != std::min(I + 4, E); ++J)
+          Word |= uint32_t(Bytes[J]) << (8 * (J - I));
+        OS << format(" %08x", Word);
+      }
+      OS << '\n';
+    }
+  }
+  OS << '\n';
+}
+
+// Compare the final states of two runs and print the differences.  Return
+// the number of them.
+static unsigned compare(const RISCVSimulator &A, const RISCVSimulator &B) {
+  raw_ostream &OS = outs();
+  unsigned Differences = 0;
+
+  // The callee-saved registers and those the value is returned in, unless
+  // asked for all.
+  static const unsigned SavedRegs[] = {2,  3,  4,  8,  9,  18, 19,
+                                       20, 21, 22, 23, 24, 25, 26, 27};
+  std::vector<unsigned> Regs;
+  if (AllRegisters) {
+    for (unsigned R = 1; R != 32; ++R)
+      Regs.push_back(R);
+  } else {
+    Regs.assign(std::begin(SavedRegs), std::end(SavedRegs));
+    for (unsigned R = 10; R != std::min(10u + ReturnRegisters, 18u); ++R)
+      Regs.push_back(R);
+  }
+  for (unsigned R : Regs)
+    if (A.getReg(R) != B.getReg(R)) {
+      OS << "Register x" << R << ": " << format("0x%08x", A.getReg(R))
+         << " != " << format("0x%08x", B.getReg(R)) << '\n';
+      ++Differences;
+    }
+
+  // Sections and buffers are matched by name, since the two objects lay
+  // them out differently.
+  for (const MemoryRegion &RA : A.getRegions()) {
+    if (RA.IsCode)
+      continue;
+    auto RB = std::find_if(
+        B.getRegions().begin(), B.getRegions().end(),
+        [&](const MemoryRegion &R) { return R.Name == RA.Name; });
+    if (RB == B.getRegions().end() || RB->Size != RA.Size) {
+      OS << "Memory " << RA.Name << ": not in both objects, or of "
+         << "different sizes\n";
+      ++Differences;
+      continue;
+    }
+    ArrayRef<uint8_t> BytesA = A.getMemory(RA.Address, RA.Size);
+    ArrayRef<uint8_t> BytesB = B.getMemory(RB->Address, RB->Size);
+    unsigned Count = 0, First = 0;
+    for (unsigned I = 0; I != RA.Size; ++I)
+      if (BytesA[I] != BytesB[I] && !Count++)
+        First = I;
+    if (!Count)
+      continue;
+    OS << "Memory " << RA.Name << ": " << Count << " bytes differ, the first "
+       << format("at offset 0x%x (0x%02x != 0x%02x)", First, BytesA[First],
+                 BytesB[First])
+       << '\n';
+    ++Differences;
+  }
+  return Differences;
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+  ProgName = argv[0];
+
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllDisassemblers();
+
+  cl::ParseCommandLineOptions(argc, argv,
+                              "RISCV instruction set simulator\n");
+
+  if (InputFilenames.size() > 2) {
+    reportError("at most two objects can be compared");
+    return 1;
+  }
+  std::vector<ArgSpec> Specs;
+  if (!parseArgs(Specs))
+    return 1;
+
+  Tracer TheTracer;
+  if (Trace && !TheTracer.init())
+    return 1;
+
+  RunResult Results[2];
+  for (unsigned I = 0, E = InputFilenames.size(); I != E; ++I) {
+    if (!run(InputFilenames[I], Specs, Trace ? &TheTracer : nullptr,
+             Results[I]))
+      return 1;
+    printReport(InputFilenames[I], *Results[I].Sim);
+  }
+  if (InputFilenames.size() == 1)
+    return 0;
+
+  const RISCVSimulator &A = *Results[0].Sim, &B = *Results[1].Sim;
+  unsigned Differences = compare(A, B);
+  outs() << "Differences:       " << Differences << '\n';
+  outs() << "Instruction ratio: "
+         << format("%.2f", double(B.getStats().Instructions) /
+                               std::max<uint64_t>(A.getStats().Instructions,
+                                                  1))
+         << '\n';
+  return Differences ? 1 : 0;
+}
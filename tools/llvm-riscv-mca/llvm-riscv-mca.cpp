@@ -0,0 +1,827 @@
+//===-- llvm-riscv-mca.cpp - RISCV basic block throughput analyzer --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility predicts how a sequence of RISCV instructions performs when it
+// runs over and over, as the body of a loop does.  It reads assembly or an
+// object file and simulates the in-order issue of the instructions for a
+// number of iterations, using the scheduling model of the selected CPU: its
+// issue width, the latency of every write and the cycles for which each write
+// holds its processor resources.  Branches are assumed to be predicted.
+//
+// The Xvec unit is modeled explicitly.  The register operands of a vector
+// operation name banks of 28 registers, bank 1 being x1-x28 themselves, so
+// each bank is tracked as a register of its own.  The unit has no interlocks
+// with scalar accesses to x1-x28, so every instruction is also checked
+// against the hazard distance that RISCVXvecHazardRecognizer enforces.  The
+// no-ops that RISCVVectorInstrBuilder pads vector operations with are counted
+// separately from real work, and missing padding is reported.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSchedule.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCSymbol.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
+
+using namespace llvm;
+using namespace object;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<input file>"), cl::init("-"));
+
+static cl::opt<std::string>
+TripleName("mtriple", cl::desc("Target triple to analyze for"),
+           cl::init("riscv"));
+
+static cl::opt<std::string>
+MCPU("mcpu", cl::desc("Target a specific cpu type (-mcpu=help for details)"),
+     cl::value_desc("cpu-name"), cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr", cl::CommaSeparated,
+       cl::desc("Target specific attributes (-mattr=help for details)"),
+       cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned>
+Iterations("iterations", cl::desc("Number of iterations to simulate"),
+           cl::init(100));
+
+static cl::opt<std::string>
+Region("region", cl::desc("Only analyze the instructions from this label to "
+                          "the next one (assembly), or this symbol (object "
+                          "files)"),
+       cl::value_desc("label"));
+
+static cl::opt<unsigned>
+XvecHazardDistance("xvec-hazard-distance", cl::init(3),
+                   cl::desc("Issue slots the Xvec unit needs between a "
+                            "vector operation and any other access to its "
+                            "bank"));
+
+static const char *ProgName;
+
+static void reportError(const Twine &Message) {
+  errs() << ProgName << ": " << Message << '\n';
+}
+
+namespace {
+// An MCStreamer that only collects the instructions the parser hands it.
+class InstCollector : public MCStreamer {
+  std::vector<MCInst> &Insts;
+  bool InRegion;
+  bool SeenRegion;
+
+public:
+  InstCollector(MCContext &Ctx, std::vector<MCInst> &Insts)
+      : MCStreamer(Ctx), Insts(Insts), InRegion(Region.empty()),
+        SeenRegion(false) {}
+
+  bool sawRegion() const { return SeenRegion; }
+
+  void EmitLabel(MCSymbol *Symbol) override {
+    MCStreamer::EmitLabel(Symbol);
+    if (Region.empty())
+      return;
+    InRegion = Symbol->getName() == Region;
+    SeenRegion |= InRegion;
+  }
+
+  void EmitInstruction(const MCInst &Inst,
+                       const MCSubtargetInfo &STI) override {
+    if (InRegion)
+      Insts.push_back(Inst);
+  }
+
+  bool EmitSymbolAttribute(MCSymbol *Symbol,
+                           MCSymbolAttr Attribute) override {
+    return true;
+  }
+  void EmitCommonSymbol(MCSymbol *Symbol, uint64_t Size,
+                        unsigned ByteAlignment) override {}
+  void EmitZerofill(MCSection *Section, MCSymbol *Symbol = nullptr,
+                    uint64_t Size = 0, unsigned ByteAlignment = 0) override {}
+};
+
+// How an instruction relates to the Xvec unit.
+enum XvecRole {
+  XR_None,
+  XR_Vector,     // A vector operation.
+  XR_BankAccess, // A scalar instruction that names one of x1-x28.
+  XR_Padding     // A no-op that keeps a vector operation apart from the rest.
+};
+
+// A processor resource that an instruction holds for some cycles.
+struct ResourceUse {
+  unsigned Idx;
+  unsigned Cycles;
+};
+
+// What the simulation needs to know about one instruction of the block.
+struct InstrDesc {
+  std::string Text;
+  unsigned Latency;
+  SmallVector<ResourceUse, 2> Resources;
+  SmallVector<unsigned, 2> Defs;
+  SmallVector<unsigned, 3> Uses;
+  XvecRole Role;
+  // The banks a vector operation reads and writes.  Bank 0 is never
+  // tracked.
+  SmallVector<unsigned, 2> SrcBanks;
+  unsigned DstBank;
+};
+
+enum StallReason { SR_None, SR_Data, SR_Resource };
+
+// One simulated issue of an instruction of the block.
+struct IssueRecord {
+  unsigned Index;
+  uint64_t Cycle;
+  uint64_t Done;
+  StallReason Reason;
+  // The issue that held this one back, or -1.
+  int Pred;
+  unsigned Resource;
+};
+
+// What an instruction waited for, for the report.
+struct StallKey {
+  StallReason Reason;
+  unsigned PredIndex;
+  unsigned Resource;
+  bool operator<(const StallKey &Other) const {
+    return std::tie(Reason, PredIndex, Resource) <
+           std::tie(Other.Reason, Other.PredIndex, Other.Resource);
+  }
+};
+
+// Per-instruction results, summed over the iterations.
+struct InstrStats {
+  uint64_t StallCycles = 0;
+  unsigned OnCriticalPath = 0;
+  unsigned HazardViolations = 0;
+  std::map<StallKey, unsigned> Stalls;
+};
+
+// Registers are keyed by encoding, with the FP registers after the GPRs.
+// x0 is never a dependence.
+const unsigned NumRegKeys = 64;
+const unsigned FirstBankReg = 1;
+const unsigned LastBankReg = 28;
+const unsigned NumBanks = 32;
+
+class Analyzer {
+  const MCSubtargetInfo &STI;
+  const MCSchedModel &SM;
+  const MCInstrInfo &MCII;
+  const MCRegisterInfo &MRI;
+  MCInstPrinter &Printer;
+  std::vector<InstrDesc> Descs;
+  std::vector<InstrStats> Stats;
+  std::vector<IssueRecord> Issues;
+  uint64_t TotalCycles = 0;
+  unsigned TotalViolations = 0;
+
+  unsigned getRegKey(unsigned Reg) const;
+  bool isVectorOp(const MCInst &Inst) const;
+  bool isNop(const MCInst &Inst) const;
+  InstrDesc describe(const MCInst &Inst) const;
+  void markPadding();
+  std::string getResourceName(unsigned Idx) const;
+  double getBlockRThroughput() const;
+  void findCriticalPath();
+  void printStallReason(raw_ostream &OS, const InstrStats &S) const;
+
+public:
+  Analyzer(const MCSubtargetInfo &STI, const MCInstrInfo &MCII,
+           const MCRegisterInfo &MRI, MCInstPrinter &Printer)
+      : STI(STI), SM(STI.getSchedModel()), MCII(MCII), MRI(MRI),
+        Printer(Printer) {}
+
+  void analyze(ArrayRef<MCInst> Insts);
+  void print(raw_ostream &OS) const;
+};
+} // end anonymous namespace
+
+unsigned Analyzer::getRegKey(unsigned Reg) const {
+  std::string Name;
+  raw_string_ostream OS(Name);
+  Printer.printRegName(OS, Reg);
+  OS.flush();
+  unsigned Key = MRI.getEncodingValue(Reg) % 32;
+  return Name[0] == 'f' ? Key + 32 : Key;
+}
+
+bool Analyzer::isVectorOp(const MCInst &Inst) const {
+  return StringSwitch<bool>(MCII.getName(Inst.getOpcode()))
+      .Cases("ADDV", "SUBV", "SLLV", "SLTV", "SLTUV", true)
+      .Cases("XORV", "SRLV", "SRAV", "ORV", "ANDV", true)
+      .Cases("ADDIV", "XORIV", "ORIV", "ANDIV", "SLLIV", true)
+      .Cases("SRLIV", "SRAIV", "SLTIV", "SLTIUV", true)
+      .Default(false);
+}
+
+// addi x0, x0, 0 is what RISCVVectorInstrBuilder pads with.
+bool Analyzer::isNop(const MCInst &Inst) const {
+  if (StringRef(MCII.getName(Inst.getOpcode())) != "ADDI" ||
+      Inst.getNumOperands() != 3)
+    return false;
+  const MCOperand &Dst = Inst.getOperand(0);
+  const MCOperand &Src = Inst.getOperand(1);
+  const MCOperand &Imm = Inst.getOperand(2);
+  return Dst.isReg() && getRegKey(Dst.getReg()) == 0 && Src.isReg() &&
+         getRegKey(Src.getReg()) == 0 && Imm.isImm() && Imm.getImm() == 0;
+}
+
+InstrDesc Analyzer::describe(const MCInst &Inst) const {
+  InstrDesc D;
+  raw_string_ostream OS(D.Text);
+  Printer.printInst(&Inst, OS, "", STI);
+  OS.flush();
+  std::replace(D.Text.begin(), D.Text.end(), '\t', ' ');
+  D.Text = StringRef(D.Text).trim();
+
+  D.Latency = 1;
+  const MCInstrDesc &MCID = MCII.get(Inst.getOpcode());
+  if (SM.hasInstrSchedModel()) {
+    const MCSchedClassDesc *SC = SM.getSchedClassDesc(MCID.getSchedClass());
+    if (SC->isValid() && !SC->isVariant()) {
+      for (unsigned I = 0; I != SC->NumWriteLatencyEntries; ++I) {
+        int Cycles = STI.getWriteLatencyEntry(SC, I)->Cycles;
+        if (Cycles > 0)
+          D.Latency = std::max(D.Latency, unsigned(Cycles));
+      }
+      for (const MCWriteProcResEntry *PRE = STI.getWriteProcResBegin(SC),
+                                     *PEnd = STI.getWriteProcResEnd(SC);
+           PRE != PEnd; ++PRE)
+        if (PRE->Cycles)
+          D.Resources.push_back({PRE->ProcResourceIdx, PRE->Cycles});
+    }
+  }
+
+  D.DstBank = 0;
+  if (isVectorOp(Inst)) {
+    // rd names the bank written and rs1 and rs2 the banks read.
+    D.Role = XR_Vector;
+    for (unsigned I = 0, E = Inst.getNumOperands(); I != E; ++I) {
+      const MCOperand &MO = Inst.getOperand(I);
+      if (!MO.isReg())
+        continue;
+      unsigned Bank = getRegKey(MO.getReg());
+      if (I == 0)
+        D.DstBank = Bank;
+      else
+        D.SrcBanks.push_back(Bank);
+    }
+    return D;
+  }
+
+  D.Role = XR_None;
+  for (unsigned I = 0, E = Inst.getNumOperands(); I != E; ++I) {
+    const MCOperand &MO = Inst.getOperand(I);
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    unsigned Key = getRegKey(MO.getReg());
+    if (Key == 0)
+      continue;
+    if (Key >= FirstBankReg && Key <= LastBankReg)
+      D.Role = XR_BankAccess;
+    if (I < MCID.getNumDefs())
+      D.Defs.push_back(Key);
+    else
+      D.Uses.push_back(Key);
+  }
+  return D;
+}
+
+// A no-op is padding if only other no-ops separate it from a vector
+// operation, in either direction around the loop.
+void Analyzer::markPadding() {
+  unsigned N = Descs.size();
+  std::vector<bool> Nop(N);
+  for (unsigned I = 0; I != N; ++I)
+    Nop[I] = Descs[I].Role == XR_Padding;
+  for (unsigned I = 0; I != N; ++I) {
+    if (!Nop[I])
+      continue;
+    bool NextToVector = false;
+    for (int Dir : {1, -1}) {
+      unsigned J = I;
+      for (unsigned Step = 1; Step != N; ++Step) {
+        J = (J + N + Dir) % N;
+        if (!Nop[J]) {
+          NextToVector |= Descs[J].Role == XR_Vector;
+          break;
+        }
+      }
+    }
+    if (!NextToVector)
+      Descs[I].Role = XR_None;
+  }
+}
+
+void Analyzer::analyze(ArrayRef<MCInst> Insts) {
+  for (const MCInst &Inst : Insts) {
+    Descs.push_back(describe(Inst));
+    if (isNop(Inst))
+      Descs.back().Role = XR_Padding;
+  }
+  markPadding();
+  Stats.resize(Descs.size());
+
+  // When each register and bank becomes available, and which issue
+  // produces it.  Bank 1 is x1-x28 itself.
+  uint64_t RegReady[NumRegKeys] = {};
+  int RegProducer[NumRegKeys];
+  std::fill(std::begin(RegProducer), std::end(RegProducer), -1);
+  uint64_t BankReady[NumBanks] = {};
+  int BankProducer[NumBanks];
+  std::fill(std::begin(BankProducer), std::end(BankProducer), -1);
+
+  // When each unit of each resource is free again, and which issue holds it.
+  std::vector<SmallVector<uint64_t, 1>> UnitFree;
+  std::vector<SmallVector<int, 1>> UnitHolder;
+  for (unsigned Idx = 0, E = SM.getNumProcResourceKinds(); Idx != E; ++Idx) {
+    unsigned NumUnits = SM.getProcResource(Idx)->NumUnits;
+    UnitFree.emplace_back(NumUnits, 0);
+    UnitHolder.emplace_back(NumUnits, -1);
+  }
+
+  // Nothing is known about the code before the first iteration, so it is
+  // assumed to leave the Xvec unit alone.
+  const int64_t Distance = XvecHazardDistance;
+  int64_t LastVector = -Distance;
+  int64_t LastBankAccess = -Distance;
+  uint64_t Cycle = 0;
+  unsigned IssuedThisCycle = 0;
+
+  for (unsigned Iter = 0; Iter != Iterations; ++Iter) {
+    for (unsigned Index = 0, E = Descs.size(); Index != E; ++Index) {
+      const InstrDesc &D = Descs[Index];
+      IssueRecord R = {Index, Cycle, 0, SR_None,
+                       Issues.empty() ? -1 : int(Issues.size() - 1), 0};
+      if (IssuedThisCycle == SM.IssueWidth) {
+        ++R.Cycle;
+        IssuedThisCycle = 0;
+      }
+      uint64_t InOrder = R.Cycle;
+
+      auto WaitFor = [&](uint64_t Ready, int Producer, StallReason Reason,
+                         unsigned Resource) {
+        if (Ready <= R.Cycle)
+          return;
+        R.Cycle = Ready;
+        R.Pred = Producer;
+        R.Reason = Reason;
+        R.Resource = Resource;
+      };
+
+      for (unsigned Key : D.Uses)
+        WaitFor(RegReady[Key], RegProducer[Key], SR_Data, 0);
+      for (unsigned Bank : D.SrcBanks) {
+        if (Bank == 1) {
+          for (unsigned Key = FirstBankReg; Key <= LastBankReg; ++Key)
+            WaitFor(RegReady[Key], RegProducer[Key], SR_Data, 0);
+        } else if (Bank) {
+          WaitFor(BankReady[Bank], BankProducer[Bank], SR_Data, 0);
+        }
+      }
+      // The resources are not pipelined, so wait for a unit of each to be
+      // free.
+      SmallVector<unsigned, 2> Units;
+      for (const ResourceUse &RU : D.Resources) {
+        auto &Free = UnitFree[RU.Idx];
+        unsigned Unit = std::min_element(Free.begin(), Free.end()) -
+                        Free.begin();
+        Units.push_back(Unit);
+        WaitFor(Free[Unit], UnitHolder[RU.Idx][Unit], SR_Resource, RU.Idx);
+      }
+
+      if (R.Cycle != Cycle)
+        IssuedThisCycle = 0;
+      Cycle = R.Cycle;
+      ++IssuedThisCycle;
+      R.Done = R.Cycle + D.Latency;
+
+      int Self = Issues.size();
+      for (unsigned I = 0, E = D.Resources.size(); I != E; ++I) {
+        const ResourceUse &RU = D.Resources[I];
+        UnitFree[RU.Idx][Units[I]] = R.Cycle + RU.Cycles;
+        UnitHolder[RU.Idx][Units[I]] = Self;
+      }
+      for (unsigned Key : D.Defs) {
+        RegReady[Key] = R.Done;
+        RegProducer[Key] = Self;
+      }
+      if (D.DstBank == 1) {
+        for (unsigned Key = FirstBankReg; Key <= LastBankReg; ++Key) {
+          RegReady[Key] = R.Done;
+          RegProducer[Key] = Self;
+        }
+      } else if (D.DstBank) {
+        BankReady[D.DstBank] = R.Done;
+        BankProducer[D.DstBank] = Self;
+      }
+
+      // The Xvec unit does not interlock, so the distances are only checked.
+      InstrStats &S = Stats[Index];
+      int64_t Now = R.Cycle;
+      bool Violation = false;
+      if (D.Role == XR_Vector) {
+        Violation = Now - LastVector < Distance ||
+                    Now - LastBankAccess < Distance;
+        LastVector = Now;
+      } else if (D.Role == XR_BankAccess) {
+        Violation = Now - LastVector < Distance;
+        LastBankAccess = Now;
+      }
+      if (Violation) {
+        ++S.HazardViolations;
+        ++TotalViolations;
+      }
+
+      if (R.Cycle > InOrder) {
+        S.StallCycles += R.Cycle - InOrder;
+        unsigned PredIndex = R.Pred < 0 ? 0 : Issues[R.Pred].Index;
+        ++S.Stalls[{R.Reason, PredIndex, R.Resource}];
+      }
+      TotalCycles = std::max(TotalCycles, R.Done);
+      Issues.push_back(R);
+    }
+  }
+
+  findCriticalPath();
+}
+
+// Walk back from the issue that finishes last through whatever held each
+// issue back.
+void Analyzer::findCriticalPath() {
+  if (Issues.empty())
+    return;
+  int Last = 0;
+  for (int I = 0, E = Issues.size(); I != E; ++I)
+    if (Issues[I].Done >= Issues[Last].Done)
+      Last = I;
+  for (int I = Last; I >= 0; I = Issues[I].Pred)
+    ++Stats[Issues[I].Index].OnCriticalPath;
+}
+
+std::string Analyzer::getResourceName(unsigned Idx) const {
+#ifndef NDEBUG
+  return SM.getProcResource(Idx)->Name;
+#else
+  return "Resource" + utostr(Idx);
+#endif
+}
+
+double Analyzer::getBlockRThroughput() const {
+  std::vector<unsigned> Cycles(SM.getNumProcResourceKinds());
+  for (const InstrDesc &D : Descs)
+    for (const ResourceUse &RU : D.Resources)
+      Cycles[RU.Idx] += RU.Cycles;
+  double RThroughput = double(Descs.size()) / SM.IssueWidth;
+  for (unsigned Idx = 1, E = Cycles.size(); Idx != E; ++Idx)
+    RThroughput = std::max(RThroughput, double(Cycles[Idx]) /
+                                            SM.getProcResource(Idx)->NumUnits);
+  return RThroughput;
+}
+
+// Pad Str to Width columns, always leaving at least one space.
+static std::string padRight(const std::string &Str, unsigned Width) {
+  return Str + std::string(Width > Str.size() ? Width - Str.size() : 1, ' ');
+}
+
+void Analyzer::printStallReason(raw_ostream &OS, const InstrStats &S) const {
+  if (S.Stalls.empty()) {
+    OS << "-";
+    return;
+  }
+  auto Most = std::max_element(
+      S.Stalls.begin(), S.Stalls.end(),
+      [](const std::pair<const StallKey, unsigned> &A,
+         const std::pair<const StallKey, unsigned> &B) {
+        return A.second < B.second;
+      });
+  const StallKey &K = Most->first;
+  if (K.Reason == SR_Data)
+    OS << "data [" << K.PredIndex << "]";
+  else
+    OS << getResourceName(K.Resource) << " [" << K.PredIndex << "]";
+}
+
+void Analyzer::print(raw_ostream &OS) const {
+  unsigned NumInsts = Descs.size() * Iterations;
+  unsigned NumVector = 0, NumPadding = 0;
+  for (const InstrDesc &D : Descs) {
+    NumVector += D.Role == XR_Vector;
+    NumPadding += D.Role == XR_Padding;
+  }
+
+  OS << "Iterations:        " << Iterations << '\n';
+  OS << "Instructions:      " << NumInsts << '\n';
+  OS << "Total Cycles:      " << TotalCycles << '\n';
+  OS << "Issue Width:       " << SM.IssueWidth << '\n';
+  OS << "IPC:               "
+     << format("%.2f", TotalCycles ? double(NumInsts) / TotalCycles : 0.0)
+     << '\n';
+  OS << "Block RThroughput: " << format("%.1f", getBlockRThroughput())
+     << "\n\n";
+
+  OS << "Xvec:\n";
+  OS << "Hazard distance:   " << XvecHazardDistance << '\n';
+  OS << "Vector operations: " << NumVector << '\n';
+  OS << "Padding no-ops:    " << NumPadding << '\n';
+  OS << "Hazard violations: " << TotalViolations << "\n\n";
+
+  std::vector<unsigned> Resources;
+  for (unsigned Idx = 1, E = SM.getNumProcResourceKinds(); Idx != E; ++Idx)
+    Resources.push_back(Idx);
+
+  if (!Resources.empty()) {
+    OS << "Resources:\n";
+    for (unsigned I = 0, E = Resources.size(); I != E; ++I)
+      OS << "[" << I << "] - " << getResourceName(Resources[I]) << '\n';
+
+    std::vector<unsigned> Pressure(SM.getNumProcResourceKinds());
+    for (const InstrDesc &D : Descs)
+      for (const ResourceUse &RU : D.Resources)
+        Pressure[RU.Idx] += RU.Cycles;
+    std::string Header, Row;
+    for (unsigned I = 0, E = Resources.size(); I != E; ++I) {
+      Header += padRight("[" + utostr(I) + "]", 7);
+      Row += padRight(Pressure[Resources[I]]
+                                  ? utostr(Pressure[Resources[I]])
+                                  : "-", 7);
+    }
+    OS << "\nResource pressure per iteration:\n";
+    OS << StringRef(Header).rtrim() << '\n' << StringRef(Row).rtrim() << '\n';
+    OS << "\nResource pressure by instruction:\n";
+    for (unsigned I = 0, E = Resources.size(); I != E; ++I)
+      OS << padRight("[" + utostr(I) + "]", 7);
+    OS << "Instructions:\n";
+    for (const InstrDesc &D : Descs) {
+      for (unsigned Idx : Resources) {
+        unsigned Cycles = 0;
+        for (const ResourceUse &RU : D.Resources)
+          if (RU.Idx == Idx)
+            Cycles += RU.Cycles;
+        OS << padRight(Cycles ? utostr(Cycles) : "-", 7);
+      }
+      OS << D.Text << '\n';
+    }
+    OS << '\n';
+  }
+
+  OS << "Instruction info:\n";
+  OS << "[1]: Latency\n";
+  OS << "[2]: Average stall cycles\n";
+  OS << "[3]: Iterations on the critical path\n";
+  OS << "[4]: Xvec role (V vector operation, P padding, B bank access, "
+        "! hazard violated)\n";
+  OS << "[5]: What it waited for most\n\n";
+  OS << "[#]  [1]  [2]     [3]    [4]  [5]                   Instructions:\n";
+  for (unsigned I = 0, E = Descs.size(); I != E; ++I) {
+    const InstrDesc &D = Descs[I];
+    const InstrStats &S = Stats[I];
+    std::string Role;
+    if (D.Role == XR_Vector)
+      Role = "V";
+    else if (D.Role == XR_Padding)
+      Role = "P";
+    else if (D.Role == XR_BankAccess && NumVector)
+      Role = "B";
+    if (S.HazardViolations)
+      Role += "!";
+    std::string Reason;
+    raw_string_ostream ReasonOS(Reason);
+    printStallReason(ReasonOS, S);
+    ReasonOS.flush();
+    OS << padRight(utostr(I), 5) << padRight(utostr(D.Latency), 5)
+       << format("%-8.2f", double(S.StallCycles) / Iterations)
+       << padRight(utostr(S.OnCriticalPath), 7)
+       << padRight(Role.empty() ? "-" : Role, 5)
+       << padRight(Reason, 22) << D.Text << '\n';
+  }
+}
+
+static bool collectFromAssembly(std::unique_ptr<MemoryBuffer> Buffer,
+                                const Target *TheTarget,
+                                const MCRegisterInfo &MRI,
+                                const MCAsmInfo &MAI,
+                                const MCSubtargetInfo &STI,
+                                const MCInstrInfo &MCII,
+                                std::vector<MCInst> &Insts) {
+  SourceMgr SrcMgr;
+  SrcMgr.AddNewSourceBuffer(std::move(Buffer), SMLoc());
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(&MAI, &MRI, &MOFI, &SrcMgr);
+  MOFI.InitMCObjectFileInfo(Triple(TripleName), /*PIC=*/false,
+                            CodeModel::Default, Ctx);
+
+  InstCollector Collector(Ctx, Insts);
+  std::unique_ptr<MCAsmParser> Parser(
+      createMCAsmParser(SrcMgr, Ctx, Collector, MAI));
+  MCTargetOptions MCOptions;
+  std::unique_ptr<MCTargetAsmParser> TAP(
+      TheTarget->createMCAsmParser(STI, *Parser, MCII, MCOptions));
+  if (!TAP) {
+    reportError("this target does not support assembly parsing");
+    return false;
+  }
+  Parser->setTargetParser(*TAP);
+  if (Parser->Run(/*NoInitialTextSection=*/false))
+    return false;
+  if (!Region.empty() && !Collector.sawRegion()) {
+    reportError("no label named '" + Region + "'");
+    return false;
+  }
+  return true;
+}
+
+static bool collectFromObject(const ObjectFile &Obj,
+                              const MCDisassembler &DisAsm,
+                              std::vector<MCInst> &Insts) {
+  uint64_t Begin = 0, End = 0;
+  SectionRef RegionSection;
+  if (!Region.empty()) {
+    bool Found = false;
+    for (const SymbolRef &Sym : Obj.symbols()) {
+      Expected<StringRef> Name = Sym.getName();
+      if (!Name || *Name != Region)
+        continue;
+      Expected<uint64_t> Address = Sym.getAddress();
+      Expected<section_iterator> Section = Sym.getSection();
+      if (!Address || !Section || *Section == Obj.section_end())
+        break;
+      RegionSection = **Section;
+      Begin = *Address;
+      End = Begin;
+      if (isa<ELFObjectFileBase>(&Obj))
+        End += ELFSymbolRef(Sym).getSize();
+      if (End == Begin)
+        End = RegionSection.getAddress() + RegionSection.getSize();
+      Found = true;
+      break;
+    }
+    if (!Found) {
+      reportError("no symbol named '" + Region + "'");
+      return false;
+    }
+  }
+
+  for (const SectionRef &Section : Obj.sections()) {
+    if (!Section.isText())
+      continue;
+    if (!Region.empty() && Section != RegionSection)
+      continue;
+    StringRef Contents;
+    if (Section.getContents(Contents))
+      continue;
+    ArrayRef<uint8_t> Bytes(
+        reinterpret_cast<const uint8_t *>(Contents.data()), Contents.size());
+    uint64_t SectionAddr = Section.getAddress();
+    uint64_t Start = 0, Stop = Bytes.size();
+    if (!Region.empty()) {
+      Start = Begin - SectionAddr;
+      Stop = std::min<uint64_t>(End - SectionAddr, Stop);
+    }
+    for (uint64_t Offset = Start, Size = 0; Offset < Stop; Offset += Size) {
+      MCInst Inst;
+      if (DisAsm.getInstruction(Inst, Size, Bytes.slice(Offset),
+                                SectionAddr + Offset, nulls(), nulls()) !=
+          MCDisassembler::Success) {
+        reportError("invalid instruction encoding at offset 0x" +
+                    utohexstr(SectionAddr + Offset));
+        return false;
+      }
+      Insts.push_back(Inst);
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+  ProgName = argv[0];
+
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllAsmParsers();
+  InitializeAllDisassemblers();
+
+  cl::ParseCommandLineOptions(argc, argv,
+                              "RISCV basic block throughput analyzer\n");
+
+  if (!Iterations) {
+    reportError("-iterations must be at least 1");
+    return 1;
+  }
+
+  Triple TheTriple(Triple::normalize(TripleName));
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget("", TheTriple, Error);
+  if (!TheTarget) {
+    reportError(Error);
+    return 1;
+  }
+  TripleName = TheTriple.getTriple();
+
+  // vscale is the core the Xvec unit is attached to.
+  if (MCPU.empty())
+    MCPU = TheTriple.isArch64Bit() ? "Rocket" : "vscale";
+  std::string FeaturesStr;
+  for (unsigned I = 0; I != MAttrs.size(); ++I)
+    FeaturesStr += (I ? "," : "") + MAttrs[I];
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TripleName, MCPU, FeaturesStr));
+  std::unique_ptr<MCInstPrinter> Printer(TheTarget->createMCInstPrinter(
+      TheTriple, /*SyntaxVariant=*/0, *MAI, *MCII, *MRI));
+  if (!MRI || !MAI || !MCII || !STI || !Printer) {
+    reportError("unable to create the target descriptions");
+    return 1;
+  }
+  if (!STI->getSchedModel().hasInstrSchedModel())
+    reportError("warning: '" + MCPU + "' has no scheduling model, assuming "
+                "single-cycle instructions");
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (std::error_code EC = BufferOrErr.getError()) {
+    reportError(InputFilename + ": " + EC.message());
+    return 1;
+  }
+
+  std::vector<MCInst> Insts;
+  sys::fs::file_magic Magic =
+      sys::fs::identify_magic((*BufferOrErr)->getBuffer());
+  if (Magic == sys::fs::file_magic::unknown) {
+    if (!collectFromAssembly(std::move(*BufferOrErr), TheTarget, *MRI, *MAI,
+                             *STI, *MCII, Insts))
+      return 1;
+  } else {
+    Expected<std::unique_ptr<ObjectFile>> ObjOrErr =
+        ObjectFile::createObjectFile((*BufferOrErr)->getMemBufferRef(), Magic);
+    if (!ObjOrErr) {
+      reportError(InputFilename + ": " + toString(ObjOrErr.takeError()));
+      return 1;
+    }
+    MCContext Ctx(MAI.get(), MRI.get(), nullptr);
+    std::unique_ptr<MCDisassembler> DisAsm(
+        TheTarget->createMCDisassembler(*STI, Ctx));
+    if (!DisAsm) {
+      reportError("this target does not support disassembly");
+      return 1;
+    }
+    if (!collectFromObject(**ObjOrErr, *DisAsm, Insts))
+      return 1;
+  }
+
+  if (Insts.empty()) {
+    reportError("no instructions to analyze");
+    return 1;
+  }
+
+  Analyzer A(*STI, *MCII, *MRI, *Printer);
+  A.analyze(Insts);
+  A.print(outs());
+  return 0;
+}